@@ -0,0 +1,322 @@
+/**
+ * Hot Path Benchmark Harness
+ *
+ * Drives the per-message code paths (state engines, checksum, metrics,
+ * writers) with synthetic order book traffic and reports time per operation.
+ * When built with -DKRAKEN_ALLOC_INSTRUMENTATION=ON it also reports heap
+ * allocations per instrumented site and fails if a path declared
+ * allocation-free allocated.
+ *
+ * Usage:
+ *   ./benchmark_hot_paths
+ *   ./benchmark_hot_paths -n 200000 --output-dir /tmp
+ *   ./benchmark_hot_paths --assert-alloc-free     # abort on first violation
+ *   ./benchmark_hot_paths --trace-file trace.json # with -DKRAKEN_STAGE_TRACING=ON
+ *
+ * Exit code:
+ *   0 - all allocation-free paths stayed allocation-free
+ *   1 - at least one violation (or invalid arguments)
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include "cli_utils.hpp"
+#include "alloc_counter.hpp"
+#include "stage_trace.hpp"
+#include "orderbook_common.hpp"
+#include "orderbook_state.hpp"
+#include "jsonl_writer.hpp"
+#include "snapshot_csv_writer.hpp"
+#include "level3_common.hpp"
+#include "level3_state.hpp"
+
+using namespace kraken;
+
+// ============================================================================
+// Synthetic data
+// ============================================================================
+
+constexpr double MID_PRICE = 50000.0;
+constexpr double TICK_SIZE = 0.1;
+constexpr int SNAPSHOT_LEVELS = 100;
+constexpr int UPDATE_WINDOW = 25;  // Updates touch the top N levels
+
+OrderBookRecord make_snapshot(std::mt19937& rng) {
+    std::uniform_real_distribution<double> qty(0.01, 5.0);
+
+    OrderBookRecord record;
+    record.timestamp = "2025-01-01 00:00:00.000";
+    record.symbol = "BTC/USD";
+    record.type = "snapshot";
+
+    for (int i = 0; i < SNAPSHOT_LEVELS; i++) {
+        record.bids.emplace_back(MID_PRICE - TICK_SIZE * (i + 1), qty(rng));
+        record.asks.emplace_back(MID_PRICE + TICK_SIZE * (i + 1), qty(rng));
+    }
+    return record;
+}
+
+std::vector<OrderBookRecord> make_updates(std::mt19937& rng, size_t count) {
+    std::uniform_int_distribution<int> level(1, UPDATE_WINDOW);
+    std::uniform_real_distribution<double> qty(0.01, 5.0);
+    std::uniform_int_distribution<int> coin(0, 9);
+
+    std::vector<OrderBookRecord> updates(count);
+    for (auto& record : updates) {
+        record.timestamp = "2025-01-01 00:00:00.000";
+        record.symbol = "BTC/USD";
+        record.type = "update";
+
+        // One in ten updates removes a level, the rest resize one
+        double q = coin(rng) == 0 ? 0.0 : qty(rng);
+        if (coin(rng) < 5) {
+            record.bids.emplace_back(MID_PRICE - TICK_SIZE * level(rng), q);
+        } else {
+            record.asks.emplace_back(MID_PRICE + TICK_SIZE * level(rng), q);
+        }
+    }
+    return updates;
+}
+
+std::vector<Level3Record> make_level3_events(std::mt19937& rng, size_t count) {
+    std::uniform_int_distribution<int> level(1, UPDATE_WINDOW);
+    std::uniform_real_distribution<double> qty(0.01, 2.0);
+
+    std::vector<Level3Record> events;
+    events.reserve(count);
+
+    // add -> modify -> delete cycles so the book stays bounded
+    for (size_t i = 0; events.size() < count; i++) {
+        bool is_bid = (i % 2) == 0;
+        double price = is_bid ? MID_PRICE - TICK_SIZE * level(rng)
+                              : MID_PRICE + TICK_SIZE * level(rng);
+        std::string id = "O" + std::to_string(i);
+
+        const char* lifecycle[] = {"add", "modify", "delete"};
+        for (const char* event : lifecycle) {
+            Level3Record record;
+            record.timestamp = "2025-01-01 00:00:00.000";
+            record.symbol = "BTC/USD";
+            record.type = "update";
+
+            Level3Order order(id, price, qty(rng), "2025-01-01T00:00:00.000000Z");
+            order.event = event;
+            (is_bid ? record.bids : record.asks).push_back(order);
+            events.push_back(record);
+        }
+    }
+    events.resize(count);
+    return events;
+}
+
+// ============================================================================
+// Timing helpers
+// ============================================================================
+
+struct BenchResult {
+    std::string name;
+    size_t operations;
+    double ns_per_op;
+};
+
+template<typename Fn>
+BenchResult run_bench(const std::string& name, size_t operations, Fn&& fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < operations; i++) {
+        fn(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    return BenchResult{name, operations, operations > 0 ? ns / operations : 0.0};
+}
+
+void print_results(const std::vector<BenchResult>& results) {
+    std::cout << std::left << std::setw(40) << "Benchmark"
+              << std::right << std::setw(12) << "Ops"
+              << std::setw(14) << "ns/op" << std::endl;
+    std::cout << std::string(66, '-') << std::endl;
+
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(40) << r.name
+                  << std::right << std::setw(12) << r.operations
+                  << std::setw(14) << std::fixed << std::setprecision(1) << r.ns_per_op
+                  << std::endl;
+    }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    cli::ArgumentParser parser(argv[0], "Benchmark per-message hot paths and report heap allocations");
+
+    parser.add_argument({
+        "-n", "--iterations",
+        "Operations per benchmark",
+        false,  // optional
+        true,   // has value
+        "100000",
+        "N"
+    });
+
+    parser.add_argument({
+        "", "--output-dir",
+        "Directory for temporary writer output",
+        false,  // optional
+        true,   // has value
+        ".",
+        "DIR"
+    });
+
+    parser.add_argument({
+        "", "--assert-alloc-free",
+        "Abort on the first allocation inside an allocation-free path",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--trace-file",
+        "Write stage trace (Chrome JSON) after the run (needs KRAKEN_STAGE_TRACING build)",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
+    if (!parser.parse(argc, argv)) {
+        if (!parser.get_errors().empty()) {
+            for (const auto& error : parser.get_errors()) {
+                std::cerr << "Error: " << error << std::endl;
+            }
+            std::cerr << std::endl;
+            parser.print_help();
+            return 1;
+        }
+        return 0; // Help shown
+    }
+
+    size_t iterations = 0;
+    try {
+        iterations = std::stoul(parser.get("-n"));
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid iteration count: " << parser.get("-n") << std::endl;
+        return 1;
+    }
+
+    std::string output_dir = parser.get("--output-dir");
+    alloc::set_assert_mode(parser.has("--assert-alloc-free"));
+
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Hot Path Benchmark" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Iterations: " << iterations << std::endl;
+    std::cout << "Allocation instrumentation: "
+              << (alloc::instrumentation_enabled() ? "enabled" : "disabled") << std::endl;
+    std::cout << "Assert mode: " << (alloc::assert_mode() ? "on" : "off") << std::endl;
+    std::cout << "Stage tracing: " << (trace::tracing_enabled() ? "enabled" : "disabled") << std::endl;
+    std::cout << std::endl;
+
+    // Generate all input up front so setup allocations stay out of the report
+    std::mt19937 rng(42);
+    OrderBookRecord snapshot = make_snapshot(rng);
+    std::vector<OrderBookRecord> updates = make_updates(rng, iterations);
+    std::vector<Level3Record> level3_events = make_level3_events(rng, iterations);
+
+    std::string jsonl_path = output_dir + "/benchmark_hot_paths.jsonl";
+    std::string csv_path = output_dir + "/benchmark_hot_paths.csv";
+
+    std::vector<BenchResult> results;
+
+    // Warm up state once, then reset counters so only steady state is measured
+    OrderBookState state("BTC/USD");
+    state.apply(snapshot);
+    alloc::reset_report();
+
+    results.push_back(run_bench("orderbook_state.apply", iterations, [&](size_t i) {
+        state.apply(updates[i]);
+    }));
+
+    volatile double sink = 0.0;
+    results.push_back(run_bench("orderbook_state.queries", iterations, [&](size_t) {
+        sink = sink + state.get_bid_volume_top_n(10) + state.get_ask_volume_top_n(10)
+                    + state.get_bid_volume_within_bps(MID_PRICE, 25.0)
+                    + state.get_ask_volume_within_bps(MID_PRICE, 25.0);
+    }));
+
+    results.push_back(run_bench("checksum.validate(snapshot)", iterations / 10, [&](size_t) {
+        sink = sink + (ChecksumValidator::validate(snapshot) ? 1.0 : 0.0);
+    }));
+
+    {
+        SnapshotCSVWriter csv_writer(csv_path);
+        if (!csv_writer.is_open()) {
+            return 1;
+        }
+
+        results.push_back(run_bench("metrics+snapshot_csv_writer", iterations / 10, [&](size_t) {
+            SnapshotMetrics metrics = MetricsCalculator::calculate(state, snapshot.timestamp);
+            csv_writer.write_snapshot(metrics);
+        }));
+    }
+
+    {
+        JsonLinesWriter jsonl_writer(jsonl_path);  // Opens on first write
+
+        results.push_back(run_bench("jsonl_writer.write_record", iterations, [&](size_t i) {
+            jsonl_writer.write_record(updates[i]);
+        }));
+        jsonl_writer.flush();
+    }
+
+    Level3OrderBookState level3_state("BTC/USD");
+    results.push_back(run_bench("level3_state.apply_update", iterations, [&](size_t i) {
+        level3_state.apply_update(level3_events[i]);
+    }));
+
+    results.push_back(run_bench("level3_state.queries", iterations, [&](size_t) {
+        sink = sink + level3_state.get_bid_volume_within_bps(MID_PRICE, 25.0)
+                    + level3_state.get_ask_volume_within_bps(MID_PRICE, 25.0);
+    }));
+
+    std::remove(jsonl_path.c_str());
+    std::remove(csv_path.c_str());
+
+    // Report
+    std::cout << "Timing" << std::endl;
+    print_results(results);
+    std::cout << std::endl;
+
+    std::cout << "Heap allocations" << std::endl;
+    alloc::print_report(std::cout);
+    std::cout << std::endl;
+
+    std::string trace_file = parser.get("--trace-file");
+    if (!trace_file.empty()) {
+        if (trace::tracing_enabled()) {
+            trace::dump_chrome_trace(trace_file);
+        } else {
+            std::cerr << "[Warning] --trace-file ignored: rebuild with -DKRAKEN_STAGE_TRACING=ON" << std::endl;
+        }
+        std::cout << std::endl;
+    }
+
+    uint64_t violations = alloc::total_violations();
+    if (violations > 0) {
+        std::cerr << "FAILED: " << violations
+                  << " allocation(s) inside allocation-free paths" << std::endl;
+        return 1;
+    }
+
+    std::cout << "All allocation-free paths stayed allocation-free" << std::endl;
+    return 0;
+}
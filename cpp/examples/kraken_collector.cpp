@@ -0,0 +1,565 @@
+/**
+ * Kraken Collector - Config-Driven Multi-Channel Collector
+ *
+ * Runs any number of ticker / book / level3 symbol groups in one process,
+ * replacing one retrieve_kraken_live_data_level1/2/3 process per group:
+ * - One WebSocket connection per group, all on a shared I/O thread pool
+ * - Book and level3 output written by a shared writer pool, off the I/O threads
+ * - One [METRICS] report covering every group, the pools and the writers
+ *
+ * Usage:
+ *   ./kraken_collector -c collector.ini
+ *   ./kraken_collector -c collector.ini --check
+ *
+ * See lib/collector_config.hpp for the configuration format.
+ *
+ * Output:
+ *   ticker groups: .csv (written by the client, same as level1)
+ *   book groups:   .jsonl (same as level2)
+ *   level3 groups: .jsonl (same as level3)
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <csignal>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <thread>
+#include "kraken_websocket_client_simdjson_v2.hpp"
+#include "kraken_book_client.hpp"
+#include "kraken_level3_client.hpp"
+#include "cli_utils.hpp"
+#include "stage_trace.hpp"
+#include "collector_config.hpp"
+#include "io_service_pool.hpp"
+#include "writer_pool.hpp"
+#include "jsonl_writer.hpp"
+#include "level3_jsonl_writer.hpp"
+#include "tls_session_cache.hpp"
+#include "websocket_deflate.hpp"
+#include "socket_tuning.hpp"
+
+using kraken::KrakenWebSocketClientSimdjsonV2;
+using kraken::KrakenBookClient;
+using kraken::KrakenLevel3Client;
+using kraken::TickerRecord;
+using kraken::OrderBookRecord;
+using kraken::Level3Record;
+using kraken::JsonLinesWriter;
+using kraken::MultiFileJsonLinesWriter;
+using kraken::Level3JsonLinesWriter;
+using kraken::MultiFileLevel3JsonLinesWriter;
+using kraken::CollectorConfig;
+using kraken::CollectorConfigParser;
+using kraken::ChannelGroupConfig;
+using kraken::CollectorChannel;
+using kraken::IoServicePool;
+using kraken::WriterPool;
+using kraken::TlsSessionCache;
+using kraken::WebSocketDeflate;
+using kraken::WatchdogStats;
+
+// Global state
+std::atomic<bool> g_running{true};
+std::mutex g_cv_mutex;
+std::condition_variable g_cv;
+
+void signal_handler(int) {
+    std::cout << "\n\nShutting down..." << std::endl;
+    g_running = false;
+    g_cv.notify_all();
+}
+
+// ============================================================================
+// Collector group: one connection and its output
+// ============================================================================
+
+struct CollectorGroup {
+    ChannelGroupConfig config;
+    size_t lane;  // Writer pool lane (book / level3)
+
+    // Exactly one client is set, matching config.channel
+    std::unique_ptr<KrakenWebSocketClientSimdjsonV2> ticker_client;
+    std::unique_ptr<KrakenBookClient> book_client;
+    std::unique_ptr<KrakenLevel3Client> level3_client;
+
+    // Output (book / level3; ticker writes through its client)
+    std::unique_ptr<JsonLinesWriter> book_writer;
+    std::unique_ptr<MultiFileJsonLinesWriter> book_multi_writer;
+    std::unique_ptr<Level3JsonLinesWriter> level3_writer;
+    std::unique_ptr<MultiFileLevel3JsonLinesWriter> level3_multi_writer;
+
+    // Counters (messages on I/O / parser threads, records on writer lanes)
+    std::atomic<uint64_t> messages{0};
+    std::atomic<uint64_t> records_written{0};
+    std::atomic<uint64_t> errors{0};
+    uint64_t last_messages = 0;  // Main thread only
+    bool watchdog = false;       // Feed watchdog enabled
+
+    bool is_running() const {
+        if (ticker_client) return ticker_client->is_running();
+        if (book_client) return book_client->is_running();
+        if (level3_client) return level3_client->is_running();
+        return false;
+    }
+
+    WatchdogStats get_watchdog_stats() const {
+        if (ticker_client) return ticker_client->get_watchdog_stats();
+        if (book_client) return book_client->get_watchdog_stats();
+        if (level3_client) return level3_client->get_watchdog_stats();
+        return WatchdogStats();
+    }
+
+    bool is_connected() const {
+        if (ticker_client) return ticker_client->is_connected();
+        if (book_client) return book_client->is_connected();
+        if (level3_client) return level3_client->is_connected();
+        return false;
+    }
+
+    void stop() {
+        if (ticker_client) ticker_client->stop();
+        if (book_client) book_client->stop();
+        if (level3_client) level3_client->stop();
+    }
+
+    // After the I/O threads stopped: level3 frames still queued for parsing
+    void drain() {
+        if (level3_client) level3_client->drain_parse_pool();
+    }
+
+    // Writer lane only
+    void write(const OrderBookRecord& record) {
+        bool ok = book_multi_writer ? book_multi_writer->write_record(record)
+                                    : book_writer->write_record(record);
+        (ok ? records_written : errors)++;
+    }
+
+    void write(const Level3Record& record) {
+        bool ok = level3_multi_writer ? level3_multi_writer->write_record(record)
+                                      : level3_writer->write_record(record);
+        (ok ? records_written : errors)++;
+    }
+
+    // Main thread, after the writer pool stopped
+    void flush() {
+        if (book_multi_writer) book_multi_writer->flush_all();
+        if (book_writer) book_writer->flush();
+        if (level3_multi_writer) level3_multi_writer->flush_all();
+        if (level3_writer) level3_writer->flush();
+        if (ticker_client) ticker_client->flush();
+    }
+};
+
+/**
+ * Create the client and output for one group
+ * @return false on configuration errors (e.g. missing token)
+ */
+bool setup_group(CollectorGroup& group, IoServicePool& io_pool, WriterPool& writer_pool,
+                 const CollectorConfig& collector) {
+    const ChannelGroupConfig& cfg = group.config;
+    CollectorGroup* g = &group;
+    auto error_callback = [g](const std::string& error) {
+        g->errors++;
+        std::cerr << "[ERROR] [" << g->config.name << "] " << error << std::endl;
+    };
+    auto connection_callback = [g](bool connected) {
+        std::cout << "[STATUS] [" << g->config.name << "] WebSocket "
+                  << (connected ? "connected" : "disconnected") << std::endl;
+    };
+
+    if (cfg.channel == CollectorChannel::TICKER) {
+        if (cfg.separate_files) {
+            std::cerr << "[Warning] [" << cfg.name << "] separate_files is not supported for ticker groups" << std::endl;
+        }
+
+        // Ticker output is buffered and written by the client (same as level1)
+        group.ticker_client.reset(new KrakenWebSocketClientSimdjsonV2());
+        KrakenWebSocketClientSimdjsonV2& client = *group.ticker_client;
+        client.set_io_service(io_pool.get_io_service());
+        client.set_socket_options(collector.socket_options);
+        client.set_output_file(cfg.output);
+        client.set_flush_interval(std::chrono::seconds(cfg.flush_interval_seconds));
+        client.set_memory_threshold(cfg.memory_threshold_bytes);
+        if (cfg.segment_mode != kraken::SegmentMode::NONE) {
+            client.set_segment_mode(cfg.segment_mode);
+        }
+        client.set_update_callback([g](const TickerRecord&) {
+            g->messages++;
+            g->records_written++;
+        });
+        client.set_connection_callback(connection_callback);
+        client.set_error_callback(error_callback);
+        client.set_watchdog(collector.watchdog);
+        group.watchdog = collector.watchdog.enabled();
+        return true;
+    }
+
+    group.lane = writer_pool.assign_lane();
+
+    if (cfg.channel == CollectorChannel::BOOK) {
+        if (cfg.separate_files) {
+            group.book_multi_writer.reset(new MultiFileJsonLinesWriter(cfg.output));
+            group.book_multi_writer->set_flush_interval(std::chrono::seconds(cfg.flush_interval_seconds));
+            group.book_multi_writer->set_memory_threshold(cfg.memory_threshold_bytes);
+            group.book_multi_writer->set_segment_mode(cfg.segment_mode);
+        } else {
+            group.book_writer.reset(new JsonLinesWriter(cfg.output));
+            group.book_writer->set_flush_interval(std::chrono::seconds(cfg.flush_interval_seconds));
+            group.book_writer->set_memory_threshold(cfg.memory_threshold_bytes);
+            if (cfg.segment_mode != kraken::SegmentMode::NONE) {
+                group.book_writer->set_segment_mode(cfg.segment_mode);
+            }
+        }
+
+        group.book_client.reset(new KrakenBookClient(cfg.depth));
+        KrakenBookClient& client = *group.book_client;
+        client.set_io_service(io_pool.get_io_service());
+        client.set_socket_options(collector.socket_options);
+        client.set_watchdog(collector.watchdog);
+        group.watchdog = collector.watchdog.enabled();
+        client.set_update_callback([g, &writer_pool](const OrderBookRecord& record) {
+            g->messages++;
+            writer_pool.submit(g->lane, [g, record]() { g->write(record); });
+        });
+        client.set_connection_callback(connection_callback);
+        client.set_error_callback(error_callback);
+        return true;
+    }
+
+    // Level 3
+    group.level3_client.reset(new KrakenLevel3Client(cfg.depth));
+    KrakenLevel3Client& client = *group.level3_client;
+
+    bool token_set = cfg.token_file.empty() ? client.set_token_from_env()
+                                            : client.set_token_from_file(cfg.token_file);
+    if (!token_set) {
+        std::cerr << "[Error] [" << cfg.name << "] No valid authentication token found ("
+                  << (cfg.token_file.empty() ? "KRAKEN_WS_TOKEN" : cfg.token_file) << ")" << std::endl;
+        return false;
+    }
+
+    if (cfg.separate_files) {
+        group.level3_multi_writer.reset(new MultiFileLevel3JsonLinesWriter(cfg.output));
+        group.level3_multi_writer->set_flush_interval(std::chrono::seconds(cfg.flush_interval_seconds));
+        group.level3_multi_writer->set_memory_threshold(cfg.memory_threshold_bytes);
+        group.level3_multi_writer->set_segment_mode(cfg.segment_mode);
+    } else {
+        group.level3_writer.reset(new Level3JsonLinesWriter(cfg.output));
+        if (!group.level3_writer->is_open()) {
+            std::cerr << "[Error] [" << cfg.name << "] Failed to open output file: " << cfg.output << std::endl;
+            return false;
+        }
+        group.level3_writer->set_flush_interval(std::chrono::seconds(cfg.flush_interval_seconds));
+        group.level3_writer->set_memory_threshold(cfg.memory_threshold_bytes);
+        if (cfg.segment_mode != kraken::SegmentMode::NONE) {
+            group.level3_writer->set_segment_mode(cfg.segment_mode);
+        }
+    }
+
+    client.set_io_service(io_pool.get_io_service());
+    client.set_socket_options(collector.socket_options);
+    client.set_watchdog(collector.watchdog);
+    group.watchdog = collector.watchdog.enabled();
+    if (cfg.validate_checksum && cfg.checksum_precision.empty()) {
+        std::cerr << "[Warning] [" << cfg.name << "] validate_checksum without checksum_precision verifies nothing" << std::endl;
+    }
+    client.set_checksum_validation(cfg.validate_checksum);
+    for (const auto& entry : cfg.checksum_precision) {
+        client.set_checksum_precision(entry.first, entry.second.first, entry.second.second);
+    }
+    client.set_parse_threads(collector.parse_threads, collector.parse_placement);
+    client.set_update_callback([g, &writer_pool](const Level3Record& record) {
+        g->messages++;
+        writer_pool.submit(g->lane, [g, record]() { g->write(record); });
+    });
+    client.set_connection_callback(connection_callback);
+    client.set_error_callback(error_callback);
+    return true;
+}
+
+bool start_group(CollectorGroup& group) {
+    const auto& symbols = group.config.symbols;
+    if (group.ticker_client) return group.ticker_client->start(symbols);
+    if (group.book_client) return group.book_client->start(symbols);
+    if (group.level3_client) return group.level3_client->start(symbols);
+    return false;
+}
+
+// ============================================================================
+// Metrics
+// ============================================================================
+
+void print_metrics(std::vector<std::unique_ptr<CollectorGroup>>& groups,
+                   const WriterPool& writer_pool, double interval_seconds) {
+    auto pool_stats = writer_pool.get_stats();
+
+    std::cout << "[METRICS] writer_pool: " << pool_stats.queued << " queued (max "
+              << pool_stats.max_queued << "), " << pool_stats.executed << "/"
+              << pool_stats.submitted << " done" << std::endl;
+
+    // TLS handshakes of all groups (one shared context and session cache)
+    auto tls_stats = TlsSessionCache::instance().get_stats();
+    std::cout << "[METRICS] tls: " << tls_stats.handshakes << " handshakes ("
+              << tls_stats.resumed << " resumed), avg " << std::fixed << std::setprecision(1)
+              << tls_stats.avg_ms() << " ms, max " << tls_stats.max_ms << " ms" << std::endl;
+
+    if (WebSocketDeflate::is_enabled()) {
+        auto deflate_stats = WebSocketDeflate::get_stats();
+        std::cout << "[METRICS] deflate: " << deflate_stats.compressed_bytes / 1024 << " KB -> "
+                  << deflate_stats.inflated_bytes / 1024 << " KB (" << deflate_stats.ratio()
+                  << "x), inflate " << deflate_stats.inflate_ns / 1000000 << " ms ("
+                  << deflate_stats.ns_per_inflated_byte() << " ns/byte)" << std::endl;
+    }
+
+    for (auto& group : groups) {
+        uint64_t messages = group->messages;
+        double rate = interval_seconds > 0 ? (messages - group->last_messages) / interval_seconds : 0.0;
+        group->last_messages = messages;
+
+        std::cout << "[METRICS] " << std::left << std::setw(16) << group->config.name << std::right
+                  << " " << std::setw(6) << CollectorConfigParser::channel_name(group->config.channel)
+                  << " " << (group->is_connected() ? "up  " : "down")
+                  << " msgs=" << messages
+                  << " rate=" << std::fixed << std::setprecision(1) << rate << "/s"
+                  << " written=" << group->records_written
+                  << " errors=" << group->errors;
+
+        if (group->level3_client && group->config.validate_checksum) {
+            int mismatches = 0;
+            int resyncs = 0;
+            for (const auto& pair : group->level3_client->get_stats()) {
+                mismatches += pair.second.checksum_mismatches;
+                resyncs += pair.second.resync_count;
+            }
+            std::cout << " checksum_mismatches=" << mismatches << " resyncs=" << resyncs;
+        }
+        if (group->watchdog) {
+            WatchdogStats wd = group->get_watchdog_stats();
+            std::cout << " rtt=" << std::setprecision(1) << wd.last_rtt_ms << "ms"
+                      << " reconnects=" << wd.stale_connections
+                      << " resubscribed=" << wd.stale_symbols;
+        }
+        std::cout << std::endl;
+    }
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char* argv[]) {
+    cli::ArgumentParser parser(argv[0], "Collect several Kraken channels and symbol groups in one process");
+
+    parser.add_argument({
+        "-c", "--config",
+        "Collector configuration file",
+        true,   // required
+        true,   // has value
+        "",
+        "FILE"
+    });
+
+    parser.add_argument({
+        "", "--check",
+        "Validate the configuration and exit",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--trace-file",
+        "Write stage trace (Chrome JSON) on SIGUSR1 and at exit (needs KRAKEN_STAGE_TRACING build)",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
+    if (!parser.parse(argc, argv)) {
+        if (!parser.get_errors().empty()) {
+            for (const auto& error : parser.get_errors()) {
+                std::cerr << "Error: " << error << std::endl;
+            }
+            std::cerr << std::endl;
+            parser.print_help();
+            return 1;
+        }
+        return 0; // Help shown
+    }
+
+    std::string config_file = parser.get("-c");
+
+    CollectorConfig config;
+    std::string config_error;
+    if (!CollectorConfigParser::parse_file(config_file, config, config_error)) {
+        std::cerr << "Error: " << config_file << ": " << config_error << std::endl;
+        return 1;
+    }
+
+    // Display configuration
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Kraken Collector" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Config file: " << config_file << std::endl;
+    std::cout << "I/O threads: " << config.io_threads << std::endl;
+    std::cout << "Writer threads: " << config.writer_threads << std::endl;
+    std::cout << "I/O placement: " << config.io_placement.describe()
+              << (config.io_spin ? " (spin)" : "") << std::endl;
+    std::cout << "Writer placement: " << config.writer_placement.describe() << std::endl;
+    if (config.parse_threads > 0) {
+        std::cout << "Parse threads: " << config.parse_threads << " per level3 group ("
+                  << config.parse_placement.describe() << ")" << std::endl;
+    }
+    std::cout << "Status interval: " << config.status_interval_seconds << " seconds" << std::endl;
+    std::cout << "permessage-deflate: " << (config.deflate ? "offered" : "off") << std::endl;
+    std::cout << "Socket options: " << kraken::SocketTuning::describe(config.socket_options) << std::endl;
+    if (config.watchdog.enabled()) {
+        std::cout << "Watchdog: stale " << config.watchdog.connection_stale_ms / 1000 << "s, symbol stale "
+                  << config.watchdog.symbol_stale_ms / 1000 << "s, ping " << config.watchdog.ping_interval_ms / 1000
+                  << "s" << std::endl;
+    }
+    std::cout << "Groups: " << config.groups.size() << std::endl;
+    for (const auto& group : config.groups) {
+        std::cout << "  - " << group.name << ": "
+                  << CollectorConfigParser::channel_name(group.channel) << ", "
+                  << group.symbols.size() << " symbols";
+        if (group.channel != CollectorChannel::TICKER) {
+            std::cout << ", depth " << group.depth;
+        }
+        std::cout << " -> " << group.output << (group.separate_files ? " (per symbol)" : "")
+                  << std::endl;
+    }
+    std::cout << std::endl;
+
+    if (parser.has("--check")) {
+        std::cout << "Configuration OK" << std::endl;
+        return 0;
+    }
+
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    WebSocketDeflate::set_enabled(config.deflate);
+
+    // Shared pools: declared before the groups so they are destroyed after them
+    IoServicePool io_pool(config.io_threads);
+    io_pool.set_thread_placement(config.io_placement, config.io_spin);
+    WriterPool writer_pool(config.writer_threads, config.writer_placement);
+    std::vector<std::unique_ptr<CollectorGroup>> groups;
+
+    for (const auto& group_config : config.groups) {
+        std::unique_ptr<CollectorGroup> group(new CollectorGroup());
+        group->config = group_config;
+        if (!setup_group(*group, io_pool, writer_pool, config)) {
+            return 1;
+        }
+        groups.push_back(std::move(group));
+    }
+
+    io_pool.start();
+    for (auto& group : groups) {
+        if (!start_group(*group)) {
+            std::cerr << "[Error] [" << group->config.name << "] Failed to start WebSocket client" << std::endl;
+        }
+    }
+
+    // Stage tracing: dump on SIGUSR1 and at exit
+    std::string trace_file = parser.get("--trace-file");
+    if (!trace_file.empty()) {
+        if (kraken::trace::tracing_enabled()) {
+            kraken::trace::install_signal_dump(SIGUSR1, trace_file);
+            std::cout << "Stage trace: " << trace_file << " (send SIGUSR1 to dump)" << std::endl;
+        } else {
+            std::cerr << "[Warning] --trace-file ignored: rebuild with -DKRAKEN_STAGE_TRACING=ON" << std::endl;
+            trace_file.clear();
+        }
+    }
+
+    std::cout << "Collecting... (Press Ctrl+C to stop)" << std::endl;
+    std::cout << std::endl;
+
+    // Main loop: periodic metrics until stopped or every group has ended
+    auto start_time = std::chrono::steady_clock::now();
+    auto last_status_time = start_time;
+    int wait_seconds = config.status_interval_seconds > 0 ? config.status_interval_seconds : 5;
+
+    while (g_running) {
+        {
+            std::unique_lock<std::mutex> lock(g_cv_mutex);
+            g_cv.wait_for(lock, std::chrono::seconds(wait_seconds), [] { return !g_running; });
+        }
+        if (!g_running) {
+            break;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (config.status_interval_seconds > 0) {
+            double elapsed = std::chrono::duration<double>(now - last_status_time).count();
+            print_metrics(groups, writer_pool, elapsed);
+            last_status_time = now;
+        }
+
+        bool any_running = false;
+        for (const auto& group : groups) {
+            any_running = any_running || group->is_running();
+        }
+        if (!any_running) {
+            std::cerr << "[Error] All connections ended" << std::endl;
+            break;
+        }
+    }
+
+    // Shutdown: close connections, stop I/O, drain writers, flush files
+    std::cout << "\nClosing connections..." << std::endl;
+    for (auto& group : groups) {
+        group->stop();
+    }
+
+    auto close_deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    bool any_connected = true;
+    while (any_connected && std::chrono::steady_clock::now() < close_deadline) {
+        any_connected = false;
+        for (const auto& group : groups) {
+            any_connected = any_connected || group->is_connected();
+        }
+        if (any_connected) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    io_pool.stop();
+    for (auto& group : groups) {
+        group->drain();
+    }
+
+    std::cout << "Flushing data..." << std::endl;
+    writer_pool.stop();
+    for (auto& group : groups) {
+        group->flush();
+    }
+
+    if (!trace_file.empty()) {
+        kraken::trace::stop_signal_dump();
+        kraken::trace::dump_chrome_trace(trace_file);
+    }
+
+    auto total_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - start_time
+    ).count();
+
+    std::cout << "\n==================================================" << std::endl;
+    std::cout << "Summary" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    print_metrics(groups, writer_pool, 0.0);
+    std::cout << "Runtime: " << total_elapsed << " seconds" << std::endl;
+    std::cout << "Shutdown complete." << std::endl;
+
+    return 0;
+}
@@ -9,6 +9,49 @@
  *   ./process_level3_snapshots -i level3_raw.jsonl --interval 1s -o snapshots.csv
  *   ./process_level3_snapshots -i level3_raw.jsonl --interval 5s --separate-files
  *   ./process_level3_snapshots -i level3_raw.jsonl --interval 1m --symbol BTC/USD -o btc.csv
+ *   ./process_level3_snapshots -i level3_raw.jsonl --interval 1s --start '2025-10-18 09' --end '2025-10-18 10'
+ *   ./process_level3_snapshots -i level3_raw.jsonl --interval 1s --validate-checksum --checksum-precision '1,8'
+ *   ./process_level3_snapshots -i level3_raw.jsonl --interval 1s --queue-probe 0.5
+ *   ./process_level3_snapshots -i 'captures/level3_*.jsonl' --interval 1s -j 8 -o all.csv
+ *   ./process_level3_snapshots -i 'captures/level3_*.jsonl' --interval 1s --checkpoint l3.ckpt -o all.csv
+ *
+ * Inputs may be files, directories (their .jsonl files) or quoted glob
+ * patterns, comma-separated. Segment files of one series (names equal apart
+ * from the YYYYMMDD_HH / YYYYMMDD segment key) form a chain: its segments
+ * are processed in key order and book state carries forward from one
+ * segment to the next. Chains are independent and run on -j threads. A
+ * single output file is written per chain and merged in series order; with
+ * --separate-files rows go straight to the per-symbol files (a symbol is
+ * expected to belong to one chain).
+ *
+ * With --checkpoint FILE the run resumes from FILE if it exists and saves it
+ * again at the end: per-symbol book state (orders in queue order), event
+ * counters, queue probes, sample timers and the position reached in every
+ * chain. Run it again as new segments arrive and each segment is processed
+ * exactly once; output files are appended to. A trailing line without a
+ * newline (segment still being written) is left for the next run.
+ *
+ * --symbol and --end are applied to the raw line bytes before JSON parsing
+ * (LinePrefilter), so lines of other symbols or past the end cost a short
+ * scan instead of a full parse. --start only suppresses samples: earlier
+ * records are still applied, the books need them. Filtered lines count as
+ * processed for --checkpoint, so a checkpoint only resumes with the same
+ * --symbol and --end.
+ *
+ * With --validate-checksum every record's checksum is verified against the
+ * rebuilt book, for symbols whose precision --checksum-precision gives
+ * ("PRICE,QTY" for all, "SYMBOL=PRICE,QTY" per symbol, ';'-separated).
+ * Precision inferred from the data gives false mismatches, so records of
+ * other symbols are counted as unverified instead. A symbol whose book
+ * diverged produces no samples until the next snapshot in the input
+ * resynchronizes it.
+ *
+ * With --queue-probe SIZE a hypothetical order of SIZE rests at the best bid
+ * and at the best ask. Each sample reports its queue position, the volume
+ * still ahead of it, the volume ahead that has traded or cancelled since it
+ * joined, and the volume that must trade to fill it. A probe rests until it
+ * reaches the front of the queue, is crossed, or the best price moves away;
+ * it then rejoins at the back of the current best level.
  *
  * Output:
  *   CSV file(s) with Level 3 snapshot metrics at specified intervals
@@ -20,18 +63,37 @@
 #include <map>
 #include <vector>
 #include <chrono>
-#include <simdjson.h>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <memory>
 #include "cli_utils.hpp"
+#include "jsonl_decoder.hpp"
 #include "level3_common.hpp"
 #include "level3_state.hpp"
 #include "level3_csv_writer.hpp"
+#include "segment_batch.hpp"
+#include "checkpoint_io.hpp"
+#include "line_prefilter.hpp"
 
 using kraken::Level3Record;
+using kraken::JsonlDecoder;
 using kraken::Level3Order;
 using kraken::Level3OrderBookState;
 using kraken::Level3SnapshotMetrics;
+using kraken::QueueEstimate;
 using kraken::Level3CSVWriter;
 using kraken::MultiFileLevel3CSVWriter;
+using kraken::SegmentBatch;
+using kraken::SegmentChain;
+using kraken::SegmentCursor;
+using kraken::SegmentLineReader;
+using kraken::CheckpointWriter;
+using kraken::CheckpointReader;
+using kraken::LinePrefilter;
+using kraken::ChecksumPrecisionMap;
+using kraken::parse_checksum_precision;
 
 /**
  * Parse interval string (e.g., "1s", "5s", "1m", "1h")
@@ -67,146 +129,379 @@ int parse_interval(const std::string& interval_str) {
 }
 
 /**
- * Parse timestamp string to Unix epoch seconds
+ * Queue probe ids for one symbol (-1 = not placed yet)
  */
-double parse_timestamp(const std::string& timestamp) {
-    // Format: "YYYY-MM-DD HH:MM:SS.mmm"
-    std::tm tm = {};
-    int millisec = 0;
+struct QueueProbes {
+    int bid;
+    int ask;
 
-    // Parse: YYYY-MM-DD HH:MM:SS.mmm
-    sscanf(timestamp.c_str(), "%d-%d-%d %d:%d:%d.%d",
-           &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
-           &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &millisec);
+    QueueProbes() : bid(-1), ask(-1) {}
+};
 
-    tm.tm_year -= 1900;  // Years since 1900
-    tm.tm_mon -= 1;      // Months since January
+/**
+ * Report one probe and requeue it at best if it is done resting
+ */
+void sample_probe(Level3OrderBookState& state, bool is_bid, double best, int& probe_id, QueueEstimate& out) {
+    if (best <= 0) {
+        return;  // Empty side
+    }
+    if (probe_id < 0) {
+        probe_id = state.add_queue_probe(is_bid, best);
+        state.get_queue_probe(probe_id, out);
+        return;
+    }
 
-    std::time_t t = std::mktime(&tm);
-    return static_cast<double>(t) + (millisec / 1000.0);
+    state.get_queue_probe(probe_id, out);
+    if (out.position == 0 || out.crossed || out.price != best) {
+        state.move_queue_probe(probe_id, best);
+    }
 }
 
 /**
- * Parse JSON Lines record to Level3Record
+ * Fill the queue probe columns for a sample
  */
-bool parse_jsonl_record(const std::string& line, Level3Record& record) {
-    try {
-        simdjson::ondemand::parser parser;
-        simdjson::padded_string padded(line);
-        simdjson::ondemand::document doc = parser.iterate(padded);
-
-        // Parse timestamp
-        if (auto ts = doc["timestamp"]; !ts.error()) {
-            std::string_view sv = ts.value();
-            record.timestamp = std::string(sv);
-        }
+void sample_queue_probes(Level3OrderBookState& state, QueueProbes& probes, double qty,
+                         Level3SnapshotMetrics& metrics) {
+    metrics.has_queue_probe = true;
+    metrics.queue_probe_qty = qty;
+    sample_probe(state, true, metrics.best_bid, probes.bid, metrics.bid_probe);
+    sample_probe(state, false, metrics.best_ask, probes.ask, metrics.ask_probe);
+}
 
-        // Parse type
-        if (auto type = doc["type"]; !type.error()) {
-            std::string_view sv = type.value();
-            record.type = std::string(sv);
+/**
+ * Settings shared by every chain
+ */
+struct ProcessOptions {
+    int interval_seconds;
+    bool validate_checksum;
+    ChecksumPrecisionMap checksum_precision;  // Symbols without an entry are not verified
+    double queue_probe_qty;
+    std::vector<std::string> allowed_symbols;
+    std::string start_time;   // Normalized --start (samples before it are not written)
+    LinePrefilter prefilter;  // Symbol / end filter on raw lines
+    bool hold_partial_lines;  // Checkpointing: leave unterminated lines for the next run
+};
+
+/**
+ * Console output and warning budget shared by the chain threads
+ */
+struct ProcessLog {
+    std::mutex mutex;
+    std::atomic<int> checksum_warnings;
+
+    ProcessLog() : checksum_warnings(0) {}
+};
+
+/**
+ * Counters of one chain
+ */
+struct ChainResult {
+    int input_records;
+    int records_filtered;
+    int records_processed;
+    int snapshots_written;
+    int checksum_mismatches;
+    int records_skipped;
+    uint64_t checksum_checks;
+    uint64_t checksum_unverified;              // Records of symbols without precision
+    std::set<std::string> symbols;
+    std::set<std::string> unverified_symbols;
+
+    ChainResult()
+        : input_records(0), records_filtered(0), records_processed(0), snapshots_written(0),
+          checksum_mismatches(0), records_skipped(0), checksum_checks(0),
+          checksum_unverified(0) {}
+};
+
+/**
+ * Everything a chain carries from one segment (or run) to the next
+ */
+struct ChainState {
+    // Maintain Level 3 order book state for each symbol
+    std::map<std::string, std::unique_ptr<Level3OrderBookState>> states;
+
+    // Track next sample time for each symbol
+    std::map<std::string, double> next_sample_time;
+
+    // Queue probes per symbol (--queue-probe)
+    std::map<std::string, QueueProbes> queue_probes;
+
+    // Symbols whose book diverged, waiting for the next snapshot
+    std::map<std::string, bool> diverged;
+
+    // Position reached in the chain
+    SegmentCursor cursor;
+};
+
+/**
+ * Apply the configured checksum precision of a symbol ("*" as fallback)
+ * Without one the state keeps inferring precision and is not verified.
+ */
+void apply_checksum_precision(Level3OrderBookState& state, const ProcessOptions& options) {
+    auto precision = options.checksum_precision.find(state.get_symbol());
+    if (precision == options.checksum_precision.end()) {
+        precision = options.checksum_precision.find("*");
+    }
+    if (precision != options.checksum_precision.end()) {
+        state.set_checksum_precision(precision->second.first, precision->second.second);
+    }
+}
+
+/**
+ * Process one segment chain
+ * Book state, probes and sample times carry forward from segment to segment;
+ * segments before chain_state.cursor are skipped.
+ */
+ChainResult process_chain(const SegmentChain& chain, const ProcessOptions& options,
+                          const std::function<void(const Level3SnapshotMetrics&)>& write,
+                          ProcessLog& log, ChainState& chain_state) {
+    ChainResult result;
+    auto& states = chain_state.states;
+    std::map<std::string, double>& next_sample_time = chain_state.next_sample_time;
+    std::map<std::string, QueueProbes>& queue_probes = chain_state.queue_probes;
+    std::map<std::string, bool>& diverged = chain_state.diverged;
+    for (const auto& pair : states) {
+        result.symbols.insert(pair.first);
+        apply_checksum_precision(*pair.second, options);  // Restored from a checkpoint
+    }
+
+    JsonlDecoder decoder;
+    std::string line;
+
+    for (size_t file_index = 0; file_index < chain.files.size(); file_index++) {
+        const std::string& input_file = chain.files[file_index];
+        uint64_t start_offset = 0;
+        if (!chain_state.cursor.resume_point(chain.keys[file_index], start_offset)) {
+            continue;  // Processed by an earlier run
         }
 
-        // Parse data object
-        auto data_obj = doc["data"];
-        if (data_obj.error()) {
-            return false;
+        SegmentLineReader infile;
+        if (!infile.open(input_file, start_offset, options.hold_partial_lines)) {
+            std::lock_guard<std::mutex> lock(log.mutex);
+            std::cerr << "Warning: Cannot open input file: " << input_file << std::endl;
+            continue;
         }
 
-        simdjson::ondemand::object data = data_obj.value();
+        int line_num = 0;
+        while (infile.next(line)) {
+            line_num++;
+            result.input_records++;
 
-        // Parse symbol
-        if (auto symbol = data["symbol"]; !symbol.error()) {
-            std::string_view sv = symbol.value();
-            record.symbol = std::string(sv);
-        }
+            if (line.empty()) {
+                continue;
+            }
 
-        // Parse bids (array of order objects)
-        if (auto bids = data["bids"]; !bids.error()) {
-            simdjson::ondemand::array bids_array = bids.value();
-            for (auto bid_value : bids_array) {
-                simdjson::ondemand::object bid_obj = bid_value.get_object();
+            // Skip lines of other symbols / past the end without parsing
+            if (!options.prefilter.accept(line)) {
+                result.records_filtered++;
+                continue;
+            }
 
-                Level3Order order;
+            // Parse record
+            Level3Record record;
+            if (!decoder.decode(line, record)) {
+                std::lock_guard<std::mutex> lock(log.mutex);
+                std::cerr << "Warning: Failed to parse " << input_file << " line " << line_num << std::endl;
+                continue;
+            }
 
-                // Event (for updates)
-                if (auto event_field = bid_obj["event"]; !event_field.error()) {
-                    std::string_view event_sv = event_field.value();
-                    order.event = std::string(event_sv);
+            // Apply symbol filter
+            if (!options.allowed_symbols.empty()) {
+                bool allowed = false;
+                for (const auto& sym : options.allowed_symbols) {
+                    if (record.symbol == sym) {
+                        allowed = true;
+                        break;
+                    }
                 }
-
-                // Order ID
-                if (auto order_id = bid_obj["order_id"]; !order_id.error()) {
-                    std::string_view id_sv = order_id.value();
-                    order.order_id = std::string(id_sv);
+                if (!allowed) {
+                    continue;
                 }
+            }
 
-                // Limit price
-                if (auto limit_price = bid_obj["limit_price"]; !limit_price.error()) {
-                    order.limit_price = limit_price.get_double();
-                }
+            // Get or create state for this symbol
+            auto it = states.find(record.symbol);
+            if (it == states.end()) {
+                std::unique_ptr<Level3OrderBookState> new_state(new Level3OrderBookState(record.symbol));
+                apply_checksum_precision(*new_state, options);
+                it = states.emplace(record.symbol, std::move(new_state)).first;
+                result.symbols.insert(record.symbol);
+                std::lock_guard<std::mutex> lock(log.mutex);
+                std::cout << "Initialized Level 3 state for " << record.symbol << std::endl;
+            }
 
-                // Order quantity
-                if (auto order_qty = bid_obj["order_qty"]; !order_qty.error()) {
-                    order.order_qty = order_qty.get_double();
-                }
+            Level3OrderBookState* state = it->second.get();
 
-                // Timestamp
-                if (auto ts = bid_obj["timestamp"]; !ts.error()) {
-                    std::string_view ts_sv = ts.value();
-                    order.timestamp = std::string(ts_sv);
+            // Apply record to state
+            if (record.type == "snapshot") {
+                state->apply_snapshot(record);
+                diverged[record.symbol] = false;
+            } else if (record.type == "update") {
+                if (diverged[record.symbol]) {
+                    result.records_skipped++;
+                    continue;  // Book is wrong until the next snapshot
                 }
-
-                record.bids.push_back(order);
+                state->apply_update(record);
+            }
+            result.records_processed++;
+
+            if (options.validate_checksum && !state->precision_known()) {
+                result.checksum_unverified++;
+                if (result.unverified_symbols.insert(record.symbol).second) {
+                    std::lock_guard<std::mutex> lock(log.mutex);
+                    std::cerr << "Warning: No checksum precision for " << record.symbol
+                              << ", not verified (see --checksum-precision)" << std::endl;
+                }
+            } else if (options.validate_checksum && !state->verify_checksum(record.checksum)) {
+                result.checksum_mismatches++;
+                if (log.checksum_warnings.fetch_add(1) < 10) {
+                    std::lock_guard<std::mutex> lock(log.mutex);
+                    std::cerr << "Warning: Checksum mismatch for " << record.symbol
+                              << " in " << input_file << " line " << line_num << " (" << record.timestamp
+                              << "), skipping until next snapshot" << std::endl;
+                }
+                diverged[record.symbol] = true;
+                continue;
             }
-        }
 
-        // Parse asks (same structure as bids)
-        if (auto asks = data["asks"]; !asks.error()) {
-            simdjson::ondemand::array asks_array = asks.value();
-            for (auto ask_value : asks_array) {
-                simdjson::ondemand::object ask_obj = ask_value.get_object();
+            // Check if we need to take a sample
+            double current_time = JsonlDecoder::parse_timestamp(record.timestamp);
 
-                Level3Order order;
+            if (next_sample_time.find(record.symbol) == next_sample_time.end()) {
+                // First record for this symbol - set next sample time
+                next_sample_time[record.symbol] = current_time + options.interval_seconds;
+            }
 
-                if (auto event_field = ask_obj["event"]; !event_field.error()) {
-                    std::string_view event_sv = event_field.value();
-                    order.event = std::string(event_sv);
-                }
+            if (current_time >= next_sample_time[record.symbol]) {
+                // Time to take a sample
+                Level3SnapshotMetrics metrics = state->calculate_metrics(record.timestamp);
 
-                if (auto order_id = ask_obj["order_id"]; !order_id.error()) {
-                    std::string_view id_sv = order_id.value();
-                    order.order_id = std::string(id_sv);
+                // Calculate flow rates (events per interval)
+                double interval_time = static_cast<double>(options.interval_seconds);
+                if (interval_time > 0) {
+                    metrics.order_arrival_rate = metrics.add_events / interval_time;
+                    metrics.order_cancel_rate = metrics.delete_events / interval_time;
                 }
 
-                if (auto limit_price = ask_obj["limit_price"]; !limit_price.error()) {
-                    order.limit_price = limit_price.get_double();
+                if (options.queue_probe_qty > 0) {
+                    sample_queue_probes(*state, queue_probes[record.symbol], options.queue_probe_qty, metrics);
                 }
 
-                if (auto order_qty = ask_obj["order_qty"]; !order_qty.error()) {
-                    order.order_qty = order_qty.get_double();
+                if (options.start_time.empty() || record.timestamp >= options.start_time) {
+                    write(metrics);
+                    result.snapshots_written++;
                 }
 
-                if (auto ts = ask_obj["timestamp"]; !ts.error()) {
-                    std::string_view ts_sv = ts.value();
-                    order.timestamp = std::string(ts_sv);
-                }
+                // Reset event counters for next interval
+                state->reset_event_counters();
 
-                record.asks.push_back(order);
+                // Update next sample time
+                next_sample_time[record.symbol] += options.interval_seconds;
             }
         }
 
-        // Parse checksum
-        if (auto checksum = data["checksum"]; !checksum.error()) {
-            record.checksum = static_cast<uint32_t>(checksum.get_uint64());
+        chain_state.cursor.started = true;
+        chain_state.cursor.key = chain.keys[file_index];
+        chain_state.cursor.offset = infile.offset();
+    }
+
+    for (auto& pair : states) {
+        result.checksum_checks += pair.second->get_checksum_checks();
+    }
+    return result;
+}
+
+/**
+ * Save every chain's state (kind "level3")
+ */
+bool save_checkpoint(const std::string& path, int interval_seconds, const std::string& filters,
+                     const std::map<std::string, ChainState>& chains, std::string& error) {
+    CheckpointWriter out("level3");
+    out.put_i32(interval_seconds);
+    out.put_string(filters);
+    out.put_u32(static_cast<uint32_t>(chains.size()));
+    for (const auto& chain : chains) {
+        const ChainState& state = chain.second;
+        out.put_string(chain.first);
+        out.put_u8(state.cursor.started ? 1 : 0);
+        out.put_string(state.cursor.key);
+        out.put_u64(state.cursor.offset);
+
+        out.put_u32(static_cast<uint32_t>(state.states.size()));
+        for (const auto& pair : state.states) {
+            const std::string& symbol = pair.first;
+            auto next = state.next_sample_time.find(symbol);
+            auto diverged = state.diverged.find(symbol);
+            auto probes = state.queue_probes.find(symbol);
+            QueueProbes probe_ids = probes != state.queue_probes.end() ? probes->second : QueueProbes();
+
+            out.put_string(symbol);
+            out.put_u8(next != state.next_sample_time.end() ? 1 : 0);
+            out.put_f64(next != state.next_sample_time.end() ? next->second : 0.0);
+            out.put_u8(diverged != state.diverged.end() && diverged->second ? 1 : 0);
+            out.put_i32(probe_ids.bid);
+            out.put_i32(probe_ids.ask);
+            pair.second->save_checkpoint(out);
         }
+    }
+    return out.write_file(path, error);
+}
 
-        return true;
+/**
+ * Load chain states saved by save_checkpoint()
+ * Refuses checkpoints written with another interval or other line filters:
+ * their cursors skipped the lines those filters rejected.
+ */
+bool load_checkpoint(const std::string& path, int interval_seconds, const std::string& filters,
+                     std::map<std::string, ChainState>& chains, std::string& error) {
+    CheckpointReader in;
+    if (!in.load_file(path, "level3", error)) {
+        return false;
+    }
+    int saved_interval = in.get_i32();
+    if (in.ok() && saved_interval != interval_seconds) {
+        error = "Checkpoint " + path + " was written with a " + std::to_string(saved_interval) +
+                "s interval, not " + std::to_string(interval_seconds) + "s";
+        return false;
+    }
+    std::string saved_filters = in.get_string();
+    if (in.ok() && saved_filters != filters) {
+        error = "Checkpoint " + path + " was written with line filters (" + saved_filters +
+                "), not (" + filters + "); use the same --symbol and --end";
+        return false;
+    }
 
-    } catch (const simdjson::simdjson_error& e) {
-        std::cerr << "Error parsing JSON: " << simdjson::error_message(e.error()) << std::endl;
+    uint32_t chain_count = in.get_u32();
+    for (uint32_t c = 0; c < chain_count && in.ok(); c++) {
+        ChainState& state = chains[in.get_string()];
+        state.cursor.started = in.get_u8() != 0;
+        state.cursor.key = in.get_string();
+        state.cursor.offset = in.get_u64();
+
+        uint32_t symbol_count = in.get_u32();
+        for (uint32_t i = 0; i < symbol_count && in.ok(); i++) {
+            std::string symbol = in.get_string();
+            bool has_next = in.get_u8() != 0;
+            double next = in.get_f64();
+            if (has_next) {
+                state.next_sample_time[symbol] = next;
+            }
+            state.diverged[symbol] = in.get_u8() != 0;
+            QueueProbes& probes = state.queue_probes[symbol];
+            probes.bid = in.get_i32();
+            probes.ask = in.get_i32();
+
+            std::unique_ptr<Level3OrderBookState> book(new Level3OrderBookState(symbol));
+            book->load_checkpoint(in);
+            state.states[symbol] = std::move(book);
+        }
+    }
+
+    if (!in.ok() || !in.at_end()) {
+        error = "Corrupt checkpoint: " + path;
         return false;
     }
+    return true;
 }
 
 int main(int argc, char* argv[]) {
@@ -215,11 +510,11 @@ int main(int argc, char* argv[]) {
 
     parser.add_argument({
         "-i", "--input",
-        "Input .jsonl file from retrieve_kraken_live_data_level3",
+        "Input .jsonl files, directories or quoted globs from retrieve_kraken_live_data_level3 (comma-separated)",
         true,  // required
         true,  // has value
         "",
-        "FILE"
+        "FILES"
     });
 
     parser.add_argument({
@@ -258,6 +553,70 @@ int main(int argc, char* argv[]) {
         "LIST"
     });
 
+    parser.add_argument({
+        "", "--start",
+        "Write samples from this UTC time on (e.g., '2025-10-18 09:30')",
+        false,  // optional
+        true,   // has value
+        "",
+        "TIME"
+    });
+
+    parser.add_argument({
+        "", "--end",
+        "Ignore records from this UTC time on (exclusive)",
+        false,  // optional
+        true,   // has value
+        "",
+        "TIME"
+    });
+
+    parser.add_argument({
+        "", "--validate-checksum",
+        "Verify each record's checksum against the rebuilt book",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--checksum-precision",
+        "Price and qty decimals for the checksum: PRICE,QTY for all symbols and/or "
+        "SYMBOL=PRICE,QTY, ';'-separated (symbols without one are not verified)",
+        false,  // optional
+        true,   // has value
+        "",
+        "SPEC"
+    });
+
+    parser.add_argument({
+        "", "--queue-probe",
+        "Track the queue standing of a hypothetical order of SIZE at the best bid/ask",
+        false,  // optional
+        true,   // has value
+        "",
+        "SIZE"
+    });
+
+    parser.add_argument({
+        "", "--checkpoint",
+        "Resume from / save book state and progress to FILE",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
+    parser.add_argument({
+        "-j", "--jobs",
+        "Segment chains processed in parallel",
+        false,  // optional
+        true,   // has value
+        "1",
+        "N"
+    });
+
     // Parse arguments
     if (!parser.parse(argc, argv)) {
         if (!parser.get_errors().empty()) {
@@ -272,11 +631,49 @@ int main(int argc, char* argv[]) {
     }
 
     // Get arguments
-    std::string input_file = parser.get("-i");
+    std::string input_list = parser.get("-i");
     std::string interval_str = parser.get("--interval");
     std::string output_file = parser.get("-o");
     bool separate_files = parser.has("--separate-files");
     std::string symbol_filter = parser.get("--symbol");
+    std::string start_arg = parser.get("--start");
+    std::string end_arg = parser.get("--end");
+    bool validate_checksum = parser.has("--validate-checksum");
+    std::string checksum_precision = parser.get("--checksum-precision");
+    std::string checkpoint_file = parser.get("--checkpoint");
+
+    int jobs = 0;
+    try {
+        jobs = std::stoi(parser.get("--jobs"));
+    } catch (const std::exception&) {
+        jobs = 0;
+    }
+    if (jobs < 1) {
+        std::cerr << "Error: --jobs must be at least 1" << std::endl;
+        return 1;
+    }
+
+    double queue_probe_qty = 0.0;
+    if (parser.has("--queue-probe")) {
+        try {
+            queue_probe_qty = std::stod(parser.get("--queue-probe"));
+        } catch (const std::exception&) {
+            queue_probe_qty = -1.0;
+        }
+        if (queue_probe_qty <= 0) {
+            std::cerr << "Error: Invalid --queue-probe: " << parser.get("--queue-probe")
+                      << " (expected a positive order size)" << std::endl;
+            return 1;
+        }
+    }
+
+    ChecksumPrecisionMap precision_map;
+    std::string precision_error;
+    if (!checksum_precision.empty() &&
+        !parse_checksum_precision(checksum_precision, precision_map, precision_error)) {
+        std::cerr << "Error: Invalid --checksum-precision: " << precision_error << std::endl;
+        return 1;
+    }
 
     // Parse interval
     int interval_seconds = parse_interval(interval_str);
@@ -290,11 +687,61 @@ int main(int argc, char* argv[]) {
         allowed_symbols = cli::ListParser::parse(symbol_filter, ',');
     }
 
+    // Parse time range
+    std::string start_time;
+    std::string end_time;
+    if (!start_arg.empty() && !LinePrefilter::normalize_time(start_arg, start_time)) {
+        std::cerr << "Error: Invalid --start time: " << start_arg
+                  << " (expected YYYY-MM-DD[ HH[:MM[:SS]]])" << std::endl;
+        return 1;
+    }
+    if (!end_arg.empty() && !LinePrefilter::normalize_time(end_arg, end_time)) {
+        std::cerr << "Error: Invalid --end time: " << end_arg
+                  << " (expected YYYY-MM-DD[ HH[:MM[:SS]]])" << std::endl;
+        return 1;
+    }
+    if (!start_time.empty() && !end_time.empty() && end_time <= start_time) {
+        std::cerr << "Error: --end must be after --start" << std::endl;
+        return 1;
+    }
+
+    // Raw line filter (also recorded in the checkpoint)
+    LinePrefilter prefilter;
+    prefilter.set_symbols(allowed_symbols);
+    prefilter.set_time_range("", end_time);
+
+    // Expand inputs into segment chains
+    std::vector<std::string> input_files;
+    std::string input_error;
+    if (!SegmentBatch::expand_inputs(cli::ListParser::parse(input_list, ','), input_files, input_error)) {
+        std::cerr << "Error: " << input_error << std::endl;
+        return 1;
+    }
+    std::vector<SegmentChain> chains = SegmentBatch::build_chains(input_files);
+
+    // Resume from checkpoint (chains not in this run are kept as they are)
+    std::map<std::string, ChainState> saved_chains;
+    bool resuming = false;
+    if (!checkpoint_file.empty() && cli::Validator::is_valid_file(checkpoint_file)) {
+        std::string checkpoint_error;
+        if (!load_checkpoint(checkpoint_file, interval_seconds, prefilter.describe(),
+                             saved_chains, checkpoint_error)) {
+            std::cerr << "Error: " << checkpoint_error << std::endl;
+            return 1;
+        }
+        resuming = true;
+    }
+
     // Display configuration
     std::cout << "==================================================" << std::endl;
     std::cout << "Process Level 3 Snapshots" << std::endl;
     std::cout << "==================================================" << std::endl;
-    std::cout << "Input file: " << input_file << std::endl;
+    if (input_files.size() == 1) {
+        std::cout << "Input file: " << input_files[0] << std::endl;
+    } else {
+        std::cout << "Input files: " << input_files.size() << " in " << chains.size()
+                  << " chain(s), " << jobs << " job(s)" << std::endl;
+    }
     std::cout << "Interval: " << interval_str << " (" << interval_seconds << " seconds)" << std::endl;
     if (separate_files) {
         std::cout << "Output mode: Separate files per symbol" << std::endl;
@@ -310,159 +757,173 @@ int main(int argc, char* argv[]) {
         }
         std::cout << std::endl;
     }
+    if (!start_time.empty() || !end_time.empty()) {
+        std::cout << "Time range: " << (start_time.empty() ? "start" : start_time)
+                  << " to " << (end_time.empty() ? "end" : end_time) << " (UTC)" << std::endl;
+    }
+    if (validate_checksum) {
+        std::cout << "Checksum validation: on" << std::endl;
+    }
+    if (queue_probe_qty > 0) {
+        std::cout << "Queue probe: " << queue_probe_qty << " at best bid/ask" << std::endl;
+    }
+    if (!checkpoint_file.empty()) {
+        std::cout << "Checkpoint: " << checkpoint_file;
+        if (resuming) {
+            std::cout << " (resuming " << saved_chains.size() << " chain(s), appending output)";
+        }
+        std::cout << std::endl;
+    }
     std::cout << std::endl;
 
-    // Open input file
-    std::ifstream infile(input_file);
-    if (!infile.is_open()) {
-        std::cerr << "Error: Cannot open input file: " << input_file << std::endl;
-        return 1;
-    }
+    ProcessOptions options;
+    options.interval_seconds = interval_seconds;
+    options.validate_checksum = validate_checksum;
+    options.checksum_precision = precision_map;
+    options.queue_probe_qty = queue_probe_qty;
+    options.allowed_symbols = allowed_symbols;
+    options.start_time = start_time;
+    options.prefilter = prefilter;
+    options.hold_partial_lines = !checkpoint_file.empty();
 
     // Create output writers
+    // A single output file gets one part per chain, merged in series order
     Level3CSVWriter* single_writer = nullptr;
     MultiFileLevel3CSVWriter* multi_writer = nullptr;
+    std::vector<std::string> part_files;
+    std::mutex multi_writer_mutex;
 
     if (separate_files) {
-        multi_writer = new MultiFileLevel3CSVWriter(output_file);
-    } else {
-        single_writer = new Level3CSVWriter(output_file);
+        multi_writer = new MultiFileLevel3CSVWriter(output_file, resuming);
+    } else if (chains.size() == 1) {
+        single_writer = new Level3CSVWriter(output_file, resuming);
         if (!single_writer->is_open()) {
             std::cerr << "Error: Cannot open output file: " << output_file << std::endl;
             delete single_writer;
             return 1;
         }
+    } else {
+        for (size_t i = 0; i < chains.size(); i++) {
+            part_files.push_back(output_file + ".part" + std::to_string(i));
+        }
     }
 
-    // Maintain Level 3 order book state for each symbol
-    std::map<std::string, Level3OrderBookState*> states;
-
-    // Track next sample time for each symbol
-    std::map<std::string, double> next_sample_time;
-
-    // Process records
-    std::string line;
-    int line_num = 0;
-    int records_processed = 0;
-    int snapshots_written = 0;
-
     std::cout << "Processing..." << std::endl;
 
-    while (std::getline(infile, line)) {
-        line_num++;
-
-        if (line.empty()) {
-            continue;
+    ProcessLog log;
+    std::vector<ChainResult> results(chains.size());
+    std::vector<ChainState> chain_states(chains.size());
+    for (size_t i = 0; i < chains.size(); i++) {
+        auto saved = saved_chains.find(chains[i].series);
+        if (saved != saved_chains.end()) {
+            chain_states[i] = std::move(saved->second);
         }
+    }
 
-        // Parse record
-        Level3Record record;
-        if (!parse_jsonl_record(line, record)) {
-            std::cerr << "Warning: Failed to parse line " << line_num << std::endl;
-            continue;
-        }
-
-        // Apply symbol filter
-        if (!allowed_symbols.empty()) {
-            bool allowed = false;
-            for (const auto& sym : allowed_symbols) {
-                if (record.symbol == sym) {
-                    allowed = true;
-                    break;
-                }
-            }
-            if (!allowed) {
-                continue;
-            }
-        }
-
-        // Get or create state for this symbol
-        auto it = states.find(record.symbol);
-        if (it == states.end()) {
-            Level3OrderBookState* new_state = new Level3OrderBookState(record.symbol);
-            states[record.symbol] = new_state;
-            std::cout << "Initialized Level 3 state for " << record.symbol << std::endl;
-            it = states.find(record.symbol);
-        }
-
-        Level3OrderBookState* state = it->second;
-
-        // Apply record to state
-        if (record.type == "snapshot") {
-            state->apply_snapshot(record);
-        } else if (record.type == "update") {
-            state->apply_update(record);
-        }
-        records_processed++;
-
-        // Check if we need to take a sample
-        double current_time = parse_timestamp(record.timestamp);
-
-        if (next_sample_time.find(record.symbol) == next_sample_time.end()) {
-            // First record for this symbol - set next sample time
-            next_sample_time[record.symbol] = current_time + interval_seconds;
-        }
-
-        if (current_time >= next_sample_time[record.symbol]) {
-            // Time to take a sample
-            Level3SnapshotMetrics metrics = state->calculate_metrics(record.timestamp);
-
-            // Calculate flow rates (events per interval)
-            double interval_time = static_cast<double>(interval_seconds);
-            if (interval_time > 0) {
-                metrics.order_arrival_rate = metrics.add_events / interval_time;
-                metrics.order_cancel_rate = metrics.delete_events / interval_time;
-            }
-
-            // Write snapshot
-            if (multi_writer) {
+    SegmentBatch::run_parallel(chains.size(), static_cast<size_t>(jobs), [&](size_t index) {
+        if (multi_writer) {
+            results[index] = process_chain(chains[index], options, [&](const Level3SnapshotMetrics& metrics) {
+                std::lock_guard<std::mutex> lock(multi_writer_mutex);
                 multi_writer->write_snapshot(metrics);
-            } else if (single_writer) {
+            }, log, chain_states[index]);
+        } else if (single_writer) {
+            results[index] = process_chain(chains[index], options, [&](const Level3SnapshotMetrics& metrics) {
                 single_writer->write_snapshot(metrics);
+            }, log, chain_states[index]);
+        } else {
+            Level3CSVWriter part_writer(part_files[index]);
+            if (!part_writer.is_open()) {
+                std::lock_guard<std::mutex> lock(log.mutex);
+                std::cerr << "Error: Cannot open output file: " << part_files[index] << std::endl;
+                return;
             }
-
-            snapshots_written++;
-
-            // Reset event counters for next interval
-            state->reset_event_counters();
-
-            // Update next sample time
-            next_sample_time[record.symbol] += interval_seconds;
+            results[index] = process_chain(chains[index], options, [&](const Level3SnapshotMetrics& metrics) {
+                part_writer.write_snapshot(metrics);
+            }, log, chain_states[index]);
         }
-    }
 
-    infile.close();
+        if (chains.size() > 1) {
+            std::lock_guard<std::mutex> lock(log.mutex);
+            std::cout << "Finished " << chains[index].series << " (" << chains[index].files.size()
+                      << " segment(s), " << results[index].snapshots_written << " snapshots)" << std::endl;
+        }
+    });
 
     // Flush output
     if (multi_writer) {
         multi_writer->flush_all();
     } else if (single_writer) {
         single_writer->flush();
+    } else {
+        std::string merge_error;
+        if (!SegmentBatch::merge_csv_parts(part_files, output_file, merge_error, resuming)) {
+            std::cerr << "Error: " << merge_error << std::endl;
+            return 1;
+        }
+    }
+
+    // Save checkpoint after the output is complete
+    if (!checkpoint_file.empty()) {
+        for (size_t i = 0; i < chains.size(); i++) {
+            saved_chains[chains[i].series] = std::move(chain_states[i]);
+        }
+        std::string checkpoint_error;
+        if (!save_checkpoint(checkpoint_file, interval_seconds, options.prefilter.describe(),
+                             saved_chains, checkpoint_error)) {
+            std::cerr << "Error: " << checkpoint_error << std::endl;
+            return 1;
+        }
+    }
+
+    ChainResult totals;
+    for (const auto& result : results) {
+        totals.input_records += result.input_records;
+        totals.records_filtered += result.records_filtered;
+        totals.records_processed += result.records_processed;
+        totals.snapshots_written += result.snapshots_written;
+        totals.checksum_mismatches += result.checksum_mismatches;
+        totals.records_skipped += result.records_skipped;
+        totals.checksum_checks += result.checksum_checks;
+        totals.checksum_unverified += result.checksum_unverified;
+        totals.unverified_symbols.insert(result.unverified_symbols.begin(), result.unverified_symbols.end());
+        totals.symbols.insert(result.symbols.begin(), result.symbols.end());
     }
 
     // Summary
     std::cout << "\n==================================================" << std::endl;
     std::cout << "Summary" << std::endl;
     std::cout << "==================================================" << std::endl;
-    std::cout << "Input records: " << line_num << std::endl;
-    std::cout << "Records processed: " << records_processed << std::endl;
-    std::cout << "Symbols: " << states.size() << std::endl;
-    std::cout << "Snapshots written: " << snapshots_written << std::endl;
+    std::cout << "Input records: " << totals.input_records << std::endl;
+    if (totals.records_filtered > 0) {
+        std::cout << "Filtered before parsing: " << totals.records_filtered << std::endl;
+    }
+    std::cout << "Records processed: " << totals.records_processed << std::endl;
+    std::cout << "Symbols: " << totals.symbols.size() << std::endl;
+    std::cout << "Snapshots written: " << totals.snapshots_written << std::endl;
+    if (validate_checksum) {
+        std::cout << "Checksum: " << totals.checksum_checks << " checked, "
+                  << totals.checksum_mismatches << " mismatches, "
+                  << totals.records_skipped << " records skipped while diverged" << std::endl;
+        if (totals.checksum_unverified > 0) {
+            std::cout << "Checksum unverified: " << totals.checksum_unverified << " records of "
+                      << totals.unverified_symbols.size() << " symbol(s) without --checksum-precision"
+                      << std::endl;
+        }
+    }
 
     if (separate_files) {
         std::cout << "Files created: " << multi_writer->get_file_count() << std::endl;
         std::cout << "Total snapshots: " << multi_writer->get_total_snapshot_count() << std::endl;
     } else {
         std::cout << "Output file: " << output_file << std::endl;
-        std::cout << "Snapshots written: " << single_writer->get_snapshot_count() << std::endl;
+        if (single_writer) {
+            std::cout << "Snapshots written: " << single_writer->get_snapshot_count() << std::endl;
+        }
     }
 
     std::cout << "Processing complete." << std::endl;
 
     // Cleanup
-    for (auto& pair : states) {
-        delete pair.second;
-    }
     if (single_writer) delete single_writer;
     if (multi_writer) delete multi_writer;
 
@@ -9,6 +9,38 @@
  *   ./process_orderbook_snapshots -i raw_data.jsonl --interval 1s -o snapshots.csv
  *   ./process_orderbook_snapshots -i raw_data.jsonl --interval 5s --separate-files
  *   ./process_orderbook_snapshots -i raw_data.jsonl --interval 1m --symbol BTC/USD -o btc.csv
+ *   ./process_orderbook_snapshots -i raw_data.jsonl --interval 1s --start '2025-10-18 09' --end '2025-10-18 10'
+ *   ./process_orderbook_snapshots -i raw_data.jsonl --interval 1s --sweep-sizes 1,5,10,50
+ *   ./process_orderbook_snapshots -i 'captures/book_*.jsonl' --interval 1s -j 8 -o all.csv
+ *   ./process_orderbook_snapshots -i captures/ --interval 1s -j 8 --separate-files
+ *
+ * Inputs may be files, directories (their .jsonl files) or quoted glob
+ * patterns, comma-separated. Segment files of one series (names equal apart
+ * from the YYYYMMDD_HH / YYYYMMDD segment key) form a chain: its segments
+ * are processed in key order and book state carries forward from one
+ * segment to the next. Chains are independent and run on -j threads. A
+ * single output file is written per chain and merged in series order; with
+ * --separate-files rows go straight to the per-symbol files (a symbol is
+ * expected to belong to one chain).
+ *
+ * With --checkpoint FILE the run resumes from FILE if it exists (book state,
+ * sample timers and the position reached in every chain) and saves it again
+ * at the end, so each new segment is processed exactly once:
+ *   ./process_orderbook_snapshots -i 'captures/book.*.jsonl' --interval 1s \
+ *       --checkpoint book.ckpt -o snapshots.csv      # run again as segments arrive
+ * Output files are appended to while resuming. A trailing line without a
+ * newline (segment still being written) is left for the next run.
+ *
+ * --symbol and --end are applied to the raw line bytes before JSON parsing
+ * (LinePrefilter), so lines of other symbols or past the end cost a short
+ * scan instead of a full parse. --start only suppresses samples: earlier
+ * records are still applied, the books need them. Filtered lines count as
+ * processed for --checkpoint, so a checkpoint only resumes with the same
+ * --symbol and --end.
+ *
+ * With --sweep-sizes each sample also reports, per side and size, the
+ * average fill price and slippage (bps vs the best price) of a market order
+ * sweeping the book. Empty cells mean the book was shallower than the size.
  *
  * Output:
  *   CSV file(s) with snapshot metrics at specified intervals
@@ -20,19 +52,36 @@
 #include <map>
 #include <vector>
 #include <chrono>
-#include <simdjson.h>
+#include <algorithm>
+#include <stdexcept>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <functional>
 #include "cli_utils.hpp"
+#include "jsonl_decoder.hpp"
 #include "orderbook_common.hpp"
 #include "orderbook_state.hpp"
 #include "snapshot_csv_writer.hpp"
+#include "segment_batch.hpp"
+#include "checkpoint_io.hpp"
+#include "line_prefilter.hpp"
 
 using kraken::OrderBookRecord;
+using kraken::JsonlDecoder;
 using kraken::OrderBookState;
 using kraken::SnapshotMetrics;
 using kraken::MetricsCalculator;
 using kraken::SnapshotCSVWriter;
 using kraken::MultiFileSnapshotCSVWriter;
 using kraken::PriceLevel;
+using kraken::SegmentBatch;
+using kraken::SegmentChain;
+using kraken::SegmentCursor;
+using kraken::SegmentLineReader;
+using kraken::CheckpointWriter;
+using kraken::CheckpointReader;
+using kraken::LinePrefilter;
 
 /**
  * Parse interval string (e.g., "1s", "5s", "1m", "1h")
@@ -68,98 +117,262 @@ int parse_interval(const std::string& interval_str) {
 }
 
 /**
- * Parse timestamp string to Unix epoch seconds
+ * Settings shared by every chain
  */
-double parse_timestamp(const std::string& timestamp) {
-    // Format: "YYYY-MM-DD HH:MM:SS.mmm"
-    // Simple conversion for our known format
-    std::tm tm = {};
-    int millisec = 0;
-
-    // Parse: YYYY-MM-DD HH:MM:SS.mmm
-    sscanf(timestamp.c_str(), "%d-%d-%d %d:%d:%d.%d",
-           &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
-           &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &millisec);
-
-    tm.tm_year -= 1900;  // Years since 1900
-    tm.tm_mon -= 1;      // Months since January
-
-    std::time_t t = std::mktime(&tm);
-    return static_cast<double>(t) + (millisec / 1000.0);
-}
+struct ProcessOptions {
+    int interval_seconds;
+    bool skip_validation;
+    std::vector<std::string> allowed_symbols;
+    std::string start_time;   // Normalized --start (samples before it are not written)
+    LinePrefilter prefilter;  // Symbol / end filter on raw lines
+    std::vector<double> sweep_sizes;
+    bool hold_partial_lines;  // Checkpointing: leave unterminated lines for the next run
+};
 
 /**
- * Parse JSON Lines record to OrderBookRecord
+ * Console output and warning budget shared by the chain threads
  */
-bool parse_jsonl_record(const std::string& line, OrderBookRecord& record) {
-    try {
-        simdjson::ondemand::parser parser;
-        simdjson::padded_string padded(line);
-        simdjson::ondemand::document doc = parser.iterate(padded);
-
-        // Parse timestamp
-        if (auto ts = doc["timestamp"]; !ts.error()) {
-            std::string_view sv = ts.value();
-            record.timestamp = std::string(sv);
-        }
+struct ProcessLog {
+    std::mutex mutex;
+    std::atomic<int> checksum_warnings;
 
-        // Parse data object
-        auto data_obj = doc["data"];
-        if (data_obj.error()) {
-            return false;
-        }
+    ProcessLog() : checksum_warnings(0) {}
+};
+
+/**
+ * Counters of one chain
+ */
+struct ChainResult {
+    int input_records;
+    int records_filtered;
+    int records_processed;
+    int snapshots_written;
+    int checksum_errors;
+    std::set<std::string> symbols;
+
+    ChainResult()
+        : input_records(0), records_filtered(0), records_processed(0), snapshots_written(0),
+          checksum_errors(0) {}
+};
+
+/**
+ * Everything a chain carries from one segment (or run) to the next
+ */
+struct ChainState {
+    // Maintain order book state for each symbol
+    std::map<std::string, OrderBookState> states;
+
+    // Track next sample time for each symbol
+    std::map<std::string, double> next_sample_time;
+
+    // Position reached in the chain
+    SegmentCursor cursor;
+};
+
+/**
+ * Process one segment chain
+ * Book state and sample times carry forward from segment to segment;
+ * segments before chain_state.cursor are skipped.
+ */
+ChainResult process_chain(const SegmentChain& chain, const ProcessOptions& options,
+                          const std::function<void(const SnapshotMetrics&)>& write,
+                          ProcessLog& log, ChainState& chain_state) {
+    ChainResult result;
+    std::map<std::string, OrderBookState>& states = chain_state.states;
+    std::map<std::string, double>& next_sample_time = chain_state.next_sample_time;
+    for (const auto& pair : states) {
+        result.symbols.insert(pair.first);
+    }
 
-        simdjson::ondemand::object data = data_obj.value();
+    JsonlDecoder decoder;
+    std::string line;
 
-        // Parse symbol
-        if (auto symbol = data["symbol"]; !symbol.error()) {
-            std::string_view sv = symbol.value();
-            record.symbol = std::string(sv);
+    for (size_t file_index = 0; file_index < chain.files.size(); file_index++) {
+        const std::string& input_file = chain.files[file_index];
+        uint64_t start_offset = 0;
+        if (!chain_state.cursor.resume_point(chain.keys[file_index], start_offset)) {
+            continue;  // Processed by an earlier run
         }
 
-        // Parse type (from parent object)
-        if (auto type = doc["type"]; !type.error()) {
-            std::string_view sv = type.value();
-            record.type = std::string(sv);
+        SegmentLineReader infile;
+        if (!infile.open(input_file, start_offset, options.hold_partial_lines)) {
+            std::lock_guard<std::mutex> lock(log.mutex);
+            std::cerr << "Warning: Cannot open input file: " << input_file << std::endl;
+            continue;
         }
 
-        // Parse bids
-        if (auto bids = data["bids"]; !bids.error()) {
-            simdjson::ondemand::array bids_array = bids.value();
-            for (auto bid_value : bids_array) {
-                simdjson::ondemand::array bid_arr = bid_value.get_array();
-                auto it = bid_arr.begin();
-                double price = (*it).get_double();
-                ++it;
-                double quantity = (*it).get_double();
-                record.bids.emplace_back(price, quantity);
+        int line_num = 0;
+        while (infile.next(line)) {
+            line_num++;
+            result.input_records++;
+
+            if (line.empty()) {
+                continue;
+            }
+
+            // Skip lines of other symbols / past the end without parsing
+            if (!options.prefilter.accept(line)) {
+                result.records_filtered++;
+                continue;
+            }
+
+            // Parse record
+            OrderBookRecord record;
+            if (!decoder.decode(line, record)) {
+                std::lock_guard<std::mutex> lock(log.mutex);
+                std::cerr << "Warning: Failed to parse " << input_file << " line " << line_num << std::endl;
+                continue;
+            }
+
+            // Apply symbol filter
+            if (!options.allowed_symbols.empty()) {
+                bool allowed = false;
+                for (const auto& sym : options.allowed_symbols) {
+                    if (record.symbol == sym) {
+                        allowed = true;
+                        break;
+                    }
+                }
+                if (!allowed) {
+                    continue;
+                }
+            }
+
+            // Get or create state for this symbol
+            auto it = states.find(record.symbol);
+            if (it == states.end()) {
+                auto inserted = states.emplace(record.symbol, OrderBookState(record.symbol));
+                it = inserted.first;
+                result.symbols.insert(record.symbol);
+                std::lock_guard<std::mutex> lock(log.mutex);
+                std::cout << "Initialized state for " << record.symbol << std::endl;
+            }
+
+            OrderBookState& state = it->second;
+
+            // Apply record to state
+            state.apply(record);
+            result.records_processed++;
+
+            // Validate checksum if enabled
+            if (!options.skip_validation && state.is_initialized()) {
+                if (!state.validate_checksum(record.checksum)) {
+                    result.checksum_errors++;
+                    if (log.checksum_warnings.fetch_add(1) < 10) {  // Only show first 10 warnings
+                        std::lock_guard<std::mutex> lock(log.mutex);
+                        std::cerr << "Warning: Checksum validation failed for "
+                                  << record.symbol << " at " << record.timestamp << std::endl;
+                    }
+                }
+            }
+
+            // Check if we need to take a sample
+            double current_time = JsonlDecoder::parse_timestamp(record.timestamp);
+
+            if (next_sample_time.find(record.symbol) == next_sample_time.end()) {
+                // First record for this symbol - set next sample time
+                next_sample_time[record.symbol] = current_time + options.interval_seconds;
             }
-        }
 
-        // Parse asks
-        if (auto asks = data["asks"]; !asks.error()) {
-            simdjson::ondemand::array asks_array = asks.value();
-            for (auto ask_value : asks_array) {
-                simdjson::ondemand::array ask_arr = ask_value.get_array();
-                auto it = ask_arr.begin();
-                double price = (*it).get_double();
-                ++it;
-                double quantity = (*it).get_double();
-                record.asks.emplace_back(price, quantity);
+            if (current_time >= next_sample_time[record.symbol]) {
+                // Time to take a sample
+                if (options.start_time.empty() || record.timestamp >= options.start_time) {
+                    SnapshotMetrics metrics = MetricsCalculator::calculate(state, record.timestamp,
+                                                                           options.sweep_sizes);
+                    write(metrics);
+                    result.snapshots_written++;
+                }
+
+                // Update next sample time
+                next_sample_time[record.symbol] += options.interval_seconds;
             }
         }
 
-        // Parse checksum
-        if (auto checksum = data["checksum"]; !checksum.error()) {
-            record.checksum = static_cast<uint32_t>(checksum.get_uint64());
+        chain_state.cursor.started = true;
+        chain_state.cursor.key = chain.keys[file_index];
+        chain_state.cursor.offset = infile.offset();
+    }
+
+    return result;
+}
+
+/**
+ * Save every chain's state (kind "book")
+ */
+bool save_checkpoint(const std::string& path, int interval_seconds, const std::string& filters,
+                     const std::map<std::string, ChainState>& chains, std::string& error) {
+    CheckpointWriter out("book");
+    out.put_i32(interval_seconds);
+    out.put_string(filters);
+    out.put_u32(static_cast<uint32_t>(chains.size()));
+    for (const auto& chain : chains) {
+        const ChainState& state = chain.second;
+        out.put_string(chain.first);
+        out.put_u8(state.cursor.started ? 1 : 0);
+        out.put_string(state.cursor.key);
+        out.put_u64(state.cursor.offset);
+
+        out.put_u32(static_cast<uint32_t>(state.states.size()));
+        for (const auto& pair : state.states) {
+            auto next = state.next_sample_time.find(pair.first);
+            out.put_string(pair.first);
+            out.put_u8(next != state.next_sample_time.end() ? 1 : 0);
+            out.put_f64(next != state.next_sample_time.end() ? next->second : 0.0);
+            pair.second.save_checkpoint(out);
         }
+    }
+    return out.write_file(path, error);
+}
+
+/**
+ * Load chain states saved by save_checkpoint()
+ * Refuses checkpoints written with another interval or other line filters:
+ * their cursors skipped the lines those filters rejected.
+ */
+bool load_checkpoint(const std::string& path, int interval_seconds, const std::string& filters,
+                     std::map<std::string, ChainState>& chains, std::string& error) {
+    CheckpointReader in;
+    if (!in.load_file(path, "book", error)) {
+        return false;
+    }
+    int saved_interval = in.get_i32();
+    if (in.ok() && saved_interval != interval_seconds) {
+        error = "Checkpoint " + path + " was written with a " + std::to_string(saved_interval) +
+                "s interval, not " + std::to_string(interval_seconds) + "s";
+        return false;
+    }
+    std::string saved_filters = in.get_string();
+    if (in.ok() && saved_filters != filters) {
+        error = "Checkpoint " + path + " was written with line filters (" + saved_filters +
+                "), not (" + filters + "); use the same --symbol and --end";
+        return false;
+    }
 
-        return true;
+    uint32_t chain_count = in.get_u32();
+    for (uint32_t c = 0; c < chain_count && in.ok(); c++) {
+        ChainState& state = chains[in.get_string()];
+        state.cursor.started = in.get_u8() != 0;
+        state.cursor.key = in.get_string();
+        state.cursor.offset = in.get_u64();
+
+        uint32_t symbol_count = in.get_u32();
+        for (uint32_t i = 0; i < symbol_count && in.ok(); i++) {
+            std::string symbol = in.get_string();
+            bool has_next = in.get_u8() != 0;
+            double next = in.get_f64();
+            if (has_next) {
+                state.next_sample_time[symbol] = next;
+            }
+            auto it = state.states.emplace(symbol, OrderBookState(symbol)).first;
+            it->second.load_checkpoint(in);
+        }
+    }
 
-    } catch (const simdjson::simdjson_error& e) {
-        std::cerr << "Error parsing JSON: " << simdjson::error_message(e.error()) << std::endl;
+    if (!in.ok() || !in.at_end()) {
+        error = "Corrupt checkpoint: " + path;
         return false;
     }
+    return true;
 }
 
 int main(int argc, char* argv[]) {
@@ -168,11 +381,11 @@ int main(int argc, char* argv[]) {
 
     parser.add_argument({
         "-i", "--input",
-        "Input .jsonl file from retrieve_kraken_live_data_level2",
+        "Input .jsonl files, directories or quoted globs from retrieve_kraken_live_data_level2 (comma-separated)",
         true,  // required
         true,  // has value
         "",
-        "FILE"
+        "FILES"
     });
 
     parser.add_argument({
@@ -211,6 +424,24 @@ int main(int argc, char* argv[]) {
         "LIST"
     });
 
+    parser.add_argument({
+        "", "--start",
+        "Write samples from this UTC time on (e.g., '2025-10-18 09:30')",
+        false,  // optional
+        true,   // has value
+        "",
+        "TIME"
+    });
+
+    parser.add_argument({
+        "", "--end",
+        "Ignore records from this UTC time on (exclusive)",
+        false,  // optional
+        true,   // has value
+        "",
+        "TIME"
+    });
+
     parser.add_argument({
         "", "--skip-validation",
         "Skip checksum validation (faster)",
@@ -220,6 +451,33 @@ int main(int argc, char* argv[]) {
         ""
     });
 
+    parser.add_argument({
+        "", "--sweep-sizes",
+        "Sweep cost columns for these order sizes (comma-separated)",
+        false,  // optional
+        true,   // has value
+        "",
+        "LIST"
+    });
+
+    parser.add_argument({
+        "", "--checkpoint",
+        "Resume from / save book state and progress to FILE",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
+    parser.add_argument({
+        "-j", "--jobs",
+        "Segment chains processed in parallel",
+        false,  // optional
+        true,   // has value
+        "1",
+        "N"
+    });
+
     // Parse arguments
     if (!parser.parse(argc, argv)) {
         if (!parser.get_errors().empty()) {
@@ -234,12 +492,47 @@ int main(int argc, char* argv[]) {
     }
 
     // Get arguments
-    std::string input_file = parser.get("-i");
+    std::string input_list = parser.get("-i");
     std::string interval_str = parser.get("--interval");
     std::string output_file = parser.get("-o");
     bool separate_files = parser.has("--separate-files");
     bool skip_validation = parser.has("--skip-validation");
     std::string symbol_filter = parser.get("--symbol");
+    std::string start_arg = parser.get("--start");
+    std::string end_arg = parser.get("--end");
+    std::string sweep_list = parser.get("--sweep-sizes");
+    std::string checkpoint_file = parser.get("--checkpoint");
+    int jobs = 0;
+    try {
+        jobs = std::stoi(parser.get("--jobs"));
+    } catch (const std::exception&) {
+        jobs = 0;
+    }
+    if (jobs < 1) {
+        std::cerr << "Error: --jobs must be at least 1" << std::endl;
+        return 1;
+    }
+
+    // Parse sweep sizes (ascending, one pass per side computes them all)
+    std::vector<double> sweep_sizes;
+    if (!sweep_list.empty()) {
+        for (const auto& item : cli::ListParser::parse(sweep_list, ',')) {
+            double size = 0.0;
+            try {
+                size = std::stod(item);
+            } catch (const std::exception&) {
+                size = -1.0;
+            }
+            if (size <= 0.0) {
+                std::cerr << "Error: Invalid --sweep-sizes entry: " << item
+                          << " (expected positive sizes, e.g. 1,5,10,50)" << std::endl;
+                return 1;
+            }
+            sweep_sizes.push_back(size);
+        }
+        std::sort(sweep_sizes.begin(), sweep_sizes.end());
+        sweep_sizes.erase(std::unique(sweep_sizes.begin(), sweep_sizes.end()), sweep_sizes.end());
+    }
 
     // Parse interval
     int interval_seconds = parse_interval(interval_str);
@@ -253,11 +546,61 @@ int main(int argc, char* argv[]) {
         allowed_symbols = cli::ListParser::parse(symbol_filter, ',');
     }
 
+    // Parse time range
+    std::string start_time;
+    std::string end_time;
+    if (!start_arg.empty() && !LinePrefilter::normalize_time(start_arg, start_time)) {
+        std::cerr << "Error: Invalid --start time: " << start_arg
+                  << " (expected YYYY-MM-DD[ HH[:MM[:SS]]])" << std::endl;
+        return 1;
+    }
+    if (!end_arg.empty() && !LinePrefilter::normalize_time(end_arg, end_time)) {
+        std::cerr << "Error: Invalid --end time: " << end_arg
+                  << " (expected YYYY-MM-DD[ HH[:MM[:SS]]])" << std::endl;
+        return 1;
+    }
+    if (!start_time.empty() && !end_time.empty() && end_time <= start_time) {
+        std::cerr << "Error: --end must be after --start" << std::endl;
+        return 1;
+    }
+
+    // Raw line filter (also recorded in the checkpoint)
+    LinePrefilter prefilter;
+    prefilter.set_symbols(allowed_symbols);
+    prefilter.set_time_range("", end_time);
+
+    // Expand inputs into segment chains
+    std::vector<std::string> input_files;
+    std::string input_error;
+    if (!SegmentBatch::expand_inputs(cli::ListParser::parse(input_list, ','), input_files, input_error)) {
+        std::cerr << "Error: " << input_error << std::endl;
+        return 1;
+    }
+    std::vector<SegmentChain> chains = SegmentBatch::build_chains(input_files);
+
+    // Resume from checkpoint (chains not in this run are kept as they are)
+    std::map<std::string, ChainState> saved_chains;
+    bool resuming = false;
+    if (!checkpoint_file.empty() && cli::Validator::is_valid_file(checkpoint_file)) {
+        std::string checkpoint_error;
+        if (!load_checkpoint(checkpoint_file, interval_seconds, prefilter.describe(),
+                             saved_chains, checkpoint_error)) {
+            std::cerr << "Error: " << checkpoint_error << std::endl;
+            return 1;
+        }
+        resuming = true;
+    }
+
     // Display configuration
     std::cout << "==================================================" << std::endl;
     std::cout << "Process Order Book Snapshots" << std::endl;
     std::cout << "==================================================" << std::endl;
-    std::cout << "Input file: " << input_file << std::endl;
+    if (input_files.size() == 1) {
+        std::cout << "Input file: " << input_files[0] << std::endl;
+    } else {
+        std::cout << "Input files: " << input_files.size() << " in " << chains.size()
+                  << " chain(s), " << jobs << " job(s)" << std::endl;
+    }
     std::cout << "Interval: " << interval_str << " (" << interval_seconds << " seconds)" << std::endl;
     if (separate_files) {
         std::cout << "Output mode: Separate files per symbol" << std::endl;
@@ -273,144 +616,149 @@ int main(int argc, char* argv[]) {
         }
         std::cout << std::endl;
     }
+    if (!start_time.empty() || !end_time.empty()) {
+        std::cout << "Time range: " << (start_time.empty() ? "start" : start_time)
+                  << " to " << (end_time.empty() ? "end" : end_time) << " (UTC)" << std::endl;
+    }
     std::cout << "Checksum validation: " << (skip_validation ? "disabled" : "enabled") << std::endl;
+    if (!checkpoint_file.empty()) {
+        std::cout << "Checkpoint: " << checkpoint_file;
+        if (resuming) {
+            std::cout << " (resuming " << saved_chains.size() << " chain(s), appending output)";
+        }
+        std::cout << std::endl;
+    }
+    if (!sweep_sizes.empty()) {
+        std::cout << "Sweep sizes: ";
+        for (size_t i = 0; i < sweep_sizes.size(); i++) {
+            if (i > 0) std::cout << ", ";
+            std::cout << sweep_sizes[i];
+        }
+        std::cout << std::endl;
+    }
     std::cout << std::endl;
 
-    // Open input file
-    std::ifstream infile(input_file);
-    if (!infile.is_open()) {
-        std::cerr << "Error: Cannot open input file: " << input_file << std::endl;
-        return 1;
-    }
+    ProcessOptions options;
+    options.interval_seconds = interval_seconds;
+    options.skip_validation = skip_validation;
+    options.allowed_symbols = allowed_symbols;
+    options.start_time = start_time;
+    options.prefilter = prefilter;
+    options.sweep_sizes = sweep_sizes;
+    options.hold_partial_lines = !checkpoint_file.empty();
 
     // Create output writers
+    // A single output file gets one part per chain, merged in series order
     SnapshotCSVWriter* single_writer = nullptr;
     MultiFileSnapshotCSVWriter* multi_writer = nullptr;
+    std::vector<std::string> part_files;
+    std::mutex multi_writer_mutex;
 
     if (separate_files) {
-        multi_writer = new MultiFileSnapshotCSVWriter(output_file);
-    } else {
-        single_writer = new SnapshotCSVWriter(output_file);
+        multi_writer = new MultiFileSnapshotCSVWriter(output_file, resuming, sweep_sizes);
+    } else if (chains.size() == 1) {
+        single_writer = new SnapshotCSVWriter(output_file, resuming, sweep_sizes);
         if (!single_writer->is_open()) {
             std::cerr << "Error: Cannot open output file: " << output_file << std::endl;
             delete single_writer;
             return 1;
         }
+    } else {
+        for (size_t i = 0; i < chains.size(); i++) {
+            part_files.push_back(output_file + ".part" + std::to_string(i));
+        }
     }
 
-    // Maintain order book state for each symbol
-    std::map<std::string, OrderBookState> states;
-
-    // Track next sample time for each symbol
-    std::map<std::string, double> next_sample_time;
-
-    // Process records
-    std::string line;
-    int line_num = 0;
-    int records_processed = 0;
-    int snapshots_written = 0;
-    int checksum_errors = 0;
-
     std::cout << "Processing..." << std::endl;
 
-    while (std::getline(infile, line)) {
-        line_num++;
-
-        if (line.empty()) {
-            continue;
-        }
-
-        // Parse record
-        OrderBookRecord record;
-        if (!parse_jsonl_record(line, record)) {
-            std::cerr << "Warning: Failed to parse line " << line_num << std::endl;
-            continue;
-        }
-
-        // Apply symbol filter
-        if (!allowed_symbols.empty()) {
-            bool allowed = false;
-            for (const auto& sym : allowed_symbols) {
-                if (record.symbol == sym) {
-                    allowed = true;
-                    break;
-                }
-            }
-            if (!allowed) {
-                continue;
-            }
-        }
-
-        // Get or create state for this symbol
-        auto it = states.find(record.symbol);
-        if (it == states.end()) {
-            auto result = states.emplace(record.symbol, OrderBookState(record.symbol));
-            it = result.first;
-            std::cout << "Initialized state for " << record.symbol << std::endl;
+    ProcessLog log;
+    std::vector<ChainResult> results(chains.size());
+    std::vector<ChainState> chain_states(chains.size());
+    for (size_t i = 0; i < chains.size(); i++) {
+        auto saved = saved_chains.find(chains[i].series);
+        if (saved != saved_chains.end()) {
+            chain_states[i] = std::move(saved->second);
         }
+    }
 
-        OrderBookState& state = it->second;
-
-        // Apply record to state
-        state.apply(record);
-        records_processed++;
-
-        // Validate checksum if enabled
-        if (!skip_validation && state.is_initialized()) {
-            if (!state.validate_checksum(record.checksum)) {
-                checksum_errors++;
-                if (checksum_errors <= 10) {  // Only show first 10 warnings
-                    std::cerr << "Warning: Checksum validation failed for "
-                              << record.symbol << " at " << record.timestamp << std::endl;
-                }
-            }
-        }
-
-        // Check if we need to take a sample
-        double current_time = parse_timestamp(record.timestamp);
-
-        if (next_sample_time.find(record.symbol) == next_sample_time.end()) {
-            // First record for this symbol - set next sample time
-            next_sample_time[record.symbol] = current_time + interval_seconds;
-        }
-
-        if (current_time >= next_sample_time[record.symbol]) {
-            // Time to take a sample
-            SnapshotMetrics metrics = MetricsCalculator::calculate(state, record.timestamp);
-
-            // Write snapshot
-            if (multi_writer) {
+    SegmentBatch::run_parallel(chains.size(), static_cast<size_t>(jobs), [&](size_t index) {
+        if (multi_writer) {
+            results[index] = process_chain(chains[index], options, [&](const SnapshotMetrics& metrics) {
+                std::lock_guard<std::mutex> lock(multi_writer_mutex);
                 multi_writer->write_snapshot(metrics);
-            } else if (single_writer) {
+            }, log, chain_states[index]);
+        } else if (single_writer) {
+            results[index] = process_chain(chains[index], options, [&](const SnapshotMetrics& metrics) {
                 single_writer->write_snapshot(metrics);
+            }, log, chain_states[index]);
+        } else {
+            SnapshotCSVWriter part_writer(part_files[index], false, sweep_sizes);
+            if (!part_writer.is_open()) {
+                std::lock_guard<std::mutex> lock(log.mutex);
+                std::cerr << "Error: Cannot open output file: " << part_files[index] << std::endl;
+                return;
             }
-
-            snapshots_written++;
-
-            // Update next sample time
-            next_sample_time[record.symbol] += interval_seconds;
+            results[index] = process_chain(chains[index], options, [&](const SnapshotMetrics& metrics) {
+                part_writer.write_snapshot(metrics);
+            }, log, chain_states[index]);
         }
-    }
 
-    infile.close();
+        if (chains.size() > 1) {
+            std::lock_guard<std::mutex> lock(log.mutex);
+            std::cout << "Finished " << chains[index].series << " (" << chains[index].files.size()
+                      << " segment(s), " << results[index].snapshots_written << " snapshots)" << std::endl;
+        }
+    });
 
     // Flush output
     if (multi_writer) {
         multi_writer->flush_all();
     } else if (single_writer) {
         single_writer->flush();
+    } else {
+        std::string merge_error;
+        if (!SegmentBatch::merge_csv_parts(part_files, output_file, merge_error, resuming)) {
+            std::cerr << "Error: " << merge_error << std::endl;
+            return 1;
+        }
+    }
+
+    // Save checkpoint after the output is complete
+    if (!checkpoint_file.empty()) {
+        for (size_t i = 0; i < chains.size(); i++) {
+            saved_chains[chains[i].series] = std::move(chain_states[i]);
+        }
+        std::string checkpoint_error;
+        if (!save_checkpoint(checkpoint_file, interval_seconds, options.prefilter.describe(),
+                             saved_chains, checkpoint_error)) {
+            std::cerr << "Error: " << checkpoint_error << std::endl;
+            return 1;
+        }
+    }
+
+    ChainResult totals;
+    for (const auto& result : results) {
+        totals.input_records += result.input_records;
+        totals.records_filtered += result.records_filtered;
+        totals.records_processed += result.records_processed;
+        totals.snapshots_written += result.snapshots_written;
+        totals.checksum_errors += result.checksum_errors;
+        totals.symbols.insert(result.symbols.begin(), result.symbols.end());
     }
 
     // Summary
     std::cout << "\n==================================================" << std::endl;
     std::cout << "Summary" << std::endl;
     std::cout << "==================================================" << std::endl;
-    std::cout << "Input records: " << line_num << std::endl;
-    std::cout << "Records processed: " << records_processed << std::endl;
-    std::cout << "Symbols: " << states.size() << std::endl;
-    std::cout << "Snapshots written: " << snapshots_written << std::endl;
-    if (!skip_validation && checksum_errors > 0) {
-        std::cout << "Checksum errors: " << checksum_errors << std::endl;
+    std::cout << "Input records: " << totals.input_records << std::endl;
+    if (totals.records_filtered > 0) {
+        std::cout << "Filtered before parsing: " << totals.records_filtered << std::endl;
+    }
+    std::cout << "Records processed: " << totals.records_processed << std::endl;
+    std::cout << "Symbols: " << totals.symbols.size() << std::endl;
+    std::cout << "Snapshots written: " << totals.snapshots_written << std::endl;
+    if (!skip_validation && totals.checksum_errors > 0) {
+        std::cout << "Checksum errors: " << totals.checksum_errors << std::endl;
     }
 
     if (separate_files) {
@@ -418,7 +766,9 @@ int main(int argc, char* argv[]) {
         std::cout << "Total snapshots: " << multi_writer->get_total_snapshot_count() << std::endl;
     } else {
         std::cout << "Output file: " << output_file << std::endl;
-        std::cout << "Snapshots written: " << single_writer->get_snapshot_count() << std::endl;
+        if (single_writer) {
+            std::cout << "Snapshots written: " << single_writer->get_snapshot_count() << std::endl;
+        }
     }
 
     std::cout << "Processing complete." << std::endl;
@@ -0,0 +1,293 @@
+/**
+ * Process Ticker Data
+ *
+ * Builds time bars from the Level 1 ticker CSV files written by
+ * retrieve_kraken_live_data_level1: OHLC of the last price, volume, OHLC
+ * of the mid price and spread statistics, per symbol, at one or more
+ * intervals in a single pass.
+ *
+ * Usage:
+ *   ./process_ticker_data -i ticker.csv --intervals 1m -o bars.csv
+ *   ./process_ticker_data -i ticker.csv --intervals 1m,5m,1h -o bars.csv
+ *   ./process_ticker_data -i 'captures/ticker.*.csv' --intervals 1m --symbol BTC/USD
+ *
+ * Inputs may be files or quoted glob patterns, comma-separated; they are
+ * read in name order as one stream, so hourly / daily segments continue
+ * each other's bars. Files are memory-mapped and scanned with CsvScanner
+ * (SIMD delimiter search, std::from_chars numbers).
+ *
+ * Volume is estimated from increases of the rolling 24h volume column;
+ * bars are aligned to UTC multiples of the interval and intervals without
+ * ticks produce no bar.
+ *
+ * Output:
+ *   CSV file with one row per (bar, interval, symbol), in closing order
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <set>
+#include <chrono>
+#include <algorithm>
+#include "cli_utils.hpp"
+#include "segment_batch.hpp"
+#include "csv_scanner.hpp"
+#include "ticker_bars.hpp"
+#include "bar_csv_writer.hpp"
+
+using kraken::SegmentBatch;
+using kraken::CsvScanner;
+using kraken::TickerBar;
+using kraken::TickerBarBuilder;
+using kraken::BarCSVWriter;
+
+/**
+ * Parse interval string (e.g., "1s", "5s", "1m", "1h")
+ * Returns interval in seconds, or -1 on error
+ */
+int parse_interval(const std::string& interval_str) {
+    if (interval_str.empty()) {
+        return -1;
+    }
+
+    // Extract number and unit
+    size_t unit_pos = interval_str.find_first_not_of("0123456789");
+    if (unit_pos == std::string::npos || unit_pos == 0) {
+        std::cerr << "Error: Invalid interval format: " << interval_str << std::endl;
+        std::cerr << "Expected format: <number><unit> (e.g., 1s, 5s, 1m, 1h)" << std::endl;
+        return -1;
+    }
+
+    int value = std::stoi(interval_str.substr(0, unit_pos));
+    std::string unit = interval_str.substr(unit_pos);
+
+    if (unit == "s") {
+        return value;
+    } else if (unit == "m") {
+        return value * 60;
+    } else if (unit == "h") {
+        return value * 3600;
+    } else {
+        std::cerr << "Error: Unknown time unit: " << unit << std::endl;
+        std::cerr << "Supported units: s (seconds), m (minutes), h (hours)" << std::endl;
+        return -1;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    // Setup argument parser
+    cli::ArgumentParser parser(argv[0], "Build OHLCV, mid and spread bars from Level 1 ticker CSV files");
+
+    parser.add_argument({
+        "-i", "--input",
+        "Input ticker CSV files or quoted globs from retrieve_kraken_live_data_level1 (comma-separated)",
+        true,   // required
+        true,   // has value
+        "",
+        "FILES"
+    });
+
+    parser.add_argument({
+        "", "--intervals",
+        "Bar intervals (comma-separated, e.g., 1m,5m,1h)",
+        true,   // required
+        true,   // has value
+        "",
+        "LIST"
+    });
+
+    parser.add_argument({
+        "-o", "--output",
+        "Output CSV file",
+        false,  // optional
+        true,   // has value
+        "bars.csv",
+        "FILE"
+    });
+
+    parser.add_argument({
+        "", "--symbol",
+        "Filter to specific symbol(s) (comma-separated)",
+        false,  // optional
+        true,   // has value
+        "",
+        "LIST"
+    });
+
+    // Parse arguments
+    if (!parser.parse(argc, argv)) {
+        if (!parser.get_errors().empty()) {
+            for (const auto& error : parser.get_errors()) {
+                std::cerr << "Error: " << error << std::endl;
+            }
+            std::cerr << std::endl;
+            parser.print_help();
+            return 1;
+        }
+        return 0; // Help shown
+    }
+
+    // Get arguments
+    std::string input_list = parser.get("-i");
+    std::string interval_list = parser.get("--intervals");
+    std::string output_file = parser.get("-o");
+    std::string symbol_filter = parser.get("--symbol");
+
+    // Parse intervals
+    std::vector<int> intervals;
+    for (const auto& item : cli::ListParser::parse(interval_list, ',')) {
+        int seconds = parse_interval(item);
+        if (seconds <= 0) {
+            return 1;
+        }
+        intervals.push_back(seconds);
+    }
+    std::sort(intervals.begin(), intervals.end());
+    intervals.erase(std::unique(intervals.begin(), intervals.end()), intervals.end());
+    if (intervals.empty()) {
+        std::cerr << "Error: No intervals given" << std::endl;
+        return 1;
+    }
+
+    // Parse symbol filter if provided
+    std::set<std::string> allowed_symbols;
+    if (!symbol_filter.empty()) {
+        for (const auto& symbol : cli::ListParser::parse(symbol_filter, ',')) {
+            allowed_symbols.insert(symbol);
+        }
+    }
+
+    // Expand inputs (name order)
+    std::vector<std::string> input_files;
+    std::string input_error;
+    if (!SegmentBatch::expand_inputs(cli::ListParser::parse(input_list, ','), input_files, input_error)) {
+        std::cerr << "Error: " << input_error << std::endl;
+        return 1;
+    }
+
+    // Display configuration
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Process Ticker Data" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    if (input_files.size() == 1) {
+        std::cout << "Input file: " << input_files[0] << std::endl;
+    } else {
+        std::cout << "Input files: " << input_files.size() << std::endl;
+    }
+    std::cout << "Intervals: ";
+    for (size_t i = 0; i < intervals.size(); i++) {
+        if (i > 0) std::cout << ", ";
+        std::cout << intervals[i] << "s";
+    }
+    std::cout << std::endl;
+    std::cout << "Output file: " << output_file << std::endl;
+    if (!allowed_symbols.empty()) {
+        std::cout << "Symbol filter: " << symbol_filter << std::endl;
+    }
+    std::cout << std::endl;
+
+    BarCSVWriter writer(output_file);
+    if (!writer.is_open()) {
+        return 1;
+    }
+    TickerBarBuilder builder(intervals, [&writer](const TickerBar& bar) {
+        writer.write_bar(bar);
+    });
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    size_t rows = 0;
+    size_t rows_used = 0;
+    size_t bad_rows = 0;
+    uint64_t bytes_read = 0;
+    std::string symbol;
+
+    CsvScanner scanner;
+    for (const auto& input_file : input_files) {
+        std::string error;
+        if (!scanner.open(input_file, error)) {
+            std::cerr << "Warning: " << error << std::endl;
+            continue;
+        }
+        bytes_read += scanner.size();
+
+        int col_timestamp = scanner.column("timestamp");
+        int col_symbol = scanner.column("pair");
+        if (col_symbol < 0) {
+            col_symbol = scanner.column("symbol");
+        }
+        int col_bid = scanner.column("bid");
+        int col_ask = scanner.column("ask");
+        int col_last = scanner.column("last");
+        int col_volume = scanner.column("volume");
+        if (col_timestamp < 0 || col_symbol < 0 || col_bid < 0 || col_ask < 0 || col_last < 0) {
+            std::cerr << "Warning: " << input_file << " is not a ticker CSV "
+                      << "(needs timestamp, pair, bid, ask, last columns), skipped" << std::endl;
+            continue;
+        }
+
+        while (scanner.next_row()) {
+            rows++;
+
+            if (!scanner.get_string(col_symbol, symbol)) {
+                bad_rows++;
+                continue;
+            }
+            if (!allowed_symbols.empty() && allowed_symbols.find(symbol) == allowed_symbols.end()) {
+                continue;
+            }
+
+            double time;
+            if (!scanner.get_timestamp(col_timestamp, time)) {
+                if (bad_rows++ < 10) {
+                    std::cerr << "Warning: Bad timestamp in " << input_file
+                              << " row " << scanner.row_number() << std::endl;
+                }
+                continue;
+            }
+
+            // Missing values count as absent (0 / -1)
+            double bid = 0.0, ask = 0.0, last = 0.0, volume = -1.0;
+            scanner.get_double(col_bid, bid);
+            scanner.get_double(col_ask, ask);
+            scanner.get_double(col_last, last);
+            if (col_volume >= 0 && !scanner.get_double(col_volume, volume)) {
+                volume = -1.0;
+            }
+
+            builder.add(symbol, time, bid, ask, last, volume);
+            rows_used++;
+        }
+        scanner.close();
+    }
+
+    builder.finish();
+    writer.flush();
+
+    auto end_time = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(end_time - start_time).count();
+
+    // Summary
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Summary" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Rows read: " << rows << std::endl;
+    std::cout << "Rows used: " << rows_used << std::endl;
+    if (bad_rows > 0) {
+        std::cout << "Malformed rows: " << bad_rows << std::endl;
+    }
+    if (builder.get_out_of_order_count() > 0) {
+        std::cout << "Out-of-order rows ignored: " << builder.get_out_of_order_count() << std::endl;
+    }
+    std::cout << "Bars written: " << writer.get_bar_count() << std::endl;
+    std::cout << "Processing time: " << std::fixed << std::setprecision(2) << elapsed << " seconds";
+    if (elapsed > 0) {
+        std::cout << " (" << std::setprecision(1) << (bytes_read / 1024.0 / 1024.0 / elapsed) << " MB/s)";
+    }
+    std::cout << std::endl;
+    std::cout << "Output: " << output_file << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,250 @@
+/**
+ * Replay Capture
+ *
+ * Replays .jsonl captures from retrieve_kraken_live_data_level2/level3
+ * through ReplaySource, which exposes the same callbacks as the live
+ * clients. The callbacks below are what a live consumer would register;
+ * here they maintain the book per symbol and report the final top of book.
+ *
+ * Usage:
+ *   ./replay_capture -i book.jsonl
+ *   ./replay_capture -i book.20251112_10.jsonl,book.20251112_11.jsonl --speed 100x
+ *   ./replay_capture -i level3.jsonl --level 3 --speed realtime --symbol BTC/USD
+ *
+ * Speed:
+ *   max       As fast as possible (default)
+ *   realtime  Original timing
+ *   <N>x      N times real time (e.g. 10x, 0.5x)
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <csignal>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "cli_utils.hpp"
+#include "orderbook_common.hpp"
+#include "orderbook_state.hpp"
+#include "level3_common.hpp"
+#include "level3_state.hpp"
+#include "replay_source.hpp"
+
+using kraken::OrderBookRecord;
+using kraken::OrderBookState;
+using kraken::Level3Record;
+using kraken::Level3OrderBookState;
+using kraken::ReplaySource;
+using kraken::ReplayPacing;
+
+// Global state
+std::atomic<bool> g_running{true};
+
+void signal_handler(int) {
+    std::cout << "\n\nStopping replay..." << std::endl;
+    g_running = false;
+}
+
+/**
+ * Run a replay and print its statistics
+ */
+template<typename Record>
+bool run_replay(ReplaySource<Record>& source, const std::vector<std::string>& symbols) {
+    source.set_connection_callback([](bool connected) {
+        std::cout << "[STATUS] Replay " << (connected ? "started" : "finished") << std::endl;
+    });
+
+    if (!source.start(symbols)) {
+        std::cerr << "Failed to start replay" << std::endl;
+        return false;
+    }
+
+    while (g_running && source.is_running()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    source.stop();
+
+    auto stats = source.get_stats();
+    std::cout << "\n==================================================" << std::endl;
+    std::cout << "Replay Summary" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Records delivered: " << stats.records << std::endl;
+    if (stats.filtered > 0) {
+        std::cout << "Records filtered: " << stats.filtered << std::endl;
+    }
+    if (stats.parse_errors > 0) {
+        std::cout << "Parse errors: " << stats.parse_errors << std::endl;
+    }
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Event time covered: " << stats.event_seconds << " seconds" << std::endl;
+    std::cout << "Wall time: " << stats.wall_seconds << " seconds" << std::endl;
+    if (stats.wall_seconds > 0) {
+        std::cout << "Throughput: " << std::setprecision(0)
+                  << stats.records / stats.wall_seconds << " records/s" << std::endl;
+        std::cout << "Speed: " << std::setprecision(1)
+                  << stats.event_seconds / stats.wall_seconds << "x real time" << std::endl;
+    }
+    if (stats.max_lag_us > 0) {
+        std::cout << "Max pacing lag: " << std::setprecision(1) << stats.max_lag_us << " us" << std::endl;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    cli::ArgumentParser parser(argv[0], "Replay captured order book data through the live client callbacks");
+
+    parser.add_argument({
+        "-i", "--input",
+        "Input .jsonl file(s), comma-separated, replayed in order",
+        true,   // required
+        true,   // has value
+        "",
+        "FILES"
+    });
+
+    parser.add_argument({
+        "", "--level",
+        "Capture level: 2 (book) or 3 (level3)",
+        false,  // optional
+        true,   // has value
+        "2",
+        "LEVEL"
+    });
+
+    parser.add_argument({
+        "", "--speed",
+        "Pacing: max, realtime or <N>x",
+        false,  // optional
+        true,   // has value
+        "max",
+        "SPEED"
+    });
+
+    parser.add_argument({
+        "", "--symbol",
+        "Filter to specific symbol(s) (comma-separated)",
+        false,  // optional
+        true,   // has value
+        "",
+        "SYMBOLS"
+    });
+
+    if (!parser.parse(argc, argv)) {
+        if (!parser.get_errors().empty()) {
+            for (const auto& error : parser.get_errors()) {
+                std::cerr << "Error: " << error << std::endl;
+            }
+            std::cerr << std::endl;
+            parser.print_help();
+            return 1;
+        }
+        return 0; // Help shown
+    }
+
+    std::vector<std::string> files = cli::ListParser::parse(parser.get("-i"), ',');
+    std::string level = parser.get("--level");
+    std::string speed_spec = parser.get("--speed");
+    std::vector<std::string> symbols;
+    if (!parser.get("--symbol").empty()) {
+        symbols = cli::ListParser::parse(parser.get("--symbol"), ',');
+    }
+
+    if (level != "2" && level != "3") {
+        std::cerr << "Error: --level must be 2 or 3" << std::endl;
+        return 1;
+    }
+
+    ReplayPacing pacing;
+    double speed = 1.0;
+    if (!ReplaySource<OrderBookRecord>::parse_pacing(speed_spec, pacing, speed)) {
+        std::cerr << "Error: Invalid --speed: " << speed_spec << " (expected max, realtime or <N>x)" << std::endl;
+        return 1;
+    }
+
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Replay Capture - Level " << level << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Files: " << files.size() << std::endl;
+    for (const auto& file : files) {
+        std::cout << "  - " << file << std::endl;
+    }
+    std::cout << "Pacing: " << ReplaySource<OrderBookRecord>::pacing_name(pacing);
+    if (pacing == ReplayPacing::SCALED) {
+        std::cout << " (" << speed << "x)";
+    }
+    std::cout << std::endl;
+    if (!symbols.empty()) {
+        std::cout << "Symbols: " << cli::StringUtils::join(symbols, ", ") << std::endl;
+    }
+    std::cout << std::endl;
+
+    std::signal(SIGINT, signal_handler);
+
+    if (level == "2") {
+        // Same consumer as a KrakenBookClient update callback
+        std::map<std::string, OrderBookState> books;
+
+        ReplaySource<OrderBookRecord> source(files);
+        source.set_pacing(pacing, speed);
+        source.set_update_callback([&books](const OrderBookRecord& record) {
+            auto it = books.find(record.symbol);
+            if (it == books.end()) {
+                it = books.emplace(record.symbol, OrderBookState(record.symbol)).first;
+            }
+            it->second.apply(record);
+        });
+
+        if (!run_replay(source, symbols)) {
+            return 1;
+        }
+
+        std::cout << "\nFinal top of book:" << std::endl;
+        for (const auto& pair : books) {
+            double bid = 0, bid_qty = 0, ask = 0, ask_qty = 0;
+            pair.second.get_best_bid(bid, bid_qty);
+            pair.second.get_best_ask(ask, ask_qty);
+            std::cout << "  " << pair.first << std::setprecision(8)
+                      << " bid " << bid << " x " << bid_qty
+                      << " | ask " << ask << " x " << ask_qty << std::endl;
+        }
+    } else {
+        // Same consumer as a KrakenLevel3Client update callback
+        std::map<std::string, std::unique_ptr<Level3OrderBookState>> books;
+
+        ReplaySource<Level3Record> source(files);
+        source.set_pacing(pacing, speed);
+        source.set_update_callback([&books](const Level3Record& record) {
+            auto& book = books[record.symbol];
+            if (!book) {
+                book.reset(new Level3OrderBookState(record.symbol));
+            }
+            if (record.type == "snapshot") {
+                book->apply_snapshot(record);
+            } else {
+                book->apply_update(record);
+            }
+        });
+
+        if (!run_replay(source, symbols)) {
+            return 1;
+        }
+
+        std::cout << "\nFinal top of book:" << std::endl;
+        for (const auto& pair : books) {
+            double bid = 0, bid_qty = 0, ask = 0, ask_qty = 0;
+            pair.second->get_best_bid(bid, bid_qty);
+            pair.second->get_best_ask(ask, ask_qty);
+            std::cout << "  " << pair.first << std::setprecision(8)
+                      << " bid " << bid << " x " << bid_qty
+                      << " | ask " << ask << " x " << ask_qty
+                      << " | orders " << pair.second->get_total_bid_orders()
+                      << "/" << pair.second->get_total_ask_orders() << std::endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,634 @@
+/**
+ * Reshard Capture
+ *
+ * Re-partitions captures by symbol and/or by the hour or day of the records'
+ * own timestamps, with optional size rolling, in one streaming pass. Lines
+ * are copied unchanged: only the symbol and timestamp fields are located,
+ * nothing is decoded, so it runs at disk speed.
+ *
+ * Usage:
+ *   ./reshard_capture -i merged_book.jsonl -o shards/book.jsonl --by-symbol --hourly
+ *   ./reshard_capture -i 'backfill/book_*.jsonl' -o book.jsonl --hourly
+ *   ./reshard_capture -i level3_raw.jsonl -o l3.jsonl --daily --max-size 512M
+ *   ./reshard_capture -i trades.csv -o trades.csv --by-symbol --daily
+ *
+ * Inputs may be files, directories (their .jsonl files) or quoted glob
+ * patterns, comma-separated; they are read in name order. Accepts the
+ * JSON Lines captures of the level 2 / level 3 recorders (record-level
+ * "timestamp" and "symbol" fields) and the recorders' CSV files (header
+ * with a "timestamp" and a "symbol" or "pair" column; the header is
+ * repeated at the top of every output file).
+ *
+ * Output names follow the recorders and SegmentBatch, so the shards can be
+ * fed to process_orderbook_snapshots / process_level3_snapshots directly:
+ *   shards/book_BTC_USD.20251112_10.jsonl
+ *   l3.20251112-001.jsonl       (second part of a size-rolled day)
+ *
+ * Memory is bounded: each output buffers at most --buffer-size bytes and at
+ * most --max-open files are open (the least recently written is closed and
+ * reopened for appending when needed). Records that arrive out of order
+ * (merged captures) are appended to the segment they belong to.
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <map>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include "cli_utils.hpp"
+#include "segment_batch.hpp"
+#include "line_segment_writer.hpp"
+
+using kraken::SegmentBatch;
+using kraken::SegmentMode;
+using kraken::SegmentClock;
+using kraken::LineSegmentWriter;
+
+/**
+ * Parse a byte size ("1048576", "64K", "512M", "2G")
+ * Returns false on error
+ */
+bool parse_size(const std::string& text, uint64_t& bytes) {
+    size_t unit_pos = text.find_first_not_of("0123456789");
+    if (text.empty() || unit_pos == 0) {
+        return false;
+    }
+
+    uint64_t multiplier = 1;
+    if (unit_pos != std::string::npos) {
+        std::string unit = text.substr(unit_pos);
+        if (unit == "K" || unit == "k") {
+            multiplier = 1024ULL;
+        } else if (unit == "M" || unit == "m") {
+            multiplier = 1024ULL * 1024;
+        } else if (unit == "G" || unit == "g") {
+            multiplier = 1024ULL * 1024 * 1024;
+        } else {
+            return false;
+        }
+    }
+
+    try {
+        bytes = std::stoull(text.substr(0, unit_pos)) * multiplier;
+    } catch (const std::exception&) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Copy the string value of a JSON field ("key":"value") into out
+ * Finds the first occurrence, which is the record-level field in the
+ * recorders' output (timestamp first, symbol before any order arrays).
+ */
+bool json_field(const char* line, size_t len, const char* pattern, size_t pattern_len, std::string& out) {
+    const char* found = static_cast<const char*>(memmem(line, len, pattern, pattern_len));
+    if (!found) {
+        return false;
+    }
+    const char* value = found + pattern_len;
+    const char* end = static_cast<const char*>(std::memchr(value, '"', line + len - value));
+    if (!end) {
+        return false;
+    }
+    out.assign(value, end - value);
+    return true;
+}
+
+/**
+ * Copy CSV column index into out (no quoting in the recorders' CSV files)
+ */
+bool csv_field(const char* line, size_t len, int index, std::string& out) {
+    if (index < 0) {
+        return false;
+    }
+    const char* end = line + len;
+    const char* start = line;
+    for (int column = 0; column < index; column++) {
+        const char* comma = static_cast<const char*>(std::memchr(start, ',', end - start));
+        if (!comma) {
+            return false;
+        }
+        start = comma + 1;
+    }
+    const char* comma = static_cast<const char*>(std::memchr(start, ',', end - start));
+    out.assign(start, comma ? comma : end);
+    return true;
+}
+
+/**
+ * Reads a file in large blocks and hands out lines in place
+ */
+class BlockLineReader {
+public:
+    explicit BlockLineReader(size_t block_size)
+        : file_(nullptr), buffer_(block_size), begin_(0), end_(0), eof_(false) {}
+
+    ~BlockLineReader() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+        file_ = std::fopen(path.c_str(), "rb");
+        begin_ = end_ = 0;
+        eof_ = false;
+        return file_ != nullptr;
+    }
+
+    void close() {
+        if (file_) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    /**
+     * Next line without its newline (and without a trailing '\r')
+     * The pointer is valid until the next call.
+     */
+    bool next(const char*& line, size_t& len) {
+        while (true) {
+            const char* start = buffer_.data() + begin_;
+            const char* newline = static_cast<const char*>(std::memchr(start, '\n', end_ - begin_));
+            if (newline) {
+                line = start;
+                len = newline - start;
+                begin_ += len + 1;
+                if (len > 0 && line[len - 1] == '\r') {
+                    len--;
+                }
+                return true;
+            }
+
+            if (eof_) {
+                if (begin_ == end_) {
+                    return false;
+                }
+                // Last line without a newline
+                line = start;
+                len = end_ - begin_;
+                begin_ = end_;
+                return true;
+            }
+
+            fill();
+        }
+    }
+
+private:
+    FILE* file_;
+    std::vector<char> buffer_;
+    size_t begin_;
+    size_t end_;
+    bool eof_;
+
+    void fill() {
+        // Move the partial line to the front; grow for lines longer than a block
+        if (begin_ > 0) {
+            std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (end_ == buffer_.size()) {
+            buffer_.resize(buffer_.size() * 2);
+        }
+        size_t got = std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+        end_ += got;
+        if (got == 0) {
+            eof_ = true;
+        }
+    }
+};
+
+/**
+ * Output writers per shard with a bound on open files
+ */
+class ShardRouter {
+public:
+    ShardRouter(const std::string& base, const std::string& extension, const std::string& header,
+                bool by_symbol, SegmentMode segment_mode, uint64_t max_file_bytes,
+                size_t buffer_bytes, size_t max_open)
+        : base_(base), extension_(extension), header_(header), by_symbol_(by_symbol),
+          segment_mode_(segment_mode), max_file_bytes_(max_file_bytes),
+          buffer_bytes_(buffer_bytes), max_open_(max_open), open_count_(0), clock_(0) {}
+
+    bool write(const std::string& symbol, const char* line, size_t len, const std::string& timestamp) {
+        Shard& shard = get_shard(by_symbol_ ? symbol : std::string());
+        shard.last_used = ++clock_;
+
+        bool was_open = shard.writer->is_open();
+        if (!was_open && open_count_ >= max_open_) {
+            suspend_least_recent();
+        }
+        bool ok = shard.writer->write_line(line, len, timestamp);
+        if (!was_open && shard.writer->is_open()) {
+            open_count_++;
+        }
+        return ok;
+    }
+
+    void flush_all() {
+        for (auto& pair : shards_) {
+            pair.second.writer->flush();
+        }
+    }
+
+    size_t get_shard_count() const { return shards_.size(); }
+
+    size_t get_file_count() const {
+        size_t total = 0;
+        for (const auto& pair : shards_) {
+            total += pair.second.writer->get_file_count();
+        }
+        return total;
+    }
+
+    uint64_t get_bytes_written() const {
+        uint64_t total = 0;
+        for (const auto& pair : shards_) {
+            total += pair.second.writer->get_bytes_written();
+        }
+        return total;
+    }
+
+private:
+    struct Shard {
+        std::unique_ptr<LineSegmentWriter> writer;
+        uint64_t last_used;
+
+        Shard() : last_used(0) {}
+    };
+
+    std::string base_;
+    std::string extension_;
+    std::string header_;
+    bool by_symbol_;
+    SegmentMode segment_mode_;
+    uint64_t max_file_bytes_;
+    size_t buffer_bytes_;
+    size_t max_open_;
+    size_t open_count_;
+    uint64_t clock_;
+    std::map<std::string, Shard> shards_;
+
+    Shard& get_shard(const std::string& symbol) {
+        auto it = shards_.find(symbol);
+        if (it != shards_.end()) {
+            return it->second;
+        }
+
+        Shard& shard = shards_[symbol];
+        shard.writer.reset(new LineSegmentWriter(create_filename(symbol), extension_, header_));
+        shard.writer->set_flush_interval(std::chrono::seconds(0));  // Flush by size only
+        shard.writer->set_memory_threshold(buffer_bytes_);
+        shard.writer->set_max_file_bytes(max_file_bytes_);
+        shard.writer->set_segment_clock(SegmentClock::EVENT_TIME);
+        shard.writer->set_segment_mode(segment_mode_);
+        return shard;
+    }
+
+    void suspend_least_recent() {
+        Shard* oldest = nullptr;
+        for (auto& pair : shards_) {
+            Shard& shard = pair.second;
+            if (shard.writer->is_open() && (!oldest || shard.last_used < oldest->last_used)) {
+                oldest = &shard;
+            }
+        }
+        if (oldest) {
+            oldest->writer->suspend();
+            open_count_--;
+        }
+    }
+
+    /**
+     * E.g., "shards/book.jsonl" + "BTC/USD" -> "shards/book_BTC_USD.jsonl"
+     */
+    std::string create_filename(const std::string& symbol) const {
+        std::string base = base_;
+        if (base.size() > extension_.size() &&
+            base.compare(base.size() - extension_.size(), extension_.size(), extension_) == 0) {
+            base = base.substr(0, base.size() - extension_.size());
+        }
+        if (symbol.empty()) {
+            return base + extension_;
+        }
+
+        std::string sanitized = symbol;
+        for (char& c : sanitized) {
+            if (c == '/') {
+                c = '_';
+            }
+        }
+        return base + "_" + sanitized + extension_;
+    }
+};
+
+/**
+ * Find a CSV column by name (-1 if absent)
+ */
+int csv_column(const std::vector<std::string>& columns, const std::string& name) {
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (columns[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+int main(int argc, char* argv[]) {
+    // Setup argument parser
+    cli::ArgumentParser parser(argv[0], "Re-shard captures by symbol and event-time hour/day/size");
+
+    parser.add_argument({
+        "-i", "--input",
+        "Input capture files, directories or quoted globs (comma-separated)",
+        true,   // required
+        true,   // has value
+        "",
+        "FILES"
+    });
+
+    parser.add_argument({
+        "-o", "--output",
+        "Output base filename (symbol and segment key are inserted before the extension)",
+        true,   // required
+        true,   // has value
+        "",
+        "FILE"
+    });
+
+    parser.add_argument({
+        "", "--by-symbol",
+        "One output series per symbol",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--hourly",
+        "Segment by the hour of the record timestamps (output.20251112_10.jsonl)",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--daily",
+        "Segment by the day of the record timestamps (output.20251112.jsonl)",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--max-size",
+        "Roll to a part file (-001, -002, ...) when a file reaches SIZE (e.g. 512M, 2G)",
+        false,  // optional
+        true,   // has value
+        "",
+        "SIZE"
+    });
+
+    parser.add_argument({
+        "", "--max-open",
+        "Maximum output files open at once",
+        false,  // optional
+        true,   // has value
+        "256",
+        "N"
+    });
+
+    parser.add_argument({
+        "", "--buffer-size",
+        "Bytes buffered per output file before writing",
+        false,  // optional
+        true,   // has value
+        "1M",
+        "SIZE"
+    });
+
+    // Parse arguments
+    if (!parser.parse(argc, argv)) {
+        if (!parser.get_errors().empty()) {
+            for (const auto& error : parser.get_errors()) {
+                std::cerr << "Error: " << error << std::endl;
+            }
+            std::cerr << std::endl;
+            parser.print_help();
+            return 1;
+        }
+        return 0; // Help shown
+    }
+
+    // Get arguments
+    std::string input_list = parser.get("-i");
+    std::string output_file = parser.get("-o");
+    bool by_symbol = parser.has("--by-symbol");
+    bool hourly = parser.has("--hourly");
+    bool daily = parser.has("--daily");
+
+    if (hourly && daily) {
+        std::cerr << "Error: --hourly and --daily are mutually exclusive" << std::endl;
+        return 1;
+    }
+    SegmentMode segment_mode = hourly ? SegmentMode::HOURLY : (daily ? SegmentMode::DAILY : SegmentMode::NONE);
+
+    uint64_t max_file_bytes = 0;
+    if (parser.has("--max-size")) {
+        if (!parse_size(parser.get("--max-size"), max_file_bytes) || max_file_bytes == 0) {
+            std::cerr << "Error: Invalid --max-size: " << parser.get("--max-size") << std::endl;
+            return 1;
+        }
+        if (segment_mode == SegmentMode::NONE) {
+            // Part keys continue a segment key ("20251112_10-001")
+            std::cerr << "Error: --max-size requires --hourly or --daily" << std::endl;
+            return 1;
+        }
+    }
+
+    uint64_t buffer_bytes = 0;
+    if (!parse_size(parser.get("--buffer-size"), buffer_bytes) || buffer_bytes == 0) {
+        std::cerr << "Error: Invalid --buffer-size: " << parser.get("--buffer-size") << std::endl;
+        return 1;
+    }
+
+    int max_open = 0;
+    try {
+        max_open = std::stoi(parser.get("--max-open"));
+    } catch (const std::exception&) {
+        max_open = 0;
+    }
+    if (max_open < 1) {
+        std::cerr << "Error: --max-open must be at least 1" << std::endl;
+        return 1;
+    }
+
+    // Expand inputs (name order)
+    std::vector<std::string> input_files;
+    std::string input_error;
+    if (!SegmentBatch::expand_inputs(cli::ListParser::parse(input_list, ','), input_files, input_error)) {
+        std::cerr << "Error: " << input_error << std::endl;
+        return 1;
+    }
+
+    // Format from the first input; all inputs must match
+    auto is_csv = [](const std::string& path) {
+        return path.size() > 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+    };
+    bool csv = is_csv(input_files[0]);
+    for (const auto& file : input_files) {
+        if (is_csv(file) != csv) {
+            std::cerr << "Error: Cannot mix CSV and JSON Lines inputs: " << file << std::endl;
+            return 1;
+        }
+    }
+    std::string extension = csv ? ".csv" : ".jsonl";
+
+    // Display configuration
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Reshard Capture" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Input files: " << input_files.size() << (csv ? " (CSV)" : " (JSON Lines)") << std::endl;
+    std::cout << "Output base: " << output_file << std::endl;
+    std::cout << "By symbol: " << (by_symbol ? "yes" : "no") << std::endl;
+    std::cout << "Segmentation: " << (hourly ? "hourly" : (daily ? "daily" : "none"))
+              << (segment_mode != SegmentMode::NONE ? " (event time)" : "") << std::endl;
+    if (max_file_bytes > 0) {
+        std::cout << "Max file size: " << (max_file_bytes / 1024.0 / 1024.0) << " MB" << std::endl;
+    }
+    std::cout << std::endl;
+
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::unique_ptr<ShardRouter> router;
+    std::string header;
+    int timestamp_column = -1;
+    int symbol_column = -1;
+
+    const char TIMESTAMP_PATTERN[] = "\"timestamp\":\"";
+    const char SYMBOL_PATTERN[] = "\"symbol\":\"";
+
+    BlockLineReader reader(4 * 1024 * 1024);
+    std::string symbol;
+    std::string timestamp;
+    uint64_t lines_read = 0;
+    uint64_t lines_written = 0;
+    uint64_t lines_skipped = 0;
+    uint64_t bytes_read = 0;
+
+    for (const auto& input_file : input_files) {
+        if (!reader.open(input_file)) {
+            std::cerr << "Warning: Cannot open input file: " << input_file << std::endl;
+            continue;
+        }
+        std::cout << "Reading " << input_file << std::endl;
+
+        const char* line;
+        size_t len;
+        bool first_line = true;
+        while (reader.next(line, len)) {
+            bytes_read += len + 1;
+
+            if (csv && first_line) {
+                first_line = false;
+                std::string file_header(line, len);
+                if (!router) {
+                    header = file_header;
+                    std::vector<std::string> columns = cli::ListParser::parse(header, ',');
+                    timestamp_column = csv_column(columns, "timestamp");
+                    symbol_column = csv_column(columns, "symbol");
+                    if (symbol_column < 0) {
+                        symbol_column = csv_column(columns, "pair");
+                    }
+                    if (timestamp_column < 0 || (by_symbol && symbol_column < 0)) {
+                        std::cerr << "Error: " << input_file << " has no timestamp"
+                                  << (by_symbol ? " or symbol" : "") << " column" << std::endl;
+                        return 1;
+                    }
+                } else if (file_header != header) {
+                    std::cerr << "Error: CSV header of " << input_file << " differs from the first input" << std::endl;
+                    return 1;
+                }
+                continue;
+            }
+
+            if (!router) {
+                router.reset(new ShardRouter(output_file, extension, header, by_symbol, segment_mode,
+                                             max_file_bytes, static_cast<size_t>(buffer_bytes),
+                                             static_cast<size_t>(max_open)));
+            }
+
+            lines_read++;
+            if (len == 0) {
+                continue;
+            }
+
+            bool has_timestamp;
+            bool has_symbol;
+            if (csv) {
+                has_timestamp = csv_field(line, len, timestamp_column, timestamp);
+                has_symbol = csv_field(line, len, symbol_column, symbol);
+            } else {
+                has_timestamp = json_field(line, len, TIMESTAMP_PATTERN, sizeof(TIMESTAMP_PATTERN) - 1, timestamp);
+                has_symbol = json_field(line, len, SYMBOL_PATTERN, sizeof(SYMBOL_PATTERN) - 1, symbol);
+            }
+
+            // Lines without a symbol (status, heartbeat) have no shard
+            if (by_symbol && !has_symbol) {
+                lines_skipped++;
+                continue;
+            }
+            if (!has_timestamp) {
+                timestamp.clear();  // Stays in the current segment
+            }
+
+            // An output that cannot be opened fails every later line too
+            if (!router->write(symbol, line, len, timestamp)) {
+                std::cerr << "Error: Cannot write output for " << (by_symbol ? symbol : output_file)
+                          << " (does the output directory exist?)" << std::endl;
+                return 1;
+            }
+            lines_written++;
+        }
+        reader.close();
+    }
+
+    if (router) {
+        router->flush_all();
+    }
+
+    auto end_time = std::chrono::steady_clock::now();
+    double elapsed = std::chrono::duration<double>(end_time - start_time).count();
+
+    // Summary
+    std::cout << "\n==================================================" << std::endl;
+    std::cout << "Summary" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Lines read: " << lines_read << std::endl;
+    std::cout << "Lines written: " << lines_written << std::endl;
+    if (lines_skipped > 0) {
+        std::cout << "Lines skipped: " << lines_skipped << " (no symbol)" << std::endl;
+    }
+    if (router) {
+        std::cout << "Shards: " << router->get_shard_count() << std::endl;
+        std::cout << "Files created: " << router->get_file_count() << std::endl;
+    }
+    std::cout << "Processing time: " << std::fixed << std::setprecision(2) << elapsed << " seconds";
+    if (elapsed > 0) {
+        std::cout << " (" << std::setprecision(1) << (bytes_read / 1024.0 / 1024.0 / elapsed) << " MB/s)";
+    }
+    std::cout << std::endl;
+
+    return 0;
+}
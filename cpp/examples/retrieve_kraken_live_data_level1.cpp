@@ -12,6 +12,9 @@
  *   ./retrieve_kraken_live_data_level1 -p /export1/rocky/dev/kraken/kraken_usd_volume.csv:pair
  *   ./retrieve_kraken_live_data_level1 -p pairs.csv:symbol
  *
+ * Send SIGHUP to re-read the pairs specification; added and removed pairs
+ * are (un)subscribed in batches without reconnecting.
+ *
  * Output:
  *   Saves ticker data to kraken_ticker_live_level1.csv
  */
@@ -25,8 +28,11 @@
 #include <string>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
 #include "kraken_websocket_client_simdjson_v2.hpp"
 #include "cli_utils.hpp"
+#include "stage_trace.hpp"
+#include "symbol_universe.hpp"
 
 using kraken::KrakenWebSocketClientSimdjsonV2;
 using kraken::TickerRecord;
@@ -37,6 +43,7 @@ std::atomic<bool> g_running{true};
 std::mutex g_cv_mutex;
 std::condition_variable g_cv;
 bool g_new_data_available = false;
+std::atomic<bool> g_reload_requested{false};  // Set by SIGHUP
 
 void signal_handler(int) {
     std::cout << "\n\nShutting down..." << std::endl;
@@ -44,6 +51,10 @@ void signal_handler(int) {
     g_cv.notify_all();
 }
 
+void reload_handler(int) {
+    g_reload_requested = true;
+}
+
 void print_usage_examples() {
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
@@ -118,6 +129,15 @@ int main(int argc, char* argv[]) {
         ""
     });
 
+    parser.add_argument({
+        "", "--trace-file",
+        "Write stage trace (Chrome JSON) on SIGUSR1 and at exit (needs KRAKEN_STAGE_TRACING build)",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
     // Parse arguments
     if (!parser.parse(argc, argv)) {
         if (!parser.get_errors().empty()) {
@@ -255,12 +275,31 @@ int main(int argc, char* argv[]) {
                   << std::endl;
     });
 
+    // Symbol universe: SIGHUP re-reads the pairs specification and the
+    // difference is applied as batched (un)subscribe messages
+    auto universe = std::make_shared<kraken::SymbolUniverse>();
+    universe->load(pairs_spec);  // Already validated above
+    ws_client.set_symbol_universe(universe);
+    std::signal(SIGHUP, reload_handler);
+
     // Start WebSocket client
     if (!ws_client.start(symbols)) {
         std::cerr << "Failed to start WebSocket client" << std::endl;
         return 1;
     }
 
+    // Stage tracing: dump on SIGUSR1 and at exit
+    std::string trace_file = parser.get("--trace-file");
+    if (!trace_file.empty()) {
+        if (kraken::trace::tracing_enabled()) {
+            kraken::trace::install_signal_dump(SIGUSR1, trace_file);
+            std::cout << "Stage trace: " << trace_file << " (send SIGUSR1 to dump)" << std::endl;
+        } else {
+            std::cerr << "[Warning] --trace-file ignored: rebuild with -DKRAKEN_STAGE_TRACING=ON" << std::endl;
+            trace_file.clear();
+        }
+    }
+
     std::cout << "Streaming live data... Press Ctrl+C to stop and save." << std::endl;
     std::cout << std::endl;
 
@@ -288,6 +327,15 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        // Apply pairs reload requested via SIGHUP
+        if (g_reload_requested.exchange(false) && universe->reload()) {
+            auto universe_stats = universe->get_stats();
+            std::cout << "[UNIVERSE] Reloaded " << pairs_spec << ": "
+                      << universe_stats.desired << " desired, "
+                      << universe_stats.subscribed << " subscribed, "
+                      << universe_stats.failed << " failed" << std::endl;
+        }
+
         // Print periodic status
         auto now = std::chrono::steady_clock::now();
         auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
@@ -317,6 +365,11 @@ int main(int argc, char* argv[]) {
     ws_client.flush();
     ws_client.stop();
 
+    if (!trace_file.empty()) {
+        kraken::trace::stop_signal_dump();
+        kraken::trace::dump_chrome_trace(trace_file);
+    }
+
     auto end_time = std::chrono::steady_clock::now();
     auto total_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
         end_time - start_time
@@ -328,6 +381,10 @@ int main(int argc, char* argv[]) {
     std::cout << "Pairs monitored: " << symbols.size() << std::endl;
     std::cout << "Total updates: " << update_count << std::endl;
     std::cout << "Total flushes: " << ws_client.get_flush_count() << std::endl;
+    auto tls_stats = ws_client.get_tls_stats();
+    std::cout << "TLS handshakes: " << tls_stats.handshakes << " (" << tls_stats.resumed
+              << " resumed), avg " << std::fixed << std::setprecision(1) << tls_stats.avg_ms()
+              << " ms, max " << tls_stats.max_ms << " ms" << std::endl;
     std::cout << "Runtime: " << total_elapsed << " seconds" << std::endl;
 
     if (hourly_mode || daily_mode) {
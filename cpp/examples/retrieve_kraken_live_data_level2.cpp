@@ -12,6 +12,11 @@
  *   ./retrieve_kraken_live_data_level2 -p "BTC/USD,ETH/USD" -d 25 --show-top
  *   ./retrieve_kraken_live_data_level2 -p pairs.txt:10 --separate-files
  *   ./retrieve_kraken_live_data_level2 -p "BTC/USD" --show-book -v
+ *   ./retrieve_kraken_live_data_level2 -p "BTC/USD" -d 1000 --top-n 10
+ *   ./retrieve_kraken_live_data_level2 -p "BTC/USD" --hourly --event-time
+ *
+ * Send SIGHUP to re-read the pairs specification; added and removed pairs
+ * are (un)subscribed in batches without reconnecting.
  *
  * Output:
  *   Saves order book data to .jsonl format (JSON Lines)
@@ -26,10 +31,18 @@
 #include <string>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
 #include "kraken_book_client.hpp"
 #include "cli_utils.hpp"
+#include "stage_trace.hpp"
+#include "symbol_universe.hpp"
 #include "orderbook_common.hpp"
 #include "jsonl_writer.hpp"
+#include "orderbook_topn.hpp"
+#include "websocket_deflate.hpp"
+#include "socket_tuning.hpp"
+#include "feed_watchdog.hpp"
+#include "thread_placement.hpp"
 
 using kraken::KrakenBookClient;
 using kraken::OrderBookRecord;
@@ -37,6 +50,12 @@ using kraken::OrderBookStats;
 using kraken::OrderBookDisplay;
 using kraken::JsonLinesWriter;
 using kraken::MultiFileJsonLinesWriter;
+using kraken::TopNFilter;
+using kraken::TopNMode;
+using kraken::SocketOptions;
+using kraken::SocketTuning;
+using kraken::WatchdogConfig;
+using kraken::ThreadPlacement;
 
 // Global state
 KrakenBookClient* g_book_client = nullptr;
@@ -44,6 +63,7 @@ std::atomic<bool> g_running{true};
 std::mutex g_cv_mutex;
 std::condition_variable g_cv;
 bool g_new_data_available = false;
+std::atomic<bool> g_reload_requested{false};  // Set by SIGHUP
 
 // Display options
 bool g_show_updates = false;
@@ -54,12 +74,20 @@ bool g_show_book = false;
 JsonLinesWriter* g_single_writer = nullptr;
 MultiFileJsonLinesWriter* g_multi_writer = nullptr;
 
+// Top-N recorder (optional, used from the WebSocket thread only)
+TopNFilter* g_topn_filter = nullptr;
+OrderBookRecord g_topn_record;
+
 void signal_handler(int) {
     std::cout << "\n\nShutting down..." << std::endl;
     g_running = false;
     g_cv.notify_all();
 }
 
+void reload_handler(int) {
+    g_reload_requested = true;
+}
+
 void print_usage_examples() {
     std::cout << std::endl;
     std::cout << "Examples:" << std::endl;
@@ -75,6 +103,9 @@ void print_usage_examples() {
     std::cout << "  4. Full monitoring (single pair only):" << std::endl;
     std::cout << "     -p \"BTC/USD\" --show-book -v --show-top" << std::endl;
     std::cout << std::endl;
+    std::cout << "  5. Deep book, record only top-10 changes:" << std::endl;
+    std::cout << "     -p \"BTC/USD\" -d 1000 --top-n 10 --top-n-mode delta" << std::endl;
+    std::cout << std::endl;
     std::cout << "Display Options:" << std::endl;
     std::cout << "  (default)  - Minimal counters (fastest)" << std::endl;
     std::cout << "  -v         - Show update details" << std::endl;
@@ -132,6 +163,24 @@ int main(int argc, char* argv[]) {
         ""
     });
 
+    parser.add_argument({
+        "", "--top-n",
+        "Record only changes within the top N levels (0 = raw feed)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "N"
+    });
+
+    parser.add_argument({
+        "", "--top-n-mode",
+        "Top-N output: delta (changed levels) or full (top-N row per change)",
+        false,  // optional
+        true,   // has value
+        "delta",
+        "MODE"
+    });
+
     parser.add_argument({
         "-v", "--show-updates",
         "Show update details",
@@ -195,6 +244,114 @@ int main(int argc, char* argv[]) {
         ""
     });
 
+    parser.add_argument({
+        "", "--event-time",
+        "Segment by the records' timestamps instead of the write time",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--deflate",
+        "Offer permessage-deflate (less bandwidth, inflate CPU on the I/O thread)",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--tcp-nodelay",
+        "Disable Nagle on the WebSocket socket (TCP_NODELAY)",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--rcvbuf",
+        "Fixed socket receive buffer in bytes (SO_RCVBUF, 0 = kernel autotuning)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "BYTES"
+    });
+
+    parser.add_argument({
+        "", "--busy-poll",
+        "Busy-poll the device queue on reads (SO_BUSY_POLL, 0 = off)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "US"
+    });
+
+    parser.add_argument({
+        "", "--stale-timeout",
+        "Reconnect when no frame (data, heartbeat, pong) arrives for SEC seconds (0 = off)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "SEC"
+    });
+
+    parser.add_argument({
+        "", "--symbol-stale-timeout",
+        "Resubscribe a symbol without data for SEC seconds (0 = off)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "SEC"
+    });
+
+    parser.add_argument({
+        "", "--ping-interval",
+        "Send WebSocket pings every SEC seconds to measure RTT; unanswered pings reconnect (0 = off)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "SEC"
+    });
+
+    parser.add_argument({
+        "", "--io-thread",
+        "Pin / schedule the WebSocket I/O thread: CPUS[:POLICY[:PRIORITY]], e.g. 3 or 3:fifo:50",
+        false,  // optional
+        true,   // has value
+        "",
+        "SPEC"
+    });
+
+    parser.add_argument({
+        "", "--io-spin",
+        "I/O thread spins on poll() instead of blocking (use with a dedicated --io-thread core)",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--main-thread",
+        "Pin / schedule the main (display / consumer) thread, same format as --io-thread",
+        false,  // optional
+        true,   // has value
+        "",
+        "SPEC"
+    });
+
+    parser.add_argument({
+        "", "--trace-file",
+        "Write stage trace (Chrome JSON) on SIGUSR1 and at exit (needs KRAKEN_STAGE_TRACING build)",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
     // Parse arguments
     if (!parser.parse(argc, argv)) {
         if (!parser.get_errors().empty()) {
@@ -224,12 +381,66 @@ int main(int argc, char* argv[]) {
     size_t memory_threshold = std::stoull(parser.get("-m"));
     bool hourly_mode = parser.has("--hourly");
     bool daily_mode = parser.has("--daily");
+    bool event_time = parser.has("--event-time");
 
     // Validate segmentation flags
     if (hourly_mode && daily_mode) {
         std::cerr << "Error: --hourly and --daily cannot be used together" << std::endl;
         return 1;
     }
+    if (event_time && !hourly_mode && !daily_mode) {
+        std::cerr << "Error: --event-time requires --hourly or --daily" << std::endl;
+        return 1;
+    }
+    kraken::SegmentClock segment_clock = event_time ? kraken::SegmentClock::EVENT_TIME
+                                                    : kraken::SegmentClock::WALL_CLOCK;
+
+    // Top-N recorder arguments
+    int top_n = std::stoi(parser.get("--top-n"));
+    TopNMode top_n_mode = TopNMode::DELTA;
+    if (top_n < 0) {
+        std::cerr << "Error: --top-n must be >= 0" << std::endl;
+        return 1;
+    }
+    if (!TopNFilter::parse_mode(parser.get("--top-n-mode"), top_n_mode)) {
+        std::cerr << "Error: --top-n-mode must be 'delta' or 'full'" << std::endl;
+        return 1;
+    }
+
+    // Socket tuning arguments
+    SocketOptions socket_options;
+    socket_options.tcp_nodelay = parser.has("--tcp-nodelay");
+    socket_options.rcvbuf_bytes = std::stoi(parser.get("--rcvbuf"));
+    socket_options.busy_poll_us = std::stoi(parser.get("--busy-poll"));
+    if (socket_options.rcvbuf_bytes < 0 || socket_options.busy_poll_us < 0) {
+        std::cerr << "Error: --rcvbuf and --busy-poll must be >= 0" << std::endl;
+        return 1;
+    }
+
+    // Feed watchdog arguments (pong timeout = ping interval)
+    WatchdogConfig watchdog_config;
+    watchdog_config.connection_stale_ms = std::stoi(parser.get("--stale-timeout")) * 1000;
+    watchdog_config.symbol_stale_ms = std::stoi(parser.get("--symbol-stale-timeout")) * 1000;
+    watchdog_config.ping_interval_ms = std::stoi(parser.get("--ping-interval")) * 1000;
+    watchdog_config.pong_timeout_ms = watchdog_config.ping_interval_ms;
+    if (watchdog_config.connection_stale_ms < 0 || watchdog_config.symbol_stale_ms < 0 ||
+        watchdog_config.ping_interval_ms < 0) {
+        std::cerr << "Error: --stale-timeout, --symbol-stale-timeout and --ping-interval must be >= 0" << std::endl;
+        return 1;
+    }
+
+    // Thread placement arguments
+    ThreadPlacement io_placement;
+    ThreadPlacement main_placement;
+    std::string placement_error;
+    if ((parser.has("--io-thread") &&
+         !ThreadPlacement::parse(parser.get("--io-thread"), io_placement, placement_error)) ||
+        (parser.has("--main-thread") &&
+         !ThreadPlacement::parse(parser.get("--main-thread"), main_placement, placement_error))) {
+        std::cerr << "Error: " << placement_error << std::endl;
+        return 1;
+    }
+    bool io_spin = parser.has("--io-spin");
 
     // Parse depth
     int depth = std::stoi(depth_str);
@@ -296,7 +507,22 @@ int main(int argc, char* argv[]) {
     std::cout << std::endl;
     std::cout << "Configuration:" << std::endl;
     std::cout << "  Depth: " << depth << " levels" << std::endl;
+    std::cout << "  permessage-deflate: " << (parser.has("--deflate") ? "offered" : "off") << std::endl;
+    std::cout << "  Socket options: " << SocketTuning::describe(socket_options) << std::endl;
+    std::cout << "  I/O thread: " << io_placement.describe() << (io_spin ? " (spin)" : "") << std::endl;
+    if (!main_placement.empty()) {
+        std::cout << "  Main thread: " << main_placement.describe() << std::endl;
+    }
+    if (watchdog_config.enabled()) {
+        std::cout << "  Watchdog: stale " << watchdog_config.connection_stale_ms / 1000
+                  << "s, symbol stale " << watchdog_config.symbol_stale_ms / 1000
+                  << "s, ping " << watchdog_config.ping_interval_ms / 1000 << "s" << std::endl;
+    }
     std::cout << "  Checksum validation: " << (skip_validation ? "disabled" : "enabled") << std::endl;
+    if (top_n > 0) {
+        std::cout << "  Recording: top " << top_n << " levels ("
+                  << TopNFilter::mode_name(top_n_mode) << ")" << std::endl;
+    }
 
     // Flush configuration
     std::cout << "  Flush interval: ";
@@ -324,6 +550,9 @@ int main(int argc, char* argv[]) {
         } else {
             std::cout << "daily (output.YYYYMMDD.jsonl)";
         }
+        if (event_time) {
+            std::cout << " by record timestamp";
+        }
         std::cout << std::endl;
     }
 
@@ -350,6 +579,7 @@ int main(int argc, char* argv[]) {
         // Configure flush and segmentation
         g_multi_writer->set_flush_interval(std::chrono::seconds(flush_interval));
         g_multi_writer->set_memory_threshold(memory_threshold);
+        g_multi_writer->set_segment_clock(segment_clock);
 
         if (hourly_mode) {
             g_multi_writer->set_segment_mode(kraken::SegmentMode::HOURLY);
@@ -362,6 +592,7 @@ int main(int argc, char* argv[]) {
         // Configure flush and segmentation
         g_single_writer->set_flush_interval(std::chrono::seconds(flush_interval));
         g_single_writer->set_memory_threshold(memory_threshold);
+        g_single_writer->set_segment_clock(segment_clock);
 
         if (hourly_mode) {
             g_single_writer->set_segment_mode(kraken::SegmentMode::HOURLY);
@@ -371,7 +602,7 @@ int main(int argc, char* argv[]) {
 
         // Check if file is open after configuration
         // (file opens in set_segment_mode or on first write)
-        if (hourly_mode || daily_mode) {
+        if ((hourly_mode || daily_mode) && !event_time) {
             // File should be open after set_segment_mode
             if (!g_single_writer->is_open()) {
                 std::cerr << "Error: Failed to open segment file" << std::endl;
@@ -382,17 +613,31 @@ int main(int argc, char* argv[]) {
         // For non-segmented mode, file will open on first write
     }
 
+    if (top_n > 0) {
+        g_topn_filter = new TopNFilter(top_n, top_n_mode);
+    }
+
+    kraken::WebSocketDeflate::set_enabled(parser.has("--deflate"));
+
     // Create WebSocket client
     KrakenBookClient book_client(depth, !skip_validation);
     g_book_client = &book_client;
+    book_client.set_socket_options(socket_options);
+    book_client.set_watchdog(watchdog_config);
+    book_client.set_io_thread(io_placement, io_spin);
 
     // Setup callbacks
     book_client.set_update_callback([&](const OrderBookRecord& record) {
-        // Write to file
-        if (g_multi_writer) {
-            g_multi_writer->write_record(record);
-        } else if (g_single_writer) {
-            g_single_writer->write_record(record);
+        // Write to file (reduced to top-N changes when enabled)
+        const OrderBookRecord* output = &record;
+        if (g_topn_filter) {
+            output = g_topn_filter->process(record, g_topn_record) ? &g_topn_record : nullptr;
+        }
+
+        if (output && g_multi_writer) {
+            g_multi_writer->write_record(*output);
+        } else if (output && g_single_writer) {
+            g_single_writer->write_record(*output);
         }
 
         // Signal new data available
@@ -407,8 +652,7 @@ int main(int argc, char* argv[]) {
             // Full order book display (single pair only)
             OrderBookDisplay::show_full_book(record, depth);
         } else if (g_show_top) {
-            // Top-of-book display
-            OrderBookDisplay::show_top_of_book(record);
+            // Top-of-book display: handled by the BBO callback below
         } else if (g_show_updates) {
             // Update details
             OrderBookDisplay::show_update_details(record, "[UPDATE]");
@@ -416,20 +660,52 @@ int main(int argc, char* argv[]) {
         // Minimal mode: handled in periodic status below
     });
 
+    // Top-of-book display only wakes up when the best bid/ask changes
+    if (g_show_top && !g_show_book) {
+        book_client.set_bbo_change_callback([](const std::string& symbol, const kraken::BestBidOffer& bbo) {
+            OrderBookDisplay::show_bbo(symbol, bbo);
+        });
+    }
+
     book_client.set_connection_callback([](bool connected) {
         std::cout << "[STATUS] WebSocket "
                   << (connected ? "connected" : "disconnected")
                   << std::endl;
     });
 
+    // Symbol universe: SIGHUP re-reads the pairs specification and the
+    // difference is applied as batched (un)subscribe messages
+    auto universe = std::make_shared<kraken::SymbolUniverse>();
+    universe->load(pairs_spec);  // Already validated above
+    book_client.set_symbol_universe(universe);
+    std::signal(SIGHUP, reload_handler);
+
     // Start WebSocket client
     if (!book_client.start(symbols)) {
         std::cerr << "Failed to start WebSocket client" << std::endl;
         if (g_single_writer) delete g_single_writer;
         if (g_multi_writer) delete g_multi_writer;
+        if (g_topn_filter) delete g_topn_filter;
         return 1;
     }
 
+    // After start(): new threads inherit the creating thread's placement
+    if (!main_placement.empty()) {
+        main_placement.apply("main");
+    }
+
+    // Stage tracing: dump on SIGUSR1 and at exit
+    std::string trace_file = parser.get("--trace-file");
+    if (!trace_file.empty()) {
+        if (kraken::trace::tracing_enabled()) {
+            kraken::trace::install_signal_dump(SIGUSR1, trace_file);
+            std::cout << "Stage trace: " << trace_file << " (send SIGUSR1 to dump)" << std::endl;
+        } else {
+            std::cerr << "[Warning] --trace-file ignored: rebuild with -DKRAKEN_STAGE_TRACING=ON" << std::endl;
+            trace_file.clear();
+        }
+    }
+
     std::cout << "Streaming live order book data... Press Ctrl+C to stop and save." << std::endl;
     std::cout << std::endl;
 
@@ -458,6 +734,15 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        // Apply pairs reload requested via SIGHUP
+        if (g_reload_requested.exchange(false) && universe->reload()) {
+            auto universe_stats = universe->get_stats();
+            std::cout << "[UNIVERSE] Reloaded " << pairs_spec << ": "
+                      << universe_stats.desired << " desired, "
+                      << universe_stats.subscribed << " subscribed, "
+                      << universe_stats.failed << " failed" << std::endl;
+        }
+
         // Print periodic status (minimal mode only)
         auto now = std::chrono::steady_clock::now();
         auto elapsed_since_status = std::chrono::duration_cast<std::chrono::seconds>(
@@ -482,6 +767,11 @@ int main(int argc, char* argv[]) {
 
     book_client.stop();
 
+    if (!trace_file.empty()) {
+        kraken::trace::stop_signal_dump();
+        kraken::trace::dump_chrome_trace(trace_file);
+    }
+
     auto end_time = std::chrono::steady_clock::now();
     auto total_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
         end_time - start_time
@@ -506,6 +796,27 @@ int main(int argc, char* argv[]) {
     std::cout << "Total snapshots: " << total_snapshots << std::endl;
     std::cout << "Total updates: " << total_updates << std::endl;
     std::cout << "Total messages: " << (total_snapshots + total_updates) << std::endl;
+    auto tls_stats = book_client.get_tls_stats();
+    std::cout << "TLS handshakes: " << tls_stats.handshakes << " (" << tls_stats.resumed
+              << " resumed), avg " << std::fixed << std::setprecision(1) << tls_stats.avg_ms()
+              << " ms, max " << tls_stats.max_ms << " ms" << std::endl;
+    if (watchdog_config.enabled()) {
+        auto watchdog_stats = book_client.get_watchdog_stats();
+        std::cout << "Watchdog: " << watchdog_stats.stale_connections << " reconnects, "
+                  << watchdog_stats.stale_symbols << " symbols resubscribed";
+        if (watchdog_stats.pongs_received > 0) {
+            std::cout << ", ping RTT avg " << watchdog_stats.avg_rtt_ms() << " ms (min "
+                      << watchdog_stats.min_rtt_ms << ", max " << watchdog_stats.max_rtt_ms << ")";
+        }
+        std::cout << std::endl;
+    }
+    if (kraken::WebSocketDeflate::is_enabled()) {
+        auto deflate_stats = kraken::WebSocketDeflate::get_stats();
+        std::cout << "Deflate: " << deflate_stats.compressed_bytes / 1024 << " KB received -> "
+                  << deflate_stats.inflated_bytes / 1024 << " KB (" << deflate_stats.ratio()
+                  << "x), inflate " << deflate_stats.inflate_ns / 1000000 << " ms ("
+                  << deflate_stats.ns_per_inflated_byte() << " ns/byte)" << std::endl;
+    }
     std::cout << "Runtime: " << total_elapsed << " seconds" << std::endl;
 
     if (separate_files) {
@@ -525,11 +836,19 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (g_topn_filter) {
+        std::cout << "Top-N records: " << g_topn_filter->get_output_count()
+                  << " of " << g_topn_filter->get_input_count() << " input ("
+                  << g_topn_filter->get_output_levels() << " of "
+                  << g_topn_filter->get_input_levels() << " levels)" << std::endl;
+    }
+
     std::cout << "Shutdown complete." << std::endl;
 
     // Cleanup
     if (g_single_writer) delete g_single_writer;
     if (g_multi_writer) delete g_multi_writer;
+    if (g_topn_filter) delete g_topn_filter;
 
     return 0;
 }
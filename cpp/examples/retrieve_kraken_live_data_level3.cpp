@@ -9,12 +9,21 @@
  *   ./retrieve_kraken_live_data_level3 -p "BTC/USD"
  *   ./retrieve_kraken_live_data_level3 -p "BTC/USD,ETH/USD" -d 100 -v --show-top
  *   ./retrieve_kraken_live_data_level3 -p "BTC/USD" --token-file ~/.kraken/ws_token
+ *   ./retrieve_kraken_live_data_level3 -p "BTC/USD" --derive-l2 book.jsonl
+ *   ./retrieve_kraken_live_data_level3 -p "BTC/USD" --validate-checksum --checksum-precision "1,8"
+ *   ./retrieve_kraken_live_data_level3 -p pairs.txt -d 1000 --parse-threads 3 --parse-placement 4-6
+ *
+ * Send SIGHUP to re-read the pairs specification; added and removed pairs
+ * are (un)subscribed in batches without reconnecting.
  *
  * Output:
  *   Saves Level 3 order data to .jsonl format
+ *   With --derive-l2, also saves the aggregated L2 book (same format as
+ *   retrieve_kraken_live_data_level2) computed from the Level 3 stream
  */
 
 #include <iostream>
+#include <iomanip>
 #include <csignal>
 #include <chrono>
 #include <atomic>
@@ -22,10 +31,19 @@
 #include <string>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
 #include "kraken_level3_client.hpp"
 #include "cli_utils.hpp"
+#include "stage_trace.hpp"
+#include "symbol_universe.hpp"
 #include "level3_common.hpp"
 #include "level3_jsonl_writer.hpp"
+#include "orderbook_common.hpp"
+#include "jsonl_writer.hpp"
+#include "websocket_deflate.hpp"
+#include "socket_tuning.hpp"
+#include "feed_watchdog.hpp"
+#include "thread_placement.hpp"
 
 using kraken::KrakenLevel3Client;
 using kraken::Level3Record;
@@ -33,6 +51,15 @@ using kraken::Level3Stats;
 using kraken::Level3Display;
 using kraken::Level3JsonLinesWriter;
 using kraken::MultiFileLevel3JsonLinesWriter;
+using kraken::OrderBookRecord;
+using kraken::JsonLinesWriter;
+using kraken::MultiFileJsonLinesWriter;
+using kraken::SocketOptions;
+using kraken::SocketTuning;
+using kraken::WatchdogConfig;
+using kraken::ThreadPlacement;
+using kraken::ChecksumPrecisionMap;
+using kraken::parse_checksum_precision;
 
 // Global state
 KrakenLevel3Client* g_level3_client = nullptr;
@@ -40,6 +67,7 @@ std::atomic<bool> g_running{true};
 std::mutex g_cv_mutex;
 std::condition_variable g_cv;
 bool g_new_data_available = false;
+std::atomic<bool> g_reload_requested{false};  // Set by SIGHUP
 
 // Display options
 bool g_show_events = false;
@@ -50,12 +78,20 @@ bool g_show_orders = false;
 Level3JsonLinesWriter* g_single_writer = nullptr;
 MultiFileLevel3JsonLinesWriter* g_multi_writer = nullptr;
 
+// Derived L2 writers (--derive-l2)
+JsonLinesWriter* g_l2_single_writer = nullptr;
+MultiFileJsonLinesWriter* g_l2_multi_writer = nullptr;
+
 void signal_handler(int) {
     std::cout << "\n\nShutting down..." << std::endl;
     g_running = false;
     g_cv.notify_all();
 }
 
+void reload_handler(int) {
+    g_reload_requested = true;
+}
+
 void print_usage_examples() {
     std::cout << std::endl;
     std::cout << "Authentication Setup:" << std::endl;
@@ -86,6 +122,15 @@ void print_usage_examples() {
     std::cout << "  5. High depth with token file:" << std::endl;
     std::cout << "     -p \"BTC/USD\" -d 100 --token-file ~/.kraken/ws_token" << std::endl;
     std::cout << std::endl;
+    std::cout << "  6. Also record the aggregated L2 book (no separate book subscription):" << std::endl;
+    std::cout << "     -p \"BTC/USD\" -d 1000 --derive-l2 book.jsonl" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  7. Verify every message's checksum, resubscribe on divergence:" << std::endl;
+    std::cout << "     -p \"BTC/USD,ETH/USD\" --validate-checksum --checksum-precision \"BTC/USD=1,8;ETH/USD=2,8\"" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  8. Many deep books: decode on 3 parser threads, keep the socket drained:" << std::endl;
+    std::cout << "     -p pairs.txt -d 1000 --parse-threads 3 --parse-placement 4-6" << std::endl;
+    std::cout << std::endl;
 }
 
 int main(int argc, char* argv[]) {
@@ -173,6 +218,152 @@ int main(int argc, char* argv[]) {
         ""
     });
 
+    parser.add_argument({
+        "", "--derive-l2",
+        "Also write the aggregated L2 book derived from Level 3 to FILE",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
+    parser.add_argument({
+        "", "--validate-checksum",
+        "Verify each message's checksum and resubscribe symbols that diverge",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--checksum-precision",
+        "Price and qty decimals for the checksum, from the instrument channel; "
+        "PRICE,QTY for all pairs or SYMBOL=PRICE,QTY;... per pair "
+        "(pairs without one are not verified)",
+        false,  // optional
+        true,   // has value
+        "",
+        "SPEC"
+    });
+
+    parser.add_argument({
+        "", "--deflate",
+        "Offer permessage-deflate (less bandwidth, inflate CPU on the I/O thread)",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--tcp-nodelay",
+        "Disable Nagle on the WebSocket socket (TCP_NODELAY)",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--rcvbuf",
+        "Fixed socket receive buffer in bytes (SO_RCVBUF, 0 = kernel autotuning)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "BYTES"
+    });
+
+    parser.add_argument({
+        "", "--busy-poll",
+        "Busy-poll the device queue on reads (SO_BUSY_POLL, 0 = off)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "US"
+    });
+
+    parser.add_argument({
+        "", "--stale-timeout",
+        "Reconnect when no frame (data, heartbeat, pong) arrives for SEC seconds (0 = off)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "SEC"
+    });
+
+    parser.add_argument({
+        "", "--symbol-stale-timeout",
+        "Resubscribe a symbol without data for SEC seconds (0 = off)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "SEC"
+    });
+
+    parser.add_argument({
+        "", "--ping-interval",
+        "Send WebSocket pings every SEC seconds to measure RTT; unanswered pings reconnect (0 = off)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "SEC"
+    });
+
+    parser.add_argument({
+        "", "--io-thread",
+        "Pin / schedule the WebSocket I/O thread: CPUS[:POLICY[:PRIORITY]], e.g. 3 or 3:fifo:50",
+        false,  // optional
+        true,   // has value
+        "",
+        "SPEC"
+    });
+
+    parser.add_argument({
+        "", "--io-spin",
+        "I/O thread spins on poll() instead of blocking (use with a dedicated --io-thread core)",
+        false,  // optional
+        false,  // flag
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--main-thread",
+        "Pin / schedule the main (display / consumer) thread, same format as --io-thread",
+        false,  // optional
+        true,   // has value
+        "",
+        "SPEC"
+    });
+
+    parser.add_argument({
+        "", "--parse-threads",
+        "Decode level3 frames on N parser threads; the I/O thread only queues them (0 = on the I/O thread)",
+        false,  // optional
+        true,   // has value
+        "0",
+        "N"
+    });
+
+    parser.add_argument({
+        "", "--parse-placement",
+        "Pin / schedule the parser threads, same format as --io-thread",
+        false,  // optional
+        true,   // has value
+        "",
+        "SPEC"
+    });
+
+    parser.add_argument({
+        "", "--trace-file",
+        "Write stage trace (Chrome JSON) on SIGUSR1 and at exit (needs KRAKEN_STAGE_TRACING build)",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
     // Parse arguments
     if (!parser.parse(argc, argv)) {
         if (!parser.get_errors().empty()) {
@@ -197,6 +388,63 @@ int main(int argc, char* argv[]) {
     g_show_events = parser.has("-v") || parser.has("--show-events");
     g_show_top = parser.has("--show-top");
     g_show_orders = parser.has("--show-orders");
+    std::string l2_output_file = parser.get("--derive-l2");
+    bool validate_checksum = parser.has("--validate-checksum");
+    std::string checksum_precision = parser.get("--checksum-precision");
+
+    ChecksumPrecisionMap precision_by_symbol;
+    std::string precision_error;
+    if (!parse_checksum_precision(checksum_precision, precision_by_symbol, precision_error)) {
+        std::cerr << "Error: Invalid --checksum-precision: " << precision_error << std::endl;
+        return 1;
+    }
+    if (validate_checksum && precision_by_symbol.empty()) {
+        std::cerr << "Warning: --validate-checksum without --checksum-precision verifies nothing" << std::endl;
+    }
+
+    // Socket tuning arguments
+    SocketOptions socket_options;
+    socket_options.tcp_nodelay = parser.has("--tcp-nodelay");
+    socket_options.rcvbuf_bytes = std::stoi(parser.get("--rcvbuf"));
+    socket_options.busy_poll_us = std::stoi(parser.get("--busy-poll"));
+    if (socket_options.rcvbuf_bytes < 0 || socket_options.busy_poll_us < 0) {
+        std::cerr << "Error: --rcvbuf and --busy-poll must be >= 0" << std::endl;
+        return 1;
+    }
+
+    // Feed watchdog arguments (pong timeout = ping interval)
+    WatchdogConfig watchdog_config;
+    watchdog_config.connection_stale_ms = std::stoi(parser.get("--stale-timeout")) * 1000;
+    watchdog_config.symbol_stale_ms = std::stoi(parser.get("--symbol-stale-timeout")) * 1000;
+    watchdog_config.ping_interval_ms = std::stoi(parser.get("--ping-interval")) * 1000;
+    watchdog_config.pong_timeout_ms = watchdog_config.ping_interval_ms;
+    if (watchdog_config.connection_stale_ms < 0 || watchdog_config.symbol_stale_ms < 0 ||
+        watchdog_config.ping_interval_ms < 0) {
+        std::cerr << "Error: --stale-timeout, --symbol-stale-timeout and --ping-interval must be >= 0" << std::endl;
+        return 1;
+    }
+
+    // Thread placement arguments
+    ThreadPlacement io_placement;
+    ThreadPlacement main_placement;
+    ThreadPlacement parse_placement;
+    std::string placement_error;
+    if ((parser.has("--io-thread") &&
+         !ThreadPlacement::parse(parser.get("--io-thread"), io_placement, placement_error)) ||
+        (parser.has("--main-thread") &&
+         !ThreadPlacement::parse(parser.get("--main-thread"), main_placement, placement_error)) ||
+        (parser.has("--parse-placement") &&
+         !ThreadPlacement::parse(parser.get("--parse-placement"), parse_placement, placement_error))) {
+        std::cerr << "Error: " << placement_error << std::endl;
+        return 1;
+    }
+    bool io_spin = parser.has("--io-spin");
+
+    int parse_threads = std::stoi(parser.get("--parse-threads"));
+    if (parse_threads < 0) {
+        std::cerr << "Error: --parse-threads must be >= 0" << std::endl;
+        return 1;
+    }
 
     // Parse depth
     int depth = std::stoi(depth_str);
@@ -237,6 +485,9 @@ int main(int argc, char* argv[]) {
     } else {
         std::cout << "Output file: " << output_file << std::endl;
     }
+    if (!l2_output_file.empty()) {
+        std::cout << "Derived L2 output: " << l2_output_file << std::endl;
+    }
     std::cout << std::endl;
 
     // Display configuration
@@ -253,6 +504,29 @@ int main(int argc, char* argv[]) {
     std::cout << std::endl;
     std::cout << "Configuration:" << std::endl;
     std::cout << "  Depth: " << depth << " levels" << std::endl;
+    std::cout << "  permessage-deflate: " << (parser.has("--deflate") ? "offered" : "off") << std::endl;
+    std::cout << "  Socket options: " << SocketTuning::describe(socket_options) << std::endl;
+    std::cout << "  I/O thread: " << io_placement.describe() << (io_spin ? " (spin)" : "") << std::endl;
+    if (!main_placement.empty()) {
+        std::cout << "  Main thread: " << main_placement.describe() << std::endl;
+    }
+    if (parse_threads > 0) {
+        std::cout << "  Parse threads: " << parse_threads << " (" << parse_placement.describe() << ")" << std::endl;
+    }
+    if (watchdog_config.enabled()) {
+        std::cout << "  Watchdog: stale " << watchdog_config.connection_stale_ms / 1000
+                  << "s, symbol stale " << watchdog_config.symbol_stale_ms / 1000
+                  << "s, ping " << watchdog_config.ping_interval_ms / 1000 << "s" << std::endl;
+    }
+    if (validate_checksum) {
+        std::cout << "  Checksum validation: on (precision: ";
+        if (precision_by_symbol.empty()) {
+            std::cout << "none, not verified";
+        } else {
+            std::cout << checksum_precision;
+        }
+        std::cout << ")" << std::endl;
+    }
     std::cout << "  Display mode: ";
     if (g_show_orders) {
         std::cout << "Live order feed (verbose)";
@@ -281,9 +555,23 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (!l2_output_file.empty()) {
+        if (separate_files) {
+            g_l2_multi_writer = new MultiFileJsonLinesWriter(l2_output_file);
+        } else {
+            g_l2_single_writer = new JsonLinesWriter(l2_output_file);
+        }
+    }
+
+    kraken::WebSocketDeflate::set_enabled(parser.has("--deflate"));
+
     // Create WebSocket client
     KrakenLevel3Client level3_client(depth);
     g_level3_client = &level3_client;
+    level3_client.set_socket_options(socket_options);
+    level3_client.set_watchdog(watchdog_config);
+    level3_client.set_io_thread(io_placement, io_spin);
+    level3_client.set_parse_threads(static_cast<size_t>(parse_threads), parse_placement);
 
     // Setup authentication (priority: --token > --token-file > env var)
     bool token_set = false;
@@ -309,6 +597,8 @@ int main(int argc, char* argv[]) {
         print_usage_examples();
         if (g_single_writer) delete g_single_writer;
         if (g_multi_writer) delete g_multi_writer;
+        if (g_l2_single_writer) delete g_l2_single_writer;
+        if (g_l2_multi_writer) delete g_l2_multi_writer;
         return 1;
     }
 
@@ -351,6 +641,24 @@ int main(int argc, char* argv[]) {
         // Event counts and minimal modes: handled in periodic status below
     });
 
+    // Derived L2 book: aggregated levels computed from the order-level state
+    if (!l2_output_file.empty()) {
+        level3_client.set_l2_update_callback([](const OrderBookRecord& record) {
+            if (g_l2_multi_writer) {
+                g_l2_multi_writer->write_record(record);
+            } else if (g_l2_single_writer) {
+                g_l2_single_writer->write_record(record);
+            }
+        });
+    }
+
+    if (validate_checksum) {
+        level3_client.set_checksum_validation(true);
+        for (const auto& entry : precision_by_symbol) {
+            level3_client.set_checksum_precision(entry.first, entry.second.first, entry.second.second);
+        }
+    }
+
     level3_client.set_connection_callback([](bool connected) {
         std::cout << "[STATUS] WebSocket "
                   << (connected ? "connected" : "disconnected")
@@ -361,14 +669,40 @@ int main(int argc, char* argv[]) {
         std::cerr << "[ERROR] " << error << std::endl;
     });
 
+    // Symbol universe: SIGHUP re-reads the pairs specification and the
+    // difference is applied as batched (un)subscribe messages
+    auto universe = std::make_shared<kraken::SymbolUniverse>();
+    universe->load(pairs_spec);  // Already validated above
+    level3_client.set_symbol_universe(universe);
+    std::signal(SIGHUP, reload_handler);
+
     // Start WebSocket client
     if (!level3_client.start(symbols)) {
         std::cerr << "Failed to start WebSocket client" << std::endl;
         if (g_single_writer) delete g_single_writer;
         if (g_multi_writer) delete g_multi_writer;
+        if (g_l2_single_writer) delete g_l2_single_writer;
+        if (g_l2_multi_writer) delete g_l2_multi_writer;
         return 1;
     }
 
+    // After start(): new threads inherit the creating thread's placement
+    if (!main_placement.empty()) {
+        main_placement.apply("main");
+    }
+
+    // Stage tracing: dump on SIGUSR1 and at exit
+    std::string trace_file = parser.get("--trace-file");
+    if (!trace_file.empty()) {
+        if (kraken::trace::tracing_enabled()) {
+            kraken::trace::install_signal_dump(SIGUSR1, trace_file);
+            std::cout << "Stage trace: " << trace_file << " (send SIGUSR1 to dump)" << std::endl;
+        } else {
+            std::cerr << "[Warning] --trace-file ignored: rebuild with -DKRAKEN_STAGE_TRACING=ON" << std::endl;
+            trace_file.clear();
+        }
+    }
+
     std::cout << "Streaming Level 3 order data... Press Ctrl+C to stop and save." << std::endl;
     std::cout << std::endl;
 
@@ -397,6 +731,15 @@ int main(int argc, char* argv[]) {
             }
         }
 
+        // Apply pairs reload requested via SIGHUP
+        if (g_reload_requested.exchange(false) && universe->reload()) {
+            auto universe_stats = universe->get_stats();
+            std::cout << "[UNIVERSE] Reloaded " << pairs_spec << ": "
+                      << universe_stats.desired << " desired, "
+                      << universe_stats.subscribed << " subscribed, "
+                      << universe_stats.failed << " failed" << std::endl;
+        }
+
         // Print periodic status
         auto now = std::chrono::steady_clock::now();
         auto elapsed_since_status = std::chrono::duration_cast<std::chrono::seconds>(
@@ -429,6 +772,18 @@ int main(int argc, char* argv[]) {
 
     level3_client.stop();
 
+    // L2 writers are fed from the I/O thread, flush after it stopped
+    if (g_l2_multi_writer) {
+        g_l2_multi_writer->flush_all();
+    } else if (g_l2_single_writer) {
+        g_l2_single_writer->flush();
+    }
+
+    if (!trace_file.empty()) {
+        kraken::trace::stop_signal_dump();
+        kraken::trace::dump_chrome_trace(trace_file);
+    }
+
     auto end_time = std::chrono::steady_clock::now();
     auto total_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
         end_time - start_time
@@ -448,7 +803,13 @@ int main(int argc, char* argv[]) {
     int total_adds = 0;
     int total_modifies = 0;
     int total_deletes = 0;
+    int total_checks = 0;
+    int total_mismatches = 0;
+    int total_resyncs = 0;
     for (const auto& pair : final_stats) {
+        total_checks += pair.second.checksum_checks;
+        total_mismatches += pair.second.checksum_mismatches;
+        total_resyncs += pair.second.resync_count;
         total_snapshots += pair.second.snapshot_count;
         total_updates += pair.second.update_count;
         total_adds += pair.second.add_events;
@@ -463,6 +824,39 @@ int main(int argc, char* argv[]) {
     std::cout << "  Add: " << total_adds << std::endl;
     std::cout << "  Modify: " << total_modifies << std::endl;
     std::cout << "  Delete: " << total_deletes << std::endl;
+    if (validate_checksum) {
+        std::cout << "Checksum: " << total_checks << " checked, "
+                  << total_mismatches << " mismatches, "
+                  << total_resyncs << " resyncs" << std::endl;
+    }
+    auto tls_stats = level3_client.get_tls_stats();
+    std::cout << "TLS handshakes: " << tls_stats.handshakes << " (" << tls_stats.resumed
+              << " resumed), avg " << std::fixed << std::setprecision(1) << tls_stats.avg_ms()
+              << " ms, max " << tls_stats.max_ms << " ms" << std::endl;
+    if (watchdog_config.enabled()) {
+        auto watchdog_stats = level3_client.get_watchdog_stats();
+        std::cout << "Watchdog: " << watchdog_stats.stale_connections << " reconnects, "
+                  << watchdog_stats.stale_symbols << " symbols resubscribed";
+        if (watchdog_stats.pongs_received > 0) {
+            std::cout << ", ping RTT avg " << watchdog_stats.avg_rtt_ms() << " ms (min "
+                      << watchdog_stats.min_rtt_ms << ", max " << watchdog_stats.max_rtt_ms << ")";
+        }
+        std::cout << std::endl;
+    }
+    if (parse_threads > 0) {
+        auto parse_stats = level3_client.get_parse_stats();
+        std::cout << "Parse pool: " << parse_stats.threads << " threads, "
+                  << parse_stats.delivered << " frames delivered, "
+                  << parse_stats.out_of_order << " parsed out of order, max queue "
+                  << parse_stats.max_queued << std::endl;
+    }
+    if (kraken::WebSocketDeflate::is_enabled()) {
+        auto deflate_stats = kraken::WebSocketDeflate::get_stats();
+        std::cout << "Deflate: " << deflate_stats.compressed_bytes / 1024 << " KB received -> "
+                  << deflate_stats.inflated_bytes / 1024 << " KB (" << deflate_stats.ratio()
+                  << "x), inflate " << deflate_stats.inflate_ns / 1000000 << " ms ("
+                  << deflate_stats.ns_per_inflated_byte() << " ns/byte)" << std::endl;
+    }
     std::cout << "Runtime: " << total_elapsed << " seconds" << std::endl;
 
     if (separate_files) {
@@ -473,11 +867,21 @@ int main(int argc, char* argv[]) {
         std::cout << "Records written: " << g_single_writer->get_record_count() << std::endl;
     }
 
+    if (g_l2_multi_writer) {
+        std::cout << "Derived L2 records: " << g_l2_multi_writer->get_total_record_count()
+                  << " (" << g_l2_multi_writer->get_file_count() << " files)" << std::endl;
+    } else if (g_l2_single_writer) {
+        std::cout << "Derived L2 records: " << g_l2_single_writer->get_record_count()
+                  << " (" << l2_output_file << ")" << std::endl;
+    }
+
     std::cout << "Shutdown complete." << std::endl;
 
     // Cleanup
     if (g_single_writer) delete g_single_writer;
     if (g_multi_writer) delete g_multi_writer;
+    if (g_l2_single_writer) delete g_l2_single_writer;
+    if (g_l2_multi_writer) delete g_l2_multi_writer;
 
     return 0;
 }
@@ -0,0 +1,388 @@
+/**
+ * Kraken Live Data Retriever - Trades
+ *
+ * A production-ready tool for recording the Kraken trade channel (every
+ * executed trade). Built for bursts such as liquidation cascades:
+ * - Each WebSocket frame is decoded into one batch (no per-trade callback)
+ * - Batches are handed to a writer thread, so disk I/O never stalls the
+ *   socket; the [STATUS] line shows the writer queue so backlog is visible
+ *
+ * Usage:
+ *   ./retrieve_kraken_live_data_trades -p "BTC/USD,ETH/USD,SOL/USD"
+ *   ./retrieve_kraken_live_data_trades -p kraken_usd_volume.csv:pair:50 --hourly
+ *
+ * Send SIGHUP to re-read the pairs specification; added and removed pairs
+ * are (un)subscribed in batches without reconnecting.
+ *
+ * Output:
+ *   Saves trades to kraken_trades_live.csv
+ *   (timestamp,symbol,type,side,ord_type,price,qty,trade_id,trade_timestamp)
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <csignal>
+#include <chrono>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <algorithm>
+#include "kraken_trade_client_simdjson.hpp"
+#include "trade_csv_writer.hpp"
+#include "writer_pool.hpp"
+#include "cli_utils.hpp"
+#include "stage_trace.hpp"
+#include "symbol_universe.hpp"
+
+using kraken::KrakenTradeClientSimdjson;
+using kraken::TradeRecord;
+using kraken::TradeCsvWriter;
+using kraken::WriterPool;
+
+// Global state
+std::atomic<bool> g_running{true};
+std::mutex g_cv_mutex;
+std::condition_variable g_cv;
+std::atomic<bool> g_reload_requested{false};  // Set by SIGHUP
+
+void signal_handler(int) {
+    std::cout << "\n\nShutting down..." << std::endl;
+    g_running = false;
+    g_cv.notify_all();
+}
+
+void reload_handler(int) {
+    g_reload_requested = true;
+}
+
+void print_usage_examples() {
+    std::cout << std::endl;
+    std::cout << "Examples:" << std::endl;
+    std::cout << "  1. Direct list (comma-separated):" << std::endl;
+    std::cout << "     -p \"BTC/USD,ETH/USD,SOL/USD\"" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  2. Text file (one pair per line, no header):" << std::endl;
+    std::cout << "     -p kraken_tickers.txt:10       # First 10 lines" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  3. CSV file (with column name), hourly files:" << std::endl;
+    std::cout << "     -p kraken_usd_volume.csv:pair:50 --hourly" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  4. Print every trade:" << std::endl;
+    std::cout << "     -p \"BTC/USD\" --print" << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    // Setup argument parser
+    cli::ArgumentParser parser(argv[0], "Record real-time trades from Kraken");
+
+    parser.add_argument({
+        "-p", "--pairs",
+        "Pairs specification (direct list or CSV file)",
+        true,  // required
+        true,  // has value
+        "",
+        "SPEC"
+    });
+
+    parser.add_argument({
+        "-o", "--output",
+        "Output CSV filename",
+        false,  // optional
+        true,   // has value
+        "kraken_trades_live.csv",
+        "FILE"
+    });
+
+    parser.add_argument({
+        "-f", "--flush-interval",
+        "Flush interval in seconds (0 to disable time-based flush)",
+        false,  // optional
+        true,   // has value
+        "30",
+        "SECONDS"
+    });
+
+    parser.add_argument({
+        "-m", "--memory-threshold",
+        "Memory threshold in bytes (0 to disable memory-based flush)",
+        false,  // optional
+        true,   // has value
+        "10485760",  // 10MB default
+        "BYTES"
+    });
+
+    parser.add_argument({
+        "", "--hourly",
+        "Enable hourly file segmentation (output.20251112_10.csv)",
+        false,  // optional
+        false,  // no value (flag)
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--daily",
+        "Enable daily file segmentation (output.20251112.csv)",
+        false,  // optional
+        false,  // no value (flag)
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--print",
+        "Print every trade to the console",
+        false,  // optional
+        false,  // no value (flag)
+        "",
+        ""
+    });
+
+    parser.add_argument({
+        "", "--trace-file",
+        "Write stage trace (Chrome JSON) on SIGUSR1 and at exit (needs KRAKEN_STAGE_TRACING build)",
+        false,  // optional
+        true,   // has value
+        "",
+        "FILE"
+    });
+
+    // Parse arguments
+    if (!parser.parse(argc, argv)) {
+        if (!parser.get_errors().empty()) {
+            for (const auto& error : parser.get_errors()) {
+                std::cerr << "Error: " << error << std::endl;
+            }
+            std::cerr << std::endl;
+            parser.print_help();
+            print_usage_examples();
+            return 1;
+        }
+        return 0; // Help shown
+    }
+
+    // Get arguments
+    std::string pairs_spec = parser.get("-p");
+    std::string output_file = parser.get("-o");
+    int flush_interval = std::stoi(parser.get("-f"));
+    size_t memory_threshold = std::stoull(parser.get("-m"));
+    bool hourly_mode = parser.has("--hourly");
+    bool daily_mode = parser.has("--daily");
+    bool print_trades = parser.has("--print");
+
+    // Validate segmentation flags (mutually exclusive)
+    if (hourly_mode && daily_mode) {
+        std::cerr << "Error: --hourly and --daily cannot be used together" << std::endl;
+        return 1;
+    }
+
+    // Parse pairs using InputParser from cli_utils
+    auto parse_result = cli::InputParser::parse(pairs_spec);
+
+    if (!parse_result.success) {
+        std::cerr << "Error: " << parse_result.error_message << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> symbols = parse_result.values;
+
+    // Display configuration
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Kraken Live Data Retriever - Trades" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Output file: " << output_file << std::endl;
+    std::cout << "Flush interval: " << flush_interval << " seconds";
+    if (flush_interval == 0) {
+        std::cout << " (disabled)";
+    }
+    std::cout << std::endl;
+    std::cout << "Segmentation: ";
+    if (hourly_mode) {
+        std::cout << "hourly (output.YYYYMMDD_HH.csv)";
+    } else if (daily_mode) {
+        std::cout << "daily (output.YYYYMMDD.csv)";
+    } else {
+        std::cout << "none (single file)";
+    }
+    std::cout << std::endl;
+    std::cout << "Subscribing to " << symbols.size() << " pairs:" << std::endl;
+    for (size_t i = 0; i < symbols.size() && i < 10; i++) {
+        std::cout << "  - " << symbols[i] << std::endl;
+    }
+    if (symbols.size() > 10) {
+        std::cout << "  ... and " << (symbols.size() - 10) << " more" << std::endl;
+    }
+    std::cout << std::endl;
+
+    // Setup signal handlers
+    std::signal(SIGINT, signal_handler);
+    std::signal(SIGTERM, signal_handler);
+
+    // Writer: owned by the writer lane once the client is running
+    TradeCsvWriter writer(output_file);
+    writer.set_flush_interval(std::chrono::seconds(flush_interval));
+    writer.set_memory_threshold(memory_threshold);
+    if (hourly_mode) {
+        writer.set_segment_mode(kraken::SegmentMode::HOURLY);
+    } else if (daily_mode) {
+        writer.set_segment_mode(kraken::SegmentMode::DAILY);
+    }
+
+    WriterPool writer_pool(1);
+    size_t lane = writer_pool.assign_lane();
+    std::atomic<uint64_t> write_errors{0};
+
+    KrakenTradeClientSimdjson trade_client;
+
+    // One task per frame: the I/O thread only copies the batch
+    trade_client.set_batch_callback([&](const std::vector<TradeRecord>& batch) {
+        writer_pool.submit(lane, [&writer, &write_errors, batch]() {
+            if (!writer.write_records(batch)) {
+                write_errors++;
+            }
+        });
+
+        if (print_trades) {
+            for (const auto& trade : batch) {
+                std::cout << "[TRADE] " << trade.symbol
+                          << " | " << std::setw(4) << trade.side
+                          << " | " << trade.qty << " @ $" << trade.price
+                          << " | " << trade.ord_type
+                          << std::endl;
+            }
+        }
+    });
+
+    trade_client.set_connection_callback([](bool connected) {
+        std::cout << "[STATUS] WebSocket "
+                  << (connected ? "connected" : "disconnected")
+                  << std::endl;
+    });
+
+    // Symbol universe: SIGHUP re-reads the pairs specification and the
+    // difference is applied as batched (un)subscribe messages
+    auto universe = std::make_shared<kraken::SymbolUniverse>();
+    universe->load(pairs_spec);  // Already validated above
+    trade_client.set_symbol_universe(universe);
+    std::signal(SIGHUP, reload_handler);
+
+    // Start trade client
+    if (!trade_client.start(symbols)) {
+        std::cerr << "Failed to start WebSocket client" << std::endl;
+        return 1;
+    }
+
+    // Stage tracing: dump on SIGUSR1 and at exit
+    std::string trace_file = parser.get("--trace-file");
+    if (!trace_file.empty()) {
+        if (kraken::trace::tracing_enabled()) {
+            kraken::trace::install_signal_dump(SIGUSR1, trace_file);
+            std::cout << "Stage trace: " << trace_file << " (send SIGUSR1 to dump)" << std::endl;
+        } else {
+            std::cerr << "[Warning] --trace-file ignored: rebuild with -DKRAKEN_STAGE_TRACING=ON" << std::endl;
+            trace_file.clear();
+        }
+    }
+
+    std::cout << "Recording trades... Press Ctrl+C to stop and save." << std::endl;
+    std::cout << std::endl;
+
+    // Main event loop: periodic status only, data flows client -> writer lane
+    auto start_time = std::chrono::steady_clock::now();
+    auto last_status_time = start_time;
+    uint64_t last_trades = 0;
+    double peak_rate = 0.0;
+
+    while (g_running && trade_client.is_running()) {
+        {
+            std::unique_lock<std::mutex> lock(g_cv_mutex);
+            g_cv.wait_for(lock, std::chrono::seconds(5), [] { return !g_running; });
+        }
+        if (!g_running) {
+            break;
+        }
+
+        // Apply pairs reload requested via SIGHUP
+        if (g_reload_requested.exchange(false) && universe->reload()) {
+            auto universe_stats = universe->get_stats();
+            std::cout << "[UNIVERSE] Reloaded " << pairs_spec << ": "
+                      << universe_stats.desired << " desired, "
+                      << universe_stats.subscribed << " subscribed, "
+                      << universe_stats.failed << " failed" << std::endl;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double interval = std::chrono::duration<double>(now - last_status_time).count();
+        if (interval < 30.0) {
+            continue;
+        }
+
+        auto stats = trade_client.get_stats();
+        auto pool_stats = writer_pool.get_stats();
+        double rate = (stats.trades - last_trades) / interval;
+        peak_rate = std::max(peak_rate, rate);
+        last_trades = stats.trades;
+        last_status_time = now;
+
+        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - start_time).count();
+        std::cout << "\n[STATUS] Running time: " << elapsed << "s"
+                  << " | Trades: " << stats.trades
+                  << " | Frames: " << stats.frames
+                  << " | Max batch: " << stats.max_batch
+                  << " | Rate: " << std::fixed << std::setprecision(1) << rate << "/s"
+                  << " | Writer queue: " << pool_stats.queued << " (max " << pool_stats.max_queued << ")"
+                  << "\n" << std::endl;
+    }
+
+    // Shutdown: stop the feed, drain the writer lane, then flush
+    trade_client.stop();
+    std::cout << "\nFlushing remaining data..." << std::endl;
+    writer_pool.stop();
+    writer.flush();
+
+    if (!trace_file.empty()) {
+        kraken::trace::stop_signal_dump();
+        kraken::trace::dump_chrome_trace(trace_file);
+    }
+
+    auto total_elapsed = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - start_time
+    ).count();
+    auto stats = trade_client.get_stats();
+    auto pool_stats = writer_pool.get_stats();
+
+    std::cout << "\n==================================================" << std::endl;
+    std::cout << "Summary" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Pairs monitored: " << symbols.size() << std::endl;
+    std::cout << "Total trades: " << stats.trades << " in " << stats.frames << " frames" << std::endl;
+    std::cout << "Largest frame: " << stats.max_batch << " trades" << std::endl;
+    std::cout << "Peak rate (30s window): " << std::fixed << std::setprecision(1) << peak_rate << " trades/s" << std::endl;
+    std::cout << "Max writer queue: " << pool_stats.max_queued << " frames" << std::endl;
+    std::cout << "Records written: " << writer.get_record_count() << std::endl;
+    if (write_errors > 0) {
+        std::cout << "Write errors: " << write_errors << std::endl;
+    }
+    auto tls_stats = trade_client.get_tls_stats();
+    std::cout << "TLS handshakes: " << tls_stats.handshakes << " (" << tls_stats.resumed
+              << " resumed), avg " << std::fixed << std::setprecision(1) << tls_stats.avg_ms()
+              << " ms, max " << tls_stats.max_ms << " ms" << std::endl;
+    std::cout << "Runtime: " << total_elapsed << " seconds" << std::endl;
+    if (hourly_mode || daily_mode) {
+        std::cout << "Files created: " << writer.get_segment_count() << std::endl;
+    }
+    std::cout << "Output file: " << output_file;
+    if (hourly_mode) {
+        std::cout << " -> *.YYYYMMDD_HH.csv";
+    } else if (daily_mode) {
+        std::cout << " -> *.YYYYMMDD.csv";
+    }
+    std::cout << std::endl;
+    std::cout << "Shutdown complete." << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * TLS Handshake Probe
+ *
+ * Opens repeated TLS connections through the shared TlsSessionCache (the
+ * same context and session cache the WebSocket clients use) and reports the
+ * handshake time of each, so full and resumed handshakes can be compared.
+ *
+ * Only the TLS handshake is timed (TCP connect excluded), exactly like the
+ * clients' connection stats. After each handshake a small HTTP request is
+ * sent so TLS 1.3 session tickets are received before closing.
+ *
+ * Usage:
+ *   ./tls_handshake_probe                          # ws.kraken.com:443
+ *   ./tls_handshake_probe -n 20 --no-resume        # full handshakes only
+ *
+ * Local TLS stand-in server:
+ *   openssl req -x509 -newkey rsa:2048 -nodes -subj /CN=localhost \
+ *       -keyout key.pem -out cert.pem -days 1
+ *   openssl s_server -accept 8443 -cert cert.pem -key key.pem -www
+ *   ./tls_handshake_probe --host localhost --port 8443 -n 10
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <csignal>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <string>
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include "cli_utils.hpp"
+#include "tls_session_cache.hpp"
+
+using kraken::TlsSessionCache;
+using kraken::TlsHandshakeStats;
+using kraken::TlsHandshakeTimer;
+
+// Global state
+std::atomic<bool> g_running{true};
+
+void signal_handler(int) {
+    std::cout << "\n\nStopping probe..." << std::endl;
+    g_running = false;
+}
+
+/**
+ * One connection: TCP connect, timed TLS handshake, short request, close
+ * @return false on connection or handshake failure
+ */
+bool probe_once(boost::asio::io_context& io,
+                const boost::asio::ip::tcp::resolver::results_type& endpoints,
+                const std::string& host,
+                double& handshake_ms, bool& resumed) {
+
+    TlsSessionCache& cache = TlsSessionCache::instance();
+    boost::asio::ssl::stream<boost::asio::ip::tcp::socket> stream(io, *cache.get_context());
+
+    try {
+        boost::asio::connect(stream.lowest_layer(), endpoints);
+        stream.lowest_layer().set_option(boost::asio::ip::tcp::no_delay(true));
+
+        TlsHandshakeTimer timer;
+        timer.start();
+        cache.prepare(stream.native_handle(), host);
+        stream.handshake(boost::asio::ssl::stream_base::client);
+        handshake_ms = timer.elapsed_ms();
+        resumed = SSL_session_reused(stream.native_handle()) == 1;
+        cache.record_handshake(handshake_ms, resumed);
+
+        // Reading the response also processes TLS 1.3 session tickets
+        std::string request = "GET / HTTP/1.1\r\nHost: " + host + "\r\nConnection: close\r\n\r\n";
+        boost::asio::write(stream, boost::asio::buffer(request));
+
+        char buffer[4096];
+        boost::system::error_code ec;
+        stream.read_some(boost::asio::buffer(buffer), ec);
+
+        stream.shutdown(ec);  // Peer may close first; not an error here
+        stream.lowest_layer().close(ec);
+        return true;
+
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] " << host << ": " << e.what() << std::endl;
+        return false;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    cli::ArgumentParser parser(argv[0], "Measure TLS handshake time with and without session resumption");
+
+    parser.add_argument({
+        "", "--host",
+        "Server host name (also used for SNI)",
+        false,  // optional
+        true,   // has value
+        "ws.kraken.com",
+        "HOST"
+    });
+
+    parser.add_argument({
+        "", "--port",
+        "Server port",
+        false,  // optional
+        true,   // has value
+        "443",
+        "PORT"
+    });
+
+    parser.add_argument({
+        "-n", "--count",
+        "Number of connections",
+        false,  // optional
+        true,   // has value
+        "5",
+        "N"
+    });
+
+    parser.add_argument({
+        "", "--interval",
+        "Pause between connections in milliseconds",
+        false,  // optional
+        true,   // has value
+        "200",
+        "MS"
+    });
+
+    parser.add_argument({
+        "", "--no-resume",
+        "Disable session resumption (every handshake is a full one)",
+        false,  // optional
+        false,  // no value (flag)
+        "",
+        ""
+    });
+
+    if (!parser.parse(argc, argv)) {
+        if (!parser.get_errors().empty()) {
+            for (const auto& error : parser.get_errors()) {
+                std::cerr << "Error: " << error << std::endl;
+            }
+            std::cerr << std::endl;
+            parser.print_help();
+            return 1;
+        }
+        return 0; // Help shown
+    }
+
+    std::string host = parser.get("--host");
+    std::string port = parser.get("--port");
+    int count = std::stoi(parser.get("-n"));
+    int interval_ms = std::stoi(parser.get("--interval"));
+    bool resume = !parser.has("--no-resume");
+
+    if (count <= 0) {
+        std::cerr << "Error: --count must be positive" << std::endl;
+        return 1;
+    }
+
+    TlsSessionCache::instance().set_resumption_enabled(resume);
+
+    std::cout << "==================================================" << std::endl;
+    std::cout << "TLS Handshake Probe" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Server: " << host << ":" << port << std::endl;
+    std::cout << "Connections: " << count << std::endl;
+    std::cout << "Session resumption: " << (resume ? "enabled" : "disabled") << std::endl;
+    std::cout << std::endl;
+
+    std::signal(SIGINT, signal_handler);
+
+    boost::asio::io_context io;
+    boost::asio::ip::tcp::resolver::results_type endpoints;
+    try {
+        boost::asio::ip::tcp::resolver resolver(io);
+        endpoints = resolver.resolve(host, port);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: Cannot resolve " << host << ": " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Full and resumed handshakes are summarized separately
+    TlsHandshakeStats full_stats;
+    TlsHandshakeStats resumed_stats;
+    int failures = 0;
+
+    std::cout << std::fixed << std::setprecision(3);
+    for (int i = 1; i <= count && g_running; ++i) {
+        double ms = 0.0;
+        bool resumed = false;
+        if (!probe_once(io, endpoints, host, ms, resumed)) {
+            failures++;
+        } else {
+            (resumed ? resumed_stats : full_stats).record(ms, resumed);
+            std::cout << "  #" << std::left << std::setw(4) << i << std::right
+                      << (resumed ? "resumed " : "full    ")
+                      << std::setw(10) << ms << " ms" << std::endl;
+        }
+
+        if (i < count && interval_ms > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+        }
+    }
+
+    TlsHandshakeStats total = TlsSessionCache::instance().get_stats();
+
+    std::cout << "\n==================================================" << std::endl;
+    std::cout << "Handshake Summary" << std::endl;
+    std::cout << "==================================================" << std::endl;
+    std::cout << "Handshakes: " << total.handshakes << " (" << total.resumed << " resumed)" << std::endl;
+    if (failures > 0) {
+        std::cout << "Failures: " << failures << std::endl;
+    }
+    if (full_stats.handshakes > 0) {
+        std::cout << "Full:    avg " << full_stats.avg_ms() << " ms, max " << full_stats.max_ms << " ms" << std::endl;
+    }
+    if (resumed_stats.handshakes > 0) {
+        std::cout << "Resumed: avg " << resumed_stats.avg_ms() << " ms, max " << resumed_stats.max_ms << " ms" << std::endl;
+    }
+    if (resume && total.handshakes > 1 && total.resumed == 0) {
+        std::cout << "Note: server did not resume any session" << std::endl;
+    }
+
+    return failures > 0 ? 1 : 0;
+}
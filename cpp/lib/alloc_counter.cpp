@@ -0,0 +1,286 @@
+/**
+ * Hot-Path Allocation Counter - Implementation
+ */
+
+#include "alloc_counter.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <iomanip>
+
+namespace kraken {
+namespace alloc {
+
+namespace {
+    // Per-thread totals (constant-initialized, safe to touch from operator new)
+    thread_local ThreadAllocCounters tl_counters = {0, 0, 0};
+
+    // Intrusive list of registered sites
+    std::atomic<AllocSite*> g_sites_head(nullptr);
+
+    std::atomic<bool> g_assert_mode(false);
+
+    void atomic_max(std::atomic<uint64_t>& target, uint64_t value) {
+        uint64_t current = target.load(std::memory_order_relaxed);
+        while (value > current &&
+               !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+}
+
+#ifdef KRAKEN_ALLOC_INSTRUMENTATION
+void note_allocation(std::size_t size) noexcept {
+    tl_counters.allocations++;
+    tl_counters.bytes += size;
+}
+
+void note_deallocation() noexcept {
+    tl_counters.deallocations++;
+}
+#endif
+
+// ============================================================================
+// AllocSite Implementation
+// ============================================================================
+
+AllocSite::AllocSite(const char* name, bool allocation_free)
+    : name_(name), allocation_free_(allocation_free), next_(nullptr),
+      calls_(0), allocations_(0), bytes_(0),
+      max_allocations_per_call_(0), violations_(0) {
+
+    // Lock-free push onto the site list
+    AllocSite* head = g_sites_head.load(std::memory_order_relaxed);
+    do {
+        next_ = head;
+    } while (!g_sites_head.compare_exchange_weak(head, this,
+                                                 std::memory_order_release,
+                                                 std::memory_order_relaxed));
+}
+
+void AllocSite::record(uint64_t allocations, uint64_t bytes) {
+    calls_.fetch_add(1, std::memory_order_relaxed);
+
+    if (allocations == 0) {
+        return;
+    }
+
+    allocations_.fetch_add(allocations, std::memory_order_relaxed);
+    bytes_.fetch_add(bytes, std::memory_order_relaxed);
+    atomic_max(max_allocations_per_call_, allocations);
+
+    if (allocation_free_) {
+        violations_.fetch_add(1, std::memory_order_relaxed);
+
+        if (g_assert_mode.load(std::memory_order_relaxed)) {
+            // No iostreams here: report and abort without touching the heap
+            std::fprintf(stderr,
+                         "[ALLOC] Allocation-free path '%s' allocated %llu time(s) (%llu bytes)\n",
+                         name_,
+                         static_cast<unsigned long long>(allocations),
+                         static_cast<unsigned long long>(bytes));
+            std::abort();
+        }
+    }
+}
+
+AllocSiteReport AllocSite::report() const {
+    AllocSiteReport r;
+    r.name = name_;
+    r.allocation_free = allocation_free_;
+    r.calls = calls_.load(std::memory_order_relaxed);
+    r.allocations = allocations_.load(std::memory_order_relaxed);
+    r.bytes = bytes_.load(std::memory_order_relaxed);
+    r.max_allocations_per_call = max_allocations_per_call_.load(std::memory_order_relaxed);
+    r.violations = violations_.load(std::memory_order_relaxed);
+    return r;
+}
+
+void AllocSite::reset() {
+    calls_ = 0;
+    allocations_ = 0;
+    bytes_ = 0;
+    max_allocations_per_call_ = 0;
+    violations_ = 0;
+}
+
+// ============================================================================
+// AllocScope Implementation
+// ============================================================================
+
+AllocScope::AllocScope(AllocSite& site)
+    : site_(site),
+      start_allocations_(tl_counters.allocations),
+      start_bytes_(tl_counters.bytes) {
+}
+
+AllocScope::~AllocScope() {
+    site_.record(tl_counters.allocations - start_allocations_,
+                 tl_counters.bytes - start_bytes_);
+}
+
+// ============================================================================
+// Reporting
+// ============================================================================
+
+bool instrumentation_enabled() {
+#ifdef KRAKEN_ALLOC_INSTRUMENTATION
+    return true;
+#else
+    return false;
+#endif
+}
+
+ThreadAllocCounters thread_counters() {
+    return tl_counters;
+}
+
+void set_assert_mode(bool enabled) {
+    g_assert_mode = enabled;
+}
+
+bool assert_mode() {
+    return g_assert_mode.load();
+}
+
+std::vector<AllocSiteReport> collect_report() {
+    std::vector<AllocSiteReport> reports;
+    for (AllocSite* site = g_sites_head.load(std::memory_order_acquire);
+         site != nullptr; site = site->next()) {
+        AllocSiteReport r = site->report();
+        if (r.calls > 0) {
+            reports.push_back(r);
+        }
+    }
+    return reports;
+}
+
+void reset_report() {
+    for (AllocSite* site = g_sites_head.load(std::memory_order_acquire);
+         site != nullptr; site = site->next()) {
+        site->reset();
+    }
+}
+
+uint64_t total_violations() {
+    uint64_t total = 0;
+    for (AllocSite* site = g_sites_head.load(std::memory_order_acquire);
+         site != nullptr; site = site->next()) {
+        total += site->report().violations;
+    }
+    return total;
+}
+
+void print_report(std::ostream& os) {
+    if (!instrumentation_enabled()) {
+        os << "Allocation instrumentation disabled "
+           << "(rebuild with -DKRAKEN_ALLOC_INSTRUMENTATION=ON)" << std::endl;
+        return;
+    }
+
+    std::vector<AllocSiteReport> reports = collect_report();
+    if (reports.empty()) {
+        os << "No instrumented sites were entered" << std::endl;
+        return;
+    }
+
+    os << std::left << std::setw(40) << "Site"
+       << std::right << std::setw(12) << "Calls"
+       << std::setw(14) << "Allocs"
+       << std::setw(12) << "Allocs/call"
+       << std::setw(10) << "Max"
+       << std::setw(14) << "Bytes/call"
+       << std::setw(12) << "Violations" << std::endl;
+    os << std::string(114, '-') << std::endl;
+
+    for (const auto& r : reports) {
+        double per_call = r.calls > 0 ? static_cast<double>(r.allocations) / r.calls : 0.0;
+        double bytes_per_call = r.calls > 0 ? static_cast<double>(r.bytes) / r.calls : 0.0;
+
+        std::string name = r.name + (r.allocation_free ? " [free]" : "");
+        os << std::left << std::setw(40) << name
+           << std::right << std::setw(12) << r.calls
+           << std::setw(14) << r.allocations
+           << std::setw(12) << std::fixed << std::setprecision(2) << per_call
+           << std::setw(10) << r.max_allocations_per_call
+           << std::setw(14) << std::setprecision(1) << bytes_per_call
+           << std::setw(12) << (r.allocation_free ? std::to_string(r.violations) : "-")
+           << std::endl;
+    }
+}
+
+} // namespace alloc
+} // namespace kraken
+
+// ============================================================================
+// Global operator new/delete hook (instrumented builds only)
+// ============================================================================
+
+#ifdef KRAKEN_ALLOC_INSTRUMENTATION
+
+namespace {
+
+void* counted_alloc(std::size_t size) {
+    if (size == 0) {
+        size = 1;
+    }
+    void* p = std::malloc(size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    kraken::alloc::note_allocation(size);
+    return p;
+}
+
+void* counted_alloc_nothrow(std::size_t size) noexcept {
+    if (size == 0) {
+        size = 1;
+    }
+    void* p = std::malloc(size);
+    if (p != nullptr) {
+        kraken::alloc::note_allocation(size);
+    }
+    return p;
+}
+
+void* counted_aligned_alloc(std::size_t size, std::size_t alignment) {
+    if (size == 0) {
+        size = 1;
+    }
+    // aligned_alloc requires size to be a multiple of alignment
+    std::size_t rounded = (size + alignment - 1) / alignment * alignment;
+    void* p = std::aligned_alloc(alignment, rounded);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    kraken::alloc::note_allocation(size);
+    return p;
+}
+
+void counted_free(void* p) noexcept {
+    if (p != nullptr) {
+        kraken::alloc::note_deallocation();
+        std::free(p);
+    }
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return counted_alloc(size); }
+void* operator new[](std::size_t size) { return counted_alloc(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc_nothrow(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return counted_alloc_nothrow(size); }
+void* operator new(std::size_t size, std::align_val_t al) { return counted_aligned_alloc(size, static_cast<std::size_t>(al)); }
+void* operator new[](std::size_t size, std::align_val_t al) { return counted_aligned_alloc(size, static_cast<std::size_t>(al)); }
+
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t) noexcept { counted_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { counted_free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { counted_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { counted_free(p); }
+
+#endif // KRAKEN_ALLOC_INSTRUMENTATION
@@ -0,0 +1,187 @@
+/**
+ * Hot-Path Allocation Counter
+ *
+ * Opt-in instrumentation that counts heap allocations per thread through a
+ * global operator new hook. Build with -DKRAKEN_ALLOC_INSTRUMENTATION=ON to
+ * enable it; otherwise the scope macros compile to nothing and the hook is
+ * not installed.
+ *
+ * Usage:
+ *   void OrderBookState::apply(const OrderBookRecord& record) {
+ *       KRAKEN_ALLOC_SCOPE("orderbook_state.apply");
+ *       ...
+ *   }
+ *
+ *   double OrderBookState::get_bid_volume_top_n(int n) const {
+ *       KRAKEN_ALLOC_FREE_SCOPE("orderbook_state.bid_volume_top_n");
+ *       ...
+ *   }
+ *
+ * Each scope site accumulates calls, allocations and bytes. Sites declared
+ * allocation-free count violations, and in assert mode a violation aborts
+ * the process so regressions fail loudly in benchmark runs.
+ */
+
+#ifndef ALLOC_COUNTER_HPP
+#define ALLOC_COUNTER_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace kraken {
+namespace alloc {
+
+/**
+ * Allocation totals for the calling thread
+ */
+struct ThreadAllocCounters {
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t bytes;
+};
+
+/**
+ * Accumulated results for one instrumented site
+ */
+struct AllocSiteReport {
+    std::string name;
+    bool allocation_free;
+    uint64_t calls;
+    uint64_t allocations;
+    uint64_t bytes;
+    uint64_t max_allocations_per_call;
+    uint64_t violations;
+};
+
+/**
+ * Instrumented code location (one static instance per macro expansion)
+ *
+ * Sites link themselves into a global intrusive list on construction, so
+ * registration never allocates.
+ */
+class AllocSite {
+public:
+    AllocSite(const char* name, bool allocation_free);
+
+    // Disable copy
+    AllocSite(const AllocSite&) = delete;
+    AllocSite& operator=(const AllocSite&) = delete;
+
+    /**
+     * Record one pass through the site
+     */
+    void record(uint64_t allocations, uint64_t bytes);
+
+    const char* name() const { return name_; }
+    bool allocation_free() const { return allocation_free_; }
+
+    /**
+     * Snapshot current counters
+     */
+    AllocSiteReport report() const;
+
+    /**
+     * Zero all counters
+     */
+    void reset();
+
+    AllocSite* next() const { return next_; }
+
+private:
+    const char* name_;
+    bool allocation_free_;
+    AllocSite* next_;
+
+    std::atomic<uint64_t> calls_;
+    std::atomic<uint64_t> allocations_;
+    std::atomic<uint64_t> bytes_;
+    std::atomic<uint64_t> max_allocations_per_call_;
+    std::atomic<uint64_t> violations_;
+};
+
+/**
+ * RAII guard measuring allocations between construction and destruction
+ */
+class AllocScope {
+public:
+    explicit AllocScope(AllocSite& site);
+    ~AllocScope();
+
+    // Disable copy
+    AllocScope(const AllocScope&) = delete;
+    AllocScope& operator=(const AllocScope&) = delete;
+
+private:
+    AllocSite& site_;
+    uint64_t start_allocations_;
+    uint64_t start_bytes_;
+};
+
+/**
+ * True when built with KRAKEN_ALLOC_INSTRUMENTATION (hook installed)
+ */
+bool instrumentation_enabled();
+
+/**
+ * Allocation totals for the calling thread (zeros when disabled)
+ */
+ThreadAllocCounters thread_counters();
+
+/**
+ * Abort on the first allocation inside an allocation-free scope
+ */
+void set_assert_mode(bool enabled);
+bool assert_mode();
+
+/**
+ * Collect reports for all sites that have been entered at least once
+ */
+std::vector<AllocSiteReport> collect_report();
+
+/**
+ * Zero the counters of every registered site
+ */
+void reset_report();
+
+/**
+ * Total violations across all allocation-free sites
+ */
+uint64_t total_violations();
+
+/**
+ * Print a formatted table of all site reports
+ */
+void print_report(std::ostream& os);
+
+} // namespace alloc
+} // namespace kraken
+
+#ifdef KRAKEN_ALLOC_INSTRUMENTATION
+
+#define KRAKEN_ALLOC_CONCAT_INNER(a, b) a##b
+#define KRAKEN_ALLOC_CONCAT(a, b) KRAKEN_ALLOC_CONCAT_INNER(a, b)
+
+#define KRAKEN_ALLOC_SCOPE_IMPL(name, allocation_free)                                   \
+    static ::kraken::alloc::AllocSite KRAKEN_ALLOC_CONCAT(kraken_alloc_site_, __LINE__)( \
+        name, allocation_free);                                                          \
+    ::kraken::alloc::AllocScope KRAKEN_ALLOC_CONCAT(kraken_alloc_scope_, __LINE__)(      \
+        KRAKEN_ALLOC_CONCAT(kraken_alloc_site_, __LINE__))
+
+// Count allocations made until the end of the enclosing block
+#define KRAKEN_ALLOC_SCOPE(name) KRAKEN_ALLOC_SCOPE_IMPL(name, false)
+
+// Same, but any allocation is a violation (aborts in assert mode)
+#define KRAKEN_ALLOC_FREE_SCOPE(name) KRAKEN_ALLOC_SCOPE_IMPL(name, true)
+
+#else
+
+#define KRAKEN_ALLOC_SCOPE(name) ((void)0)
+#define KRAKEN_ALLOC_FREE_SCOPE(name) ((void)0)
+
+#endif // KRAKEN_ALLOC_INSTRUMENTATION
+
+#endif // ALLOC_COUNTER_HPP
@@ -0,0 +1,119 @@
+/**
+ * Bar CSV Writer - Implementation
+ */
+
+#include "bar_csv_writer.hpp"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <ctime>
+#include <cmath>
+
+namespace kraken {
+
+BarCSVWriter::BarCSVWriter(const std::string& filename) : bar_count_(0) {
+    file_.open(filename, std::ios::out);
+
+    if (!file_.is_open()) {
+        std::cerr << "Error: Cannot open file for writing: " << filename << std::endl;
+        return;
+    }
+
+    write_header();
+}
+
+BarCSVWriter::~BarCSVWriter() {
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+bool BarCSVWriter::is_open() const {
+    return file_.is_open();
+}
+
+size_t BarCSVWriter::get_bar_count() const {
+    return bar_count_;
+}
+
+void BarCSVWriter::flush() {
+    if (file_.is_open()) {
+        file_.flush();
+    }
+}
+
+void BarCSVWriter::write_header() {
+    file_ << "bar_start,interval_seconds,symbol,ticks,"
+          << "open,high,low,close,volume,"
+          << "mid_open,mid_high,mid_low,mid_close,"
+          << "spread_mean,spread_min,spread_max,spread_bps_mean"
+          << "\n";
+}
+
+std::string BarCSVWriter::format_double(double value) const {
+    // Use adaptive precision, then remove trailing zeros
+    std::ostringstream oss;
+    oss << std::setprecision(15) << value;
+    std::string result = oss.str();
+
+    // Remove trailing zeros after decimal point
+    if (result.find('.') != std::string::npos) {
+        result.erase(result.find_last_not_of('0') + 1, std::string::npos);
+        // Remove trailing decimal point if no decimals left
+        if (result.back() == '.') {
+            result.pop_back();
+        }
+    }
+
+    return result;
+}
+
+std::string BarCSVWriter::format_time(double seconds) const {
+    std::time_t t = static_cast<std::time_t>(std::floor(seconds));
+    std::tm tm;
+    gmtime_r(&t, &tm);
+
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &tm);
+    return buffer;
+}
+
+bool BarCSVWriter::write_bar(const TickerBar& bar) {
+    if (!file_.is_open()) {
+        return false;
+    }
+
+    file_ << format_time(bar.start) << ","
+          << bar.interval_seconds << ","
+          << bar.symbol << ","
+          << bar.ticks << ",";
+
+    if (bar.has_price) {
+        file_ << format_double(bar.open) << ","
+              << format_double(bar.high) << ","
+              << format_double(bar.low) << ","
+              << format_double(bar.close) << ",";
+    } else {
+        file_ << ",,,,";
+    }
+    file_ << format_double(bar.volume) << ",";
+
+    if (bar.has_mid) {
+        file_ << format_double(bar.mid_open) << ","
+              << format_double(bar.mid_high) << ","
+              << format_double(bar.mid_low) << ","
+              << format_double(bar.mid_close) << ","
+              << format_double(bar.spread_mean) << ","
+              << format_double(bar.spread_min) << ","
+              << format_double(bar.spread_max) << ","
+              << format_double(bar.spread_bps_mean);
+    } else {
+        file_ << ",,,,,,,";
+    }
+    file_ << "\n";
+
+    bar_count_++;
+    return true;
+}
+
+} // namespace kraken
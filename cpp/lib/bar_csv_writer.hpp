@@ -0,0 +1,76 @@
+/**
+ * Bar CSV Writer
+ *
+ * Writes ticker bars (TickerBar) to CSV with adaptive precision. Price
+ * columns are left empty when no tick in the bar carried that value (no
+ * last price, or a side of the book missing).
+ */
+
+#ifndef BAR_CSV_WRITER_HPP
+#define BAR_CSV_WRITER_HPP
+
+#include <string>
+#include <fstream>
+#include "ticker_bars.hpp"
+
+namespace kraken {
+
+/**
+ * CSV writer for ticker bars
+ */
+class BarCSVWriter {
+public:
+    /**
+     * Constructor
+     * @param filename Output CSV filename
+     */
+    explicit BarCSVWriter(const std::string& filename);
+
+    /**
+     * Destructor - closes file
+     */
+    ~BarCSVWriter();
+
+    /**
+     * Write one bar
+     */
+    bool write_bar(const TickerBar& bar);
+
+    /**
+     * Flush buffered data to disk
+     */
+    void flush();
+
+    /**
+     * Check if file is open and writable
+     */
+    bool is_open() const;
+
+    /**
+     * Get number of bars written
+     */
+    size_t get_bar_count() const;
+
+private:
+    std::ofstream file_;
+    size_t bar_count_;
+
+    /**
+     * Write CSV header
+     */
+    void write_header();
+
+    /**
+     * Format double with adaptive precision (no trailing zeros)
+     */
+    std::string format_double(double value) const;
+
+    /**
+     * Format bar start as "YYYY-MM-DD HH:MM:SS" (UTC)
+     */
+    std::string format_time(double seconds) const;
+};
+
+} // namespace kraken
+
+#endif // BAR_CSV_WRITER_HPP
@@ -0,0 +1,509 @@
+/**
+ * Buffered Record Writer
+ *
+ * One implementation of buffering, flushing, segmentation and per-symbol
+ * file management for the record streams the tools write (raw .jsonl
+ * captures, snapshot CSVs). The output format is a codec chosen at compile
+ * time:
+ *
+ *   BufferedWriter<Record, Codec>   One output file (or segment series)
+ *   MultiFileWriter<Record, Codec>  One BufferedWriter per symbol
+ *
+ * Records are encoded as they are written into a byte buffer that
+ * FlushSegmentMixin flushes on its time / memory triggers and rotates on
+ * segment boundaries. The memory threshold therefore counts the exact
+ * bytes the next flush writes.
+ *
+ * Required Codec interface (held by value, so it may carry settings and
+ * per-file state such as columns fixed by the first record):
+ *
+ *   static const char* extension()
+ *       File extension (".csv", ".jsonl")
+ *
+ *   void header(const Record& first, std::string& out)
+ *       Append the header of a new file (may append nothing); called with
+ *       the first record written to the file
+ *
+ *   void encode(const Record& record, std::string& out)
+ *       Append one record, including its newline
+ *
+ * Records must have string members `timestamp` (event-time segmentation,
+ * "YYYY-MM-DD HH:MM:SS...") and `symbol` (MultiFileWriter routing).
+ *
+ * Usage:
+ *   BufferedWriter<SnapshotMetrics, SnapshotCsvCodec> writer("out.csv");
+ *   writer.set_segment_mode(SegmentMode::HOURLY);
+ *   writer.write(metrics);
+ *   writer.flush();
+ */
+
+#ifndef BUFFERED_WRITER_HPP
+#define BUFFERED_WRITER_HPP
+
+#include "flush_segment_mixin.hpp"
+#include <fstream>
+#include <string>
+#include <map>
+#include <charconv>
+#include <cstdio>
+#include <cstdint>
+
+namespace kraken {
+
+/**
+ * Field formatting shared by the codecs (appends to the output buffer)
+ */
+struct FieldFormat {
+    /**
+     * Integer in decimal
+     */
+    template<typename T>
+    static void append_int(std::string& out, T value) {
+        char buffer[24];
+        auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        out.append(buffer, result.ptr);
+    }
+
+    /**
+     * Double with up to 15 significant digits, no trailing zeros
+     * (same text as an ostream with setprecision(15))
+     */
+    static void append_double(std::string& out, double value) {
+        char buffer[32];
+        int len = std::snprintf(buffer, sizeof(buffer), "%.15g", value);
+        out.append(buffer, static_cast<size_t>(len));
+    }
+
+    /**
+     * Double with a fixed number of decimals
+     * (same text as an ostream with std::fixed and setprecision(decimals))
+     */
+    static void append_fixed(std::string& out, double value, int decimals) {
+        char buffer[64];
+        int len = std::snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+        if (len >= static_cast<int>(sizeof(buffer))) {
+            // Huge magnitude: format again into a buffer of the right size
+            std::string wide(static_cast<size_t>(len) + 1, '\0');
+            std::snprintf(&wide[0], wide.size(), "%.*f", decimals, value);
+            out.append(wide.data(), static_cast<size_t>(len));
+            return;
+        }
+        out.append(buffer, static_cast<size_t>(len));
+    }
+
+    /**
+     * JSON string contents (without the quotes)
+     */
+    static void append_json_escaped(std::string& out, const std::string& str) {
+        for (char c : str) {
+            switch (c) {
+                case '"':  out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\b': out += "\\b";  break;
+                case '\f': out += "\\f";  break;
+                case '\n': out += "\\n";  break;
+                case '\r': out += "\\r";  break;
+                case '\t': out += "\\t";  break;
+                default:   out += c;      break;
+            }
+        }
+    }
+};
+
+/**
+ * Buffered, segmenting writer for one output file
+ *
+ * @tparam Record Record type (with timestamp / symbol members)
+ * @tparam Codec Output format (see file header)
+ */
+template<typename Record, typename Codec>
+class BufferedWriter : public FlushSegmentMixin<BufferedWriter<Record, Codec>> {
+    friend class FlushSegmentMixin<BufferedWriter<Record, Codec>>;  // Allow mixin to access private interface
+    typedef FlushSegmentMixin<BufferedWriter<Record, Codec>> Mixin;
+
+public:
+    /**
+     * Constructor
+     * The file opens with open(), on the first write, or in
+     * set_segment_mode() when segmenting.
+     * @param filename Output filename (base name when segmenting)
+     * @param append Append to existing files instead of truncating them
+     * @param codec Codec (with its settings)
+     */
+    explicit BufferedWriter(const std::string& filename, bool append = false,
+                            const Codec& codec = Codec())
+        : codec_(codec), append_(append), header_pending_(false),
+          record_count_(0), bytes_written_(0) {
+        this->set_base_filename(filename);
+    }
+
+    /**
+     * Destructor - flushes remaining data and closes the file
+     */
+    ~BufferedWriter() {
+        this->force_flush();
+        if (file_.is_open()) {
+            file_.close();
+        }
+    }
+
+    /**
+     * Open the (unsegmented) output file now
+     * Writers whose callers check is_open() right after construction call
+     * this; segmented writers open in set_segment_mode().
+     */
+    bool open() {
+        if (file_.is_open() || this->segment_mode_ != SegmentMode::NONE) {
+            return file_.is_open();
+        }
+        if (!open_file(this->base_filename_, append_)) {
+            return false;
+        }
+        this->current_segment_filename_ = this->base_filename_;
+        return true;
+    }
+
+    /**
+     * Encode and buffer one record (flushes / rotates as configured)
+     */
+    bool write(const Record& record) {
+        // Event-time segmentation: rotate before buffering (no-op otherwise)
+        this->advance_event_time(record.timestamp);
+
+        if (!file_.is_open() && !open()) {
+            return false;
+        }
+
+        if (header_pending_) {
+            codec_.header(record, buffer_);
+            header_pending_ = false;
+        }
+        codec_.encode(record, buffer_);
+        record_count_++;
+
+        this->check_and_flush();
+        return true;
+    }
+
+    /**
+     * Write buffered data to disk
+     */
+    void flush() {
+        this->force_flush();
+    }
+
+    /**
+     * Check if file is open and writable
+     */
+    bool is_open() const {
+        return file_.is_open();
+    }
+
+    /**
+     * Records written (including ones still buffered)
+     */
+    size_t get_record_count() const {
+        return record_count_;
+    }
+
+    /**
+     * Bytes flushed to disk
+     */
+    uint64_t get_bytes_written() const {
+        return bytes_written_;
+    }
+
+    // Note: Flush/segment configuration methods inherited from FlushSegmentMixin
+    // - void set_flush_interval(std::chrono::seconds interval)
+    // - void set_memory_threshold(size_t bytes)
+    // - void set_segment_clock(SegmentClock clock)
+    // - void set_segment_mode(SegmentMode mode)
+    // - size_t get_flush_count() const
+    // - size_t get_current_memory_usage() const
+    // - size_t get_segment_count() const
+    // - std::string get_current_segment_filename() const
+
+private:
+    std::ofstream file_;
+    Codec codec_;
+    std::string buffer_;     // Encoded records not yet written
+    bool append_;
+    bool header_pending_;    // Current file still needs its header
+    size_t record_count_;
+    uint64_t bytes_written_;
+
+    /**
+     * Open a file; a new or empty file gets the codec header
+     * @param append Keep existing content (append_ or a revisited segment)
+     */
+    bool open_file(const std::string& filename, bool append) {
+        bool has_content = false;
+        if (append) {
+            std::ifstream check(filename, std::ios::binary | std::ios::ate);
+            has_content = check.is_open() && check.tellg() > 0;
+        }
+
+        auto mode = append ? (std::ios::out | std::ios::app) : std::ios::out;
+        file_.open(filename, mode);
+        if (!file_.is_open()) {
+            std::cerr << "Error: Cannot open file for writing: " << filename << std::endl;
+            return false;
+        }
+
+        header_pending_ = !has_content;
+        return true;
+    }
+
+    // ========================================================================
+    // CRTP Interface Implementation (required by FlushSegmentMixin)
+    // ========================================================================
+
+    /**
+     * Buffered bytes (get_record_size() is 1, so thresholds are in bytes)
+     */
+    size_t get_buffer_size() const {
+        return buffer_.size();
+    }
+
+    size_t get_record_size() const {
+        return 1;
+    }
+
+    std::string get_file_extension() const {
+        return Codec::extension();
+    }
+
+    void perform_flush() {
+        if (!file_.is_open() || buffer_.empty()) {
+            return;
+        }
+
+        file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        file_.flush();
+        bytes_written_ += buffer_.size();
+
+        // Capacity is kept for the next batch
+        buffer_.clear();
+    }
+
+    void perform_segment_transition(const std::string& new_filename) {
+        if (file_.is_open()) {
+            file_.close();
+        }
+        // A late record leading back to an earlier segment must not truncate it
+        if (!open_file(new_filename, append_ || this->segment_entered(new_filename))) {
+            std::cerr << "Error: Cannot open segment file: " << new_filename << std::endl;
+        }
+    }
+
+    void on_segment_mode_set() {
+        // Create first segment file when segmentation is enabled
+        perform_segment_transition(this->current_segment_filename_);
+    }
+};
+
+/**
+ * Per-symbol files, one BufferedWriter each
+ * Files are named <base>_<SYMBOL>.<ext> ("/" in symbols becomes "_").
+ * Configuration applies to existing and future writers.
+ */
+template<typename Record, typename Codec>
+class MultiFileWriter {
+public:
+    typedef BufferedWriter<Record, Codec> Writer;
+
+    /**
+     * Constructor
+     * @param base_filename Base filename (will be appended with symbol)
+     * @param append Append to existing per-symbol files
+     * @param codec Codec copied into every writer
+     */
+    explicit MultiFileWriter(const std::string& base_filename, bool append = false,
+                             const Codec& codec = Codec())
+        : base_filename_(base_filename),
+          append_(append),
+          codec_(codec),
+          flush_interval_(30),                           // Default: 30 seconds
+          memory_threshold_bytes_(10 * 1024 * 1024),    // Default: 10 MB
+          segment_mode_(SegmentMode::NONE),
+          segment_clock_(SegmentClock::WALL_CLOCK) {
+    }
+
+    /**
+     * Destructor - flushes and closes all files
+     */
+    ~MultiFileWriter() {
+        for (auto& pair : writers_) {
+            delete pair.second;
+        }
+        writers_.clear();
+    }
+
+    // Non-copyable (owns the writers)
+    MultiFileWriter(const MultiFileWriter&) = delete;
+    MultiFileWriter& operator=(const MultiFileWriter&) = delete;
+
+    /**
+     * Write record to the file of its symbol
+     */
+    bool write(const Record& record) {
+        Writer* writer = get_writer(record.symbol);
+        if (!writer) {
+            return false;
+        }
+        return writer->write(record);
+    }
+
+    /**
+     * Flush all files
+     */
+    void flush_all() {
+        for (auto& pair : writers_) {
+            pair.second->flush();
+        }
+    }
+
+    /**
+     * Get number of files open
+     */
+    size_t get_file_count() const {
+        return writers_.size();
+    }
+
+    /**
+     * Get total records written across all files
+     */
+    size_t get_total_record_count() const {
+        size_t total = 0;
+        for (const auto& pair : writers_) {
+            total += pair.second->get_record_count();
+        }
+        return total;
+    }
+
+    // ========================================================================
+    // Flush Configuration (applies to all writers)
+    // ========================================================================
+
+    void set_flush_interval(std::chrono::seconds interval) {
+        flush_interval_ = interval;
+        for (auto& pair : writers_) {
+            pair.second->set_flush_interval(interval);
+        }
+    }
+
+    void set_memory_threshold(size_t bytes) {
+        memory_threshold_bytes_ = bytes;
+        for (auto& pair : writers_) {
+            pair.second->set_memory_threshold(bytes);
+        }
+    }
+
+    size_t get_total_flush_count() const {
+        size_t total = 0;
+        for (const auto& pair : writers_) {
+            total += pair.second->get_flush_count();
+        }
+        return total;
+    }
+
+    size_t get_total_memory_usage() const {
+        size_t total = 0;
+        for (const auto& pair : writers_) {
+            total += pair.second->get_current_memory_usage();
+        }
+        return total;
+    }
+
+    // ========================================================================
+    // Segmentation Configuration (applies to all writers)
+    // ========================================================================
+
+    /**
+     * Set segment clock for all writers (call before set_segment_mode)
+     */
+    void set_segment_clock(SegmentClock clock) {
+        segment_clock_ = clock;
+        for (auto& pair : writers_) {
+            pair.second->set_segment_clock(clock);
+        }
+    }
+
+    void set_segment_mode(SegmentMode mode) {
+        segment_mode_ = mode;
+        for (auto& pair : writers_) {
+            pair.second->set_segment_mode(mode);
+        }
+    }
+
+    size_t get_total_segment_count() const {
+        size_t total = 0;
+        for (const auto& pair : writers_) {
+            total += pair.second->get_segment_count();
+        }
+        return total;
+    }
+
+private:
+    std::string base_filename_;
+    bool append_;
+    Codec codec_;
+    std::map<std::string, Writer*> writers_;
+
+    // Configuration to apply to all new writers
+    std::chrono::seconds flush_interval_;
+    size_t memory_threshold_bytes_;
+    SegmentMode segment_mode_;
+    SegmentClock segment_clock_;
+
+    /**
+     * Get or create writer for symbol
+     */
+    Writer* get_writer(const std::string& symbol) {
+        auto it = writers_.find(symbol);
+        if (it != writers_.end()) {
+            return it->second;
+        }
+
+        Writer* writer = new Writer(create_filename(symbol), append_, codec_);
+        writer->set_flush_interval(flush_interval_);
+        writer->set_memory_threshold(memory_threshold_bytes_);
+        writer->set_segment_clock(segment_clock_);
+        writer->set_segment_mode(segment_mode_);  // Opens the first segment
+
+        if (segment_mode_ == SegmentMode::NONE && !writer->open()) {
+            delete writer;
+            return nullptr;
+        }
+
+        writers_[symbol] = writer;
+        return writer;
+    }
+
+    /**
+     * Create filename for symbol
+     * E.g., "orderbook.jsonl" + "BTC/USD" -> "orderbook_BTC_USD.jsonl"
+     */
+    std::string create_filename(const std::string& symbol) const {
+        std::string sanitized = symbol;
+        for (char& c : sanitized) {
+            if (c == '/') {
+                c = '_';
+            }
+        }
+
+        // Remove extension from base if present
+        std::string extension = Codec::extension();
+        std::string base = base_filename_;
+        if (base.size() > extension.size() &&
+            base.compare(base.size() - extension.size(), extension.size(), extension) == 0) {
+            base = base.substr(0, base.size() - extension.size());
+        }
+
+        return base + "_" + sanitized + extension;
+    }
+};
+
+} // namespace kraken
+
+#endif // BUFFERED_WRITER_HPP
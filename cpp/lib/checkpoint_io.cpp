@@ -0,0 +1,170 @@
+/**
+ * Checkpoint I/O - Implementation
+ */
+
+#include "checkpoint_io.hpp"
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+
+namespace kraken {
+
+namespace {
+
+const char MAGIC[8] = {'K', 'R', 'K', 'N', 'C', 'K', 'P', 'T'};
+
+} // anonymous namespace
+
+// ============================================================================
+// CheckpointWriter Implementation
+// ============================================================================
+
+CheckpointWriter::CheckpointWriter(const std::string& kind) {
+    put_raw(MAGIC, sizeof(MAGIC));
+    put_u32(VERSION);
+    put_string(kind);
+}
+
+void CheckpointWriter::put_raw(const void* data, size_t len) {
+    buffer_.append(static_cast<const char*>(data), len);
+}
+
+void CheckpointWriter::put_u8(uint8_t value) {
+    put_raw(&value, sizeof(value));
+}
+
+void CheckpointWriter::put_u32(uint32_t value) {
+    put_raw(&value, sizeof(value));
+}
+
+void CheckpointWriter::put_u64(uint64_t value) {
+    put_raw(&value, sizeof(value));
+}
+
+void CheckpointWriter::put_i32(int32_t value) {
+    put_raw(&value, sizeof(value));
+}
+
+void CheckpointWriter::put_f64(double value) {
+    put_raw(&value, sizeof(value));
+}
+
+void CheckpointWriter::put_string(const std::string& value) {
+    put_u32(static_cast<uint32_t>(value.size()));
+    put_raw(value.data(), value.size());
+}
+
+bool CheckpointWriter::write_file(const std::string& path, std::string& error) const {
+    std::string tmp_path = path + ".tmp";
+    {
+        std::ofstream out(tmp_path, std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            error = "Cannot open checkpoint for writing: " + tmp_path;
+            return false;
+        }
+        out.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+        out.flush();
+        if (!out.good()) {
+            error = "Write failed: " + tmp_path;
+            return false;
+        }
+    }
+
+    if (std::rename(tmp_path.c_str(), path.c_str()) != 0) {
+        error = "Cannot rename " + tmp_path + " to " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+// ============================================================================
+// CheckpointReader Implementation
+// ============================================================================
+
+CheckpointReader::CheckpointReader() : pos_(0), ok_(true) {}
+
+bool CheckpointReader::load_file(const std::string& path, const std::string& kind, std::string& error) {
+    std::ifstream in(path, std::ios::in | std::ios::binary);
+    if (!in.is_open()) {
+        error = "Cannot open checkpoint: " + path;
+        return false;
+    }
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    buffer_ = contents.str();
+    pos_ = 0;
+    ok_ = true;
+
+    char magic[sizeof(MAGIC)];
+    if (!get_raw(magic, sizeof(magic)) || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        error = "Not a checkpoint file: " + path;
+        return false;
+    }
+    uint32_t version = get_u32();
+    if (!ok_ || version != CheckpointWriter::VERSION) {
+        error = "Unsupported checkpoint version " + std::to_string(version) + ": " + path;
+        return false;
+    }
+    std::string file_kind = get_string();
+    if (!ok_ || file_kind != kind) {
+        error = "Checkpoint " + path + " holds '" + file_kind + "' state, expected '" + kind + "'";
+        return false;
+    }
+    return true;
+}
+
+bool CheckpointReader::get_raw(void* data, size_t len) {
+    if (!ok_ || buffer_.size() - pos_ < len) {
+        ok_ = false;
+        std::memset(data, 0, len);
+        return false;
+    }
+    std::memcpy(data, buffer_.data() + pos_, len);
+    pos_ += len;
+    return true;
+}
+
+uint8_t CheckpointReader::get_u8() {
+    uint8_t value;
+    get_raw(&value, sizeof(value));
+    return value;
+}
+
+uint32_t CheckpointReader::get_u32() {
+    uint32_t value;
+    get_raw(&value, sizeof(value));
+    return value;
+}
+
+uint64_t CheckpointReader::get_u64() {
+    uint64_t value;
+    get_raw(&value, sizeof(value));
+    return value;
+}
+
+int32_t CheckpointReader::get_i32() {
+    int32_t value;
+    get_raw(&value, sizeof(value));
+    return value;
+}
+
+double CheckpointReader::get_f64() {
+    double value;
+    get_raw(&value, sizeof(value));
+    return value;
+}
+
+std::string CheckpointReader::get_string() {
+    uint32_t len = get_u32();
+    if (!ok_ || buffer_.size() - pos_ < len) {
+        ok_ = false;
+        return std::string();
+    }
+    std::string value = buffer_.substr(pos_, len);
+    pos_ += len;
+    return value;
+}
+
+} // namespace kraken
@@ -0,0 +1,94 @@
+/**
+ * Checkpoint I/O
+ *
+ * Compact binary encoding for processing checkpoints (book state, sample
+ * timers, counters) so offline tools can resume where the previous run
+ * stopped instead of re-reading earlier segments.
+ *
+ * File layout:
+ *   "KRKNCKPT"  magic (8 bytes)
+ *   u32         format version
+ *   string      kind (e.g. "book", "level3"), checked on load
+ *   ...         payload written by the caller
+ *
+ * Integers and doubles are stored in host byte order (checkpoints are
+ * resumed on the machine family that wrote them); strings are a u32 length
+ * followed by the bytes. Files are written to "<path>.tmp" and renamed, so
+ * a crash never leaves a truncated checkpoint behind.
+ */
+
+#ifndef CHECKPOINT_IO_HPP
+#define CHECKPOINT_IO_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace kraken {
+
+/**
+ * Append-only checkpoint encoder
+ */
+class CheckpointWriter {
+public:
+    static const uint32_t VERSION = 2;
+
+    explicit CheckpointWriter(const std::string& kind);
+
+    void put_u8(uint8_t value);
+    void put_u32(uint32_t value);
+    void put_u64(uint64_t value);
+    void put_i32(int32_t value);
+    void put_f64(double value);
+    void put_string(const std::string& value);
+
+    /**
+     * Write atomically (temporary file + rename)
+     * @return false with error set on failure
+     */
+    bool write_file(const std::string& path, std::string& error) const;
+
+    size_t size() const { return buffer_.size(); }
+
+private:
+    std::string buffer_;
+
+    void put_raw(const void* data, size_t len);
+};
+
+/**
+ * Checkpoint decoder
+ * Reads past the end or into a malformed field set a sticky failure flag
+ * and return zero values; check ok() once after decoding.
+ */
+class CheckpointReader {
+public:
+    CheckpointReader();
+
+    /**
+     * Load and verify magic, version and kind
+     * @return false with error set (missing file, wrong kind, corrupt)
+     */
+    bool load_file(const std::string& path, const std::string& kind, std::string& error);
+
+    uint8_t get_u8();
+    uint32_t get_u32();
+    uint64_t get_u64();
+    int32_t get_i32();
+    double get_f64();
+    std::string get_string();
+
+    bool ok() const { return ok_; }
+    bool at_end() const { return pos_ == buffer_.size(); }
+
+private:
+    std::string buffer_;
+    size_t pos_;
+    bool ok_;
+
+    bool get_raw(void* data, size_t len);
+};
+
+} // namespace kraken
+
+#endif // CHECKPOINT_IO_HPP
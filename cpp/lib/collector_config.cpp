@@ -0,0 +1,333 @@
+/**
+ * Collector Configuration - Implementation
+ */
+
+#include "collector_config.hpp"
+#include "cli_utils.hpp"
+#include <fstream>
+#include <sstream>
+#include <set>
+#include <limits>
+
+namespace kraken {
+
+namespace {
+
+bool parse_bool(const std::string& value, bool& out) {
+    if (value == "true" || value == "yes" || value == "1" || value == "on") {
+        out = true;
+        return true;
+    }
+    if (value == "false" || value == "no" || value == "0" || value == "off") {
+        out = false;
+        return true;
+    }
+    return false;
+}
+
+bool parse_long(const std::string& value, long long& out) {
+    try {
+        size_t pos = 0;
+        out = std::stoll(value, &pos);
+        return pos == value.size() && out >= 0;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+std::string strip_comment(const std::string& line) {
+    // Full-line comments, or " #" / " ;" after a value
+    size_t pos = line.find(" #");
+    size_t semi = line.find(" ;");
+    if (semi < pos) {
+        pos = semi;
+    }
+    return pos == std::string::npos ? line : line.substr(0, pos);
+}
+
+bool is_valid_depth(CollectorChannel channel, int depth) {
+    // Depths the exchange accepts per channel
+    if (channel == CollectorChannel::LEVEL3) {
+        return depth == 10 || depth == 100 || depth == 1000;
+    }
+    return depth == 10 || depth == 25 || depth == 100 || depth == 500 || depth == 1000;
+}
+
+} // anonymous namespace
+
+bool CollectorConfigParser::parse_file(const std::string& filepath, CollectorConfig& config,
+                                       std::string& error_message) {
+    std::ifstream file(filepath);
+    if (!file.is_open()) {
+        error_message = "Cannot open config file: " + filepath;
+        return false;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    return parse_string(buffer.str(), config, error_message);
+}
+
+bool CollectorConfigParser::parse_string(const std::string& text, CollectorConfig& config,
+                                         std::string& error_message) {
+    config = CollectorConfig();
+
+    enum class Section { NONE, COLLECTOR, GROUP };
+    Section section = Section::NONE;
+
+    std::istringstream input(text);
+    std::string raw_line;
+    int line_num = 0;
+
+    while (std::getline(input, raw_line)) {
+        line_num++;
+        std::string line = cli::StringUtils::trim(raw_line);
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+        line = cli::StringUtils::trim(strip_comment(line));
+
+        std::string prefix = "line " + std::to_string(line_num) + ": ";
+
+        // Section header
+        if (line.front() == '[') {
+            if (line.back() != ']') {
+                error_message = prefix + "unterminated section header";
+                return false;
+            }
+            std::string header = cli::StringUtils::trim(line.substr(1, line.size() - 2));
+
+            if (header == "collector") {
+                section = Section::COLLECTOR;
+            } else if (header.compare(0, 6, "group ") == 0) {
+                ChannelGroupConfig group;
+                group.name = cli::StringUtils::trim(header.substr(6));
+                config.groups.push_back(group);
+                section = Section::GROUP;
+            } else {
+                error_message = prefix + "unknown section [" + header + "]";
+                return false;
+            }
+            continue;
+        }
+
+        // key = value
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            error_message = prefix + "expected key = value";
+            return false;
+        }
+        std::string key = cli::StringUtils::trim(line.substr(0, eq));
+        std::string value = cli::StringUtils::trim(line.substr(eq + 1));
+
+        std::string key_error;
+        bool ok = false;
+        if (section == Section::COLLECTOR) {
+            ok = apply_collector_key(config, key, value, key_error);
+        } else if (section == Section::GROUP) {
+            ok = apply_group_key(config.groups.back(), key, value, key_error);
+        } else {
+            key_error = "key outside of a section";
+        }
+
+        if (!ok) {
+            error_message = prefix + key_error;
+            return false;
+        }
+    }
+
+    return validate(config, error_message);
+}
+
+bool CollectorConfigParser::apply_collector_key(CollectorConfig& config, const std::string& key,
+                                                const std::string& value, std::string& error_message) {
+    if (key == "io_placement") {
+        return ThreadPlacement::parse(value, config.io_placement, error_message);
+    }
+    if (key == "writer_placement") {
+        return ThreadPlacement::parse(value, config.writer_placement, error_message);
+    }
+    if (key == "parse_placement") {
+        return ThreadPlacement::parse(value, config.parse_placement, error_message);
+    }
+
+    if (key == "deflate" || key == "tcp_nodelay" || key == "io_spin") {
+        bool& flag = key == "deflate" ? config.deflate
+                   : key == "tcp_nodelay" ? config.socket_options.tcp_nodelay
+                   : config.io_spin;
+        if (!parse_bool(value, flag)) {
+            error_message = "invalid boolean for " + key + ": " + value;
+            return false;
+        }
+        return true;
+    }
+
+    long long number = 0;
+    if (!parse_long(value, number)) {
+        error_message = "invalid number for " + key + ": " + value;
+        return false;
+    }
+
+    // Timeouts are given in seconds and stored in milliseconds
+    bool seconds_to_ms = key == "stale_timeout" || key == "symbol_stale_timeout" ||
+                         key == "ping_interval" || key == "pong_timeout";
+    long long limit = std::numeric_limits<int>::max();
+    if (seconds_to_ms) {
+        limit /= 1000;
+    }
+    if (number > limit) {
+        error_message = key + " out of range: " + value;
+        return false;
+    }
+
+    if (key == "io_threads") {
+        config.io_threads = static_cast<size_t>(number);
+    } else if (key == "writer_threads") {
+        config.writer_threads = static_cast<size_t>(number);
+    } else if (key == "parse_threads") {
+        config.parse_threads = static_cast<size_t>(number);
+    } else if (key == "status_interval") {
+        config.status_interval_seconds = static_cast<int>(number);
+    } else if (key == "rcvbuf" || key == "busy_poll") {
+        int& option = key == "rcvbuf" ? config.socket_options.rcvbuf_bytes : config.socket_options.busy_poll_us;
+        option = static_cast<int>(number);
+    } else if (key == "stale_timeout") {
+        config.watchdog.connection_stale_ms = static_cast<int>(number * 1000);
+    } else if (key == "symbol_stale_timeout") {
+        config.watchdog.symbol_stale_ms = static_cast<int>(number * 1000);
+    } else if (key == "ping_interval") {
+        config.watchdog.ping_interval_ms = static_cast<int>(number * 1000);
+    } else if (key == "pong_timeout") {
+        config.watchdog.pong_timeout_ms = static_cast<int>(number * 1000);
+    } else {
+        error_message = "unknown collector key: " + key;
+        return false;
+    }
+    return true;
+}
+
+bool CollectorConfigParser::apply_group_key(ChannelGroupConfig& group, const std::string& key,
+                                            const std::string& value, std::string& error_message) {
+    long long number = 0;
+
+    if (key == "channel") {
+        if (value == "ticker") {
+            group.channel = CollectorChannel::TICKER;
+        } else if (value == "book") {
+            group.channel = CollectorChannel::BOOK;
+        } else if (value == "level3") {
+            group.channel = CollectorChannel::LEVEL3;
+        } else {
+            error_message = "unknown channel: " + value + " (expected ticker, book or level3)";
+            return false;
+        }
+    } else if (key == "symbols") {
+        group.symbols_spec = value;
+    } else if (key == "output") {
+        group.output = value;
+    } else if (key == "token_file") {
+        group.token_file = value;
+    } else if (key == "checksum_precision") {
+        if (!parse_checksum_precision(value, group.checksum_precision, error_message)) {
+            return false;
+        }
+    } else if (key == "separate_files" || key == "validate_checksum") {
+        bool flag = false;
+        if (!parse_bool(value, flag)) {
+            error_message = "invalid boolean for " + key + ": " + value;
+            return false;
+        }
+        (key == "separate_files" ? group.separate_files : group.validate_checksum) = flag;
+    } else if (key == "segment") {
+        if (value == "none") {
+            group.segment_mode = SegmentMode::NONE;
+        } else if (value == "hourly") {
+            group.segment_mode = SegmentMode::HOURLY;
+        } else if (value == "daily") {
+            group.segment_mode = SegmentMode::DAILY;
+        } else {
+            error_message = "unknown segment mode: " + value + " (expected none, hourly or daily)";
+            return false;
+        }
+    } else if (key == "depth" || key == "flush_interval" || key == "memory_threshold") {
+        if (!parse_long(value, number)) {
+            error_message = "invalid number for " + key + ": " + value;
+            return false;
+        }
+        if (key != "memory_threshold" && number > std::numeric_limits<int>::max()) {
+            error_message = key + " out of range: " + value;
+            return false;
+        }
+        if (key == "depth") {
+            group.depth = static_cast<int>(number);
+        } else if (key == "flush_interval") {
+            group.flush_interval_seconds = static_cast<int>(number);
+        } else {
+            group.memory_threshold_bytes = static_cast<size_t>(number);
+        }
+    } else {
+        error_message = "unknown group key: " + key;
+        return false;
+    }
+    return true;
+}
+
+bool CollectorConfigParser::validate(CollectorConfig& config, std::string& error_message) {
+    if (config.groups.empty()) {
+        error_message = "no [group NAME] sections";
+        return false;
+    }
+
+    std::set<std::string> names;
+    std::set<std::string> outputs;
+
+    for (auto& group : config.groups) {
+        std::string prefix = "group '" + group.name + "': ";
+
+        if (group.name.empty()) {
+            error_message = "group without a name";
+            return false;
+        }
+        if (!names.insert(group.name).second) {
+            error_message = prefix + "duplicate group name";
+            return false;
+        }
+        if (group.symbols_spec.empty()) {
+            error_message = prefix + "missing symbols";
+            return false;
+        }
+        if (group.output.empty()) {
+            error_message = prefix + "missing output";
+            return false;
+        }
+        if (!outputs.insert(group.output).second) {
+            error_message = prefix + "output " + group.output + " is used by another group";
+            return false;
+        }
+        if (group.channel != CollectorChannel::TICKER && !is_valid_depth(group.channel, group.depth)) {
+            error_message = prefix + "invalid depth " + std::to_string(group.depth) + " (expected " +
+                            (group.channel == CollectorChannel::LEVEL3 ? "10, 100 or 1000"
+                                                                       : "10, 25, 100, 500 or 1000") + ")";
+            return false;
+        }
+
+        auto result = cli::InputParser::parse(group.symbols_spec);
+        if (!result.success) {
+            error_message = prefix + result.error_message;
+            return false;
+        }
+        group.symbols = result.values;
+    }
+    return true;
+}
+
+const char* CollectorConfigParser::channel_name(CollectorChannel channel) {
+    switch (channel) {
+        case CollectorChannel::TICKER: return "ticker";
+        case CollectorChannel::BOOK:   return "book";
+        case CollectorChannel::LEVEL3: return "level3";
+    }
+    return "unknown";
+}
+
+} // namespace kraken
@@ -0,0 +1,159 @@
+/**
+ * Collector Configuration
+ *
+ * INI-style configuration for kraken_collector: one [collector] section
+ * with process-wide settings and one [group NAME] section per channel /
+ * symbol group.
+ *
+ * Example:
+ *   [collector]
+ *   io_threads = 2            # Shared WebSocket I/O threads
+ *   writer_threads = 2        # Shared writer pool lanes
+ *   parse_threads = 0         # Level3 parser threads per group (0 = on the I/O thread)
+ *   status_interval = 10      # Seconds between [METRICS] reports (0 = off)
+ *   deflate = false           # Offer permessage-deflate (bandwidth vs inflate CPU)
+ *   tcp_nodelay = true        # Socket options for every connection
+ *   rcvbuf = 4194304          # SO_RCVBUF bytes (0 = kernel autotuning)
+ *   busy_poll = 0             # SO_BUSY_POLL microseconds (0 = off)
+ *   stale_timeout = 30        # Feed watchdog for every group, seconds
+ *   symbol_stale_timeout = 0  #   (0 = off): no frame -> reconnect, no data for
+ *   ping_interval = 10        #   a symbol -> resubscribe, ping RTT, unanswered
+ *   pong_timeout = 10         #   ping -> reconnect
+ *   io_placement = 2-3:fifo:50  # I/O / writer thread CPUs and policy
+ *   writer_placement = 4-5      #   (see thread_placement.hpp)
+ *   parse_placement = 6-7       #   Level3 parser threads
+ *   io_spin = false           # I/O threads spin on poll() (dedicated cores)
+ *
+ *   [group majors_book]
+ *   channel = book            # ticker | book | level3
+ *   symbols = BTC/USD,ETH/USD # Any InputParser spec (list, file.csv:col, file.txt)
+ *   depth = 10                # book: 10, 25, 100, 500, 1000; level3: 10, 100, 1000
+ *   output = majors_book.jsonl
+ *   separate_files = true
+ *   segment = hourly          # none | hourly | daily
+ *   flush_interval = 30       # Seconds (0 = disabled)
+ *   memory_threshold = 10485760
+ *
+ *   [group majors_l3]
+ *   channel = level3
+ *   symbols = BTC/USD
+ *   output = majors_l3.jsonl
+ *   token_file = ws_token.txt   # Default: KRAKEN_WS_TOKEN
+ *   validate_checksum = true
+ *   checksum_precision = BTC/USD=1,8   # From the instrument channel
+ *
+ * Lines starting with '#' or ';' are comments, as is anything after " #".
+ */
+
+#ifndef COLLECTOR_CONFIG_HPP
+#define COLLECTOR_CONFIG_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "flush_segment_mixin.hpp"
+#include "socket_tuning.hpp"
+#include "feed_watchdog.hpp"
+#include "thread_placement.hpp"
+#include "level3_common.hpp"
+
+namespace kraken {
+
+/**
+ * Kraken WebSocket v2 channel collected by a group
+ */
+enum class CollectorChannel {
+    TICKER,
+    BOOK,
+    LEVEL3
+};
+
+/**
+ * One channel / symbol group (one WebSocket connection)
+ */
+struct ChannelGroupConfig {
+    std::string name;
+    CollectorChannel channel;
+    std::string symbols_spec;           // As written in the file
+    std::vector<std::string> symbols;   // Resolved via InputParser
+    int depth;
+
+    // Output layout
+    std::string output;
+    bool separate_files;
+
+    // Flush / segment policy
+    SegmentMode segment_mode;
+    int flush_interval_seconds;
+    size_t memory_threshold_bytes;
+
+    // Level 3 only
+    std::string token_file;
+    bool validate_checksum;
+    ChecksumPrecisionMap checksum_precision;   // Symbols without one are not verified
+
+    ChannelGroupConfig()
+        : channel(CollectorChannel::BOOK), depth(10), separate_files(false),
+          segment_mode(SegmentMode::NONE), flush_interval_seconds(30),
+          memory_threshold_bytes(10 * 1024 * 1024), validate_checksum(false) {}
+};
+
+/**
+ * Whole collector configuration
+ */
+struct CollectorConfig {
+    size_t io_threads;
+    size_t writer_threads;
+    size_t parse_threads;
+    int status_interval_seconds;
+    bool deflate;
+    SocketOptions socket_options;
+    WatchdogConfig watchdog;
+    ThreadPlacement io_placement;
+    ThreadPlacement writer_placement;
+    ThreadPlacement parse_placement;
+    bool io_spin;
+    std::vector<ChannelGroupConfig> groups;
+
+    CollectorConfig()
+        : io_threads(1), writer_threads(1), parse_threads(0), status_interval_seconds(10),
+          deflate(false), io_spin(false) {}
+};
+
+/**
+ * Collector configuration parser
+ */
+class CollectorConfigParser {
+public:
+    /**
+     * Parse configuration file
+     * @param filepath Path to the configuration file
+     * @param config Filled on success
+     * @param error_message Set on failure (with line number where possible)
+     * @return true on success
+     */
+    static bool parse_file(const std::string& filepath, CollectorConfig& config,
+                           std::string& error_message);
+
+    /**
+     * Parse configuration text (same format as parse_file)
+     */
+    static bool parse_string(const std::string& text, CollectorConfig& config,
+                             std::string& error_message);
+
+    /**
+     * Channel name ("ticker", "book", "level3")
+     */
+    static const char* channel_name(CollectorChannel channel);
+
+private:
+    static bool apply_collector_key(CollectorConfig& config, const std::string& key,
+                                    const std::string& value, std::string& error_message);
+    static bool apply_group_key(ChannelGroupConfig& group, const std::string& key,
+                                const std::string& value, std::string& error_message);
+    static bool validate(CollectorConfig& config, std::string& error_message);
+};
+
+} // namespace kraken
+
+#endif // COLLECTOR_CONFIG_HPP
@@ -0,0 +1,264 @@
+/**
+ * CSV Scanner - Implementation
+ */
+
+#include "csv_scanner.hpp"
+#include <charconv>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace kraken {
+
+namespace {
+
+/**
+ * Fixed-width unsigned decimal (false on a non-digit)
+ */
+inline bool parse_digits(const char* p, int count, int& out) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        unsigned digit = static_cast<unsigned>(p[i] - '0');
+        if (digit > 9) {
+            return false;
+        }
+        value = value * 10 + static_cast<int>(digit);
+    }
+    out = value;
+    return true;
+}
+
+/**
+ * Days since 1970-01-01 of a proleptic Gregorian date
+ */
+inline int64_t days_from_civil(int year, int month, int day) {
+    year -= month <= 2 ? 1 : 0;
+    int64_t era = (year >= 0 ? year : year - 399) / 400;
+    int64_t year_of_era = year - era * 400;
+    int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+} // anonymous namespace
+
+CsvScanner::CsvScanner() : data_(nullptr), size_(0), pos_(0), row_number_(0) {}
+
+CsvScanner::~CsvScanner() {
+    close();
+}
+
+bool CsvScanner::open(const std::string& path, std::string& error) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Cannot open file: " + path;
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        error = "Empty or unreadable file: " + path;
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  // The mapping stays valid
+    if (mapping == MAP_FAILED) {
+        error = "Cannot map file: " + path;
+        return false;
+    }
+    madvise(mapping, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+
+    data_ = static_cast<const char*>(mapping);
+    size_ = static_cast<size_t>(info.st_size);
+    pos_ = 0;
+    row_number_ = 0;
+
+    // Header row
+    scan_row();
+    columns_.clear();
+    for (size_t i = 0; i < field_begin_.size(); i++) {
+        columns_.emplace_back(field_begin_[i], field_end_[i]);
+    }
+    field_begin_.clear();
+    field_end_.clear();
+    return true;
+}
+
+void CsvScanner::close() {
+    if (data_) {
+        munmap(const_cast<char*>(data_), size_);
+        data_ = nullptr;
+    }
+    size_ = 0;
+    pos_ = 0;
+    row_number_ = 0;
+    columns_.clear();
+    field_begin_.clear();
+    field_end_.clear();
+}
+
+int CsvScanner::column(const std::string& name) const {
+    for (size_t i = 0; i < columns_.size(); i++) {
+        if (columns_[i] == name) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+bool CsvScanner::next_row() {
+    while (pos_ < size_) {
+        scan_row();
+        if (field_begin_.size() > 1 || field_begin_[0] != field_end_[0]) {
+            row_number_++;
+            return true;
+        }
+        // Blank line
+    }
+    field_begin_.clear();
+    field_end_.clear();
+    return false;
+}
+
+inline void CsvScanner::add_field(const char* begin, const char* end) {
+    field_begin_.push_back(begin);
+    field_end_.push_back(end);
+}
+
+void CsvScanner::scan_row() {
+    field_begin_.clear();
+    field_end_.clear();
+
+    const char* p = data_ + pos_;
+    const char* end = data_ + size_;
+    const char* field_start = p;
+
+#if defined(__SSE2__)
+    // 16 bytes per step: one bit per ',' or '\n'
+    const __m128i comma = _mm_set1_epi8(',');
+    const __m128i newline = _mm_set1_epi8('\n');
+    while (p + 16 <= end) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, comma), _mm_cmpeq_epi8(chunk, newline))));
+        while (mask != 0) {
+            const char* delimiter = p + __builtin_ctz(mask);
+            if (*delimiter == '\n') {
+                const char* field_end = delimiter;
+                if (field_end > field_start && field_end[-1] == '\r') {
+                    field_end--;
+                }
+                add_field(field_start, field_end);
+                pos_ = static_cast<size_t>(delimiter + 1 - data_);
+                return;
+            }
+            add_field(field_start, delimiter);
+            field_start = delimiter + 1;
+            mask &= mask - 1;
+        }
+        p += 16;
+    }
+#endif
+
+    // Tail (or the whole row without SSE2)
+    for (; p < end; ++p) {
+        if (*p == '\n') {
+            const char* field_end = p;
+            if (field_end > field_start && field_end[-1] == '\r') {
+                field_end--;
+            }
+            add_field(field_start, field_end);
+            pos_ = static_cast<size_t>(p + 1 - data_);
+            return;
+        }
+        if (*p == ',') {
+            add_field(field_start, p);
+            field_start = p + 1;
+        }
+    }
+
+    // Last row without a newline
+    add_field(field_start, end);
+    pos_ = size_;
+}
+
+bool CsvScanner::field(int index, const char*& begin, const char*& end) const {
+    if (index < 0 || static_cast<size_t>(index) >= field_begin_.size()) {
+        return false;
+    }
+    begin = field_begin_[index];
+    end = field_end_[index];
+    return true;
+}
+
+bool CsvScanner::get_string(int index, std::string& out) const {
+    const char* begin;
+    const char* end;
+    if (!field(index, begin, end)) {
+        return false;
+    }
+    out.assign(begin, end);
+    return true;
+}
+
+bool CsvScanner::get_double(int index, double& out) const {
+    const char* begin;
+    const char* end;
+    return field(index, begin, end) && parse_double(begin, end, out);
+}
+
+bool CsvScanner::get_timestamp(int index, double& out) const {
+    const char* begin;
+    const char* end;
+    return field(index, begin, end) && parse_timestamp(begin, end, out);
+}
+
+bool CsvScanner::parse_double(const char* begin, const char* end, double& out) {
+    if (begin == end) {
+        return false;
+    }
+    auto result = std::from_chars(begin, end, out);
+    return result.ec == std::errc() && result.ptr == end;
+}
+
+bool CsvScanner::parse_timestamp(const char* begin, const char* end, double& out) {
+    // YYYY-MM-DD HH:MM:SS
+    if (end - begin < 19 || begin[4] != '-' || begin[7] != '-' ||
+        (begin[10] != ' ' && begin[10] != 'T') || begin[13] != ':' || begin[16] != ':') {
+        return false;
+    }
+
+    int year, month, day, hour, minute, second;
+    if (!parse_digits(begin, 4, year) || !parse_digits(begin + 5, 2, month) ||
+        !parse_digits(begin + 8, 2, day) || !parse_digits(begin + 11, 2, hour) ||
+        !parse_digits(begin + 14, 2, minute) || !parse_digits(begin + 17, 2, second)) {
+        return false;
+    }
+
+    // Optional fraction
+    double fraction = 0.0;
+    const char* p = begin + 19;
+    if (p < end && *p == '.') {
+        double scale = 0.1;
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            fraction += (*p - '0') * scale;
+            scale *= 0.1;
+        }
+    }
+
+    int64_t days = days_from_civil(year, month, day);
+    out = static_cast<double>(days * 86400 + hour * 3600 + minute * 60 + second) + fraction;
+    return true;
+}
+
+} // namespace kraken
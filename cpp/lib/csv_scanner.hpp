@@ -0,0 +1,140 @@
+/**
+ * CSV Scanner
+ *
+ * Streaming reader for the recorders' CSV files (ticker, trades) built for
+ * offline processing of large captures:
+ * - The file is memory-mapped and read sequentially; fields are returned
+ *   as pointers into the mapping (no per-row strings)
+ * - Delimiters (',' and '\n') are found 16 bytes at a time with SSE2
+ *   (scalar fallback on other targets)
+ * - Numbers are parsed with std::from_chars, timestamps without mktime()
+ *
+ * Quoting is not supported: the recorders never quote fields.
+ * cli::CSVParser remains the convenience reader for small files (pair lists).
+ *
+ * Usage:
+ *   CsvScanner scanner;
+ *   if (!scanner.open("ticker.csv", error)) { ... }
+ *   int bid = scanner.column("bid");
+ *   double value;
+ *   while (scanner.next_row()) {
+ *       if (scanner.get_double(bid, value)) { ... }
+ *   }
+ */
+
+#ifndef CSV_SCANNER_HPP
+#define CSV_SCANNER_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace kraken {
+
+/**
+ * Memory-mapped CSV reader with SIMD delimiter search
+ */
+class CsvScanner {
+public:
+    CsvScanner();
+    ~CsvScanner();
+
+    // Non-copyable (owns the mapping)
+    CsvScanner(const CsvScanner&) = delete;
+    CsvScanner& operator=(const CsvScanner&) = delete;
+
+    /**
+     * Map the file and read its header row
+     * @return false with error set if the file cannot be mapped or is empty
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * Unmap the file
+     */
+    void close();
+
+    /**
+     * Header column names
+     */
+    const std::vector<std::string>& columns() const { return columns_; }
+
+    /**
+     * Index of a header column (-1 if absent)
+     */
+    int column(const std::string& name) const;
+
+    /**
+     * Advance to the next non-empty row
+     * @return false at the end of the file
+     */
+    bool next_row();
+
+    /**
+     * Fields in the current row
+     */
+    size_t field_count() const { return field_begin_.size(); }
+
+    /**
+     * Field of the current row as a range (false if the row is shorter)
+     */
+    bool field(int index, const char*& begin, const char*& end) const;
+
+    /**
+     * Field of the current row as a string
+     */
+    bool get_string(int index, std::string& out) const;
+
+    /**
+     * Field of the current row as a double (false if empty or malformed)
+     */
+    bool get_double(int index, double& out) const;
+
+    /**
+     * Field of the current row as seconds since the epoch (see parse_timestamp)
+     */
+    bool get_timestamp(int index, double& out) const;
+
+    /**
+     * Data rows read so far (1-based number of the current row)
+     */
+    size_t row_number() const { return row_number_; }
+
+    /**
+     * Mapped file size in bytes
+     */
+    size_t size() const { return size_; }
+
+    /**
+     * Parse a decimal number with std::from_chars
+     */
+    static bool parse_double(const char* begin, const char* end, double& out);
+
+    /**
+     * Parse "YYYY-MM-DD HH:MM:SS[.fff]" (or with 'T') as UTC seconds
+     * since the epoch. Unlike mktime() it does not depend on the local time
+     * zone, and it is cheap enough to call per row.
+     */
+    static bool parse_timestamp(const char* begin, const char* end, double& out);
+
+private:
+    const char* data_;
+    size_t size_;
+    size_t pos_;
+    size_t row_number_;
+    std::vector<std::string> columns_;
+    std::vector<const char*> field_begin_;
+    std::vector<const char*> field_end_;
+
+    /**
+     * Split the row starting at pos_ into fields; advances pos_ past it
+     */
+    void scan_row();
+
+    void add_field(const char* begin, const char* end);
+};
+
+} // namespace kraken
+
+#endif // CSV_SCANNER_HPP
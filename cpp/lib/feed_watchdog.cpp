@@ -0,0 +1,221 @@
+/**
+ * Feed Watchdog - Implementation
+ */
+
+#include "feed_watchdog.hpp"
+#include <algorithm>
+
+namespace kraken {
+
+namespace {
+
+typedef std::chrono::milliseconds Ms;
+
+double elapsed_ms(FeedWatchdog::Clock::time_point from, FeedWatchdog::Clock::time_point to) {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+}
+
+} // namespace
+
+FeedWatchdog::FeedWatchdog(const WatchdogConfig& config)
+    : config_(config), ping_seq_(0), ping_outstanding_(false),
+      wheel_(WHEEL_SLOTS), origin_(Clock::now()), current_tick_(0) {
+
+    if (config_.check_interval_ms <= 0) {
+        config_.check_interval_ms = 1000;
+    }
+    last_frame_ = origin_;
+    last_ping_ = origin_;
+}
+
+void FeedWatchdog::reset(Clock::time_point now) {
+    last_frame_ = now;
+    last_ping_ = now;
+    ping_outstanding_ = false;
+
+    // Armed entries keep their slot and re-arm from the fresh timestamp
+    for (size_t i = 0; i < entries_.size(); ++i) {
+        Entry& entry = entries_[i];
+        if (!entry.watched) {
+            continue;
+        }
+        entry.last_data = now;
+        if (!entry.armed) {
+            arm(i, now + Ms(config_.symbol_stale_ms));
+        }
+    }
+}
+
+void FeedWatchdog::watch(const std::string& symbol, Clock::time_point now) {
+    if (config_.symbol_stale_ms <= 0) {
+        return;
+    }
+
+    auto it = index_.find(symbol);
+    size_t index;
+    if (it == index_.end()) {
+        index = entries_.size();
+        entries_.emplace_back();
+        entries_.back().symbol = symbol;
+        index_[symbol] = index;
+    } else {
+        index = it->second;
+    }
+
+    Entry& entry = entries_[index];
+    entry.watched = true;
+    entry.last_data = now;
+    if (!entry.armed) {
+        arm(index, now + Ms(config_.symbol_stale_ms));
+    }
+}
+
+void FeedWatchdog::unwatch(const std::string& symbol) {
+    auto it = index_.find(symbol);
+    if (it != index_.end()) {
+        entries_[it->second].watched = false;  // Leaves the wheel when its slot comes due
+    }
+}
+
+void FeedWatchdog::on_frame(Clock::time_point now) {
+    last_frame_ = now;
+}
+
+void FeedWatchdog::on_heartbeat() {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.heartbeats++;
+}
+
+void FeedWatchdog::on_data(const std::string& symbol) {
+    if (config_.symbol_stale_ms <= 0) {
+        return;
+    }
+
+    auto it = index_.find(symbol);
+    if (it == index_.end() || !entries_[it->second].watched) {
+        watch(symbol, last_frame_);
+        return;
+    }
+    entries_[it->second].last_data = last_frame_;
+}
+
+bool FeedWatchdog::next_ping(Clock::time_point now, std::string& payload) {
+    if (config_.ping_interval_ms <= 0 || ping_outstanding_) {
+        return false;
+    }
+    if (now - last_ping_ < Ms(config_.ping_interval_ms)) {
+        return false;
+    }
+
+    ping_payload_ = "wd" + std::to_string(++ping_seq_);
+    payload = ping_payload_;
+    ping_sent_ = now;
+    last_ping_ = now;
+    ping_outstanding_ = true;
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.pings_sent++;
+    return true;
+}
+
+void FeedWatchdog::on_pong(const std::string& payload, Clock::time_point now) {
+    last_frame_ = now;
+    if (!ping_outstanding_ || payload != ping_payload_) {
+        return;
+    }
+    ping_outstanding_ = false;
+
+    double rtt = elapsed_ms(ping_sent_, now);
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (stats_.pongs_received == 0 || rtt < stats_.min_rtt_ms) {
+        stats_.min_rtt_ms = rtt;
+    }
+    stats_.max_rtt_ms = std::max(stats_.max_rtt_ms, rtt);
+    stats_.last_rtt_ms = rtt;
+    stats_.total_rtt_ms += rtt;
+    stats_.pongs_received++;
+}
+
+FeedWatchdog::Action FeedWatchdog::check(Clock::time_point now, std::vector<std::string>& stale_symbols) {
+    stale_symbols.clear();
+
+    bool connection_stale = config_.connection_stale_ms > 0 &&
+                            now - last_frame_ >= Ms(config_.connection_stale_ms);
+    bool pong_overdue = config_.pong_timeout_ms > 0 && ping_outstanding_ &&
+                        now - ping_sent_ >= Ms(config_.pong_timeout_ms);
+    if (connection_stale || pong_overdue) {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        stats_.stale_connections++;
+        return Action::RECONNECT;
+    }
+
+    if (config_.symbol_stale_ms > 0) {
+        advance(now, stale_symbols);
+    }
+    if (stale_symbols.empty()) {
+        return Action::NONE;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.stale_symbols += stale_symbols.size();
+    return Action::RESUBSCRIBE;
+}
+
+WatchdogStats FeedWatchdog::get_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return stats_;
+}
+
+int64_t FeedWatchdog::tick_of(Clock::time_point tp, bool round_up) const {
+    int64_t ms = std::chrono::duration_cast<Ms>(tp - origin_).count();
+    int64_t interval = config_.check_interval_ms;
+    return round_up ? (ms + interval - 1) / interval : ms / interval;
+}
+
+void FeedWatchdog::arm(size_t index, Clock::time_point deadline) {
+    // Rounding up means a due slot never holds an entry before its deadline
+    Entry& entry = entries_[index];
+    entry.due_tick = std::max(tick_of(deadline, true), current_tick_ + 1);
+    entry.armed = true;
+    wheel_[static_cast<size_t>(entry.due_tick) % WHEEL_SLOTS].push_back(index);
+}
+
+void FeedWatchdog::advance(Clock::time_point now, std::vector<std::string>& stale_symbols) {
+    int64_t now_tick = tick_of(now, false);
+    if (now_tick <= current_tick_) {
+        return;
+    }
+
+    // One turn visits every slot, however long the timer was delayed
+    int64_t first = current_tick_ + 1;
+    int64_t last = std::min(now_tick, current_tick_ + static_cast<int64_t>(WHEEL_SLOTS));
+    current_tick_ = now_tick;  // Re-armed entries land after now
+
+    for (int64_t tick = first; tick <= last; ++tick) {
+        std::vector<size_t>& slot = wheel_[static_cast<size_t>(tick) % WHEEL_SLOTS];
+        due_.clear();
+        due_.swap(slot);
+
+        for (size_t index : due_) {
+            Entry& entry = entries_[index];
+            if (!entry.watched) {
+                entry.armed = false;
+                continue;
+            }
+            if (entry.due_tick > now_tick) {
+                slot.push_back(index);  // Later turn of the wheel
+                continue;
+            }
+
+            Clock::time_point deadline = entry.last_data + Ms(config_.symbol_stale_ms);
+            if (deadline <= now) {
+                stale_symbols.push_back(entry.symbol);
+                arm(index, now + Ms(config_.symbol_stale_ms));
+            } else {
+                arm(index, deadline);
+            }
+        }
+    }
+}
+
+} // namespace kraken
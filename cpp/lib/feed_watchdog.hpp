@@ -0,0 +1,190 @@
+/**
+ * Feed Watchdog
+ *
+ * Detects stalled feeds on one WebSocket connection. A half-open TCP
+ * connection delivers nothing and raises no error, so without a watchdog a
+ * recorder keeps "running" while writing nothing.
+ *
+ * Per connection:
+ *   - Last frame of any kind (data, heartbeat, pong); reconnect when older
+ *     than connection_stale_ms
+ *   - WebSocket ping/pong round trip; reconnect when a ping stays
+ *     unanswered for pong_timeout_ms
+ * Per symbol:
+ *   - Last data message; resubscribe the symbol when older than
+ *     symbol_stale_ms
+ *
+ * Symbol deadlines live in a hashed timer wheel. Data only refreshes the
+ * symbol's timestamp (no wheel operation); when a slot comes due its
+ * entries are either reported stale or re-armed at their real deadline, so
+ * a check only touches the symbols that are due, not the whole universe.
+ *
+ * The client's I/O thread owns the watchdog: it reports frames, runs
+ * check() from a timer and performs the returned action. Only get_stats()
+ * may be called from other threads.
+ */
+
+#ifndef FEED_WATCHDOG_HPP
+#define FEED_WATCHDOG_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
+
+namespace kraken {
+
+/**
+ * Watchdog thresholds (0 = check disabled)
+ */
+struct WatchdogConfig {
+    int connection_stale_ms;  // No frame at all -> reconnect
+    int symbol_stale_ms;      // No data for a symbol -> resubscribe it
+    int ping_interval_ms;     // WebSocket ping period (RTT measurement)
+    int pong_timeout_ms;      // Unanswered ping -> reconnect
+    int check_interval_ms;    // Watchdog timer period and wheel resolution
+
+    WatchdogConfig()
+        : connection_stale_ms(0), symbol_stale_ms(0), ping_interval_ms(0),
+          pong_timeout_ms(0), check_interval_ms(1000) {}
+
+    bool enabled() const {
+        return connection_stale_ms > 0 || symbol_stale_ms > 0 || ping_interval_ms > 0;
+    }
+};
+
+/**
+ * Watchdog counters and ping round-trip times
+ */
+struct WatchdogStats {
+    uint64_t heartbeats;
+    uint64_t pings_sent;
+    uint64_t pongs_received;
+    double last_rtt_ms;
+    double min_rtt_ms;
+    double max_rtt_ms;
+    double total_rtt_ms;
+    uint64_t stale_symbols;    // Symbols resubscribed
+    uint64_t stale_connections;  // Reconnects triggered
+
+    WatchdogStats()
+        : heartbeats(0), pings_sent(0), pongs_received(0),
+          last_rtt_ms(0.0), min_rtt_ms(0.0), max_rtt_ms(0.0), total_rtt_ms(0.0),
+          stale_symbols(0), stale_connections(0) {}
+
+    double avg_rtt_ms() const {
+        return pongs_received > 0 ? total_rtt_ms / pongs_received : 0.0;
+    }
+};
+
+/**
+ * Stall detection for one connection
+ */
+class FeedWatchdog {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    enum class Action {
+        NONE,
+        RESUBSCRIBE,  // Resubscribe the returned stale symbols
+        RECONNECT     // Drop the connection and connect again
+    };
+
+    explicit FeedWatchdog(const WatchdogConfig& config);
+
+    const WatchdogConfig& get_config() const { return config_; }
+
+    /**
+     * New connection opened: clears ping state and restarts every
+     * threshold from now
+     */
+    void reset(Clock::time_point now);
+
+    /**
+     * Start / stop staleness tracking for a symbol
+     */
+    void watch(const std::string& symbol, Clock::time_point now);
+    void unwatch(const std::string& symbol);
+
+    /**
+     * Any frame received (call first for every message)
+     */
+    void on_frame(Clock::time_point now);
+
+    /**
+     * The current frame is a heartbeat / carries data for symbol
+     * (timestamped with the last on_frame(); unknown symbols are watched)
+     */
+    void on_heartbeat();
+    void on_data(const std::string& symbol);
+
+    /**
+     * Ping due? At most one ping is outstanding at a time.
+     * @param payload Set to the ping payload to send
+     * @return true if a ping should be sent now
+     */
+    bool next_ping(Clock::time_point now, std::string& payload);
+
+    /**
+     * Pong received (payloads of other pings are ignored)
+     */
+    void on_pong(const std::string& payload, Clock::time_point now);
+
+    /**
+     * Evaluate thresholds and advance the timer wheel
+     * A stale symbol is reported once per symbol_stale_ms, which gives the
+     * resubscribe that long to bring data back.
+     * @param stale_symbols Cleared, then filled for Action::RESUBSCRIBE
+     */
+    Action check(Clock::time_point now, std::vector<std::string>& stale_symbols);
+
+    /**
+     * Thread-safe stats snapshot
+     */
+    WatchdogStats get_stats() const;
+
+private:
+    struct Entry {
+        std::string symbol;
+        Clock::time_point last_data;
+        int64_t due_tick;  // Wheel tick the entry is filed under
+        bool watched;
+        bool armed;        // Present in the wheel
+
+        Entry() : due_tick(0), watched(false), armed(false) {}
+    };
+
+    static const size_t WHEEL_SLOTS = 256;
+
+    WatchdogConfig config_;
+
+    // Connection state
+    Clock::time_point last_frame_;
+    Clock::time_point last_ping_;
+    Clock::time_point ping_sent_;
+    std::string ping_payload_;
+    uint64_t ping_seq_;
+    bool ping_outstanding_;
+
+    // Symbol deadlines
+    std::vector<Entry> entries_;
+    std::unordered_map<std::string, size_t> index_;
+    std::vector<std::vector<size_t>> wheel_;
+    std::vector<size_t> due_;  // Reused slot buffer
+    Clock::time_point origin_;
+    int64_t current_tick_;     // Last processed tick
+
+    // Statistics (protected by stats_mutex_)
+    mutable std::mutex stats_mutex_;
+    WatchdogStats stats_;
+
+    int64_t tick_of(Clock::time_point tp, bool round_up) const;
+    void arm(size_t index, Clock::time_point deadline);
+    void advance(Clock::time_point now, std::vector<std::string>& stale_symbols);
+};
+
+} // namespace kraken
+
+#endif // FEED_WATCHDOG_HPP
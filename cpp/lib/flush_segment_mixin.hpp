@@ -31,6 +31,16 @@
  *   void on_segment_mode_set()
  *       Called when segmentation mode is enabled (optional hook)
  *
+ * Segment Clock:
+ *   WALL_CLOCK (default) keys segments by the time of the write. EVENT_TIME
+ *   keys them by the records' own timestamps ("YYYY-MM-DD HH:MM:SS..."), so
+ *   backfills, merged captures and replays land in the hour they describe.
+ *   With EVENT_TIME the derived class calls advance_event_time(timestamp)
+ *   before buffering each record; the first file opens with the first
+ *   record rather than in set_segment_mode(). A late record can lead back
+ *   to an earlier segment: perform_segment_transition() must append when
+ *   segment_entered(filename) is true.
+ *
  * Usage Example:
  *
  *   class MyWriter : public FlushSegmentMixin<MyWriter> {
@@ -55,9 +65,11 @@
 
 #include <chrono>
 #include <string>
+#include <set>
 #include <iostream>
 #include <ctime>
 #include <iomanip>
+#include "stage_trace.hpp"
 
 namespace kraken {
 
@@ -70,6 +82,14 @@ enum class SegmentMode {
     DAILY    // One file per day (YYYYMMDD)
 };
 
+/**
+ * Time source for segment keys
+ */
+enum class SegmentClock {
+    WALL_CLOCK,  // Time of the write (default)
+    EVENT_TIME   // Record timestamps passed to advance_event_time()
+};
+
 /**
  * CRTP Mixin for flush and segmentation management
  *
@@ -84,6 +104,7 @@ protected:
     std::chrono::seconds flush_interval_;          // Time-based flush trigger
     size_t memory_threshold_bytes_;                // Memory-based flush trigger
     SegmentMode segment_mode_;                     // Segmentation mode
+    SegmentClock segment_clock_;                   // Wall clock or event time
 
     // ========================================================================
     // State
@@ -94,6 +115,8 @@ protected:
     std::string current_segment_key_;              // Current segment identifier (e.g., "20251112_10")
     std::string current_segment_filename_;         // Current segment filename
     std::string base_filename_;                    // Base filename without segment suffix
+    std::string event_key_;                        // Segment key of the latest record (EVENT_TIME)
+    std::set<std::string> entered_segments_;       // Segment files opened so far
 
     /**
      * Constructor - initializes with default values
@@ -102,6 +125,7 @@ protected:
         : flush_interval_(30),                     // Default: 30 seconds
           memory_threshold_bytes_(10 * 1024 * 1024),  // Default: 10 MB
           segment_mode_(SegmentMode::NONE),
+          segment_clock_(SegmentClock::WALL_CLOCK),
           flush_count_(0),
           segment_count_(0) {
         last_flush_time_ = std::chrono::steady_clock::now();
@@ -140,6 +164,14 @@ public:
         base_filename_ = filename;
     }
 
+    /**
+     * Set segment clock (call before set_segment_mode)
+     * @param clock WALL_CLOCK or EVENT_TIME
+     */
+    void set_segment_clock(SegmentClock clock) {
+        segment_clock_ = clock;
+    }
+
     /**
      * Set segmentation mode
      * @param mode NONE, HOURLY, or DAILY
@@ -147,6 +179,13 @@ public:
     void set_segment_mode(SegmentMode mode) {
         segment_mode_ = mode;
 
+        if (mode != SegmentMode::NONE && segment_clock_ == SegmentClock::EVENT_TIME &&
+            event_key_.empty()) {
+            // Key unknown until the first record arrives
+            current_segment_key_.clear();
+            return;
+        }
+
         if (mode != SegmentMode::NONE) {
             // Initialize first segment
             current_segment_key_ = generate_segment_key();
@@ -158,6 +197,7 @@ public:
 
             // Notify derived class
             derived()->on_segment_mode_set();
+            entered_segments_.insert(current_segment_filename_);
 
             segment_count_ = 1;
             std::cout << "[SEGMENT] Starting new file: "
@@ -177,6 +217,10 @@ public:
         return segment_count_;
     }
 
+    SegmentClock get_segment_clock() const {
+        return segment_clock_;
+    }
+
     std::string get_current_segment_filename() const {
         return current_segment_filename_;
     }
@@ -252,13 +296,17 @@ protected:
     }
 
     /**
-     * Generate segment key based on current time
+     * Generate segment key based on current time (or the latest record's
+     * timestamp with EVENT_TIME)
      * Returns YYYYMMDD_HH for hourly, YYYYMMDD for daily
      */
     std::string generate_segment_key() const {
         if (segment_mode_ == SegmentMode::NONE) {
             return "";
         }
+        if (segment_clock_ == SegmentClock::EVENT_TIME && !event_key_.empty()) {
+            return segment_mode_ == SegmentMode::DAILY ? event_key_.substr(0, 8) : event_key_;
+        }
 
         auto now = std::time(nullptr);
         auto tm = *std::gmtime(&now);  // UTC
@@ -277,6 +325,15 @@ protected:
         return std::string(buffer);
     }
 
+    /**
+     * Was this segment file opened before? (call from perform_segment_transition)
+     * With EVENT_TIME a late record can lead back to an earlier segment; the
+     * derived class must then append to the file instead of truncating it.
+     */
+    bool segment_entered(const std::string& filename) const {
+        return entered_segments_.count(filename) > 0;
+    }
+
     /**
      * Insert segment key into filename before extension
      * E.g., "output.csv" + "20251112_10" -> "output.20251112_10.csv"
@@ -296,6 +353,57 @@ protected:
         return base.substr(0, ext_pos) + "." + key + extension;
     }
 
+    /**
+     * Close the current segment and open the one for generate_segment_key()
+     */
+    void transition_segment() {
+        KRAKEN_TRACE_SCOPE("segment_rotation");
+
+        // Flush current buffer before transitioning
+        if (derived()->get_buffer_size() > 0) {
+            derived()->perform_flush();
+            flush_count_++;
+            last_flush_time_ = std::chrono::steady_clock::now();
+        }
+
+        // Transition to new segment
+        std::string new_key = generate_segment_key();
+        current_segment_key_ = new_key;
+        current_segment_filename_ = insert_segment_key(
+            base_filename_,
+            new_key,
+            derived()->get_file_extension()
+        );
+
+        derived()->perform_segment_transition(current_segment_filename_);
+        entered_segments_.insert(current_segment_filename_);
+        segment_count_++;
+
+        std::cout << "[SEGMENT] Starting new file: "
+                 << current_segment_filename_ << std::endl;
+    }
+
+    /**
+     * Hourly key "YYYYMMDD_HH" of a "YYYY-MM-DD HH:MM:SS..." timestamp
+     * @return false if the timestamp does not have that shape
+     */
+    static bool event_segment_key(const std::string& timestamp, char (&key)[12]) {
+        static const size_t DIGITS[10] = {0, 1, 2, 3, 5, 6, 8, 9, 11, 12};
+        if (timestamp.size() < 13 || timestamp[4] != '-' || timestamp[7] != '-') {
+            return false;
+        }
+        for (size_t i = 0; i < 10; i++) {
+            char c = timestamp[DIGITS[i]];
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            key[i < 8 ? i : i + 1] = c;
+        }
+        key[8] = '_';
+        key[11] = '\0';
+        return true;
+    }
+
 public:
     // ========================================================================
     // Primary Interface - Call this from derived class
@@ -317,31 +425,12 @@ public:
     void check_and_flush() {
         // Check for segment transition first
         if (should_transition_segment()) {
-            // Flush current buffer before transitioning
-            if (derived()->get_buffer_size() > 0) {
-                derived()->perform_flush();
-                flush_count_++;
-                last_flush_time_ = std::chrono::steady_clock::now();
-            }
-
-            // Transition to new segment
-            std::string new_key = generate_segment_key();
-            current_segment_key_ = new_key;
-            current_segment_filename_ = insert_segment_key(
-                base_filename_,
-                new_key,
-                derived()->get_file_extension()
-            );
-
-            derived()->perform_segment_transition(current_segment_filename_);
-            segment_count_++;
-
-            std::cout << "[SEGMENT] Starting new file: "
-                     << current_segment_filename_ << std::endl;
+            transition_segment();
         }
 
         // Check if regular flush needed
         if (should_flush()) {
+            KRAKEN_TRACE_SCOPE("flush");
             derived()->perform_flush();
             flush_count_++;
             last_flush_time_ = std::chrono::steady_clock::now();
@@ -356,12 +445,36 @@ public:
         }
     }
 
+    /**
+     * Event-time segmentation: call with a record's timestamp BEFORE
+     * buffering it, so the buffered records go to the segment they belong
+     * to. No-op with WALL_CLOCK. A timestamp that cannot be parsed keeps
+     * the current segment.
+     */
+    void advance_event_time(const std::string& timestamp) {
+        if (segment_clock_ != SegmentClock::EVENT_TIME || segment_mode_ == SegmentMode::NONE) {
+            return;
+        }
+
+        // Common case: same hour as the previous record, no allocation
+        char key[12];
+        if (!event_segment_key(timestamp, key) || event_key_ == key) {
+            return;
+        }
+        event_key_ = key;
+
+        if (should_transition_segment()) {
+            transition_segment();
+        }
+    }
+
     /**
      * Force immediate flush
      * Useful for shutdown/cleanup
      */
     void force_flush() {
         if (derived()->get_buffer_size() > 0) {
+            KRAKEN_TRACE_SCOPE("flush");
             derived()->perform_flush();
             flush_count_++;
             last_flush_time_ = std::chrono::steady_clock::now();
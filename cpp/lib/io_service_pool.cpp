@@ -0,0 +1,84 @@
+/**
+ * I/O Service Pool - Implementation
+ */
+
+#include "io_service_pool.hpp"
+#include "stage_trace.hpp"
+#include <iostream>
+#include <string>
+
+namespace kraken {
+
+IoServicePool::IoServicePool(size_t num_threads)
+    : next_(0), running_(false), busy_poll_(false) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+
+    for (size_t i = 0; i < num_threads; i++) {
+        io_services_.emplace_back(new boost::asio::io_service());
+    }
+}
+
+IoServicePool::~IoServicePool() {
+    stop();
+}
+
+void IoServicePool::set_thread_placement(const ThreadPlacement& placement, bool busy_poll) {
+    if (running_) {
+        std::cerr << "[Error] set_thread_placement() must be called before start()" << std::endl;
+        return;
+    }
+    placement_ = placement;
+    busy_poll_ = busy_poll;
+}
+
+void IoServicePool::start() {
+    if (running_) {
+        return;
+    }
+    running_ = true;
+
+    for (size_t i = 0; i < io_services_.size(); i++) {
+        boost::asio::io_service* io_service = io_services_[i].get();
+        work_guards_.emplace_back(new WorkGuard(boost::asio::make_work_guard(*io_service)));
+
+        ThreadPlacement placement = placement_;
+        bool busy_poll = busy_poll_;
+        threads_.emplace_back([io_service, i, placement, busy_poll]() {
+            KRAKEN_TRACE_THREAD_NAME(("io_pool_" + std::to_string(i)).c_str());
+            placement.apply("io_pool_" + std::to_string(i), i);
+            try {
+                ThreadPlacement::run_io(*io_service, busy_poll);
+            } catch (const std::exception& e) {
+                std::cerr << "[Error] I/O pool thread " << i << ": " << e.what() << std::endl;
+            }
+        });
+    }
+}
+
+void IoServicePool::stop() {
+    if (!running_) {
+        return;
+    }
+    running_ = false;
+
+    work_guards_.clear();
+    for (auto& io_service : io_services_) {
+        io_service->stop();
+    }
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+    threads_.clear();
+}
+
+boost::asio::io_service* IoServicePool::get_io_service() {
+    boost::asio::io_service* io_service = io_services_[next_].get();
+    next_ = (next_ + 1) % io_services_.size();
+    return io_service;
+}
+
+} // namespace kraken
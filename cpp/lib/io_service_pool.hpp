@@ -0,0 +1,91 @@
+/**
+ * I/O Service Pool
+ *
+ * A fixed set of asio io_services, each run by exactly one thread. Clients
+ * are assigned round-robin and keep their io_service for their lifetime,
+ * so every client still sees a single I/O thread while many connections
+ * share a few threads.
+ *
+ * Usage:
+ *   IoServicePool pool(2);
+ *   book_client.set_io_service(pool.get_io_service());
+ *   level3_client.set_io_service(pool.get_io_service());
+ *   pool.start();
+ *   book_client.start(...);
+ *   ...
+ *   book_client.stop();
+ *   level3_client.stop();
+ *   pool.stop();          // Before the clients are destroyed
+ */
+
+#ifndef IO_SERVICE_POOL_HPP
+#define IO_SERVICE_POOL_HPP
+
+#include <vector>
+#include <thread>
+#include <memory>
+#include <atomic>
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include "thread_placement.hpp"
+
+namespace kraken {
+
+class IoServicePool {
+public:
+    /**
+     * Constructor
+     * @param num_threads Number of io_services / threads (at least 1)
+     */
+    explicit IoServicePool(size_t num_threads);
+
+    /**
+     * Destructor - stops and joins all threads
+     */
+    ~IoServicePool();
+
+    // Disable copy
+    IoServicePool(const IoServicePool&) = delete;
+    IoServicePool& operator=(const IoServicePool&) = delete;
+
+    /**
+     * Place the pool threads (call before start())
+     * Thread i is pinned to the i-th CPU of the placement.
+     * @param busy_poll Spin on poll() instead of blocking (dedicated cores)
+     */
+    void set_thread_placement(const ThreadPlacement& placement, bool busy_poll = false);
+
+    /**
+     * Start one thread per io_service
+     */
+    void start();
+
+    /**
+     * Stop all io_services and join their threads
+     * Pending handlers are discarded.
+     */
+    void stop();
+
+    /**
+     * Next io_service (round-robin)
+     */
+    boost::asio::io_service* get_io_service();
+
+    size_t size() const { return io_services_.size(); }
+    bool is_running() const { return running_; }
+
+private:
+    using WorkGuard = boost::asio::executor_work_guard<boost::asio::io_service::executor_type>;
+
+    std::vector<std::unique_ptr<boost::asio::io_service>> io_services_;
+    std::vector<std::unique_ptr<WorkGuard>> work_guards_;  // Keep run() alive without connections
+    std::vector<std::thread> threads_;
+    size_t next_;
+    std::atomic<bool> running_;
+    ThreadPlacement placement_;
+    bool busy_poll_;
+};
+
+} // namespace kraken
+
+#endif // IO_SERVICE_POOL_HPP
@@ -43,7 +43,7 @@ struct NlohmannJsonParser {
     }
 
     static void parse_message(const std::string& payload,
-                              std::function<void(const TickerRecord&)> callback) {
+                              std::function<void(TickerRecord&)> callback) {
         json data = json::parse(payload);
 
         // Handle subscription status
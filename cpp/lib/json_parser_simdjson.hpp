@@ -51,7 +51,7 @@ struct SimdjsonParser {
     }
 
     static void parse_message(const std::string& payload,
-                              std::function<void(const TickerRecord&)> callback) {
+                              std::function<void(TickerRecord&)> callback) {
         try {
             // simdjson on-demand parsing
             simdjson::ondemand::parser parser;
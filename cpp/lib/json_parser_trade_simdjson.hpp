@@ -0,0 +1,137 @@
+#ifndef JSON_PARSER_TRADE_SIMDJSON_HPP
+#define JSON_PARSER_TRADE_SIMDJSON_HPP
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iostream>
+#include <simdjson.h>
+#include "kraken_common.hpp"
+
+namespace kraken {
+
+/**
+ * Trade channel parser adapter for simdjson library
+ *
+ * Provides static methods for the template-based trade client.
+ * Unlike the ticker adapters, parse_message() decodes a whole frame into a
+ * caller-owned batch: during liquidation cascades one frame carries dozens
+ * of trades, and the client hands them on under a single lock.
+ *
+ * The simdjson parser and padded input buffer are kept per thread and
+ * reused, so steady-state decoding does not allocate beyond the records.
+ */
+struct SimdjsonTradeParser {
+    static const char* name() { return "simdjson"; }
+
+    static std::string build_subscription(const std::vector<std::string>& symbols) {
+        // simdjson is read-only, so build JSON manually
+        std::ostringstream subscribe_msg;
+        subscribe_msg << R"({"method":"subscribe","params":{)";
+        subscribe_msg << R"("channel":"trade",)";
+        subscribe_msg << R"("symbol":[)";
+
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            if (i > 0) subscribe_msg << ",";
+            subscribe_msg << "\"" << symbols[i] << "\"";
+        }
+
+        subscribe_msg << R"(],"snapshot":true}})";
+        return subscribe_msg.str();
+    }
+
+    static std::string build_unsubscribe(const std::vector<std::string>& symbols) {
+        std::ostringstream unsubscribe_msg;
+        unsubscribe_msg << R"({"method":"unsubscribe","params":{)";
+        unsubscribe_msg << R"("channel":"trade",)";
+        unsubscribe_msg << R"("symbol":[)";
+
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            if (i > 0) unsubscribe_msg << ",";
+            unsubscribe_msg << "\"" << symbols[i] << "\"";
+        }
+
+        unsubscribe_msg << R"(]}})";
+        return unsubscribe_msg.str();
+    }
+
+    /**
+     * Decode every trade in a frame
+     * @param payload Raw WebSocket message
+     * @param batch Output, cleared first (capacity is kept between frames)
+     * @return true if the payload was a trade snapshot/update frame
+     */
+    static bool parse_message(const std::string& payload, std::vector<TradeRecord>& batch) {
+        batch.clear();
+
+        // Fast rejection of heartbeats and acks without a full parse
+        if (payload.find("\"channel\":\"trade\"") == std::string::npos) {
+            if (payload.find("\"method\":\"subscribe\"") != std::string::npos &&
+                payload.find("\"success\":false") != std::string::npos) {
+                std::cerr << "Subscription failed: " << payload << std::endl;
+            }
+            return false;
+        }
+
+        thread_local simdjson::ondemand::parser parser;
+        thread_local std::string buffer;
+
+        try {
+            // Copy into a reused buffer with simdjson's required padding
+            if (buffer.capacity() < payload.size() + simdjson::SIMDJSON_PADDING) {
+                buffer.reserve(payload.size() + simdjson::SIMDJSON_PADDING);
+            }
+            buffer.assign(payload);
+
+            simdjson::ondemand::document doc = parser.iterate(
+                simdjson::padded_string_view(buffer.data(), buffer.size(), buffer.capacity()));
+
+            std::string_view type_str;
+            if (doc["type"].get_string().get(type_str) ||
+                (type_str != "snapshot" && type_str != "update")) {
+                return false;
+            }
+
+            simdjson::ondemand::array data_array;
+            if (doc["data"].get_array().get(data_array)) {
+                return false;
+            }
+
+            std::string timestamp = Utils::get_utc_timestamp();
+
+            for (auto trade_value : data_array) {
+                simdjson::ondemand::object trade;
+                if (trade_value.get_object().get(trade)) {
+                    continue;
+                }
+
+                batch.emplace_back();
+                TradeRecord& record = batch.back();
+                record.timestamp = timestamp;
+                record.type = std::string(type_str);
+
+                // Fields in Kraken's order, so on-demand lookups scan forward only
+                std::string_view sv;
+                double number;
+                if (!trade["symbol"].get_string().get(sv)) record.symbol = std::string(sv);
+                if (!trade["side"].get_string().get(sv)) record.side = std::string(sv);
+                if (!trade["price"].get_double().get(number)) record.price = number;
+                if (!trade["qty"].get_double().get(number)) record.qty = number;
+                if (!trade["ord_type"].get_string().get(sv)) record.ord_type = std::string(sv);
+                uint64_t trade_id;
+                if (!trade["trade_id"].get_uint64().get(trade_id)) record.trade_id = trade_id;
+                if (!trade["timestamp"].get_string().get(sv)) record.trade_timestamp = std::string(sv);
+            }
+        } catch (const simdjson::simdjson_error& e) {
+            std::cerr << "simdjson parsing error: " << simdjson::error_message(e.error()) << std::endl;
+            batch.clear();
+            return false;
+        }
+
+        return !batch.empty();
+    }
+};
+
+} // namespace kraken
+
+#endif // JSON_PARSER_TRADE_SIMDJSON_HPP
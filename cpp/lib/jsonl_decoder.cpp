@@ -0,0 +1,237 @@
+/**
+ * JSON Lines Decoder - Implementation
+ */
+
+#include "jsonl_decoder.hpp"
+#include <iostream>
+#include <cstdio>
+#include <ctime>
+#include <string_view>
+
+namespace kraken {
+
+JsonlDecoder::JsonlDecoder() {
+    buffer_.reserve(4096 + simdjson::SIMDJSON_PADDING);
+}
+
+bool JsonlDecoder::has_recv_ts(const std::string& line) {
+    return std::string_view(line).substr(0, 96).find("\"recv_ts_ns\"") != std::string_view::npos;
+}
+
+simdjson::ondemand::document JsonlDecoder::iterate(const std::string& line) {
+    if (buffer_.capacity() < line.size() + simdjson::SIMDJSON_PADDING) {
+        buffer_.reserve(line.size() + simdjson::SIMDJSON_PADDING);
+    }
+    buffer_.assign(line);
+    return parser_.iterate(
+        simdjson::padded_string_view(buffer_.data(), buffer_.size(), buffer_.capacity()));
+}
+
+bool JsonlDecoder::decode(const std::string& line, OrderBookRecord& record) {
+    record.timestamp.clear();
+    record.symbol.clear();
+    record.type.clear();
+    record.bids.clear();
+    record.asks.clear();
+    record.checksum = 0;
+    record.recv_ts_ns = 0;
+
+    try {
+        simdjson::ondemand::document doc = iterate(line);
+
+        // Parse timestamp
+        if (auto ts = doc["timestamp"]; !ts.error()) {
+            std::string_view sv = ts.value();
+            record.timestamp = std::string(sv);
+        }
+
+        // Receive time (written right after the timestamp when known; older
+        // captures lack it, and a missing-key lookup would rescan the line)
+        if (has_recv_ts(line)) {
+            if (auto recv_ts = doc["recv_ts_ns"]; !recv_ts.error()) {
+                int64_t ns = 0;
+                if (!recv_ts.get(ns)) {
+                    record.recv_ts_ns = ns;
+                }
+            }
+        }
+
+        // Parse data object
+        auto data_obj = doc["data"];
+        if (data_obj.error()) {
+            return false;
+        }
+
+        simdjson::ondemand::object data = data_obj.value();
+
+        // Parse symbol
+        if (auto symbol = data["symbol"]; !symbol.error()) {
+            std::string_view sv = symbol.value();
+            record.symbol = std::string(sv);
+        }
+
+        // Parse type (from parent object)
+        if (auto type = doc["type"]; !type.error()) {
+            std::string_view sv = type.value();
+            record.type = std::string(sv);
+        }
+
+        // Parse bids
+        if (auto bids = data["bids"]; !bids.error()) {
+            simdjson::ondemand::array bids_array = bids.value();
+            for (auto bid_value : bids_array) {
+                simdjson::ondemand::array bid_arr = bid_value.get_array();
+                auto it = bid_arr.begin();
+                double price = (*it).get_double();
+                ++it;
+                double quantity = (*it).get_double();
+                record.bids.emplace_back(price, quantity);
+            }
+        }
+
+        // Parse asks
+        if (auto asks = data["asks"]; !asks.error()) {
+            simdjson::ondemand::array asks_array = asks.value();
+            for (auto ask_value : asks_array) {
+                simdjson::ondemand::array ask_arr = ask_value.get_array();
+                auto it = ask_arr.begin();
+                double price = (*it).get_double();
+                ++it;
+                double quantity = (*it).get_double();
+                record.asks.emplace_back(price, quantity);
+            }
+        }
+
+        // Parse checksum
+        if (auto checksum = data["checksum"]; !checksum.error()) {
+            record.checksum = static_cast<uint32_t>(checksum.get_uint64());
+        }
+
+        return true;
+
+    } catch (const simdjson::simdjson_error& e) {
+        std::cerr << "Error parsing JSON: " << simdjson::error_message(e.error()) << std::endl;
+        return false;
+    }
+}
+
+bool JsonlDecoder::decode(const std::string& line, Level3Record& record) {
+    record.timestamp.clear();
+    record.symbol.clear();
+    record.type.clear();
+    record.bids.clear();
+    record.asks.clear();
+    record.checksum = 0;
+    record.recv_ts_ns = 0;
+
+    try {
+        simdjson::ondemand::document doc = iterate(line);
+
+        // Parse timestamp
+        if (auto ts = doc["timestamp"]; !ts.error()) {
+            std::string_view sv = ts.value();
+            record.timestamp = std::string(sv);
+        }
+
+        // Receive time (written right after the timestamp when known; older
+        // captures lack it, and a missing-key lookup would rescan the line)
+        if (has_recv_ts(line)) {
+            if (auto recv_ts = doc["recv_ts_ns"]; !recv_ts.error()) {
+                int64_t ns = 0;
+                if (!recv_ts.get(ns)) {
+                    record.recv_ts_ns = ns;
+                }
+            }
+        }
+
+        // Parse type
+        if (auto type = doc["type"]; !type.error()) {
+            std::string_view sv = type.value();
+            record.type = std::string(sv);
+        }
+
+        // Parse data object
+        auto data_obj = doc["data"];
+        if (data_obj.error()) {
+            return false;
+        }
+
+        simdjson::ondemand::object data = data_obj.value();
+
+        // Parse symbol
+        if (auto symbol = data["symbol"]; !symbol.error()) {
+            std::string_view sv = symbol.value();
+            record.symbol = std::string(sv);
+        }
+
+        // Parse bids and asks (arrays of order objects)
+        if (auto bids = data["bids"]; !bids.error()) {
+            decode_orders(bids.value(), record.bids);
+        }
+        if (auto asks = data["asks"]; !asks.error()) {
+            decode_orders(asks.value(), record.asks);
+        }
+
+        // Parse checksum
+        if (auto checksum = data["checksum"]; !checksum.error()) {
+            record.checksum = static_cast<uint32_t>(checksum.get_uint64());
+        }
+
+        return true;
+
+    } catch (const simdjson::simdjson_error& e) {
+        std::cerr << "Error parsing JSON: " << simdjson::error_message(e.error()) << std::endl;
+        return false;
+    }
+}
+
+void JsonlDecoder::decode_orders(simdjson::ondemand::array orders, std::vector<Level3Order>& out) {
+    for (auto order_value : orders) {
+        simdjson::ondemand::object order_obj = order_value.get_object();
+
+        out.emplace_back();
+        Level3Order& order = out.back();
+
+        // Event (for updates)
+        if (auto event_field = order_obj["event"]; !event_field.error()) {
+            std::string_view event_sv = event_field.value();
+            order.event = std::string(event_sv);
+        }
+
+        if (auto order_id = order_obj["order_id"]; !order_id.error()) {
+            std::string_view id_sv = order_id.value();
+            order.order_id = std::string(id_sv);
+        }
+
+        if (auto limit_price = order_obj["limit_price"]; !limit_price.error()) {
+            order.limit_price = limit_price.get_double();
+        }
+
+        if (auto order_qty = order_obj["order_qty"]; !order_qty.error()) {
+            order.order_qty = order_qty.get_double();
+        }
+
+        if (auto ts = order_obj["timestamp"]; !ts.error()) {
+            std::string_view ts_sv = ts.value();
+            order.timestamp = std::string(ts_sv);
+        }
+    }
+}
+
+double JsonlDecoder::parse_timestamp(const std::string& timestamp) {
+    // Format: "YYYY-MM-DD HH:MM:SS.mmm"
+    std::tm tm = {};
+    int millisec = 0;
+
+    sscanf(timestamp.c_str(), "%d-%d-%d %d:%d:%d.%d",
+           &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
+           &tm.tm_hour, &tm.tm_min, &tm.tm_sec, &millisec);
+
+    tm.tm_year -= 1900;  // Years since 1900
+    tm.tm_mon -= 1;      // Months since January
+
+    std::time_t t = std::mktime(&tm);
+    return static_cast<double>(t) + (millisec / 1000.0);
+}
+
+} // namespace kraken
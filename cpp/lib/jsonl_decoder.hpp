@@ -0,0 +1,85 @@
+/**
+ * JSON Lines Decoder
+ *
+ * Decodes lines written by JsonLinesWriter (Level 2) and
+ * Level3JsonLinesWriter (Level 3) back into OrderBookRecord / Level3Record.
+ * Shared by the offline processing tools and ReplaySource so that every
+ * consumer of a capture file sees exactly the same records.
+ *
+ * One decoder keeps its simdjson parser and padded line buffer between
+ * calls; use one decoder per thread.
+ */
+
+#ifndef JSONL_DECODER_HPP
+#define JSONL_DECODER_HPP
+
+#include <string>
+#include <simdjson.h>
+#include "orderbook_common.hpp"
+#include "level3_common.hpp"
+
+namespace kraken {
+
+/**
+ * Capture file line decoder
+ *
+ * Usage:
+ *   JsonlDecoder decoder;
+ *   OrderBookRecord record;
+ *   while (std::getline(in, line)) {
+ *       if (decoder.decode(line, record)) { ... }
+ *   }
+ */
+class JsonlDecoder {
+public:
+    JsonlDecoder();
+
+    // Disable copy (parser owns large buffers)
+    JsonlDecoder(const JsonlDecoder&) = delete;
+    JsonlDecoder& operator=(const JsonlDecoder&) = delete;
+
+    /**
+     * Decode a Level 2 line
+     * @param line One line of a .jsonl capture
+     * @param record Output (fully overwritten, capacity of level vectors is kept)
+     * @return false if the line is not a valid book record
+     */
+    bool decode(const std::string& line, OrderBookRecord& record);
+
+    /**
+     * Decode a Level 3 line
+     * @param line One line of a .jsonl capture
+     * @param record Output (fully overwritten, capacity of order vectors is kept)
+     * @return false if the line is not a valid Level 3 record
+     */
+    bool decode(const std::string& line, Level3Record& record);
+
+    /**
+     * Parse a record timestamp to Unix epoch seconds
+     * @param timestamp Format "YYYY-MM-DD HH:MM:SS.mmm" (Utils::get_utc_timestamp)
+     */
+    static double parse_timestamp(const std::string& timestamp);
+
+private:
+    simdjson::ondemand::parser parser_;
+    std::string buffer_;  // Line copy with simdjson padding
+
+    /**
+     * Iterate line with the reused parser and buffer
+     */
+    simdjson::ondemand::document iterate(const std::string& line);
+
+    /**
+     * Decode one side of a Level 3 record
+     */
+    static void decode_orders(simdjson::ondemand::array orders, std::vector<Level3Order>& out);
+
+    /**
+     * Whether the line carries recv_ts_ns (checked near the start only)
+     */
+    static bool has_recv_ts(const std::string& line);
+};
+
+} // namespace kraken
+
+#endif // JSONL_DECODER_HPP
@@ -1,33 +1,45 @@
 /**
- * JSON Lines Writer for Order Book Data (CRTP Refactored Version)
+ * JSON Lines Writer for Order Book Data
  *
  * Writes OrderBookRecord data to .jsonl (JSON Lines) format
  * One JSON object per line, suitable for streaming data
  *
- * Uses FlushSegmentMixin for periodic flushing and segmentation
+ * A BufferedWriter with BookJsonlCodec: periodic flushing and segmentation
+ * come from FlushSegmentMixin.
  */
 
 #ifndef JSONL_WRITER_HPP
 #define JSONL_WRITER_HPP
 
 #include "orderbook_common.hpp"
-#include "flush_segment_mixin.hpp"
-#include <fstream>
+#include "buffered_writer.hpp"
 #include <string>
-#include <sstream>
-#include <iomanip>
-#include <map>
 #include <vector>
 
 namespace kraken {
 
 /**
- * JSON Lines Writer
- * Writes order book records to .jsonl format with periodic flushing and segmentation
+ * Level 2 record codec (one JSON object per line)
  */
-class JsonLinesWriter : public FlushSegmentMixin<JsonLinesWriter> {
-    friend class FlushSegmentMixin<JsonLinesWriter>;  // Allow mixin to access private interface
+struct BookJsonlCodec {
+    static const char* extension() { return ".jsonl"; }
+
+    void header(const OrderBookRecord&, std::string&) {}
+
+    void encode(const OrderBookRecord& record, std::string& out) const;
+
+    /**
+     * Append a price level array ([[price,qty],...])
+     */
+    static void append_levels(std::string& out, const std::vector<PriceLevel>& levels);
+};
 
+/**
+ * JSON Lines Writer
+ * Writes order book records to .jsonl format with periodic flushing and segmentation.
+ * The file opens on the first write, or in set_segment_mode() when segmenting.
+ */
+class JsonLinesWriter : public BufferedWriter<OrderBookRecord, BookJsonlCodec> {
 public:
     /**
      * Constructor
@@ -36,210 +48,28 @@ public:
      */
     JsonLinesWriter(const std::string& filename, bool append = false);
 
-    /**
-     * Destructor - closes file and flushes remaining data
-     */
-    ~JsonLinesWriter();
-
     /**
      * Write order book record (buffered with periodic flush)
      */
     bool write_record(const OrderBookRecord& record);
-
-    /**
-     * Flush buffered data to disk
-     */
-    void flush();
-
-    /**
-     * Check if file is open and writable
-     */
-    bool is_open() const;
-
-    /**
-     * Get number of records written (total across all flushes)
-     */
-    size_t get_record_count() const;
-
-    // Note: Flush/segment configuration methods inherited from FlushSegmentMixin
-    // - void set_flush_interval(std::chrono::seconds interval)
-    // - void set_memory_threshold(size_t bytes)
-    // - void set_segment_mode(SegmentMode mode)
-    // - size_t get_flush_count() const
-    // - size_t get_current_memory_usage() const
-    // - size_t get_segment_count() const
-    // - std::string get_current_segment_filename() const
-
-private:
-    std::ofstream file_;
-    size_t record_count_;
-    std::vector<OrderBookRecord> record_buffer_;      // Buffered records
-
-    // ========================================================================
-    // CRTP Interface Implementation (required by FlushSegmentMixin)
-    // ========================================================================
-
-    /**
-     * Get buffer size (required by CRTP)
-     */
-    size_t get_buffer_size() const {
-        return record_buffer_.size();
-    }
-
-    /**
-     * Get record size (required by CRTP)
-     */
-    size_t get_record_size() const {
-        return sizeof(OrderBookRecord);
-    }
-
-    /**
-     * Get file extension (required by CRTP)
-     */
-    std::string get_file_extension() const {
-        return ".jsonl";
-    }
-
-    /**
-     * Perform actual flush to disk (required by CRTP)
-     */
-    void perform_flush();
-
-    /**
-     * Perform segment transition (required by CRTP)
-     */
-    void perform_segment_transition(const std::string& new_filename);
-
-    /**
-     * Called when segmentation mode is set (required by CRTP)
-     */
-    void on_segment_mode_set();
-
-    // ========================================================================
-    // JSON Serialization
-    // ========================================================================
-
-    /**
-     * Convert OrderBookRecord to JSON string
-     */
-    std::string record_to_json(const OrderBookRecord& record) const;
-
-    /**
-     * Escape JSON string
-     */
-    std::string escape_json_string(const std::string& str) const;
-
-    /**
-     * Format price level array to JSON
-     */
-    std::string price_levels_to_json(const std::vector<PriceLevel>& levels) const;
 };
 
 /**
  * Multi-file JSON Lines Writer
  * Manages separate files per symbol with periodic flushing and segmentation
  */
-class MultiFileJsonLinesWriter {
+class MultiFileJsonLinesWriter : public MultiFileWriter<OrderBookRecord, BookJsonlCodec> {
 public:
     /**
      * Constructor
      * @param base_filename Base filename (will be appended with symbol)
      */
-    MultiFileJsonLinesWriter(const std::string& base_filename);
-
-    /**
-     * Destructor - closes all files and flushes remaining data
-     */
-    ~MultiFileJsonLinesWriter();
+    explicit MultiFileJsonLinesWriter(const std::string& base_filename);
 
     /**
      * Write record to appropriate file based on symbol
      */
     bool write_record(const OrderBookRecord& record);
-
-    /**
-     * Flush all files
-     */
-    void flush_all();
-
-    /**
-     * Get number of files open
-     */
-    size_t get_file_count() const;
-
-    /**
-     * Get total records written across all files
-     */
-    size_t get_total_record_count() const;
-
-    // ========================================================================
-    // Flush Configuration (applies to all writers)
-    // ========================================================================
-
-    /**
-     * Set flush interval for all writers
-     */
-    void set_flush_interval(std::chrono::seconds interval);
-
-    /**
-     * Set memory threshold for all writers
-     */
-    void set_memory_threshold(size_t bytes);
-
-    /**
-     * Get total flush count across all writers
-     */
-    size_t get_total_flush_count() const;
-
-    /**
-     * Get total memory usage across all writers
-     */
-    size_t get_total_memory_usage() const;
-
-    // ========================================================================
-    // Segmentation Configuration (applies to all writers)
-    // ========================================================================
-
-    /**
-     * Set segmentation mode for all writers
-     */
-    void set_segment_mode(SegmentMode mode);
-
-    /**
-     * Get total segment count across all writers
-     */
-    size_t get_total_segment_count() const;
-
-private:
-    std::string base_filename_;
-    std::map<std::string, JsonLinesWriter*> writers_;
-
-    // Configuration to apply to all new writers
-    std::chrono::seconds flush_interval_;
-    size_t memory_threshold_bytes_;
-    SegmentMode segment_mode_;
-
-    /**
-     * Get or create writer for symbol
-     */
-    JsonLinesWriter* get_writer(const std::string& symbol);
-
-    /**
-     * Create filename for symbol
-     * E.g., "orderbook_BTC_USD.jsonl"
-     */
-    std::string create_filename(const std::string& symbol) const;
-
-    /**
-     * Sanitize symbol for filename
-     * Replace / with _
-     */
-    std::string sanitize_symbol(const std::string& symbol) const;
-
-    /**
-     * Apply configuration to a writer
-     */
-    void apply_configuration(JsonLinesWriter* writer);
 };
 
 } // namespace kraken
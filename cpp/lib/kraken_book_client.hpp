@@ -10,95 +10,92 @@
 
 #include <string>
 #include <vector>
-#include <thread>
 #include <mutex>
 #include <atomic>
 #include <functional>
 #include <sstream>
 #include <iostream>
 #include <map>
-#include <websocketpp/config/asio_client.hpp>
-#include <websocketpp/client.hpp>
 #include <simdjson.h>
 #include "orderbook_common.hpp"
+#include "orderbook_state.hpp"
 #include "jsonl_writer.hpp"
 #include "kraken_common.hpp"
+#include "kraken_stream_client_base.hpp"
+#include "alloc_counter.hpp"
+#include "stage_trace.hpp"
 
 namespace kraken {
 
 /**
  * WebSocket client for order book (Level 2) data
+ *
+ * Connection handling (I/O thread, TLS, socket options, symbol universe,
+ * watchdog) comes from KrakenStreamClientBase.
  */
-class KrakenBookClient {
+class KrakenBookClient : public KrakenStreamClientBase<KrakenBookClient> {
+    friend class KrakenStreamClientBase<KrakenBookClient>;
+
 public:
     // Type definitions
     using UpdateCallback = std::function<void(const OrderBookRecord&)>;
-    using ConnectionCallback = std::function<void(bool connected)>;
-    using ErrorCallback = std::function<void(const std::string& error)>;
+    using BboCallback = std::function<void(const std::string& symbol, const BestBidOffer& bbo)>;
 
     KrakenBookClient(int depth = 10, bool validate_checksums = true);
     ~KrakenBookClient();
 
-    // Disable copy
-    KrakenBookClient(const KrakenBookClient&) = delete;
-    KrakenBookClient& operator=(const KrakenBookClient&) = delete;
-
-    // Public API
-    bool start(const std::vector<std::string>& symbols);
-    void stop();
-    bool is_connected() const;
-    bool is_running() const;
     void set_update_callback(UpdateCallback callback);
-    void set_connection_callback(ConnectionCallback callback);
-    void set_error_callback(ErrorCallback callback);
+
+    /**
+     * Call back only when the best bid/ask price or quantity changes
+     *
+     * Enables BBO filtering: the client maintains the full book per symbol
+     * and deep-level updates that leave the top unchanged trigger nothing.
+     * Can be used alone or together with the update callback.
+     * NOTE: Should be called BEFORE start()
+     */
+    void set_bbo_change_callback(BboCallback callback);
 
     // Get statistics per symbol
     std::map<std::string, OrderBookStats> get_stats() const;
 
 private:
-    // WebSocket types
-    typedef websocketpp::client<websocketpp::config::asio_tls_client> client;
-    typedef websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context> context_ptr;
-
     // Configuration
     int depth_;
     bool validate_checksums_;
 
-    // WebSocket client and connection
-    client ws_client_;
-    websocketpp::connection_hdl connection_hdl_;
-    std::thread worker_thread_;
-
-    // State
-    std::atomic<bool> running_;
-    std::atomic<bool> connected_;
-    std::vector<std::string> symbols_;
-
     // Statistics (protected by stats_mutex_)
     mutable std::mutex stats_mutex_;
     std::map<std::string, OrderBookStats> stats_;
 
-    // Callbacks (protected by callback_mutex_)
-    mutable std::mutex callback_mutex_;
+    // BBO filter state (WebSocket thread only)
+    struct BboTracker {
+        OrderBookState book;
+        BestBidOffer last;
+        bool has_last;
+
+        explicit BboTracker(const std::string& symbol) : book(symbol), has_last(false) {}
+    };
+    std::atomic<bool> bbo_tracking_;
+    std::map<std::string, BboTracker> bbo_trackers_;
+
+    // Record callbacks (protected by callback_mutex_)
     UpdateCallback update_callback_;
-    ConnectionCallback connection_callback_;
-    ErrorCallback error_callback_;
+    BboCallback bbo_callback_;
 
-    // WebSocket event handlers
-    context_ptr on_tls_init(websocketpp::connection_hdl hdl);
-    void on_open(websocketpp::connection_hdl hdl);
-    void on_close(websocketpp::connection_hdl hdl);
-    void on_fail(websocketpp::connection_hdl hdl);
-    void on_message(websocketpp::connection_hdl hdl, client::message_ptr msg);
+    // ========================================================================
+    // Channel interface (required by KrakenStreamClientBase)
+    // ========================================================================
 
-    // Worker thread main function
-    void run_client();
+    static const char* client_name() { return "Book client"; }
+    static const char* io_thread_name() { return "book_io"; }
+    std::string build_subscription(const std::vector<std::string>& symbols) const;
+    std::string build_unsubscribe(const std::vector<std::string>& symbols) const;
+    bool prepare_start();
+    void handle_payload(const std::string& payload, int64_t recv_ts_ns);
 
     // Helper methods
-    void notify_connection(bool connected);
-    void notify_error(const std::string& error);
-    void process_book_message(const std::string& payload);
-    std::string build_subscription() const;
+    void update_bbo(const OrderBookRecord& record);
 };
 
 // ============================================================================
@@ -106,64 +103,11 @@ private:
 // ============================================================================
 
 KrakenBookClient::KrakenBookClient(int depth, bool validate_checksums)
-    : depth_(depth), validate_checksums_(validate_checksums),
-      running_(false), connected_(false) {
-
-    // Initialize WebSocket client
-    ws_client_.clear_access_channels(websocketpp::log::alevel::all);
-    ws_client_.clear_error_channels(websocketpp::log::elevel::all);
-    ws_client_.init_asio();
-    ws_client_.set_tls_init_handler(std::bind(
-        &KrakenBookClient::on_tls_init, this, std::placeholders::_1
-    ));
+    : depth_(depth), validate_checksums_(validate_checksums), bbo_tracking_(false) {
 }
 
 KrakenBookClient::~KrakenBookClient() {
-    stop();
-}
-
-bool KrakenBookClient::start(const std::vector<std::string>& symbols) {
-    if (running_) {
-        return false;
-    }
-
-    symbols_ = symbols;
-    running_ = true;
-
-    // Initialize statistics
-    {
-        std::lock_guard<std::mutex> lock(stats_mutex_);
-        stats_.clear();
-        for (const auto& symbol : symbols_) {
-            stats_[symbol] = OrderBookStats();
-        }
-    }
-
-    // Start worker thread
-    worker_thread_ = std::thread(&KrakenBookClient::run_client, this);
-
-    return true;
-}
-
-void KrakenBookClient::stop() {
-    if (!running_) {
-        return;
-    }
-
-    running_ = false;
-    ws_client_.stop();
-
-    if (worker_thread_.joinable()) {
-        worker_thread_.join();
-    }
-}
-
-bool KrakenBookClient::is_connected() const {
-    return connected_;
-}
-
-bool KrakenBookClient::is_running() const {
-    return running_;
+    stop();  // The I/O thread dispatches into this object's members
 }
 
 void KrakenBookClient::set_update_callback(UpdateCallback callback) {
@@ -171,14 +115,10 @@ void KrakenBookClient::set_update_callback(UpdateCallback callback) {
     update_callback_ = callback;
 }
 
-void KrakenBookClient::set_connection_callback(ConnectionCallback callback) {
+void KrakenBookClient::set_bbo_change_callback(BboCallback callback) {
     std::lock_guard<std::mutex> lock(callback_mutex_);
-    connection_callback_ = callback;
-}
-
-void KrakenBookClient::set_error_callback(ErrorCallback callback) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    error_callback_ = callback;
+    bbo_callback_ = callback;
+    bbo_tracking_ = static_cast<bool>(bbo_callback_);
 }
 
 std::map<std::string, OrderBookStats> KrakenBookClient::get_stats() const {
@@ -186,124 +126,52 @@ std::map<std::string, OrderBookStats> KrakenBookClient::get_stats() const {
     return stats_;
 }
 
-KrakenBookClient::context_ptr KrakenBookClient::on_tls_init(websocketpp::connection_hdl) {
-    context_ptr ctx = websocketpp::lib::make_shared<boost::asio::ssl::context>(
-        boost::asio::ssl::context::tlsv12
-    );
-
-    try {
-        ctx->set_options(
-            boost::asio::ssl::context::default_workarounds |
-            boost::asio::ssl::context::no_sslv2 |
-            boost::asio::ssl::context::no_sslv3 |
-            boost::asio::ssl::context::single_dh_use
-        );
-    } catch (std::exception& e) {
-        notify_error(std::string("TLS init error: ") + e.what());
-    }
-
-    return ctx;
-}
-
-void KrakenBookClient::on_open(websocketpp::connection_hdl hdl) {
-    connection_hdl_ = hdl;
-    connected_ = true;
-    notify_connection(true);
-
-    // Send subscription
-    std::string subscribe_msg = build_subscription();
-
-    try {
-        ws_client_.send(hdl, subscribe_msg, websocketpp::frame::opcode::text);
-    } catch (const std::exception& e) {
-        notify_error(std::string("Failed to send subscription: ") + e.what());
+bool KrakenBookClient::prepare_start() {
+    // Initialize statistics
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.clear();
+    for (const auto& symbol : symbols_) {
+        stats_[symbol] = OrderBookStats();
     }
+    return true;
 }
 
-void KrakenBookClient::on_close(websocketpp::connection_hdl) {
-    connected_ = false;
-    notify_connection(false);
-}
-
-void KrakenBookClient::on_fail(websocketpp::connection_hdl) {
-    connected_ = false;
-    notify_connection(false);
-    notify_error("WebSocket connection failed");
-}
-
-void KrakenBookClient::on_message(websocketpp::connection_hdl, client::message_ptr msg) {
-    const std::string& payload = msg->get_payload();
-    process_book_message(payload);
-}
-
-void KrakenBookClient::run_client() {
-    try {
-        // Set handlers
-        ws_client_.set_open_handler(std::bind(
-            &KrakenBookClient::on_open, this, std::placeholders::_1
-        ));
-        ws_client_.set_close_handler(std::bind(
-            &KrakenBookClient::on_close, this, std::placeholders::_1
-        ));
-        ws_client_.set_fail_handler(std::bind(
-            &KrakenBookClient::on_fail, this, std::placeholders::_1
-        ));
-        ws_client_.set_message_handler(std::bind(
-            &KrakenBookClient::on_message, this, std::placeholders::_1, std::placeholders::_2
-        ));
-
-        // Connect to Kraken WebSocket v2
-        const std::string uri = "wss://ws.kraken.com/v2";
-        websocketpp::lib::error_code ec;
-        client::connection_ptr con = ws_client_.get_connection(uri, ec);
-
-        if (ec) {
-            notify_error(std::string("Connection init error: ") + ec.message());
-            running_ = false;
-            return;
-        }
-
-        ws_client_.connect(con);
-        ws_client_.run();
+std::string KrakenBookClient::build_subscription(const std::vector<std::string>& symbols) const {
+    std::ostringstream oss;
+    oss << R"({"method":"subscribe","params":{)";
+    oss << R"("channel":"book",)";
+    oss << R"("symbol":[)";
 
-    } catch (const std::exception& e) {
-        notify_error(std::string("WebSocket error: ") + e.what());
-        running_ = false;
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << "\"" << symbols[i] << "\"";
     }
-}
 
-void KrakenBookClient::notify_connection(bool connected) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    if (connection_callback_) {
-        connection_callback_(connected);
-    }
-}
+    oss << R"(],"depth":)" << depth_ << ",";
+    oss << R"("snapshot":true}})";
 
-void KrakenBookClient::notify_error(const std::string& error) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    if (error_callback_) {
-        error_callback_(error);
-    }
+    return oss.str();
 }
 
-std::string KrakenBookClient::build_subscription() const {
+std::string KrakenBookClient::build_unsubscribe(const std::vector<std::string>& symbols) const {
     std::ostringstream oss;
-    oss << R"({"method":"subscribe","params":{)";
+    oss << R"({"method":"unsubscribe","params":{)";
     oss << R"("channel":"book",)";
     oss << R"("symbol":[)";
 
-    for (size_t i = 0; i < symbols_.size(); ++i) {
+    for (size_t i = 0; i < symbols.size(); ++i) {
         if (i > 0) oss << ",";
-        oss << "\"" << symbols_[i] << "\"";
+        oss << "\"" << symbols[i] << "\"";
     }
 
-    oss << R"(],"depth":)" << depth_ << ",";
-    oss << R"("snapshot":true}})";
+    oss << R"(],"depth":)" << depth_ << "}}";
 
     return oss.str();
 }
 
-void KrakenBookClient::process_book_message(const std::string& payload) {
+void KrakenBookClient::handle_payload(const std::string& payload, int64_t recv_ts_ns) {
+    KRAKEN_ALLOC_SCOPE("book_client.process_message");
+    KRAKEN_TRACE_SCOPE("book.parse");
     try {
         simdjson::ondemand::parser parser;
         simdjson::padded_string padded(payload);
@@ -312,9 +180,13 @@ void KrakenBookClient::process_book_message(const std::string& payload) {
         // Handle subscription response
         if (auto method_result = doc["method"]; !method_result.error()) {
             std::string_view method = method_result.value();
-            if (method == "subscribe") {
+            if (method == "subscribe" || method == "unsubscribe") {
+                bool success = false;
                 if (auto success_result = doc["success"]; !success_result.error()) {
-                    bool success = success_result.value();
+                    success = success_result.value();
+                }
+
+                if (method == "subscribe") {
                     if (success) {
                         std::cout << "[STATUS] Successfully subscribed to book channel" << std::endl;
                     } else {
@@ -325,12 +197,9 @@ void KrakenBookClient::process_book_message(const std::string& payload) {
             }
         }
 
-        // Handle heartbeat
+        // Heartbeats are handled by the base; only book messages remain
         if (auto channel_result = doc["channel"]; !channel_result.error()) {
             std::string_view channel = channel_result.value();
-            if (channel == "heartbeat") {
-                return;
-            }
 
             // Handle book messages
             if (channel == "book") {
@@ -353,6 +222,7 @@ void KrakenBookClient::process_book_message(const std::string& payload) {
 
                     OrderBookRecord record;
                     record.timestamp = timestamp;
+                    record.recv_ts_ns = recv_ts_ns;
                     record.type = std::string(type_str);
 
                     // Extract symbol
@@ -407,22 +277,40 @@ void KrakenBookClient::process_book_message(const std::string& payload) {
                     }
 
                     // Validate checksum if enabled
-                    if (validate_checksums_ && !ChecksumValidator::validate(record)) {
-                        std::cerr << "[WARNING] Checksum validation failed for "
-                                  << record.symbol << std::endl;
+                    if (validate_checksums_) {
+                        KRAKEN_TRACE_SCOPE("book.checksum");
+                        if (!ChecksumValidator::validate(record)) {
+                            std::cerr << "[WARNING] Checksum validation failed for "
+                                      << record.symbol << std::endl;
+                        }
                     }
 
                     // Update statistics
                     {
+                        KRAKEN_TRACE_SCOPE("book.stats_lock");
                         std::lock_guard<std::mutex> lock(stats_mutex_);
                         auto it = stats_.find(record.symbol);
+                        if (it == stats_.end() && universe_) {
+                            // Symbol added at runtime by the universe
+                            it = stats_.emplace(record.symbol, OrderBookStats()).first;
+                        }
                         if (it != stats_.end()) {
                             OrderBookDisplay::update_stats(it->second, record);
                         }
                     }
 
+                    if (watchdog_) {
+                        watchdog_->on_data(record.symbol);
+                    }
+
+                    // Top-of-book filter
+                    if (bbo_tracking_) {
+                        update_bbo(record);
+                    }
+
                     // Notify callback
                     {
+                        KRAKEN_TRACE_SCOPE("book.callback");
                         std::lock_guard<std::mutex> lock(callback_mutex_);
                         if (update_callback_) {
                             update_callback_(record);
@@ -438,6 +326,42 @@ void KrakenBookClient::process_book_message(const std::string& payload) {
     }
 }
 
+void KrakenBookClient::update_bbo(const OrderBookRecord& record) {
+    KRAKEN_TRACE_SCOPE("book.bbo");
+
+    auto it = bbo_trackers_.find(record.symbol);
+    if (it == bbo_trackers_.end()) {
+        it = bbo_trackers_.emplace(record.symbol, BboTracker(record.symbol)).first;
+    }
+
+    BboTracker& tracker = it->second;
+    tracker.book.apply(record);
+    if (!tracker.book.is_initialized()) {
+        return;
+    }
+
+    BestBidOffer bbo;
+    if (!tracker.book.get_best_bid(bbo.bid_price, bbo.bid_qty)) {
+        bbo.bid_price = bbo.bid_qty = 0.0;
+    }
+    if (!tracker.book.get_best_ask(bbo.ask_price, bbo.ask_qty)) {
+        bbo.ask_price = bbo.ask_qty = 0.0;
+    }
+
+    if (tracker.has_last && bbo.same_top(tracker.last)) {
+        return;  // Deep-level change only
+    }
+
+    bbo.timestamp = record.timestamp;
+    tracker.last = bbo;
+    tracker.has_last = true;
+
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (bbo_callback_) {
+        bbo_callback_(record.symbol, bbo);
+    }
+}
+
 } // namespace kraken
 
 #endif // KRAKEN_BOOK_CLIENT_HPP
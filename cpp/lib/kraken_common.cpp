@@ -1,11 +1,15 @@
 #include "kraken_common.hpp"
+#include "alloc_counter.hpp"
 #include <iostream>
 #include <cctype>
+#include <cstdio>
+#include <ctime>
 
 namespace kraken {
 
 // Get current UTC timestamp
 std::string Utils::get_utc_timestamp() {
+    KRAKEN_ALLOC_SCOPE("utils.get_utc_timestamp");
     auto now = std::chrono::system_clock::now();
     auto time_t = std::chrono::system_clock::to_time_t(now);
     auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
@@ -18,40 +22,150 @@ std::string Utils::get_utc_timestamp() {
     return oss.str();
 }
 
+// Format a nanosecond timestamp (gmtime_r: safe on parser threads)
+std::string Utils::format_utc_timestamp(int64_t ns_since_epoch) {
+    std::time_t seconds = static_cast<std::time_t>(ns_since_epoch / 1000000000);
+    int ms = static_cast<int>((ns_since_epoch / 1000000) % 1000);
+
+    std::tm tm;
+    gmtime_r(&seconds, &tm);
+    // 23 characters in practice; sized for any int fields so the output
+    // is never truncated (and -Wformat-truncation can prove it)
+    char buffer[96];
+    std::snprintf(buffer, sizeof(buffer), "%04d-%02d-%02d %02d:%02d:%02d.%03d",
+                  tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday,
+                  tm.tm_hour, tm.tm_min, tm.tm_sec, ms);
+    return std::string(buffer);
+}
+
+constexpr size_t TickerHistory::CHUNK_RECORDS;
+
+// Append a record to the open chunk
+void TickerHistory::push_back(const TickerRecord& record) {
+    if (!open_) {
+        open_ = std::make_shared<Chunk>();
+        open_->reserve(CHUNK_RECORDS);
+    }
+    open_->push_back(record);
+    size_++;
+
+    if (open_->size() >= CHUNK_RECORDS) {
+        seal();
+    }
+}
+
+// Seal the open chunk and share the chunk list
+TickerHistory::Snapshot TickerHistory::snapshot() {
+    seal();
+    return sealed_;
+}
+
+// Drop all records
+void TickerHistory::clear() {
+    sealed_.clear();
+    open_.reset();
+    size_ = 0;
+}
+
+// Flatten into a vector
+std::vector<TickerRecord> TickerHistory::to_vector() const {
+    std::vector<TickerRecord> records;
+    records.reserve(size_);
+    for_each([&records](const TickerRecord& record) { records.push_back(record); });
+    return records;
+}
+
+// Count records in a snapshot
+size_t TickerHistory::count(const Snapshot& snapshot) {
+    size_t total = 0;
+    for (const auto& chunk : snapshot) {
+        total += chunk->size();
+    }
+    return total;
+}
+
+// Move the open chunk to the sealed list
+void TickerHistory::seal() {
+    // A sealed chunk is shared with snapshots and must not change afterwards
+    if (open_ && !open_->empty()) {
+        sealed_.push_back(open_);
+    }
+    open_.reset();
+}
+
 // Save ticker records to CSV
-void Utils::save_to_csv(const std::string& filename,
+bool Utils::save_to_csv(const std::string& filename,
                        const std::vector<TickerRecord>& records) {
     std::ofstream file(filename);
 
     if (!file.is_open()) {
         std::cerr << "Error: Could not open file " << filename << std::endl;
-        return;
+        return false;
     }
 
-    // Write header
-    file << "timestamp,pair,type,bid,bid_qty,ask,ask_qty,last,volume,vwap,low,high,change,change_pct\n";
-
-    // Write data
+    write_csv_header(file);
     for (const auto& record : records) {
-        file << record.timestamp << ","
-             << record.pair << ","
-             << record.type << ","
-             << record.bid << ","
-             << record.bid_qty << ","
-             << record.ask << ","
-             << record.ask_qty << ","
-             << record.last << ","
-             << record.volume << ","
-             << record.vwap << ","
-             << record.low << ","
-             << record.high << ","
-             << record.change << ","
-             << record.change_pct << "\n";
+        write_csv_record(file, record);
     }
 
     file.close();
+    if (file.fail()) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
     std::cout << "\nSaved to " << filename << std::endl;
     std::cout << "Total records: " << records.size() << std::endl;
+    return true;
+}
+
+// Save a history snapshot to CSV
+bool Utils::save_to_csv(const std::string& filename,
+                       const TickerHistory::Snapshot& snapshot) {
+    std::ofstream file(filename);
+
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open file " << filename << std::endl;
+        return false;
+    }
+
+    write_csv_header(file);
+    for (const auto& chunk : snapshot) {
+        for (const auto& record : *chunk) {
+            write_csv_record(file, record);
+        }
+    }
+
+    file.close();
+    if (file.fail()) {
+        std::cerr << "Error: Failed writing " << filename << std::endl;
+        return false;
+    }
+    std::cout << "\nSaved to " << filename << std::endl;
+    std::cout << "Total records: " << TickerHistory::count(snapshot) << std::endl;
+    return true;
+}
+
+// Write CSV header
+void Utils::write_csv_header(std::ostream& out) {
+    out << "timestamp,pair,type,bid,bid_qty,ask,ask_qty,last,volume,vwap,low,high,change,change_pct\n";
+}
+
+// Write a single record as CSV
+void Utils::write_csv_record(std::ostream& out, const TickerRecord& record) {
+    out << record.timestamp << ","
+        << record.pair << ","
+        << record.type << ","
+        << record.bid << ","
+        << record.bid_qty << ","
+        << record.ask << ","
+        << record.ask_qty << ","
+        << record.last << ","
+        << record.volume << ","
+        << record.vwap << ","
+        << record.low << ","
+        << record.high << ","
+        << record.change << ","
+        << record.change_pct << "\n";
 }
 
 // Print CSV header
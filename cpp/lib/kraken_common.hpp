@@ -3,10 +3,12 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 #include <fstream>
 #include <chrono>
 #include <iomanip>
 #include <sstream>
+#include <cstdint>
 
 namespace kraken {
 
@@ -26,6 +28,92 @@ struct TickerRecord {
     double high;
     double change;
     double change_pct;
+    int64_t recv_ts_ns = 0;     // Frame receive time (ns since epoch, 0 = unknown)
+};
+
+// Trade record structure - matches Kraken WebSocket v2 trade data
+// One record per executed trade; a single frame may carry many
+struct TradeRecord {
+    std::string timestamp;        // Local receive time
+    std::string symbol;
+    std::string type;             // "snapshot" or "update"
+    std::string side;             // "buy" or "sell" (taker side)
+    std::string ord_type;         // "market" or "limit"
+    double price;
+    double qty;
+    uint64_t trade_id;
+    std::string trade_timestamp;  // Exchange time (RFC3339)
+    int64_t recv_ts_ns;           // Frame receive time (ns since epoch, 0 = unknown)
+
+    TradeRecord() : price(0.0), qty(0.0), trade_id(0), recv_ts_ns(0) {}
+};
+
+/**
+ * Ticker history stored as immutable chunks
+ *
+ * Records are appended to an open chunk; full chunks are sealed and never
+ * modified again. snapshot() seals the open chunk and copies only the chunk
+ * pointers, so a consumer can read the records without holding the lock
+ * that guards the history while the owner keeps appending.
+ * Not thread-safe; the owner serializes access.
+ */
+class TickerHistory {
+public:
+    typedef std::vector<TickerRecord> Chunk;
+    typedef std::vector<std::shared_ptr<const Chunk>> Snapshot;
+
+    static constexpr size_t CHUNK_RECORDS = 1024;
+
+    TickerHistory() : size_(0) {}
+
+    /**
+     * Append a record (seals the open chunk once it is full)
+     */
+    void push_back(const TickerRecord& record);
+
+    /**
+     * Seal the open chunk and return the current chunk list
+     * Cost is one pointer copy per chunk; the records themselves are shared
+     */
+    Snapshot snapshot();
+
+    /**
+     * Drop all records (chunks held by snapshots stay alive)
+     */
+    void clear();
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    /**
+     * Visit every record in insertion order
+     */
+    template<typename Fn>
+    void for_each(Fn&& fn) const {
+        for (const auto& chunk : sealed_) {
+            for (const auto& record : *chunk) fn(record);
+        }
+        if (open_) {
+            for (const auto& record : *open_) fn(record);
+        }
+    }
+
+    /**
+     * Copy all records into a flat vector
+     */
+    std::vector<TickerRecord> to_vector() const;
+
+    /**
+     * Number of records in a snapshot
+     */
+    static size_t count(const Snapshot& snapshot);
+
+private:
+    void seal();
+
+    Snapshot sealed_;
+    std::shared_ptr<Chunk> open_;
+    size_t size_;
 };
 
 // Common utility functions
@@ -36,14 +124,41 @@ public:
      */
     static std::string get_utc_timestamp();
 
+    /**
+     * Format a time in the same format as get_utc_timestamp() (thread-safe)
+     * @param ns_since_epoch Realtime clock in nanoseconds (e.g. a receive stamp)
+     */
+    static std::string format_utc_timestamp(int64_t ns_since_epoch);
+
     /**
      * Save ticker records to CSV file
      * @param filename Output CSV filename
      * @param records Vector of ticker records to save
+     * @return false if the file could not be written
      */
-    static void save_to_csv(const std::string& filename,
+    static bool save_to_csv(const std::string& filename,
                            const std::vector<TickerRecord>& records);
 
+    /**
+     * Save a ticker history snapshot to CSV file
+     * Safe to call without the history's lock (snapshot chunks are immutable)
+     * @param filename Output CSV filename
+     * @param snapshot Chunks from TickerHistory::snapshot()
+     * @return false if the file could not be written
+     */
+    static bool save_to_csv(const std::string& filename,
+                           const TickerHistory::Snapshot& snapshot);
+
+    /**
+     * Write the ticker CSV header line
+     */
+    static void write_csv_header(std::ostream& out);
+
+    /**
+     * Write a single ticker record as a CSV line
+     */
+    static void write_csv_record(std::ostream& out, const TickerRecord& record);
+
     /**
      * Print CSV header to console
      */
@@ -3,6 +3,8 @@
  */
 
 #include "kraken_level3_client.hpp"
+#include "alloc_counter.hpp"
+#include "stage_trace.hpp"
 
 namespace kraken {
 
@@ -11,19 +13,16 @@ namespace kraken {
 // ============================================================================
 
 KrakenLevel3Client::KrakenLevel3Client(int depth, const std::string& token)
-    : depth_(depth), token_(token), running_(false), connected_(false) {
-
-    // Initialize WebSocket client
-    ws_client_.clear_access_channels(websocketpp::log::alevel::all);
-    ws_client_.clear_error_channels(websocketpp::log::elevel::all);
-    ws_client_.init_asio();
-    ws_client_.set_tls_init_handler(std::bind(
-        &KrakenLevel3Client::on_tls_init, this, std::placeholders::_1
-    ));
+    : depth_(depth), token_(token), l2_derivation_(false),
+      checksum_validation_(false), resync_on_mismatch_(true), max_resyncs_(5),
+      parse_threads_(0) {
 }
 
 KrakenLevel3Client::~KrakenLevel3Client() {
     stop();
+
+    // Deliver queued frames while books and callbacks still exist
+    drain_parse_pool();
 }
 
 bool KrakenLevel3Client::set_token(const std::string& token) {
@@ -74,19 +73,12 @@ bool KrakenLevel3Client::has_token() const {
     return !token_.empty();
 }
 
-bool KrakenLevel3Client::start(const std::vector<std::string>& symbols) {
-    if (running_) {
-        return false;
-    }
-
+bool KrakenLevel3Client::prepare_start() {
     if (!has_token()) {
         notify_error("No authentication token provided. Set via --token, --token-file, or KRAKEN_WS_TOKEN environment variable.");
         return false;
     }
 
-    symbols_ = symbols;
-    running_ = true;
-
     // Initialize statistics
     {
         std::lock_guard<std::mutex> lock(stats_mutex_);
@@ -96,31 +88,16 @@ bool KrakenLevel3Client::start(const std::vector<std::string>& symbols) {
         }
     }
 
-    // Start worker thread
-    worker_thread_ = std::thread(&KrakenLevel3Client::run_client, this);
-
-    return true;
-}
-
-void KrakenLevel3Client::stop() {
-    if (!running_) {
-        return;
-    }
-
-    running_ = false;
-    ws_client_.stop();
-
-    if (worker_thread_.joinable()) {
-        worker_thread_.join();
+    // Parser threads (a stopped pool cannot be restarted)
+    if (parse_threads_ > 0) {
+        parse_pool_.reset(new ParsePool(parse_threads_, parse_placement_));
     }
+    return true;
 }
 
-bool KrakenLevel3Client::is_connected() const {
-    return connected_;
-}
-
-bool KrakenLevel3Client::is_running() const {
-    return running_;
+void KrakenLevel3Client::on_stopped() {
+    // No more frames: deliver what the parser threads still hold
+    drain_parse_pool();
 }
 
 void KrakenLevel3Client::set_update_callback(UpdateCallback callback) {
@@ -128,14 +105,22 @@ void KrakenLevel3Client::set_update_callback(UpdateCallback callback) {
     update_callback_ = callback;
 }
 
-void KrakenLevel3Client::set_connection_callback(ConnectionCallback callback) {
+void KrakenLevel3Client::set_l2_update_callback(L2UpdateCallback callback) {
     std::lock_guard<std::mutex> lock(callback_mutex_);
-    connection_callback_ = callback;
+    l2_callback_ = callback;
+    l2_derivation_ = static_cast<bool>(l2_callback_);
 }
 
-void KrakenLevel3Client::set_error_callback(ErrorCallback callback) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    error_callback_ = callback;
+void KrakenLevel3Client::set_checksum_validation(bool enabled, bool resync_on_mismatch,
+                                                 int max_resyncs) {
+    resync_on_mismatch_ = resync_on_mismatch;
+    max_resyncs_ = max_resyncs;
+    checksum_validation_ = enabled;
+}
+
+void KrakenLevel3Client::set_checksum_precision(const std::string& symbol,
+                                                int price_precision, int qty_precision) {
+    checksum_precision_[symbol] = std::make_pair(price_precision, qty_precision);
 }
 
 std::map<std::string, Level3Stats> KrakenLevel3Client::get_stats() const {
@@ -143,125 +128,75 @@ std::map<std::string, Level3Stats> KrakenLevel3Client::get_stats() const {
     return stats_;
 }
 
-KrakenLevel3Client::context_ptr KrakenLevel3Client::on_tls_init(websocketpp::connection_hdl) {
-    context_ptr ctx = websocketpp::lib::make_shared<boost::asio::ssl::context>(
-        boost::asio::ssl::context::tlsv12
-    );
-
-    try {
-        ctx->set_options(
-            boost::asio::ssl::context::default_workarounds |
-            boost::asio::ssl::context::no_sslv2 |
-            boost::asio::ssl::context::no_sslv3 |
-            boost::asio::ssl::context::single_dh_use
-        );
-    } catch (std::exception& e) {
-        notify_error(std::string("TLS init error: ") + e.what());
+void KrakenLevel3Client::set_parse_threads(size_t threads, const ThreadPlacement& placement) {
+    if (running_) {
+        std::cerr << "[Error] set_parse_threads() must be called before start()" << std::endl;
+        return;
     }
-
-    return ctx;
+    parse_threads_ = threads;
+    parse_placement_ = placement;
 }
 
-void KrakenLevel3Client::on_open(websocketpp::connection_hdl hdl) {
-    connection_hdl_ = hdl;
-    connected_ = true;
-    notify_connection(true);
-
-    // Send subscription
-    std::string subscribe_msg = build_subscription();
-
-    try {
-        ws_client_.send(hdl, subscribe_msg, websocketpp::frame::opcode::text);
-    } catch (const std::exception& e) {
-        notify_error(std::string("Failed to send subscription: ") + e.what());
+void KrakenLevel3Client::drain_parse_pool() {
+    if (parse_pool_) {
+        parse_pool_->stop();
     }
 }
 
-void KrakenLevel3Client::on_close(websocketpp::connection_hdl) {
-    connected_ = false;
-    notify_connection(false);
-}
-
-void KrakenLevel3Client::on_fail(websocketpp::connection_hdl) {
-    connected_ = false;
-    notify_connection(false);
-    notify_error("WebSocket connection failed");
+ParsePool::PoolStats KrakenLevel3Client::get_parse_stats() const {
+    if (!parse_pool_) {
+        ParsePool::PoolStats stats = {};
+        return stats;
+    }
+    return parse_pool_->get_stats();
 }
 
-void KrakenLevel3Client::on_message(websocketpp::connection_hdl, client::message_ptr msg) {
+void KrakenLevel3Client::handle_frame(client::message_ptr msg, int64_t recv_ts_ns) {
+    if (parse_pool_ && offload_level3_message(msg, recv_ts_ns)) {
+        return;
+    }
     const std::string& payload = msg->get_payload();
-    process_level3_message(payload);
+    process_level3_message(payload, recv_ts_ns);
 }
 
-void KrakenLevel3Client::run_client() {
-    try {
-        // Set handlers
-        ws_client_.set_open_handler(std::bind(
-            &KrakenLevel3Client::on_open, this, std::placeholders::_1
-        ));
-        ws_client_.set_close_handler(std::bind(
-            &KrakenLevel3Client::on_close, this, std::placeholders::_1
-        ));
-        ws_client_.set_fail_handler(std::bind(
-            &KrakenLevel3Client::on_fail, this, std::placeholders::_1
-        ));
-        ws_client_.set_message_handler(std::bind(
-            &KrakenLevel3Client::on_message, this, std::placeholders::_1, std::placeholders::_2
-        ));
-
-        // Connect to Kraken WebSocket v2
-        const std::string uri = "wss://ws.kraken.com/v2";
-        websocketpp::lib::error_code ec;
-        client::connection_ptr con = ws_client_.get_connection(uri, ec);
-
-        if (ec) {
-            notify_error(std::string("Connection init error: ") + ec.message());
-            running_ = false;
-            return;
-        }
-
-        ws_client_.connect(con);
-        ws_client_.run();
+std::string KrakenLevel3Client::build_subscription(const std::vector<std::string>& symbols) const {
+    std::ostringstream oss;
+    oss << R"({"method":"subscribe","params":{)";
+    oss << R"("channel":"level3",)";
+    oss << R"("symbol":[)";
 
-    } catch (const std::exception& e) {
-        notify_error(std::string("WebSocket error: ") + e.what());
-        running_ = false;
+    for (size_t i = 0; i < symbols.size(); ++i) {
+        if (i > 0) oss << ",";
+        oss << "\"" << symbols[i] << "\"";
     }
-}
 
-void KrakenLevel3Client::notify_connection(bool connected) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    if (connection_callback_) {
-        connection_callback_(connected);
-    }
-}
+    oss << R"(],"depth":)" << depth_ << ",";
+    oss << R"("snapshot":true,)";
+    oss << R"("token":")" << token_ << R"("})})";
 
-void KrakenLevel3Client::notify_error(const std::string& error) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    if (error_callback_) {
-        error_callback_(error);
-    }
+    return oss.str();
 }
 
-std::string KrakenLevel3Client::build_subscription() const {
+std::string KrakenLevel3Client::build_unsubscribe(const std::vector<std::string>& symbols) const {
     std::ostringstream oss;
-    oss << R"({"method":"subscribe","params":{)";
+    oss << R"({"method":"unsubscribe","params":{)";
     oss << R"("channel":"level3",)";
     oss << R"("symbol":[)";
 
-    for (size_t i = 0; i < symbols_.size(); ++i) {
+    for (size_t i = 0; i < symbols.size(); ++i) {
         if (i > 0) oss << ",";
-        oss << "\"" << symbols_[i] << "\"";
+        oss << "\"" << symbols[i] << "\"";
     }
 
     oss << R"(],"depth":)" << depth_ << ",";
-    oss << R"("snapshot":true,)";
     oss << R"("token":")" << token_ << R"("})})";
 
     return oss.str();
 }
 
-void KrakenLevel3Client::process_level3_message(const std::string& payload) {
+void KrakenLevel3Client::process_level3_message(const std::string& payload, int64_t recv_ts_ns) {
+    KRAKEN_ALLOC_SCOPE("level3_client.process_message");
+    KRAKEN_TRACE_SCOPE("level3.parse");
     try {
         simdjson::ondemand::parser parser;
         simdjson::padded_string padded(payload);
@@ -270,6 +205,7 @@ void KrakenLevel3Client::process_level3_message(const std::string& payload) {
         // Handle subscription response
         if (auto method_result = doc["method"]; !method_result.error()) {
             std::string_view method = method_result.value();
+
             if (method == "subscribe") {
                 if (auto success_result = doc["success"]; !success_result.error()) {
                     bool success = success_result.value();
@@ -294,141 +230,381 @@ void KrakenLevel3Client::process_level3_message(const std::string& payload) {
         if (auto channel_result = doc["channel"]; !channel_result.error()) {
             std::string_view channel = channel_result.value();
             if (channel == "heartbeat") {
+                if (watchdog_) {
+                    watchdog_->on_heartbeat();
+                }
                 return;
             }
 
             // Handle level3 messages
             if (channel == "level3") {
-                auto type_result = doc["type"];
-                if (type_result.error()) return;
+                records_.clear();
+                decode_level3_records(doc, recv_ts_ns, records_);
+                for (const auto& record : records_) {
+                    if (watchdog_) {
+                        watchdog_->on_data(record.symbol);
+                    }
+                    deliver_record(record);
+                }
+            }
+        }
+
+    } catch (const simdjson::simdjson_error& e) {
+        std::cerr << "[ERROR] simdjson parsing error: "
+                  << simdjson::error_message(e.error()) << std::endl;
+    }
+}
+
+bool KrakenLevel3Client::decode_level3_records(simdjson::ondemand::document& doc, int64_t recv_ts_ns,
+                                               std::vector<Level3Record>& records) {
+    KRAKEN_TRACE_SCOPE("level3.decode");
+    try {
+        auto type_result = doc["type"];
+        if (type_result.error()) return true;
+
+        std::string_view type_str = type_result.value();
+        if (type_str != "snapshot" && type_str != "update") return true;
 
-                std::string_view type_str = type_result.value();
-                if (type_str != "snapshot" && type_str != "update") return;
+        // Receive time, not decode time: frames may wait for a parser thread
+        std::string timestamp = Utils::format_utc_timestamp(recv_ts_ns);
 
-                std::string timestamp = Utils::get_utc_timestamp();
+        // Parse data array
+        auto data_result = doc["data"];
+        if (data_result.error()) return true;
 
-                // Parse data array
-                auto data_result = doc["data"];
-                if (data_result.error()) return;
+        simdjson::ondemand::array data_array = data_result.value();
 
-                simdjson::ondemand::array data_array = data_result.value();
+        for (auto level3_value : data_array) {
+            simdjson::ondemand::object level3_obj = level3_value.get_object();
 
-                for (auto level3_value : data_array) {
-                    simdjson::ondemand::object level3_obj = level3_value.get_object();
+            Level3Record record;
+            record.timestamp = timestamp;
+            record.recv_ts_ns = recv_ts_ns;
+            record.type = std::string(type_str);
 
-                    Level3Record record;
-                    record.timestamp = timestamp;
-                    record.type = std::string(type_str);
+            // Extract symbol
+            if (auto symbol = level3_obj["symbol"]; !symbol.error()) {
+                std::string_view sv = symbol.value();
+                record.symbol = std::string(sv);
+            }
+
+            // Extract bids (Level 3: array of orders)
+            if (auto bids = level3_obj["bids"]; !bids.error()) {
+                simdjson::ondemand::array bids_array = bids.value();
+                for (auto bid_value : bids_array) {
+                    simdjson::ondemand::object bid_obj = bid_value.get_object();
+
+                    Level3Order order;
 
-                    // Extract symbol
-                    if (auto symbol = level3_obj["symbol"]; !symbol.error()) {
-                        std::string_view sv = symbol.value();
-                        record.symbol = std::string(sv);
+                    // Event (for updates only)
+                    if (auto event_field = bid_obj["event"]; !event_field.error()) {
+                        std::string_view event_sv = event_field.value();
+                        order.event = std::string(event_sv);
                     }
 
-                    // Extract bids (Level 3: array of orders)
-                    if (auto bids = level3_obj["bids"]; !bids.error()) {
-                        simdjson::ondemand::array bids_array = bids.value();
-                        for (auto bid_value : bids_array) {
-                            simdjson::ondemand::object bid_obj = bid_value.get_object();
-
-                            Level3Order order;
-
-                            // Event (for updates only)
-                            if (auto event_field = bid_obj["event"]; !event_field.error()) {
-                                std::string_view event_sv = event_field.value();
-                                order.event = std::string(event_sv);
-                            }
-
-                            // Order ID
-                            if (auto order_id = bid_obj["order_id"]; !order_id.error()) {
-                                std::string_view id_sv = order_id.value();
-                                order.order_id = std::string(id_sv);
-                            }
-
-                            // Limit price
-                            if (auto limit_price = bid_obj["limit_price"]; !limit_price.error()) {
-                                order.limit_price = limit_price.get_double();
-                            }
-
-                            // Order quantity
-                            if (auto order_qty = bid_obj["order_qty"]; !order_qty.error()) {
-                                order.order_qty = order_qty.get_double();
-                            }
-
-                            // Timestamp
-                            if (auto ts = bid_obj["timestamp"]; !ts.error()) {
-                                std::string_view ts_sv = ts.value();
-                                order.timestamp = std::string(ts_sv);
-                            }
-
-                            record.bids.push_back(order);
-                        }
+                    // Order ID
+                    if (auto order_id = bid_obj["order_id"]; !order_id.error()) {
+                        std::string_view id_sv = order_id.value();
+                        order.order_id = std::string(id_sv);
                     }
 
-                    // Extract asks (same structure as bids)
-                    if (auto asks = level3_obj["asks"]; !asks.error()) {
-                        simdjson::ondemand::array asks_array = asks.value();
-                        for (auto ask_value : asks_array) {
-                            simdjson::ondemand::object ask_obj = ask_value.get_object();
+                    // Limit price
+                    if (auto limit_price = bid_obj["limit_price"]; !limit_price.error()) {
+                        order.limit_price = limit_price.get_double();
+                    }
 
-                            Level3Order order;
+                    // Order quantity
+                    if (auto order_qty = bid_obj["order_qty"]; !order_qty.error()) {
+                        order.order_qty = order_qty.get_double();
+                    }
 
-                            if (auto event_field = ask_obj["event"]; !event_field.error()) {
-                                std::string_view event_sv = event_field.value();
-                                order.event = std::string(event_sv);
-                            }
+                    // Timestamp
+                    if (auto ts = bid_obj["timestamp"]; !ts.error()) {
+                        std::string_view ts_sv = ts.value();
+                        order.timestamp = std::string(ts_sv);
+                    }
 
-                            if (auto order_id = ask_obj["order_id"]; !order_id.error()) {
-                                std::string_view id_sv = order_id.value();
-                                order.order_id = std::string(id_sv);
-                            }
+                    record.bids.push_back(order);
+                }
+            }
 
-                            if (auto limit_price = ask_obj["limit_price"]; !limit_price.error()) {
-                                order.limit_price = limit_price.get_double();
-                            }
+            // Extract asks (same structure as bids)
+            if (auto asks = level3_obj["asks"]; !asks.error()) {
+                simdjson::ondemand::array asks_array = asks.value();
+                for (auto ask_value : asks_array) {
+                    simdjson::ondemand::object ask_obj = ask_value.get_object();
 
-                            if (auto order_qty = ask_obj["order_qty"]; !order_qty.error()) {
-                                order.order_qty = order_qty.get_double();
-                            }
+                    Level3Order order;
 
-                            if (auto ts = ask_obj["timestamp"]; !ts.error()) {
-                                std::string_view ts_sv = ts.value();
-                                order.timestamp = std::string(ts_sv);
-                            }
+                    if (auto event_field = ask_obj["event"]; !event_field.error()) {
+                        std::string_view event_sv = event_field.value();
+                        order.event = std::string(event_sv);
+                    }
 
-                            record.asks.push_back(order);
-                        }
+                    if (auto order_id = ask_obj["order_id"]; !order_id.error()) {
+                        std::string_view id_sv = order_id.value();
+                        order.order_id = std::string(id_sv);
                     }
 
-                    // Extract checksum
-                    if (auto checksum = level3_obj["checksum"]; !checksum.error()) {
-                        record.checksum = static_cast<uint32_t>(checksum.get_uint64());
+                    if (auto limit_price = ask_obj["limit_price"]; !limit_price.error()) {
+                        order.limit_price = limit_price.get_double();
                     }
 
-                    // Update statistics
-                    {
-                        std::lock_guard<std::mutex> lock(stats_mutex_);
-                        auto it = stats_.find(record.symbol);
-                        if (it != stats_.end()) {
-                            Level3Display::update_stats(it->second, record);
-                        }
+                    if (auto order_qty = ask_obj["order_qty"]; !order_qty.error()) {
+                        order.order_qty = order_qty.get_double();
                     }
 
-                    // Notify callback
-                    {
-                        std::lock_guard<std::mutex> lock(callback_mutex_);
-                        if (update_callback_) {
-                            update_callback_(record);
-                        }
+                    if (auto ts = ask_obj["timestamp"]; !ts.error()) {
+                        std::string_view ts_sv = ts.value();
+                        order.timestamp = std::string(ts_sv);
                     }
+
+                    record.asks.push_back(order);
                 }
             }
-        }
 
+            // Extract checksum
+            if (auto checksum = level3_obj["checksum"]; !checksum.error()) {
+                record.checksum = static_cast<uint32_t>(checksum.get_uint64());
+            }
+
+            records.push_back(std::move(record));
+        }
     } catch (const simdjson::simdjson_error& e) {
         std::cerr << "[ERROR] simdjson parsing error: "
                   << simdjson::error_message(e.error()) << std::endl;
+        return false;  // Records decoded before the error are kept
+    }
+    return true;
+}
+
+void KrakenLevel3Client::deliver_record(const Level3Record& record) {
+    // Maintained book: checksum validation and L2 derivation
+    ChecksumResult checksum_result = ChecksumResult::NOT_CHECKED;
+    if (checksum_validation_ || l2_derivation_) {
+        checksum_result = maintain_book(record);
+    }
+
+    // Update statistics
+    {
+        KRAKEN_TRACE_SCOPE("level3.stats_lock");
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        auto it = stats_.find(record.symbol);
+        if (it == stats_.end() && universe_) {
+            // Symbol added at runtime by the universe
+            it = stats_.emplace(record.symbol, Level3Stats()).first;
+        }
+        if (it != stats_.end()) {
+            Level3Display::update_stats(it->second, record);
+            if (checksum_result != ChecksumResult::NOT_CHECKED) {
+                it->second.checksum_checks++;
+            }
+            if (checksum_result == ChecksumResult::MISMATCH ||
+                checksum_result == ChecksumResult::MISMATCH_RESYNC) {
+                it->second.checksum_mismatches++;
+            }
+            if (checksum_result == ChecksumResult::MISMATCH_RESYNC) {
+                it->second.resync_count++;
+            }
+        }
+    }
+
+    // Notify callback
+    {
+        KRAKEN_TRACE_SCOPE("level3.callback");
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        if (update_callback_) {
+            update_callback_(record);
+        }
+    }
+}
+
+bool KrakenLevel3Client::offload_level3_message(client::message_ptr msg, int64_t recv_ts_ns) {
+    // Control messages and heartbeats drive I/O thread state: parsed inline
+    std::string symbol;
+    if (!peek_level3_symbol(msg->get_payload(), symbol)) {
+        return false;
+    }
+
+    // The frame is shared, not copied; decoded records travel with the delivery step
+    bool accepted = parse_pool_->submit(symbol, [this, msg, recv_ts_ns]() {
+        KRAKEN_ALLOC_SCOPE("level3_client.process_message");
+        KRAKEN_TRACE_SCOPE("level3.parse");
+        std::shared_ptr<std::vector<Level3Record>> records(new std::vector<Level3Record>());
+        try {
+            simdjson::ondemand::parser parser;
+            simdjson::padded_string padded(msg->get_payload());
+            simdjson::ondemand::document doc = parser.iterate(padded);
+            decode_level3_records(doc, recv_ts_ns, *records);
+        } catch (const simdjson::simdjson_error& e) {
+            std::cerr << "[ERROR] simdjson parsing error: "
+                      << simdjson::error_message(e.error()) << std::endl;
+        }
+
+        if (records->empty()) {
+            return ParsePool::Deliver();
+        }
+        return ParsePool::Deliver([this, records]() {
+            for (const auto& record : *records) {
+                deliver_record(record);
+            }
+        });
+    });
+
+    // A drained (stopped) pool rejects the frame: the caller parses it inline
+    if (!accepted) {
+        return false;
+    }
+    if (watchdog_) {
+        watchdog_->on_data(symbol);
+    }
+    return true;
+}
+
+bool KrakenLevel3Client::peek_level3_symbol(const std::string& payload, std::string& symbol) {
+    // Kraken writes the channel first in data frames (acknowledgements start
+    // with "method"), and a level3 frame carries a single symbol
+    static const char channel_prefix[] = "{\"channel\":\"level3\"";
+    static const char symbol_key[] = "\"symbol\":\"";
+    const size_t prefix_length = sizeof(channel_prefix) - 1;
+
+    if (payload.compare(0, prefix_length, channel_prefix) != 0) {
+        return false;
+    }
+
+    size_t begin = payload.find(symbol_key, prefix_length);
+    if (begin == std::string::npos) {
+        return false;
+    }
+    begin += sizeof(symbol_key) - 1;
+    size_t end = payload.find('"', begin);
+    if (end == std::string::npos) {
+        return false;
+    }
+
+    symbol.assign(payload, begin, end - begin);
+    return true;
+}
+
+KrakenLevel3Client::ChecksumResult KrakenLevel3Client::maintain_book(const Level3Record& record) {
+    KRAKEN_TRACE_SCOPE("level3.book");
+
+    // Map nodes are stable; the tracker itself belongs to this symbol's delivery
+    std::unique_lock<std::mutex> books_lock(books_mutex_);
+    auto it = books_.find(record.symbol);
+    if (it == books_.end()) {
+        BookTracker tracker;
+        tracker.state.reset(new Level3OrderBookState(record.symbol));
+        tracker.resyncing = false;
+        tracker.diverged = false;
+        tracker.log_only = false;
+        tracker.resync_attempts = 0;
+
+        auto precision = checksum_precision_.find(record.symbol);
+        if (precision == checksum_precision_.end()) {
+            precision = checksum_precision_.find("*");
+        }
+        if (precision != checksum_precision_.end()) {
+            tracker.state->set_checksum_precision(precision->second.first, precision->second.second);
+        }
+        if (checksum_validation_ && !tracker.state->precision_known()) {
+            std::cout << "[CHECKSUM] No precision configured for " << record.symbol
+                      << ", checksum not verified" << std::endl;
+        }
+        it = books_.emplace(record.symbol, std::move(tracker)).first;
+    }
+    books_lock.unlock();
+
+    BookTracker& book = it->second;
+    Level3OrderBookState& state = *book.state;
+    if (record.type == "snapshot") {
+        state.apply_snapshot(record);
+        book.resyncing = false;
+    } else if (book.resyncing) {
+        return ChecksumResult::NOT_CHECKED;  // Stale stream, wait for the snapshot
+    } else {
+        state.apply_update(record);
+    }
+
+    // Inferred decimals do not reproduce Kraken's strings: verifying them
+    // would only produce false mismatches (and resubscribes)
+    ChecksumResult result = ChecksumResult::NOT_CHECKED;
+    if (checksum_validation_ && state.precision_known()) {
+        KRAKEN_TRACE_SCOPE("level3.checksum");
+        uint32_t expected = record.checksum;
+        auto now = std::chrono::steady_clock::now();
+        if (state.verify_checksum(expected)) {
+            // Healthy past the backoff window: later divergence starts over
+            if (book.resync_attempts > 0 && now >= book.next_resync) {
+                book.resync_attempts = 0;
+            }
+            book.diverged = false;
+            result = ChecksumResult::MATCH;
+        } else {
+            result = ChecksumResult::MISMATCH;
+            if (!book.diverged) {
+                std::ostringstream oss;
+                oss << "Level 3 checksum mismatch for " << record.symbol
+                    << " (expected " << expected << ", computed " << state.calculate_checksum() << ")";
+                notify_error(oss.str());
+                book.diverged = true;
+            }
+
+            if (resync_on_mismatch_ && !book.log_only && now >= book.next_resync) {
+                if (book.resync_attempts >= max_resyncs_) {
+                    book.log_only = true;
+                    std::ostringstream oss;
+                    oss << "Level 3 checksum for " << record.symbol << " still diverges after "
+                        << book.resync_attempts << " resyncs, logging mismatches only";
+                    notify_error(oss.str());
+                } else {
+                    // 1s, 2s, 4s, ... capped at 60s between resyncs of a symbol
+                    long delay_ms = std::min(1000L << std::min(book.resync_attempts, 6), 60000L);
+                    book.resync_attempts++;
+                    book.next_resync = now + std::chrono::milliseconds(delay_ms);
+                    book.resyncing = true;
+                    book.diverged = false;  // Report the next divergence after the snapshot
+                    request_resync(record.symbol);
+                    result = ChecksumResult::MISMATCH_RESYNC;
+                }
+            }
+            return result;  // Diverged book produces no L2 output
+        }
+    }
+
+    if (l2_derivation_ && state.take_l2_update(record.timestamp, book.l2_record)) {
+        KRAKEN_TRACE_SCOPE("level3.derive_l2");
+        book.l2_record.recv_ts_ns = record.recv_ts_ns;
+        std::lock_guard<std::mutex> lock(callback_mutex_);
+        if (l2_callback_) {
+            l2_callback_(book.l2_record);
+        }
+    }
+
+    return result;
+}
+
+void KrakenLevel3Client::request_resync(const std::string& symbol) {
+    // Sends belong to the I/O thread; parser threads hand the request over
+    if (parse_pool_) {
+        boost::asio::post(ws_client_.get_io_service(), [this, symbol]() {
+            send_resync(symbol);
+        });
+        return;
+    }
+    send_resync(symbol);
+}
+
+void KrakenLevel3Client::send_resync(const std::string& symbol) {
+    // Unsubscribe + subscribe makes the server send a fresh snapshot
+    std::vector<std::string> symbols(1, symbol);
+
+    try {
+        ws_client_.send(connection_hdl_, build_unsubscribe(symbols), websocketpp::frame::opcode::text);
+        ws_client_.send(connection_hdl_, build_subscription(symbols), websocketpp::frame::opcode::text);
+        std::cout << "[CHECKSUM] Resubscribing " << symbol << " for a fresh snapshot" << std::endl;
+    } catch (const std::exception& e) {
+        notify_error(std::string("Failed to send resync request: ") + e.what());
     }
 }
 
@@ -3,6 +3,15 @@
  *
  * Subscribes to Kraken WebSocket v2 level3 channel with authentication
  * and processes individual order-level data.
+ *
+ * Optionally maintains the order-level book per symbol to:
+ * - verify the Kraken checksum on every message, resubscribing the symbol
+ *   (fresh snapshot) when the reconstructed book diverges
+ * - derive the aggregated (L2) book, so L2 consumers do not need a separate
+ *   book subscription
+ *
+ * Optionally decodes level3 frames on a ParsePool instead of the I/O thread
+ * (set_parse_threads()); records are still delivered in order per symbol.
  */
 
 #ifndef KRAKEN_LEVEL3_CLIENT_HPP
@@ -10,7 +19,6 @@
 
 #include <string>
 #include <vector>
-#include <thread>
 #include <mutex>
 #include <atomic>
 #include <functional>
@@ -19,24 +27,32 @@
 #include <map>
 #include <fstream>
 #include <cstdlib>
-#include <websocketpp/config/asio_client.hpp>
-#include <websocketpp/client.hpp>
+#include <memory>
+#include <chrono>
 #include <simdjson.h>
 #include "level3_common.hpp"
+#include "level3_state.hpp"
+#include "orderbook_common.hpp"
 #include "kraken_common.hpp"
+#include "kraken_stream_client_base.hpp"
+#include "parse_pool.hpp"
 
 namespace kraken {
 
 /**
  * WebSocket client for Level 3 order book data
  * Requires authentication token
+ *
+ * Connection handling (I/O thread, TLS, socket options, symbol universe,
+ * watchdog) comes from KrakenStreamClientBase.
  */
-class KrakenLevel3Client {
+class KrakenLevel3Client : public KrakenStreamClientBase<KrakenLevel3Client> {
+    friend class KrakenStreamClientBase<KrakenLevel3Client>;
+
 public:
     // Type definitions
     using UpdateCallback = std::function<void(const Level3Record&)>;
-    using ConnectionCallback = std::function<void(bool connected)>;
-    using ErrorCallback = std::function<void(const std::string& error)>;
+    using L2UpdateCallback = std::function<void(const OrderBookRecord&)>;
 
     /**
      * Constructor
@@ -50,10 +66,6 @@ public:
      */
     ~KrakenLevel3Client();
 
-    // Disable copy
-    KrakenLevel3Client(const KrakenLevel3Client&) = delete;
-    KrakenLevel3Client& operator=(const KrakenLevel3Client&) = delete;
-
     /**
      * Set authentication token
      * Priority: explicit token > token file > environment variable
@@ -68,81 +80,135 @@ public:
     bool has_token() const;
 
     /**
-     * Start WebSocket connection and subscribe to symbols
+     * Set callbacks
      */
-    bool start(const std::vector<std::string>& symbols);
+    void set_update_callback(UpdateCallback callback);
 
     /**
-     * Stop WebSocket connection
+     * Call back with L2 records derived from the Level 3 book
+     *
+     * The client maintains Level3OrderBookState per symbol and emits an
+     * OrderBookRecord ("snapshot", then "update" with quantity 0 for removed
+     * levels) whenever an aggregated price level changes. Records carry the
+     * L2 checksum of the aggregated top 10 and can go straight to
+     * OrderBookState, JsonLinesWriter or MetricsCalculator consumers.
+     * NOTE: Should be called BEFORE start()
      */
-    void stop();
+    void set_l2_update_callback(L2UpdateCallback callback);
 
     /**
-     * Check if connected
+     * Verify the checksum of every message against the maintained book
+     * Only symbols with a configured precision (set_checksum_precision) are
+     * verified; an inferred precision cannot reproduce Kraken's strings.
+     * Mismatches are counted in Level3Stats and reported via the error
+     * callback; with resync_on_mismatch the symbol is unsubscribed and
+     * subscribed again, and its updates are dropped until the new snapshot.
+     * Resyncs of a symbol back off (1s, 2s, 4s, ... capped at 60s); after
+     * max_resyncs without a healthy book the symbol falls back to log-only.
+     * NOTE: Should be called BEFORE start()
      */
-    bool is_connected() const;
+    void set_checksum_validation(bool enabled, bool resync_on_mismatch = true, int max_resyncs = 5);
 
     /**
-     * Check if running
+     * Price/qty decimals used for a symbol's checksum
+     * Take them from the instrument channel (price_precision, qty_precision).
+     * Symbol "*" sets the default for symbols without their own entry.
+     * -1 infers the precision from data, which disables verification.
+     * NOTE: Should be called BEFORE start()
      */
-    bool is_running() const;
+    void set_checksum_precision(const std::string& symbol, int price_precision, int qty_precision);
 
     /**
-     * Set callbacks
+     * Get statistics per symbol
      */
-    void set_update_callback(UpdateCallback callback);
-    void set_connection_callback(ConnectionCallback callback);
-    void set_error_callback(ErrorCallback callback);
+    std::map<std::string, Level3Stats> get_stats() const;
 
     /**
-     * Get statistics per symbol
+     * Decode level3 frames on a pool of parser threads (call before start())
+     * The I/O thread only stamps each frame and queues it; per-symbol order
+     * of books, statistics and callbacks is kept by the pool's sequencing
+     * stage. Callbacks then run on parser threads (still one at a time).
+     * @param threads Parser threads (0 = parse on the I/O thread, default)
+     * @param placement Parser threads' placement
      */
-    std::map<std::string, Level3Stats> get_stats() const;
+    void set_parse_threads(size_t threads, const ThreadPlacement& placement = ThreadPlacement());
 
-private:
-    // WebSocket types
-    typedef websocketpp::client<websocketpp::config::asio_tls_client> client;
-    typedef websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context> context_ptr;
+    /**
+     * Deliver all frames still queued for the parser threads and join them
+     * stop() does this on the own I/O thread; with set_io_service() call it
+     * once the shared io_service has stopped, before tearing down consumers.
+     */
+    void drain_parse_pool();
 
+    /**
+     * Get parse pool counters (zeros when parsing on the I/O thread)
+     */
+    ParsePool::PoolStats get_parse_stats() const;
+
+private:
     // Configuration
     int depth_;
     std::string token_;
 
-    // WebSocket client and connection
-    client ws_client_;
-    websocketpp::connection_hdl connection_hdl_;
-    std::thread worker_thread_;
-
-    // State
-    std::atomic<bool> running_;
-    std::atomic<bool> connected_;
-    std::vector<std::string> symbols_;
-
     // Statistics (protected by stats_mutex_)
     mutable std::mutex stats_mutex_;
     std::map<std::string, Level3Stats> stats_;
 
-    // Callbacks (protected by callback_mutex_)
-    mutable std::mutex callback_mutex_;
+    // Maintained books for checksum validation / L2 derivation
+    // A tracker is used by one thread at a time (its symbol's delivery);
+    // books_mutex_ only guards the map itself
+    struct BookTracker {
+        std::unique_ptr<Level3OrderBookState> state;
+        bool resyncing;               // Waiting for a fresh snapshot
+        bool diverged;                // Mismatch reported, not yet healthy again
+        bool log_only;                // Resync limit reached: count, don't resync
+        int resync_attempts;          // Resyncs since the book was last healthy
+        std::chrono::steady_clock::time_point next_resync;  // Backoff deadline
+        OrderBookRecord l2_record;    // Reused output record
+    };
+    enum class ChecksumResult { NOT_CHECKED, MATCH, MISMATCH, MISMATCH_RESYNC };
+
+    std::atomic<bool> l2_derivation_;
+    std::atomic<bool> checksum_validation_;
+    bool resync_on_mismatch_;
+    int max_resyncs_;
+    ChecksumPrecisionMap checksum_precision_;
+    std::mutex books_mutex_;
+    std::map<std::string, BookTracker> books_;
+
+    // Parse offload (optional)
+    size_t parse_threads_;
+    ThreadPlacement parse_placement_;
+    std::unique_ptr<ParsePool> parse_pool_;
+    std::vector<Level3Record> records_;  // Reused decode output (I/O thread)
+
+    // Record callbacks (protected by callback_mutex_)
     UpdateCallback update_callback_;
-    ConnectionCallback connection_callback_;
-    ErrorCallback error_callback_;
+    L2UpdateCallback l2_callback_;
 
-    // WebSocket event handlers
-    context_ptr on_tls_init(websocketpp::connection_hdl hdl);
-    void on_open(websocketpp::connection_hdl hdl);
-    void on_close(websocketpp::connection_hdl hdl);
-    void on_fail(websocketpp::connection_hdl hdl);
-    void on_message(websocketpp::connection_hdl hdl, client::message_ptr msg);
+    // ========================================================================
+    // Channel interface (required by KrakenStreamClientBase)
+    // ========================================================================
 
-    // Worker thread main function
-    void run_client();
+    static const char* client_name() { return "Level3 client"; }
+    static const char* io_thread_name() { return "level3_io"; }
+    std::string build_subscription(const std::vector<std::string>& symbols) const;
+    std::string build_unsubscribe(const std::vector<std::string>& symbols) const;
+    bool prepare_start();
+    void on_stopped();
+    void handle_frame(client::message_ptr msg, int64_t recv_ts_ns);
 
     // Helper methods
-    void notify_connection(bool connected);
-    void notify_error(const std::string& error);
-    void process_level3_message(const std::string& payload);
-    std::string build_subscription() const;
+    void process_level3_message(const std::string& payload, int64_t recv_ts_ns);
+    bool offload_level3_message(client::message_ptr msg, int64_t recv_ts_ns);
+    void deliver_record(const Level3Record& record);
+    static bool decode_level3_records(simdjson::ondemand::document& doc, int64_t recv_ts_ns,
+                                      std::vector<Level3Record>& records);
+    static bool peek_level3_symbol(const std::string& payload, std::string& symbol);
+    ChecksumResult maintain_book(const Level3Record& record);
+    void request_resync(const std::string& symbol);
+    void send_resync(const std::string& symbol);
+
     std::string read_token_file(const std::string& filepath);
 };
 
@@ -0,0 +1,907 @@
+#ifndef KRAKEN_STREAM_CLIENT_BASE_HPP
+#define KRAKEN_STREAM_CLIENT_BASE_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <algorithm>
+#include <memory>
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/client.hpp>
+#include "stage_trace.hpp"
+#include "symbol_universe.hpp"
+#include "tls_session_cache.hpp"
+#include "websocket_deflate.hpp"
+#include "socket_tuning.hpp"
+#include "thread_placement.hpp"
+#include "feed_watchdog.hpp"
+
+namespace kraken {
+
+/**
+ * Connection handling shared by the Kraken channel clients (CRTP)
+ *
+ * Owns the WebSocket/TLS connection, the own or shared I/O thread, socket
+ * and TLS session tuning, subscriptions (fixed list or symbol universe),
+ * the feed watchdog with reconnect, and the connection / error callbacks.
+ * The channel client derives from it and only decodes and stores its
+ * records.
+ *
+ * Template parameter Derived must provide:
+ * - static const char* client_name()      (log prefix, e.g. "Trade client")
+ * - static const char* io_thread_name()   (thread name, e.g. "trade_io")
+ * - std::string build_subscription(const std::vector<std::string>& symbols) const
+ * - std::string build_unsubscribe(const std::vector<std::string>& symbols) const
+ * - void handle_payload(const std::string& payload, int64_t recv_ts_ns)
+ *   (data frames only; subscription acks under a symbol universe and
+ *   heartbeats are handled here)
+ * and must call stop() first in its destructor, before its own members go.
+ *
+ * Derived may also provide (defaults below):
+ * - bool prepare_start()   (after symbols_ is set, before connecting;
+ *                           false aborts start())
+ * - void on_stopped()      (own I/O thread joined, no more frames)
+ * - void handle_frame(typename client::message_ptr msg, int64_t recv_ts_ns)
+ *   (instead of handle_payload, to keep the frame itself)
+ */
+template<typename Derived>
+class KrakenStreamClientBase {
+public:
+    using ConnectionCallback = std::function<void(bool connected)>;
+    using ErrorCallback = std::function<void(const std::string& error)>;
+
+    KrakenStreamClientBase();
+    virtual ~KrakenStreamClientBase();
+
+    // Disable copy
+    KrakenStreamClientBase(const KrakenStreamClientBase&) = delete;
+    KrakenStreamClientBase& operator=(const KrakenStreamClientBase&) = delete;
+
+    // Public API
+    bool start(std::vector<std::string> symbols);
+    void stop();
+    bool is_connected() const;
+    bool is_running() const;
+
+    void set_connection_callback(ConnectionCallback callback);
+
+    /**
+     * Errors go to the callback; without one they are printed to stderr
+     */
+    void set_error_callback(ErrorCallback callback);
+
+    /**
+     * Subscribe to additional symbols while connected
+     * The message is sent and symbols_ updated on the I/O thread, so this is
+     * safe to call from any thread. With a symbol universe attached the
+     * symbols are added to its desired set instead.
+     * @param symbols Vector of symbols to subscribe to (e.g., {"BTC/USD", "ETH/USD"})
+     * @return true if subscription was queued, false if not connected
+     */
+    bool subscribe_symbols(const std::vector<std::string>& symbols);
+
+    /**
+     * Unsubscribe from symbols while connected
+     * Same threading rules as subscribe_symbols()
+     * @param symbols Vector of symbols to unsubscribe from
+     * @return true if unsubscribe was queued, false if not connected
+     */
+    bool unsubscribe_symbols(const std::vector<std::string>& symbols);
+
+    /**
+     * Drive subscriptions from a symbol universe (call before start())
+     * Symbols passed to start() are added to the universe's desired set;
+     * changes are sent as batched, rate-limited messages on the I/O thread.
+     */
+    void set_symbol_universe(std::shared_ptr<SymbolUniverse> universe);
+
+    /**
+     * Run on a shared io_service instead of an own I/O thread (call before start())
+     * The io_service must be run by exactly one thread (handlers assume a
+     * single I/O thread) and must be stopped before this client is destroyed.
+     * stop() then only closes this client's connection.
+     */
+    void set_io_service(websocketpp::lib::asio::io_service* io_service);
+
+    /**
+     * Connect to a different WebSocket endpoint (call before start())
+     * Default is wss://ws.kraken.com/v2; used to run against a local TLS stand-in.
+     */
+    void set_endpoint(const std::string& uri);
+
+    /**
+     * Socket options applied to each new connection (call before start())
+     */
+    void set_socket_options(const SocketOptions& options);
+
+    /**
+     * Place the own I/O thread (call before start(); the shared I/O of
+     * set_io_service() is placed by its owner instead)
+     * @param busy_poll Spin on poll() instead of blocking (dedicated core)
+     */
+    void set_io_thread(const ThreadPlacement& placement, bool busy_poll = false);
+
+    /**
+     * TLS handshake statistics for this client's connections
+     * Process-wide totals: TlsSessionCache::instance().get_stats()
+     */
+    TlsHandshakeStats get_tls_stats() const;
+
+    /**
+     * Enable the feed stall watchdog (call before start())
+     * A stalled connection is closed and reopened with backoff; symbols
+     * without data are resubscribed. See feed_watchdog.hpp.
+     */
+    void set_watchdog(const WatchdogConfig& config);
+
+    /**
+     * Get watchdog counters and ping RTT (zeros when disabled)
+     */
+    WatchdogStats get_watchdog_stats() const;
+
+protected:
+    // WebSocket types
+    typedef websocketpp::client<asio_tls_client_deflate> client;
+    typedef websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context> context_ptr;
+
+    // WebSocket client and connection
+    client ws_client_;
+    websocketpp::connection_hdl connection_hdl_;
+    std::thread worker_thread_;
+    websocketpp::lib::asio::io_service* io_service_;  // Shared I/O (nullptr = own thread)
+    bool asio_initialized_;                           // init_asio() may only run once
+    std::string endpoint_;
+    SocketOptions socket_options_;
+    ThreadPlacement io_placement_;
+    bool io_busy_poll_;
+
+    // State
+    std::atomic<bool> running_;
+    std::atomic<bool> connected_;
+    std::vector<std::string> symbols_;  // Accessed on the I/O thread once started
+
+    // TLS handshake timing (timer: I/O thread only, stats protected by tls_mutex_)
+    TlsHandshakeTimer tls_timer_;
+    mutable std::mutex tls_mutex_;
+    TlsHandshakeStats tls_stats_;
+
+    // Symbol universe (optional, pumped on the I/O thread)
+    std::shared_ptr<SymbolUniverse> universe_;
+    uint64_t universe_generation_;  // Invalidates pump timers of old connections
+
+    // Feed watchdog (optional, driven on the I/O thread)
+    std::unique_ptr<FeedWatchdog> watchdog_;
+    uint64_t watchdog_generation_;  // Invalidates watchdog timers of old connections
+    bool reconnecting_;             // Watchdog dropped the connection, reopen on close
+    int reconnect_attempts_;
+    std::vector<std::string> stale_symbols_;  // Reused watchdog output
+
+    // Callbacks (protected by callback_mutex_, which also guards the
+    // channel client's record callbacks)
+    mutable std::mutex callback_mutex_;
+    ConnectionCallback connection_callback_;
+    ErrorCallback error_callback_;
+
+    // WebSocket event handlers
+    context_ptr on_tls_init(websocketpp::connection_hdl hdl);
+    void on_socket_init(websocketpp::connection_hdl hdl,
+                        websocketpp::lib::asio::ssl::stream<websocketpp::lib::asio::ip::tcp::socket>& socket);
+    void on_tcp_pre_init(websocketpp::connection_hdl hdl);
+    void on_tcp_post_init(websocketpp::connection_hdl hdl);
+    void on_open(websocketpp::connection_hdl hdl);
+    void on_close(websocketpp::connection_hdl hdl);
+    void on_fail(websocketpp::connection_hdl hdl);
+    void on_message(websocketpp::connection_hdl hdl, typename client::message_ptr msg);
+    void on_pong(websocketpp::connection_hdl hdl, std::string payload);
+
+    // Worker thread main function
+    void run_client();
+    bool open_connection();
+
+    // Helper methods
+    void notify_connection(bool connected);
+    void notify_error(const std::string& error);
+
+    // Symbol universe pump (I/O thread)
+    void schedule_universe_pump(uint64_t generation);
+    void pump_universe();
+
+    // Feed watchdog (I/O thread)
+    void schedule_watchdog(uint64_t generation);
+    void run_watchdog();
+    void resubscribe(const std::vector<std::string>& symbols);
+    void reconnect();
+    void schedule_reconnect();
+
+    // Default channel hooks (see class comment)
+    bool prepare_start() { return true; }
+    void on_stopped() {}
+    void handle_frame(typename client::message_ptr msg, int64_t recv_ts_ns);
+
+private:
+    Derived& derived() { return static_cast<Derived&>(*this); }
+};
+
+// Implementation must be in header for templates
+
+template<typename Derived>
+KrakenStreamClientBase<Derived>::KrakenStreamClientBase()
+    : io_service_(nullptr), asio_initialized_(false),
+      endpoint_("wss://ws.kraken.com/v2"), io_busy_poll_(false),
+      running_(false), connected_(false),
+      universe_generation_(0), watchdog_generation_(0),
+      reconnecting_(false), reconnect_attempts_(0) {
+
+    // Connection-level handlers; per-connection handlers are set in open_connection()
+    ws_client_.clear_access_channels(websocketpp::log::alevel::all);
+    ws_client_.set_access_channels(websocketpp::log::alevel::connect);
+    ws_client_.set_access_channels(websocketpp::log::alevel::disconnect);
+    ws_client_.clear_error_channels(websocketpp::log::elevel::all);
+
+    ws_client_.set_tls_init_handler([this](websocketpp::connection_hdl hdl) {
+        return this->on_tls_init(hdl);
+    });
+    ws_client_.set_socket_init_handler([this](websocketpp::connection_hdl hdl,
+        websocketpp::lib::asio::ssl::stream<websocketpp::lib::asio::ip::tcp::socket>& socket) {
+        this->on_socket_init(hdl, socket);
+    });
+    ws_client_.set_tcp_pre_init_handler([this](websocketpp::connection_hdl hdl) {
+        this->on_tcp_pre_init(hdl);
+    });
+    ws_client_.set_tcp_post_init_handler([this](websocketpp::connection_hdl hdl) {
+        this->on_tcp_post_init(hdl);
+    });
+}
+
+template<typename Derived>
+KrakenStreamClientBase<Derived>::~KrakenStreamClientBase() {
+    stop();
+}
+
+template<typename Derived>
+bool KrakenStreamClientBase<Derived>::start(std::vector<std::string> symbols) {
+    if (running_) {
+        std::cerr << "Client already running" << std::endl;
+        return false;
+    }
+
+    if (symbols.empty() && !universe_) {
+        notify_error("No symbols provided");
+        return false;
+    }
+
+    symbols_ = std::move(symbols);
+    if (!derived().prepare_start()) {
+        return false;
+    }
+    running_ = true;
+
+    if (universe_) {
+        universe_->add_desired(symbols_);
+    }
+
+    if (io_service_) {
+        // Shared I/O: connect from the io_service's thread
+        if (!asio_initialized_) {
+            ws_client_.init_asio(io_service_);
+            asio_initialized_ = true;
+        }
+        boost::asio::post(*io_service_, [this]() {
+            if (!this->open_connection()) {
+                running_ = false;
+            }
+        });
+    } else {
+        if (!asio_initialized_) {
+            ws_client_.init_asio();
+            asio_initialized_ = true;
+        }
+        worker_thread_ = std::thread([this]() {
+            this->run_client();
+        });
+    }
+
+    std::cout << Derived::client_name() << " started" << std::endl;
+    return true;
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::stop() {
+    if (!running_) {
+        return;
+    }
+
+    running_ = false;
+    connected_ = false;
+
+    if (io_service_) {
+        // Shared I/O: close only this connection, the io_service keeps running
+        boost::asio::post(*io_service_, [this]() {
+            websocketpp::lib::error_code ec;
+            ws_client_.close(connection_hdl_, websocketpp::close::status::going_away, "", ec);
+        });
+        return;
+    }
+
+    try {
+        if (!ws_client_.stopped()) {
+            ws_client_.stop();
+        }
+
+        if (worker_thread_.joinable()) {
+            worker_thread_.join();
+        }
+
+        derived().on_stopped();
+        std::cout << Derived::client_name() << " stopped" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error stopping client: " << e.what() << std::endl;
+    }
+}
+
+template<typename Derived>
+bool KrakenStreamClientBase<Derived>::is_connected() const {
+    return connected_.load();
+}
+
+template<typename Derived>
+bool KrakenStreamClientBase<Derived>::is_running() const {
+    return running_.load();
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::set_connection_callback(ConnectionCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    connection_callback_ = callback;
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::set_error_callback(ErrorCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    error_callback_ = callback;
+}
+
+template<typename Derived>
+bool KrakenStreamClientBase<Derived>::subscribe_symbols(const std::vector<std::string>& symbols) {
+    if (symbols.empty()) {
+        std::cerr << "Cannot subscribe: No symbols provided" << std::endl;
+        return false;
+    }
+
+    if (universe_) {
+        universe_->add_desired(symbols);
+        return true;
+    }
+
+    if (!is_connected()) {
+        std::cerr << "Cannot subscribe: WebSocket not connected" << std::endl;
+        return false;
+    }
+
+    // Send and update symbols_ on the I/O thread (no shared mutable state)
+    boost::asio::post(ws_client_.get_io_service(), [this, symbols]() {
+        std::string msg_str = derived().build_subscription(symbols);
+
+        try {
+            ws_client_.send(connection_hdl_, msg_str, websocketpp::frame::opcode::text);
+
+            // Add symbols to internal list (avoid duplicates)
+            FeedWatchdog::Clock::time_point now = FeedWatchdog::Clock::now();
+            for (const auto& symbol : symbols) {
+                auto it = std::find(symbols_.begin(), symbols_.end(), symbol);
+                if (it == symbols_.end()) {
+                    symbols_.push_back(symbol);
+                }
+                if (watchdog_) {
+                    watchdog_->watch(symbol, now);
+                }
+            }
+
+            std::cout << "Subscribed to " << symbols.size() << " additional symbol(s)" << std::endl;
+        } catch (const std::exception& e) {
+            notify_error("Failed to send subscribe message: " + std::string(e.what()));
+        }
+    });
+
+    return true;
+}
+
+template<typename Derived>
+bool KrakenStreamClientBase<Derived>::unsubscribe_symbols(const std::vector<std::string>& symbols) {
+    if (symbols.empty()) {
+        std::cerr << "Cannot unsubscribe: No symbols provided" << std::endl;
+        return false;
+    }
+
+    if (universe_) {
+        universe_->remove_desired(symbols);
+        return true;
+    }
+
+    if (!is_connected()) {
+        std::cerr << "Cannot unsubscribe: WebSocket not connected" << std::endl;
+        return false;
+    }
+
+    // Send and update symbols_ on the I/O thread (no shared mutable state)
+    boost::asio::post(ws_client_.get_io_service(), [this, symbols]() {
+        std::string msg_str = derived().build_unsubscribe(symbols);
+
+        try {
+            ws_client_.send(connection_hdl_, msg_str, websocketpp::frame::opcode::text);
+
+            // Remove symbols from internal list
+            for (const auto& symbol : symbols) {
+                auto it = std::find(symbols_.begin(), symbols_.end(), symbol);
+                if (it != symbols_.end()) {
+                    symbols_.erase(it);
+                }
+                if (watchdog_) {
+                    watchdog_->unwatch(symbol);
+                }
+            }
+
+            std::cout << "Unsubscribed from " << symbols.size() << " symbol(s)" << std::endl;
+        } catch (const std::exception& e) {
+            notify_error("Failed to send unsubscribe message: " + std::string(e.what()));
+        }
+    });
+
+    return true;
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::set_symbol_universe(std::shared_ptr<SymbolUniverse> universe) {
+    if (running_) {
+        std::cerr << "[Error] set_symbol_universe() must be called before start()" << std::endl;
+        return;
+    }
+    universe_ = universe;
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::set_io_service(websocketpp::lib::asio::io_service* io_service) {
+    if (running_) {
+        std::cerr << "[Error] set_io_service() must be called before start()" << std::endl;
+        return;
+    }
+    io_service_ = io_service;
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::set_endpoint(const std::string& uri) {
+    if (running_) {
+        std::cerr << "[Error] set_endpoint() must be called before start()" << std::endl;
+        return;
+    }
+    endpoint_ = uri;
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::set_socket_options(const SocketOptions& options) {
+    if (running_) {
+        std::cerr << "[Error] set_socket_options() must be called before start()" << std::endl;
+        return;
+    }
+    socket_options_ = options;
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::set_io_thread(const ThreadPlacement& placement, bool busy_poll) {
+    if (running_) {
+        std::cerr << "[Error] set_io_thread() must be called before start()" << std::endl;
+        return;
+    }
+    io_placement_ = placement;
+    io_busy_poll_ = busy_poll;
+}
+
+template<typename Derived>
+TlsHandshakeStats KrakenStreamClientBase<Derived>::get_tls_stats() const {
+    std::lock_guard<std::mutex> lock(tls_mutex_);
+    return tls_stats_;
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::set_watchdog(const WatchdogConfig& config) {
+    if (running_) {
+        std::cerr << "[Error] set_watchdog() must be called before start()" << std::endl;
+        return;
+    }
+    watchdog_.reset(config.enabled() ? new FeedWatchdog(config) : nullptr);
+}
+
+template<typename Derived>
+WatchdogStats KrakenStreamClientBase<Derived>::get_watchdog_stats() const {
+    return watchdog_ ? watchdog_->get_stats() : WatchdogStats();
+}
+
+template<typename Derived>
+typename KrakenStreamClientBase<Derived>::context_ptr
+KrakenStreamClientBase<Derived>::on_tls_init(websocketpp::connection_hdl) {
+    // One long-lived context per process; it carries the session cache
+    return TlsSessionCache::instance().get_context();
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::on_socket_init(
+    websocketpp::connection_hdl,
+    websocketpp::lib::asio::ssl::stream<websocketpp::lib::asio::ip::tcp::socket>& socket) {
+
+    if (!socket_options_.empty()) {
+        SocketTuning::apply(socket.lowest_layer().native_handle(), socket_options_);
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::on_tcp_pre_init(websocketpp::connection_hdl hdl) {
+    // TCP is connected, the TLS handshake starts next
+    websocketpp::lib::error_code ec;
+    typename client::connection_ptr con = ws_client_.get_con_from_hdl(hdl, ec);
+    if (ec) {
+        return;
+    }
+
+    tls_timer_.start();
+    TlsSessionCache::instance().prepare(con->get_socket().native_handle(), con->get_host());
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::on_tcp_post_init(websocketpp::connection_hdl hdl) {
+    websocketpp::lib::error_code ec;
+    typename client::connection_ptr con = ws_client_.get_con_from_hdl(hdl, ec);
+    if (ec) {
+        return;
+    }
+
+    SSL* ssl = con->get_socket().native_handle();
+    if (!SSL_is_init_finished(ssl)) {
+        return;  // Handshake failed, reported through on_fail
+    }
+
+    double ms = tls_timer_.elapsed_ms();
+    bool resumed = SSL_session_reused(ssl) == 1;
+    {
+        std::lock_guard<std::mutex> lock(tls_mutex_);
+        tls_stats_.record(ms, resumed);
+    }
+    TlsSessionCache::instance().record_handshake(ms, resumed);
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::on_open(websocketpp::connection_hdl hdl) {
+    std::cout << "WebSocket connection opened" << std::endl;
+    connection_hdl_ = hdl;
+    connected_ = true;
+
+    notify_connection(true);
+
+    if (watchdog_) {
+        reconnecting_ = false;
+        reconnect_attempts_ = 0;
+        FeedWatchdog::Clock::time_point now = FeedWatchdog::Clock::now();
+        watchdog_->reset(now);
+        if (!universe_) {
+            for (const auto& symbol : symbols_) {
+                watchdog_->watch(symbol, now);
+            }
+        }
+        schedule_watchdog(++watchdog_generation_);
+    }
+
+    // Universe mode: subscriptions go out in batches from the pump
+    if (universe_) {
+        pump_universe();
+        schedule_universe_pump(++universe_generation_);
+        return;
+    }
+
+    // The message may carry a token: log the symbol count only
+    std::string msg_str = derived().build_subscription(symbols_);
+    std::cout << "Subscribing to " << symbols_.size() << " symbol(s)" << std::endl;
+
+    try {
+        ws_client_.send(hdl, msg_str, websocketpp::frame::opcode::text);
+    } catch (const std::exception& e) {
+        notify_error("Send error: " + std::string(e.what()));
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::on_close(websocketpp::connection_hdl) {
+    std::cout << "WebSocket connection closed" << std::endl;
+    connected_ = false;
+    bool reconnect = reconnecting_ && running_;
+    if (io_service_ && !reconnect) {
+        running_ = false;  // Shared I/O: no run() loop to return from
+    }
+    if (universe_) {
+        universe_->on_disconnected();
+    }
+    notify_connection(false);
+    if (reconnect) {
+        schedule_reconnect();
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::on_fail(websocketpp::connection_hdl) {
+    connected_ = false;
+    bool reconnect = reconnecting_ && running_;
+    if (io_service_ && !reconnect) {
+        running_ = false;  // Shared I/O: no run() loop to return from
+    }
+    if (universe_) {
+        universe_->on_disconnected();
+    }
+    notify_connection(false);
+    notify_error("WebSocket connection failed");
+    if (reconnect) {
+        schedule_reconnect();
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::on_message(websocketpp::connection_hdl,
+                                                 typename client::message_ptr msg) {
+    int64_t recv_ts_ns = SocketTuning::realtime_ns();
+    if (watchdog_) {
+        watchdog_->on_frame(FeedWatchdog::Clock::now());
+    }
+
+    try {
+        const std::string& payload = msg->get_payload();
+
+        // Heartbeats only feed the watchdog (Kraken writes the channel first)
+        static const char heartbeat_prefix[] = "{\"channel\":\"heartbeat\"";
+        if (payload.compare(0, sizeof(heartbeat_prefix) - 1, heartbeat_prefix) == 0) {
+            if (watchdog_) {
+                watchdog_->on_heartbeat();
+            }
+            return;
+        }
+
+        // Subscription acks update the universe; they carry no channel data
+        if (universe_ && universe_->handle_message(payload)) {
+            return;
+        }
+
+        derived().handle_frame(msg, recv_ts_ns);
+    } catch (const std::exception& e) {
+        notify_error("Message handling error: " + std::string(e.what()));
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::on_pong(websocketpp::connection_hdl, std::string payload) {
+    if (watchdog_) {
+        watchdog_->on_pong(payload, FeedWatchdog::Clock::now());
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::handle_frame(typename client::message_ptr msg, int64_t recv_ts_ns) {
+    derived().handle_payload(msg->get_payload(), recv_ts_ns);
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::run_client() {
+    KRAKEN_TRACE_THREAD_NAME(Derived::io_thread_name());
+    io_placement_.apply(Derived::io_thread_name());  // Shared I/O threads are placed by their owner
+
+    if (!open_connection()) {
+        running_ = false;
+        return;
+    }
+
+    try {
+        ThreadPlacement::run_io(ws_client_, io_busy_poll_);
+    } catch (const websocketpp::exception& e) {
+        notify_error("WebSocket++ exception: " + std::string(e.what()));
+    } catch (const std::exception& e) {
+        notify_error("Exception: " + std::string(e.what()));
+    }
+
+    running_ = false;
+    connected_ = false;
+}
+
+template<typename Derived>
+bool KrakenStreamClientBase<Derived>::open_connection() {
+    try {
+        ws_client_.set_open_handler([this](websocketpp::connection_hdl hdl) {
+            this->on_open(hdl);
+        });
+        ws_client_.set_message_handler([this](websocketpp::connection_hdl hdl, typename client::message_ptr msg) {
+            this->on_message(hdl, msg);
+        });
+        ws_client_.set_close_handler([this](websocketpp::connection_hdl hdl) {
+            this->on_close(hdl);
+        });
+        ws_client_.set_fail_handler([this](websocketpp::connection_hdl hdl) {
+            this->on_fail(hdl);
+        });
+        ws_client_.set_pong_handler([this](websocketpp::connection_hdl hdl, std::string payload) {
+            this->on_pong(hdl, payload);
+        });
+
+        // Connect to Kraken WebSocket v2 (or the configured endpoint)
+        const std::string& uri = endpoint_;
+        websocketpp::lib::error_code ec;
+        typename client::connection_ptr con = ws_client_.get_connection(uri, ec);
+
+        if (ec) {
+            notify_error("Connection error: " + ec.message());
+            return false;
+        }
+
+        ws_client_.connect(con);
+        std::cout << "Connecting to " << uri << "..." << std::endl;
+        return true;
+
+    } catch (const std::exception& e) {
+        notify_error("WebSocket error: " + std::string(e.what()));
+        return false;
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::notify_connection(bool connected) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (connection_callback_) {
+        connection_callback_(connected);
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::notify_error(const std::string& error) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (error_callback_) {
+        error_callback_(error);
+    } else {
+        std::cerr << "[Error] " << Derived::client_name() << ": " << error << std::endl;
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::schedule_universe_pump(uint64_t generation) {
+    long interval_ms = static_cast<long>(universe_->get_min_message_interval().count());
+
+    ws_client_.set_timer(interval_ms > 0 ? interval_ms : 1,
+        [this, generation](const websocketpp::lib::error_code& ec) {
+            // Stop on cancel, shutdown, or when a newer connection owns the pump
+            if (ec || !running_ || !connected_ || generation != universe_generation_) {
+                return;
+            }
+            pump_universe();
+            schedule_universe_pump(generation);
+        });
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::pump_universe() {
+    SymbolUniverse::Batch batch;
+    if (!universe_->next_batch(SymbolUniverse::Clock::now(), batch)) {
+        return;
+    }
+
+    bool subscribe = batch.action == SymbolUniverse::Action::SUBSCRIBE;
+    std::string msg_str = subscribe ? derived().build_subscription(batch.symbols)
+                                    : derived().build_unsubscribe(batch.symbols);
+
+    try {
+        ws_client_.send(connection_hdl_, msg_str, websocketpp::frame::opcode::text);
+        symbols_ = universe_->get_active_symbols();
+        std::cout << "[UNIVERSE] " << Derived::client_name() << ": "
+                  << (subscribe ? "subscribing " : "unsubscribing ")
+                  << batch.symbols.size() << " symbol(s)" << std::endl;
+    } catch (const std::exception& e) {
+        // Unacknowledged symbols are resent after the ack timeout
+        notify_error("Failed to send " + std::string(subscribe ? "subscribe" : "unsubscribe") +
+                     " message: " + std::string(e.what()));
+    }
+
+    if (watchdog_) {
+        FeedWatchdog::Clock::time_point now = FeedWatchdog::Clock::now();
+        for (const auto& symbol : batch.symbols) {
+            if (subscribe) {
+                watchdog_->watch(symbol, now);
+            } else {
+                watchdog_->unwatch(symbol);
+            }
+        }
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::schedule_watchdog(uint64_t generation) {
+    ws_client_.set_timer(watchdog_->get_config().check_interval_ms,
+        [this, generation](const websocketpp::lib::error_code& ec) {
+            // Stop on cancel, shutdown, or when a newer connection owns the watchdog
+            if (ec || !running_ || !connected_ || generation != watchdog_generation_) {
+                return;
+            }
+            run_watchdog();
+            if (generation == watchdog_generation_) {
+                schedule_watchdog(generation);
+            }
+        });
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::run_watchdog() {
+    FeedWatchdog::Clock::time_point now = FeedWatchdog::Clock::now();
+
+    std::string ping_payload;
+    if (watchdog_->next_ping(now, ping_payload)) {
+        websocketpp::lib::error_code ec;
+        ws_client_.ping(connection_hdl_, ping_payload, ec);
+        if (ec) {
+            notify_error("Failed to send ping: " + ec.message());
+        }
+    }
+
+    switch (watchdog_->check(now, stale_symbols_)) {
+        case FeedWatchdog::Action::RECONNECT:
+            reconnect();
+            break;
+        case FeedWatchdog::Action::RESUBSCRIBE:
+            resubscribe(stale_symbols_);
+            break;
+        case FeedWatchdog::Action::NONE:
+            break;
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::resubscribe(const std::vector<std::string>& symbols) {
+    // Unsubscribe + subscribe makes the server send a fresh snapshot
+    try {
+        ws_client_.send(connection_hdl_, derived().build_unsubscribe(symbols), websocketpp::frame::opcode::text);
+        ws_client_.send(connection_hdl_, derived().build_subscription(symbols), websocketpp::frame::opcode::text);
+        std::cout << "[WATCHDOG] " << Derived::client_name() << ": resubscribing "
+                  << symbols.size() << " stale symbol(s)" << std::endl;
+    } catch (const std::exception& e) {
+        notify_error("Failed to send resubscribe: " + std::string(e.what()));
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::reconnect() {
+    std::cout << "[WATCHDOG] " << Derived::client_name() << ": feed stalled, reconnecting" << std::endl;
+    reconnecting_ = true;
+    ++watchdog_generation_;
+
+    // A half-open connection never answers the close frame; websocketpp
+    // drops it after the close handshake timeout and on_close reconnects
+    websocketpp::lib::error_code ec;
+    ws_client_.close(connection_hdl_, websocketpp::close::status::going_away, "feed stalled", ec);
+    if (ec) {
+        connected_ = false;
+        schedule_reconnect();
+    }
+}
+
+template<typename Derived>
+void KrakenStreamClientBase<Derived>::schedule_reconnect() {
+    // 1s, 2s, 4s, ... capped at 30s while the endpoint stays unreachable
+    long delay_ms = std::min(1000L << std::min(reconnect_attempts_, 5), 30000L);
+    reconnect_attempts_++;
+
+    ws_client_.set_timer(delay_ms, [this](const websocketpp::lib::error_code& ec) {
+        if (ec || !running_) {
+            return;
+        }
+        if (!open_connection()) {
+            schedule_reconnect();
+        }
+    });
+}
+
+} // namespace kraken
+
+#endif // KRAKEN_STREAM_CLIENT_BASE_HPP
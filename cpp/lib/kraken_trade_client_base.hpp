@@ -0,0 +1,223 @@
+#ifndef KRAKEN_TRADE_CLIENT_BASE_HPP
+#define KRAKEN_TRADE_CLIENT_BASE_HPP
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include "kraken_common.hpp"
+#include "kraken_stream_client_base.hpp"
+#include "alloc_counter.hpp"
+#include "stage_trace.hpp"
+
+namespace kraken {
+
+/**
+ * Base template class for trade channel clients with different JSON parsers
+ *
+ * Template parameter JsonParser must provide:
+ * - static std::string build_subscription(const std::vector<std::string>& symbols)
+ * - static std::string build_unsubscribe(const std::vector<std::string>& symbols)
+ * - static bool parse_message(const std::string& payload,
+ *                             std::vector<TradeRecord>& batch)
+ *
+ * Connection handling comes from KrakenStreamClientBase. Trades are
+ * delivered per frame: the batch callback receives all trades of one
+ * message at once, so a burst costs one callback and one lock per frame
+ * instead of per trade. Output is left to the caller (see TradeCsvWriter)
+ * so the I/O thread never touches disk.
+ */
+template<typename JsonParser>
+class KrakenTradeClientBase
+    : public KrakenStreamClientBase<KrakenTradeClientBase<JsonParser>> {
+    friend class KrakenStreamClientBase<KrakenTradeClientBase<JsonParser>>;
+
+public:
+    // Type definitions
+    using UpdateCallback = std::function<void(const TradeRecord&)>;
+    using BatchCallback = std::function<void(const std::vector<TradeRecord>&)>;
+
+    /**
+     * Frame / trade counters
+     */
+    struct TradeClientStats {
+        uint64_t frames;        // Trade frames received
+        uint64_t trades;        // Trades decoded
+        uint64_t max_batch;     // Largest number of trades in one frame
+    };
+
+    KrakenTradeClientBase();
+    virtual ~KrakenTradeClientBase();
+
+    /**
+     * Call back once per trade
+     */
+    void set_update_callback(UpdateCallback callback);
+
+    /**
+     * Call back once per frame with all of its trades (preferred for recording)
+     * The vector is reused by the client; copy or move out what you keep.
+     */
+    void set_batch_callback(BatchCallback callback);
+
+    /**
+     * Get pending trades (polling pattern)
+     * Trades are only buffered for polling when no update or batch callback
+     * is set, so callback users do not accumulate an unread backlog.
+     * @return All trades since the last call (moves data, clears internal buffer)
+     */
+    std::vector<TradeRecord> get_updates();
+
+    size_t pending_count() const;
+
+    TradeClientStats get_stats() const;
+
+protected:
+    // Decode buffer, reused for every frame (I/O thread only)
+    std::vector<TradeRecord> batch_;
+
+    // Polling buffer (protected by data_mutex_)
+    mutable std::mutex data_mutex_;
+    std::vector<TradeRecord> pending_updates_;
+
+    // Statistics
+    std::atomic<uint64_t> frame_count_;
+    std::atomic<uint64_t> trade_count_;
+    std::atomic<uint64_t> max_batch_;
+
+    // Record callbacks (protected by callback_mutex_)
+    UpdateCallback update_callback_;
+    BatchCallback batch_callback_;
+
+    void dispatch_batch(const std::vector<TradeRecord>& batch);
+
+private:
+    // ========================================================================
+    // Channel interface (required by KrakenStreamClientBase)
+    // ========================================================================
+
+    static const char* client_name() { return "Trade client"; }
+    static const char* io_thread_name() { return "trade_io"; }
+
+    std::string build_subscription(const std::vector<std::string>& symbols) const {
+        return JsonParser::build_subscription(symbols);
+    }
+    std::string build_unsubscribe(const std::vector<std::string>& symbols) const {
+        return JsonParser::build_unsubscribe(symbols);
+    }
+
+    /**
+     * Decode one frame and dispatch its trades (I/O thread)
+     */
+    void handle_payload(const std::string& payload, int64_t recv_ts_ns);
+};
+
+// Implementation must be in header for templates
+
+template<typename JsonParser>
+KrakenTradeClientBase<JsonParser>::KrakenTradeClientBase()
+    : frame_count_(0), trade_count_(0), max_batch_(0) {
+    batch_.reserve(64);
+}
+
+template<typename JsonParser>
+KrakenTradeClientBase<JsonParser>::~KrakenTradeClientBase() {
+    this->stop();  // The I/O thread dispatches into this object's members
+}
+
+template<typename JsonParser>
+void KrakenTradeClientBase<JsonParser>::set_update_callback(UpdateCallback callback) {
+    std::lock_guard<std::mutex> lock(this->callback_mutex_);
+    update_callback_ = callback;
+}
+
+template<typename JsonParser>
+void KrakenTradeClientBase<JsonParser>::set_batch_callback(BatchCallback callback) {
+    std::lock_guard<std::mutex> lock(this->callback_mutex_);
+    batch_callback_ = callback;
+}
+
+template<typename JsonParser>
+std::vector<TradeRecord> KrakenTradeClientBase<JsonParser>::get_updates() {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    std::vector<TradeRecord> updates = std::move(pending_updates_);
+    pending_updates_.clear();
+    return updates;
+}
+
+template<typename JsonParser>
+size_t KrakenTradeClientBase<JsonParser>::pending_count() const {
+    std::lock_guard<std::mutex> lock(data_mutex_);
+    return pending_updates_.size();
+}
+
+template<typename JsonParser>
+typename KrakenTradeClientBase<JsonParser>::TradeClientStats
+KrakenTradeClientBase<JsonParser>::get_stats() const {
+    TradeClientStats stats;
+    stats.frames = frame_count_.load();
+    stats.trades = trade_count_.load();
+    stats.max_batch = max_batch_.load();
+    return stats;
+}
+
+template<typename JsonParser>
+void KrakenTradeClientBase<JsonParser>::handle_payload(const std::string& payload, int64_t recv_ts_ns) {
+    KRAKEN_ALLOC_SCOPE("trade_client.on_message");
+
+    {
+        KRAKEN_TRACE_SCOPE("trade.parse");
+        if (!JsonParser::parse_message(payload, batch_)) {
+            return;
+        }
+    }
+
+    for (auto& record : batch_) {
+        record.recv_ts_ns = recv_ts_ns;
+    }
+    if (this->watchdog_) {
+        // A frame usually carries one symbol: report each run once
+        const std::string* last = nullptr;
+        for (const auto& record : batch_) {
+            if (!last || record.symbol != *last) {
+                this->watchdog_->on_data(record.symbol);
+                last = &record.symbol;
+            }
+        }
+    }
+    dispatch_batch(batch_);
+}
+
+template<typename JsonParser>
+void KrakenTradeClientBase<JsonParser>::dispatch_batch(const std::vector<TradeRecord>& batch) {
+    uint64_t size = batch.size();
+    frame_count_++;
+    trade_count_ += size;
+    if (size > max_batch_.load(std::memory_order_relaxed)) {
+        max_batch_.store(size, std::memory_order_relaxed);  // Single writer (I/O thread)
+    }
+
+    KRAKEN_TRACE_SCOPE("trade.callback");
+    std::lock_guard<std::mutex> lock(this->callback_mutex_);
+
+    if (!batch_callback_ && !update_callback_) {
+        // Polling pattern: one lock for the whole frame
+        std::lock_guard<std::mutex> data_lock(data_mutex_);
+        pending_updates_.insert(pending_updates_.end(), batch.begin(), batch.end());
+        return;
+    }
+
+    if (batch_callback_) {
+        batch_callback_(batch);
+    }
+    if (update_callback_) {
+        for (const auto& record : batch) {
+            update_callback_(record);
+        }
+    }
+}
+
+} // namespace kraken
+
+#endif // KRAKEN_TRADE_CLIENT_BASE_HPP
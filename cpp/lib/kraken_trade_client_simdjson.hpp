@@ -0,0 +1,19 @@
+#ifndef KRAKEN_TRADE_CLIENT_SIMDJSON_HPP
+#define KRAKEN_TRADE_CLIENT_SIMDJSON_HPP
+
+#include "kraken_trade_client_base.hpp"
+#include "json_parser_trade_simdjson.hpp"
+
+namespace kraken {
+
+/**
+ * Trade channel client using simdjson parser
+ *
+ * This is a simple typedef using the template base class.
+ * All implementation is in kraken_trade_client_base.hpp
+ */
+using KrakenTradeClientSimdjson = KrakenTradeClientBase<SimdjsonTradeParser>;
+
+} // namespace kraken
+
+#endif // KRAKEN_TRADE_CLIENT_SIMDJSON_HPP
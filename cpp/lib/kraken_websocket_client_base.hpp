@@ -3,23 +3,21 @@
 
 #include <string>
 #include <vector>
-#include <thread>
 #include <mutex>
-#include <atomic>
 #include <functional>
 #include <fstream>
-#include <algorithm>
-#include <websocketpp/config/asio_client.hpp>
-#include <websocketpp/client.hpp>
+#include <future>
 #include "kraken_common.hpp"
+#include "kraken_stream_client_base.hpp"
 #include "flush_segment_mixin.hpp"
+#include "alloc_counter.hpp"
+#include "stage_trace.hpp"
 
 namespace kraken {
 
 // Configuration constants
 namespace {
     constexpr size_t MAX_LOGGED_FLUSHES = 3;  // Reduce log spam after N flushes
-    constexpr size_t RECORD_BUFFER_INITIAL_CAPACITY = 1000;  // ~30s at 30 updates/sec
 }
 
 /**
@@ -27,36 +25,30 @@ namespace {
  *
  * Template parameter JsonParser must provide:
  * - static std::string build_subscription(const std::vector<std::string>& symbols)
+ * - static std::string build_unsubscribe(const std::vector<std::string>& symbols)
  * - static void parse_message(const std::string& payload,
- *                             std::function<void(const TickerRecord&)> callback)
+ *                             std::function<void(TickerRecord&)> callback)
+ *   (the client completes each record, e.g. recv_ts_ns, before storing it)
  *
  * This eliminates code duplication between nlohmann and simdjson implementations
  *
- * Inherits from FlushSegmentMixin for periodic flushing and segmentation
+ * Connection handling comes from KrakenStreamClientBase; inherits from
+ * FlushSegmentMixin for periodic flushing and segmentation
  */
 template<typename JsonParser>
-class KrakenWebSocketClientBase : public FlushSegmentMixin<KrakenWebSocketClientBase<JsonParser>> {
+class KrakenWebSocketClientBase
+    : public KrakenStreamClientBase<KrakenWebSocketClientBase<JsonParser>>,
+      public FlushSegmentMixin<KrakenWebSocketClientBase<JsonParser>> {
+    friend class KrakenStreamClientBase<KrakenWebSocketClientBase<JsonParser>>;
     friend class FlushSegmentMixin<KrakenWebSocketClientBase<JsonParser>>;  // Allow mixin to access private interface
 
 public:
     // Type definitions
     using UpdateCallback = std::function<void(const TickerRecord&)>;
-    using ConnectionCallback = std::function<void(bool connected)>;
-    using ErrorCallback = std::function<void(const std::string& error)>;
 
     KrakenWebSocketClientBase();
     virtual ~KrakenWebSocketClientBase();
 
-    // Disable copy
-    KrakenWebSocketClientBase(const KrakenWebSocketClientBase&) = delete;
-    KrakenWebSocketClientBase& operator=(const KrakenWebSocketClientBase&) = delete;
-
-    // Public API
-    bool start(std::vector<std::string> symbols);
-    void stop();
-    bool is_connected() const;
-    bool is_running() const;
-
     /**
      * Get pending updates (polling pattern)
      *
@@ -92,8 +84,6 @@ public:
 
     size_t pending_count() const;
     void set_update_callback(UpdateCallback callback);
-    void set_connection_callback(ConnectionCallback callback);
-    void set_error_callback(ErrorCallback callback);
 
     /**
      * Flush remaining buffered data to configured output file
@@ -106,9 +96,21 @@ public:
      * Save all historical data to a specific file (one-shot snapshot)
      * This creates a new file with all data and header, regardless of set_output_file()
      * Use this for ad-hoc exports or when not using periodic flushing
+     * The history is snapshotted under data_mutex_; formatting and file I/O run
+     * on the calling thread without the lock, so message handling is not blocked
+     * @param filename Target file to write snapshot
+     * @return false if the file could not be written
+     */
+    bool save_to_csv(const std::string& filename);
+
+    /**
+     * Save all historical data to a specific file on a background thread
+     * Same snapshot as save_to_csv(); records arriving after the call are not included
+     * NOTE: The returned future blocks in its destructor until the export finishes
      * @param filename Target file to write snapshot
+     * @return Future that becomes ready with the export result
      */
-    void save_to_csv(const std::string& filename);
+    std::future<bool> save_to_csv_async(const std::string& filename);
 
     /**
      * Set output file for periodic flushing
@@ -117,22 +119,6 @@ public:
      */
     void set_output_file(const std::string& filename);
 
-    /**
-     * Subscribe to additional symbols while connected
-     * Updates internal symbols_ vector with new symbols
-     * @param symbols Vector of symbols to subscribe to (e.g., {"BTC/USD", "ETH/USD"})
-     * @return true if subscription message sent successfully, false if not connected
-     */
-    bool subscribe_symbols(const std::vector<std::string>& symbols);
-
-    /**
-     * Unsubscribe from symbols while connected
-     * Removes symbols from internal symbols_ vector
-     * @param symbols Vector of symbols to unsubscribe from
-     * @return true if unsubscribe message sent successfully, false if not connected
-     */
-    bool unsubscribe_symbols(const std::vector<std::string>& symbols);
-
     // Note: Flush/segment configuration methods inherited from FlushSegmentMixin:
     // - void set_flush_interval(std::chrono::seconds interval)
     // - void set_memory_threshold(size_t bytes)
@@ -143,23 +129,9 @@ public:
     // - size_t get_current_memory_usage() const
 
 protected:
-    // WebSocket types
-    typedef websocketpp::client<websocketpp::config::asio_tls_client> client;
-    typedef websocketpp::lib::shared_ptr<websocketpp::lib::asio::ssl::context> context_ptr;
-
-    // WebSocket client and connection
-    client ws_client_;
-    websocketpp::connection_hdl connection_hdl_;
-    std::thread worker_thread_;
-
-    // State
-    std::atomic<bool> running_;
-    std::atomic<bool> connected_;
-    std::vector<std::string> symbols_;
-
     // Data storage (protected by data_mutex_)
     mutable std::mutex data_mutex_;
-    std::vector<TickerRecord> ticker_history_;
+    TickerHistory ticker_history_;  // Immutable chunks, shared with exports
 
     // pending_updates is used for polling pattern when there is no update_callback_ defined
     std::vector<TickerRecord> pending_updates_;
@@ -178,28 +150,31 @@ protected:
     // - base_filename_, current_segment_filename_, current_segment_key_
     // - last_flush_time_, flush_count_
 
-    // Callbacks (protected by callback_mutex_)
-    mutable std::mutex callback_mutex_;
+    // Record callback (protected by callback_mutex_)
     UpdateCallback update_callback_;
-    ConnectionCallback connection_callback_;
-    ErrorCallback error_callback_;
-
-    // WebSocket event handlers
-    context_ptr on_tls_init(websocketpp::connection_hdl hdl);
-    void on_open(websocketpp::connection_hdl hdl);
-    void on_close(websocketpp::connection_hdl hdl);
-    void on_fail(websocketpp::connection_hdl hdl);
-    void on_message(websocketpp::connection_hdl hdl, client::message_ptr msg);
-
-    // Worker thread main function
-    void run_client();
-
-    // Helper methods
-    void notify_connection(bool connected);
-    void notify_error(const std::string& error);
+
     void add_record(const TickerRecord& record);
 
 private:
+    // ========================================================================
+    // Channel interface (required by KrakenStreamClientBase)
+    // ========================================================================
+
+    static const char* client_name() { return "WebSocket client"; }
+    static const char* io_thread_name() { return "ticker_io"; }
+
+    std::string build_subscription(const std::vector<std::string>& symbols) const {
+        return JsonParser::build_subscription(symbols);
+    }
+    std::string build_unsubscribe(const std::vector<std::string>& symbols) const {
+        return JsonParser::build_unsubscribe(symbols);
+    }
+
+    /**
+     * Decode one frame and store its tickers (I/O thread)
+     */
+    void handle_payload(const std::string& payload, int64_t recv_ts_ns);
+
     // ========================================================================
     // CRTP Interface Implementation (required by FlushSegmentMixin)
     // ========================================================================
@@ -246,7 +221,6 @@ private:
 template<typename JsonParser>
 KrakenWebSocketClientBase<JsonParser>::KrakenWebSocketClientBase()
     : FlushSegmentMixin<KrakenWebSocketClientBase<JsonParser>>(),  // Initialize mixin
-      running_(false), connected_(false),
       csv_header_written_(false) {
     // Note: flush_interval_, memory_threshold_bytes_, flush_count_,
     // segment_mode_, segment_count_, last_flush_time_ are initialized by mixin
@@ -254,7 +228,7 @@ KrakenWebSocketClientBase<JsonParser>::KrakenWebSocketClientBase()
 
 template<typename JsonParser>
 KrakenWebSocketClientBase<JsonParser>::~KrakenWebSocketClientBase() {
-    stop();
+    this->stop();  // The I/O thread stores into this object's members
 
     // Flush and close output file if open
     std::lock_guard<std::mutex> lock(data_mutex_);
@@ -266,63 +240,6 @@ KrakenWebSocketClientBase<JsonParser>::~KrakenWebSocketClientBase() {
     }
 }
 
-template<typename JsonParser>
-bool KrakenWebSocketClientBase<JsonParser>::start(std::vector<std::string> symbols) {
-    if (running_) {
-        std::cerr << "Client already running" << std::endl;
-        return false;
-    }
-
-    if (symbols.empty()) {
-        std::cerr << "No symbols provided" << std::endl;
-        return false;
-    }
-
-    symbols_ = std::move(symbols);
-    running_ = true;
-
-    worker_thread_ = std::thread([this]() {
-        this->run_client();
-    });
-
-    std::cout << "WebSocket client started (" << JsonParser::name() << " version)" << std::endl;
-    return true;
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::stop() {
-    if (!running_) {
-        return;
-    }
-
-    running_ = false;
-    connected_ = false;
-
-    try {
-        if (!ws_client_.stopped()) {
-            ws_client_.stop();
-        }
-
-        if (worker_thread_.joinable()) {
-            worker_thread_.join();
-        }
-
-        std::cout << "WebSocket client stopped" << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "Error stopping client: " << e.what() << std::endl;
-    }
-}
-
-template<typename JsonParser>
-bool KrakenWebSocketClientBase<JsonParser>::is_connected() const {
-    return connected_.load();
-}
-
-template<typename JsonParser>
-bool KrakenWebSocketClientBase<JsonParser>::is_running() const {
-    return running_.load();
-}
-
 template<typename JsonParser>
 std::vector<TickerRecord> KrakenWebSocketClientBase<JsonParser>::get_updates() {
     std::lock_guard<std::mutex> lock(data_mutex_);
@@ -334,7 +251,7 @@ std::vector<TickerRecord> KrakenWebSocketClientBase<JsonParser>::get_updates() {
 template<typename JsonParser>
 std::vector<TickerRecord> KrakenWebSocketClientBase<JsonParser>::get_history() const {
     std::lock_guard<std::mutex> lock(data_mutex_);
-    return ticker_history_;
+    return ticker_history_.to_vector();
 }
 
 template<typename JsonParser>
@@ -345,22 +262,10 @@ size_t KrakenWebSocketClientBase<JsonParser>::pending_count() const {
 
 template<typename JsonParser>
 void KrakenWebSocketClientBase<JsonParser>::set_update_callback(UpdateCallback callback) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
+    std::lock_guard<std::mutex> lock(this->callback_mutex_);
     update_callback_ = callback;
 }
 
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::set_connection_callback(ConnectionCallback callback) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    connection_callback_ = callback;
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::set_error_callback(ErrorCallback callback) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    error_callback_ = callback;
-}
-
 template<typename JsonParser>
 void KrakenWebSocketClientBase<JsonParser>::flush() {
     std::lock_guard<std::mutex> lock(data_mutex_);
@@ -380,12 +285,29 @@ void KrakenWebSocketClientBase<JsonParser>::flush() {
 }
 
 template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::save_to_csv(const std::string& filename) {
-    std::lock_guard<std::mutex> lock(data_mutex_);
-
+bool KrakenWebSocketClientBase<JsonParser>::save_to_csv(const std::string& filename) {
     // Always create a one-shot snapshot to the specified file
     // This is independent of the configured output_file_ for periodic flushing
-    Utils::save_to_csv(filename, ticker_history_);
+    TickerHistory::Snapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        snapshot = ticker_history_.snapshot();
+    }
+    return Utils::save_to_csv(filename, snapshot);
+}
+
+template<typename JsonParser>
+std::future<bool> KrakenWebSocketClientBase<JsonParser>::save_to_csv_async(const std::string& filename) {
+    TickerHistory::Snapshot snapshot;
+    {
+        std::lock_guard<std::mutex> lock(data_mutex_);
+        snapshot = ticker_history_.snapshot();
+    }
+
+    // The task owns the snapshot; it does not touch the client
+    return std::async(std::launch::async, [filename, snapshot]() {
+        return Utils::save_to_csv(filename, snapshot);
+    });
 }
 
 template<typename JsonParser>
@@ -414,146 +336,26 @@ void KrakenWebSocketClientBase<JsonParser>::set_output_file(const std::string& f
 }
 
 template<typename JsonParser>
-typename KrakenWebSocketClientBase<JsonParser>::context_ptr
-KrakenWebSocketClientBase<JsonParser>::on_tls_init(websocketpp::connection_hdl) {
-    context_ptr ctx = std::make_shared<boost::asio::ssl::context>(
-        boost::asio::ssl::context::sslv23);
-
-    try {
-        ctx->set_options(boost::asio::ssl::context::default_workarounds |
-                        boost::asio::ssl::context::no_sslv2 |
-                        boost::asio::ssl::context::no_sslv3 |
-                        boost::asio::ssl::context::single_dh_use);
-    } catch (const std::exception& e) {
-        notify_error("TLS init error: " + std::string(e.what()));
-    }
-
-    return ctx;
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::on_open(websocketpp::connection_hdl hdl) {
-    std::cout << "WebSocket connection opened" << std::endl;
-    connection_hdl_ = hdl;
-    connected_ = true;
-
-    notify_connection(true);
-
-    // Build subscription using parser-specific method
-    std::string msg_str = JsonParser::build_subscription(symbols_);
-    std::cout << "Subscribing to: " << msg_str << std::endl;
-
-    try {
-        ws_client_.send(hdl, msg_str, websocketpp::frame::opcode::text);
-    } catch (const std::exception& e) {
-        notify_error("Send error: " + std::string(e.what()));
-    }
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::on_close(websocketpp::connection_hdl) {
-    std::cout << "WebSocket connection closed" << std::endl;
-    connected_ = false;
-    notify_connection(false);
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::on_fail(websocketpp::connection_hdl) {
-    std::cerr << "WebSocket connection failed" << std::endl;
-    connected_ = false;
-    notify_connection(false);
-    notify_error("Connection failed");
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::on_message(
-    websocketpp::connection_hdl, client::message_ptr msg) {
-
-    try {
-        // Use parser-specific parsing - it will call add_record() for each ticker
-        JsonParser::parse_message(msg->get_payload(),
-            [this](const TickerRecord& record) {
-                this->add_record(record);
-            });
-    } catch (const std::exception& e) {
-        notify_error("Message handling error: " + std::string(e.what()));
-    }
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::run_client() {
-    try {
-        ws_client_.init_asio();
-        ws_client_.set_tls_init_handler([this](websocketpp::connection_hdl hdl) {
-            return this->on_tls_init(hdl);
-        });
-
-        ws_client_.set_open_handler([this](websocketpp::connection_hdl hdl) {
-            this->on_open(hdl);
-        });
-        ws_client_.set_message_handler([this](websocketpp::connection_hdl hdl, client::message_ptr msg) {
-            this->on_message(hdl, msg);
-        });
-        ws_client_.set_close_handler([this](websocketpp::connection_hdl hdl) {
-            this->on_close(hdl);
-        });
-        ws_client_.set_fail_handler([this](websocketpp::connection_hdl hdl) {
-            this->on_fail(hdl);
+void KrakenWebSocketClientBase<JsonParser>::handle_payload(const std::string& payload, int64_t recv_ts_ns) {
+    KRAKEN_ALLOC_SCOPE("ticker_client.on_message");
+    KRAKEN_TRACE_SCOPE("ticker.parse");
+
+    // Use parser-specific parsing - it will call add_record() for each ticker
+    JsonParser::parse_message(payload,
+        [this, recv_ts_ns](TickerRecord& record) {
+            record.recv_ts_ns = recv_ts_ns;
+            if (this->watchdog_) {
+                this->watchdog_->on_data(record.pair);
+            }
+            this->add_record(record);
         });
-
-        // Set logging
-        ws_client_.clear_access_channels(websocketpp::log::alevel::all);
-        ws_client_.set_access_channels(websocketpp::log::alevel::connect);
-        ws_client_.set_access_channels(websocketpp::log::alevel::disconnect);
-
-        // Connect
-        std::string uri = "wss://ws.kraken.com/v2";
-        websocketpp::lib::error_code ec;
-        client::connection_ptr con = ws_client_.get_connection(uri, ec);
-
-        if (ec) {
-            notify_error("Connection error: " + ec.message());
-            running_ = false;
-            return;
-        }
-
-        ws_client_.connect(con);
-        std::cout << "Connecting to " << uri << "..." << std::endl;
-
-        ws_client_.run();
-
-    } catch (const websocketpp::exception& e) {
-        notify_error("WebSocket++ exception: " + std::string(e.what()));
-    } catch (const std::exception& e) {
-        notify_error("Exception: " + std::string(e.what()));
-    }
-
-    running_ = false;
-    connected_ = false;
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::notify_connection(bool connected) {
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    if (connection_callback_) {
-        connection_callback_(connected);
-    }
-}
-
-template<typename JsonParser>
-void KrakenWebSocketClientBase<JsonParser>::notify_error(const std::string& error) {
-    std::cerr << "[Error] " << error << std::endl;
-
-    std::lock_guard<std::mutex> lock(callback_mutex_);
-    if (error_callback_) {
-        error_callback_(error);
-    }
 }
 
 template<typename JsonParser>
 void KrakenWebSocketClientBase<JsonParser>::add_record(const TickerRecord& record) {
     // Store in history and pending, check if flush needed
     {
+        KRAKEN_TRACE_SCOPE("ticker.data_lock");
         std::lock_guard<std::mutex> lock(data_mutex_);
         ticker_history_.push_back(record);
         pending_updates_.push_back(record);
@@ -568,85 +370,14 @@ void KrakenWebSocketClientBase<JsonParser>::add_record(const TickerRecord& recor
 
     // Call user callback (outside data lock)
     {
-        std::lock_guard<std::mutex> lock(callback_mutex_);
+        KRAKEN_TRACE_SCOPE("ticker.callback");
+        std::lock_guard<std::mutex> lock(this->callback_mutex_);
         if (update_callback_) {
             update_callback_(record);
         }
     }
 }
 
-template<typename JsonParser>
-bool KrakenWebSocketClientBase<JsonParser>::subscribe_symbols(
-    const std::vector<std::string>& symbols) {
-
-    if (!is_connected()) {
-        std::cerr << "Cannot subscribe: WebSocket not connected" << std::endl;
-        return false;
-    }
-
-    if (symbols.empty()) {
-        std::cerr << "Cannot subscribe: No symbols provided" << std::endl;
-        return false;
-    }
-
-    // Build and send subscription message
-    std::string msg_str = JsonParser::build_subscription(symbols);
-
-    try {
-        ws_client_.send(connection_hdl_, msg_str, websocketpp::frame::opcode::text);
-
-        // Add symbols to internal list (avoid duplicates)
-        for (const auto& symbol : symbols) {
-            auto it = std::find(symbols_.begin(), symbols_.end(), symbol);
-            if (it == symbols_.end()) {
-                symbols_.push_back(symbol);
-            }
-        }
-
-        std::cout << "Subscribed to " << symbols.size() << " additional symbol(s)" << std::endl;
-        return true;
-    } catch (const std::exception& e) {
-        notify_error("Failed to send subscribe message: " + std::string(e.what()));
-        return false;
-    }
-}
-
-template<typename JsonParser>
-bool KrakenWebSocketClientBase<JsonParser>::unsubscribe_symbols(
-    const std::vector<std::string>& symbols) {
-
-    if (!is_connected()) {
-        std::cerr << "Cannot unsubscribe: WebSocket not connected" << std::endl;
-        return false;
-    }
-
-    if (symbols.empty()) {
-        std::cerr << "Cannot unsubscribe: No symbols provided" << std::endl;
-        return false;
-    }
-
-    // Build and send unsubscription message
-    std::string msg_str = JsonParser::build_unsubscribe(symbols);
-
-    try {
-        ws_client_.send(connection_hdl_, msg_str, websocketpp::frame::opcode::text);
-
-        // Remove symbols from internal list
-        for (const auto& symbol : symbols) {
-            auto it = std::find(symbols_.begin(), symbols_.end(), symbol);
-            if (it != symbols_.end()) {
-                symbols_.erase(it);
-            }
-        }
-
-        std::cout << "Unsubscribed from " << symbols.size() << " symbol(s)" << std::endl;
-        return true;
-    } catch (const std::exception& e) {
-        notify_error("Failed to send unsubscribe message: " + std::string(e.what()));
-        return false;
-    }
-}
-
 // ============================================================================
 // CRTP Interface Implementation
 // ============================================================================
@@ -666,27 +397,14 @@ void KrakenWebSocketClientBase<JsonParser>::perform_flush() {
 
     // Write header only on first write
     if (!csv_header_written_) {
-        output_file_ << "timestamp,pair,type,bid,bid_qty,ask,ask_qty,last,volume,vwap,low,high,change,change_pct\n";
+        Utils::write_csv_header(output_file_);
         csv_header_written_ = true;
     }
 
     // Write data
-    for (const auto& record : ticker_history_) {
-        output_file_ << record.timestamp << ","
-                     << record.pair << ","
-                     << record.type << ","
-                     << record.bid << ","
-                     << record.bid_qty << ","
-                     << record.ask << ","
-                     << record.ask_qty << ","
-                     << record.last << ","
-                     << record.volume << ","
-                     << record.vwap << ","
-                     << record.low << ","
-                     << record.high << ","
-                     << record.change << ","
-                     << record.change_pct << "\n";
-    }
+    ticker_history_.for_each([this](const TickerRecord& record) {
+        Utils::write_csv_record(output_file_, record);
+    });
 
     // Flush to disk
     output_file_.flush();
@@ -700,7 +418,6 @@ void KrakenWebSocketClientBase<JsonParser>::perform_flush() {
 
     // Clear buffers
     ticker_history_.clear();
-    ticker_history_.reserve(RECORD_BUFFER_INITIAL_CAPACITY);
 
     // Also clear pending_updates_ to prevent memory leak in callback-driven mode
     // NOTE: If using polling pattern, call get_updates() more frequently than
@@ -717,14 +434,19 @@ void KrakenWebSocketClientBase<JsonParser>::perform_segment_transition(const std
         output_file_.close();
     }
 
-    // Mark that new file needs header
+    // Mark that new file needs header (a revisited segment may already have one)
+    bool revisit = this->segment_entered(new_filename);
     csv_header_written_ = false;
+    if (revisit) {
+        std::ifstream check(new_filename, std::ios::binary | std::ios::ate);
+        csv_header_written_ = check.is_open() && check.tellg() > 0;
+    }
 
     // Update output filename
     output_filename_ = new_filename;
 
-    // Open new segment file (use 'out' only to overwrite, not append)
-    output_file_.open(new_filename, std::ios::out);
+    // Open new segment file (overwrite, append when revisiting a segment)
+    output_file_.open(new_filename, revisit ? (std::ios::out | std::ios::app) : std::ios::out);
 
     if (!output_file_.is_open()) {
         std::cerr << "[Error] Cannot open segment file: " << new_filename << std::endl;
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <stdexcept>
 
 namespace kraken {
 
@@ -35,6 +36,9 @@ void Level3Display::show_minimal(const std::map<std::string, Level3Stats>& stats
                   << pair.second.update_count << " updates, "
                   << pair.second.bid_order_count << " bids, "
                   << pair.second.ask_order_count << " asks";
+        if (pair.second.checksum_mismatches > 0) {
+            std::cout << ", " << pair.second.checksum_mismatches << " checksum mismatches";
+        }
         first = false;
     }
     std::cout << std::endl;
@@ -132,4 +136,65 @@ void Level3Display::update_stats(Level3Stats& stats, const Level3Record& record)
     }
 }
 
+// ============================================================================
+// Checksum precision
+// ============================================================================
+
+namespace {
+
+std::string trim(const std::string& value) {
+    size_t begin = value.find_first_not_of(" \t");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = value.find_last_not_of(" \t");
+    return value.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+bool parse_checksum_precision(const std::string& spec, ChecksumPrecisionMap& out,
+                              std::string& error_message) {
+    std::istringstream entries(spec);
+    std::string entry;
+    while (std::getline(entries, entry, ';')) {
+        entry = trim(entry);
+        if (entry.empty()) {
+            continue;
+        }
+
+        std::string symbol = "*";
+        std::string decimals = entry;
+        size_t equals = entry.find('=');
+        if (equals != std::string::npos) {
+            symbol = trim(entry.substr(0, equals));
+            decimals = entry.substr(equals + 1);
+        }
+
+        size_t comma = decimals.find(',');
+        try {
+            if (symbol.empty() || comma == std::string::npos) {
+                throw std::invalid_argument("expected PRICE,QTY");
+            }
+            size_t used = 0;
+            std::string price = trim(decimals.substr(0, comma));
+            std::string qty = trim(decimals.substr(comma + 1));
+            int price_precision = std::stoi(price, &used);
+            if (used != price.size() || price_precision < 0) {
+                throw std::invalid_argument("bad price decimals");
+            }
+            int qty_precision = std::stoi(qty, &used);
+            if (used != qty.size() || qty_precision < 0) {
+                throw std::invalid_argument("bad qty decimals");
+            }
+            out[symbol] = std::make_pair(price_precision, qty_precision);
+        } catch (const std::exception&) {
+            error_message = "invalid checksum precision entry: " + entry +
+                            " (expected PRICE,QTY or SYMBOL=PRICE,QTY)";
+            return false;
+        }
+    }
+    return true;
+}
+
 } // namespace kraken
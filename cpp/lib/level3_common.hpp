@@ -11,6 +11,7 @@
 #include <vector>
 #include <cstdint>
 #include <map>
+#include <utility>
 
 namespace kraken {
 
@@ -45,8 +46,9 @@ struct Level3Record {
     std::vector<Level3Order> bids;
     std::vector<Level3Order> asks;
     uint32_t checksum;
+    int64_t recv_ts_ns;  // Frame receive time (ns since epoch, 0 = unknown)
 
-    Level3Record() : checksum(0) {}
+    Level3Record() : checksum(0), recv_ts_ns(0) {}
 };
 
 /**
@@ -69,6 +71,11 @@ struct Level3Stats {
     double best_ask;
     double spread;
 
+    // Checksum validation (when enabled)
+    int checksum_checks;
+    int checksum_mismatches;
+    int resync_count;
+
     Level3Stats()
         : snapshot_count(0)
         , update_count(0)
@@ -81,6 +88,9 @@ struct Level3Stats {
         , best_bid(0.0)
         , best_ask(0.0)
         , spread(0.0)
+        , checksum_checks(0)
+        , checksum_mismatches(0)
+        , resync_count(0)
     {}
 };
 
@@ -121,6 +131,22 @@ private:
     static std::string format_quantity(double qty, int width = 10);
 };
 
+/**
+ * Checksum precision per symbol: symbol -> (price decimals, qty decimals)
+ * The "*" entry applies to symbols without an entry of their own.
+ */
+using ChecksumPrecisionMap = std::map<std::string, std::pair<int, int>>;
+
+/**
+ * Parse a checksum precision specification
+ * "PRICE,QTY" applies to every symbol, "SYMBOL=PRICE,QTY" to one symbol;
+ * entries are separated by ';' (e.g. "1,8;ETH/USD=2,8"). Use the pair's
+ * price_precision / qty_precision from the instrument channel.
+ * @return false with error_message set on a malformed entry
+ */
+bool parse_checksum_precision(const std::string& spec, ChecksumPrecisionMap& out,
+                              std::string& error_message);
+
 } // namespace kraken
 
 #endif // LEVEL3_COMMON_HPP
@@ -2,22 +2,47 @@
  * Level 3 Snapshot CSV Writer
  *
  * Writes Level 3 order book snapshot metrics to CSV format with adaptive precision.
+ * Queue probe columns are added when the first snapshot written carries them
+ * (Level3SnapshotMetrics::has_queue_probe).
+ *
+ * A BufferedWriter with Level3CsvCodec (see buffered_writer.hpp).
  */
 
 #ifndef LEVEL3_CSV_WRITER_HPP
 #define LEVEL3_CSV_WRITER_HPP
 
 #include <string>
-#include <fstream>
-#include <map>
 #include "level3_state.hpp"
+#include "buffered_writer.hpp"
 
 namespace kraken {
 
+/**
+ * Level 3 snapshot metrics codec (CSV with adaptive precision)
+ */
+struct Level3CsvCodec {
+    bool columns_fixed;   // Queue columns decided (first snapshot of the file)
+    bool queue_columns;
+
+    Level3CsvCodec() : columns_fixed(false), queue_columns(false) {}
+
+    static const char* extension() { return ".csv"; }
+
+    void header(const Level3SnapshotMetrics& first, std::string& out);
+
+    void encode(const Level3SnapshotMetrics& metrics, std::string& out);
+
+    /**
+     * Append one side's queue probe columns
+     */
+    static void append_probe(std::string& out, const QueueEstimate& probe, double qty);
+};
+
 /**
  * CSV writer for Level 3 snapshot metrics
+ * The file is opened by the constructor.
  */
-class Level3CSVWriter {
+class Level3CSVWriter : public BufferedWriter<Level3SnapshotMetrics, Level3CsvCodec> {
 public:
     /**
      * Constructor
@@ -26,103 +51,39 @@ public:
      */
     Level3CSVWriter(const std::string& filename, bool append = false);
 
-    /**
-     * Destructor - closes file
-     */
-    ~Level3CSVWriter();
-
     /**
      * Write snapshot metrics to CSV
      */
     bool write_snapshot(const Level3SnapshotMetrics& metrics);
 
-    /**
-     * Flush buffered data to disk
-     */
-    void flush();
-
-    /**
-     * Check if file is open and writable
-     */
-    bool is_open() const;
-
     /**
      * Get number of snapshots written
      */
-    size_t get_snapshot_count() const;
-
-private:
-    std::ofstream file_;
-    std::string filename_;
-    size_t snapshot_count_;
-    bool header_written_;
-
-    /**
-     * Write CSV header
-     */
-    void write_header();
-
-    /**
-     * Format double with adaptive precision (no trailing zeros)
-     */
-    std::string format_double(double value) const;
+    size_t get_snapshot_count() const { return get_record_count(); }
 };
 
 /**
  * Multi-file CSV writer - separate file per symbol
+ * E.g., "level3_snapshots.csv" -> "level3_snapshots_BTC_USD.csv"
  */
-class MultiFileLevel3CSVWriter {
+class MultiFileLevel3CSVWriter : public MultiFileWriter<Level3SnapshotMetrics, Level3CsvCodec> {
 public:
     /**
      * Constructor
      * @param base_filename Base filename (will be appended with symbol)
+     * @param append Append to existing per-symbol files (default: false)
      */
-    MultiFileLevel3CSVWriter(const std::string& base_filename);
-
-    /**
-     * Destructor - closes all files
-     */
-    ~MultiFileLevel3CSVWriter();
+    MultiFileLevel3CSVWriter(const std::string& base_filename, bool append = false);
 
     /**
      * Write snapshot to appropriate file based on symbol
      */
     bool write_snapshot(const Level3SnapshotMetrics& metrics);
 
-    /**
-     * Flush all files
-     */
-    void flush_all();
-
-    /**
-     * Get number of files open
-     */
-    size_t get_file_count() const;
-
     /**
      * Get total snapshots written across all files
      */
-    size_t get_total_snapshot_count() const;
-
-private:
-    std::string base_filename_;
-    std::map<std::string, Level3CSVWriter*> writers_;
-
-    /**
-     * Get or create writer for symbol
-     */
-    Level3CSVWriter* get_writer(const std::string& symbol);
-
-    /**
-     * Create filename for symbol
-     * E.g., "level3_snapshots_BTC_USD.csv"
-     */
-    std::string create_filename(const std::string& symbol) const;
-
-    /**
-     * Sanitize symbol for filename (replace / with _)
-     */
-    std::string sanitize_symbol(const std::string& symbol) const;
+    size_t get_total_snapshot_count() const { return get_total_record_count(); }
 };
 
 } // namespace kraken
@@ -3,138 +3,76 @@
  *
  * Writes Level3Record data to .jsonl (JSON Lines) format
  * One JSON object per line, suitable for streaming order-level data
+ *
+ * A BufferedWriter with Level3JsonlCodec (see buffered_writer.hpp).
  */
 
 #ifndef LEVEL3_JSONL_WRITER_HPP
 #define LEVEL3_JSONL_WRITER_HPP
 
 #include "level3_common.hpp"
-#include <fstream>
+#include "buffered_writer.hpp"
 #include <string>
-#include <sstream>
-#include <iomanip>
-#include <map>
+#include <vector>
 
 namespace kraken {
 
 /**
- * JSON Lines Writer for Level 3 orders
+ * Level 3 record codec (one JSON object per line)
  */
-class Level3JsonLinesWriter {
-public:
-    /**
-     * Constructor
-     * @param filename Output filename
-     * @param append Append to existing file (default: false)
-     */
-    Level3JsonLinesWriter(const std::string& filename, bool append = false);
-
-    /**
-     * Destructor - closes file
-     */
-    ~Level3JsonLinesWriter();
-
-    /**
-     * Write Level 3 order book record to file
-     */
-    bool write_record(const Level3Record& record);
-
-    /**
-     * Flush buffered data to disk
-     */
-    void flush();
-
-    /**
-     * Check if file is open and writable
-     */
-    bool is_open() const;
+struct Level3JsonlCodec {
+    static const char* extension() { return ".jsonl"; }
 
-    /**
-     * Get number of records written
-     */
-    size_t get_record_count() const;
+    void header(const Level3Record&, std::string&) {}
 
-private:
-    std::ofstream file_;
-    std::string filename_;
-    size_t record_count_;
+    void encode(const Level3Record& record, std::string& out) const;
 
     /**
-     * Convert Level3Record to JSON string
+     * Append an orders array
      */
-    std::string record_to_json(const Level3Record& record) const;
+    static void append_orders(std::string& out, const std::vector<Level3Order>& orders);
 
     /**
-     * Escape JSON string
+     * Append a single order object
      */
-    std::string escape_json_string(const std::string& str) const;
+    static void append_order(std::string& out, const Level3Order& order);
+};
 
+/**
+ * JSON Lines Writer for Level 3 orders
+ * The file is opened by the constructor.
+ */
+class Level3JsonLinesWriter : public BufferedWriter<Level3Record, Level3JsonlCodec> {
+public:
     /**
-     * Format orders array to JSON
+     * Constructor
+     * @param filename Output filename
+     * @param append Append to existing file (default: false)
      */
-    std::string orders_to_json(const std::vector<Level3Order>& orders) const;
+    Level3JsonLinesWriter(const std::string& filename, bool append = false);
 
     /**
-     * Format single order to JSON
+     * Write Level 3 order book record (buffered with periodic flush)
      */
-    std::string order_to_json(const Level3Order& order) const;
+    bool write_record(const Level3Record& record);
 };
 
 /**
  * Multi-file JSON Lines Writer for Level 3
  * Manages separate files per symbol
  */
-class MultiFileLevel3JsonLinesWriter {
+class MultiFileLevel3JsonLinesWriter : public MultiFileWriter<Level3Record, Level3JsonlCodec> {
 public:
     /**
      * Constructor
      * @param base_filename Base filename (will be appended with symbol)
      */
-    MultiFileLevel3JsonLinesWriter(const std::string& base_filename);
-
-    /**
-     * Destructor - closes all files
-     */
-    ~MultiFileLevel3JsonLinesWriter();
+    explicit MultiFileLevel3JsonLinesWriter(const std::string& base_filename);
 
     /**
      * Write record to appropriate file based on symbol
      */
     bool write_record(const Level3Record& record);
-
-    /**
-     * Flush all files
-     */
-    void flush_all();
-
-    /**
-     * Get number of files open
-     */
-    size_t get_file_count() const;
-
-    /**
-     * Get total records written across all files
-     */
-    size_t get_total_record_count() const;
-
-private:
-    std::string base_filename_;
-    std::map<std::string, Level3JsonLinesWriter*> writers_;
-
-    /**
-     * Get or create writer for symbol
-     */
-    Level3JsonLinesWriter* get_writer(const std::string& symbol);
-
-    /**
-     * Create filename for symbol
-     */
-    std::string create_filename(const std::string& symbol) const;
-
-    /**
-     * Sanitize symbol for filename
-     */
-    std::string sanitize_symbol(const std::string& symbol) const;
 };
 
 } // namespace kraken
@@ -3,8 +3,10 @@
  */
 
 #include "level3_state.hpp"
+#include "alloc_counter.hpp"
 #include <algorithm>
 #include <cmath>
+#include <cstdio>
 
 namespace kraken {
 
@@ -12,8 +14,42 @@ namespace kraken {
 // Level3OrderBookState Implementation
 // ============================================================================
 
+namespace {
+
+// Compact a level once it has more empty slots than orders (and enough to matter)
+const size_t MIN_COMPACT_HOLES = 32;
+
+// Remove order from its level; returns true if the level is now empty
+bool remove_from_level(Level3PriceLevel& level, const std::shared_ptr<Order>& order) {
+    size_t slot = order->queue_slot;
+    if (slot < level.orders.size() && level.orders[slot] == order) {
+        level.orders[slot].reset();
+        level.queue.remove(slot);
+        level.total_qty -= order->order_qty;
+        level.fragment_valid = false;
+    }
+    return level.queue.live() == 0;
+}
+
+// Change the order's quantity in place, keeping its queue position
+void update_in_level(Level3PriceLevel& level, const std::shared_ptr<Order>& order, double new_qty) {
+    size_t slot = order->queue_slot;
+    if (slot < level.orders.size() && level.orders[slot] == order) {
+        level.queue.set_qty(slot, new_qty);
+        level.total_qty += new_qty - order->order_qty;
+        level.fragment_valid = false;
+    }
+    order->order_qty = new_qty;
+}
+
+} // anonymous namespace
+
 Level3OrderBookState::Level3OrderBookState(const std::string& symbol)
-    : symbol_(symbol), add_count_(0), modify_count_(0), delete_count_(0) {
+    : symbol_(symbol), l2_snapshot_pending_(false),
+      price_precision_(0), qty_precision_(0),
+      infer_price_precision_(true), infer_qty_precision_(true),
+      checksum_checks_(0), checksum_mismatches_(0),
+      add_count_(0), modify_count_(0), delete_count_(0) {
 }
 
 Level3OrderBookState::~Level3OrderBookState() {
@@ -24,9 +60,12 @@ void Level3OrderBookState::clear_all_orders() {
     orders_by_id_.clear();
     bids_by_price_.clear();
     asks_by_price_.clear();
+    changed_bids_.clear();
+    changed_asks_.clear();
 }
 
 void Level3OrderBookState::apply_snapshot(const Level3Record& record) {
+    KRAKEN_ALLOC_SCOPE("level3_state.apply_snapshot");
     // Clear existing state
     clear_all_orders();
 
@@ -39,9 +78,20 @@ void Level3OrderBookState::apply_snapshot(const Level3Record& record) {
     for (const auto& order : record.asks) {
         add_order(order, false);
     }
+
+    // Individual level changes are superseded by the full book
+    changed_bids_.clear();
+    changed_asks_.clear();
+    l2_snapshot_pending_ = true;
+
+    // Where a probe stood is unknown after a resync; requeue at the back
+    for (size_t i = 0; i < probes_.size(); i++) {
+        move_queue_probe(static_cast<int>(i), probes_[i].price);
+    }
 }
 
 void Level3OrderBookState::apply_update(const Level3Record& record) {
+    KRAKEN_ALLOC_SCOPE("level3_state.apply_update");
     // Process bid updates
     for (const auto& order : record.bids) {
         if (order.event == "add") {
@@ -72,19 +122,22 @@ void Level3OrderBookState::apply_update(const Level3Record& record) {
 }
 
 void Level3OrderBookState::add_order(const Level3Order& order, bool is_bid) {
+    observe_precision(order.limit_price, order.order_qty);
+
     // Create new order
     auto new_order = std::make_shared<Order>(
         order.order_id,
         order.limit_price,
         order.order_qty,
-        order.timestamp
+        order.timestamp,
+        is_bid
     );
 
     // Add to ID index
     orders_by_id_[order.order_id] = new_order;
 
     // Add to price index
-    add_to_price_index(new_order, is_bid);
+    add_to_price_index(new_order);
 }
 
 void Level3OrderBookState::modify_order(const std::string& order_id, double new_price, double new_qty) {
@@ -96,27 +149,34 @@ void Level3OrderBookState::modify_order(const std::string& order_id, double new_
     }
 
     auto order = it->second;
-    bool is_bid = false;
-
-    // Determine if bid or ask by checking which index it's in
-    auto bid_it = bids_by_price_.find(order->limit_price);
-    if (bid_it != bids_by_price_.end()) {
-        auto& orders = bid_it->second;
-        auto order_it = std::find(orders.begin(), orders.end(), order);
-        if (order_it != orders.end()) {
-            is_bid = true;
+    observe_precision(new_price, new_qty);
+
+    // Same price: the order keeps its place in the queue
+    if (new_price == order->limit_price) {
+        Level3PriceLevel* level = nullptr;
+        if (order->is_bid) {
+            auto level_it = bids_by_price_.find(new_price);
+            level = level_it != bids_by_price_.end() ? &level_it->second : nullptr;
+        } else {
+            auto level_it = asks_by_price_.find(new_price);
+            level = level_it != asks_by_price_.end() ? &level_it->second : nullptr;
+        }
+        if (level) {
+            update_in_level(*level, order, new_qty);
+            (order->is_bid ? changed_bids_ : changed_asks_).push_back(new_price);
+            return;
         }
     }
 
     // Remove from old price level
-    remove_from_price_index(order, is_bid);
+    remove_from_price_index(order);
 
     // Update order data
     order->limit_price = new_price;
     order->order_qty = new_qty;
 
     // Add to new price level
-    add_to_price_index(order, is_bid);
+    add_to_price_index(order);
 }
 
 void Level3OrderBookState::delete_order(const std::string& order_id) {
@@ -126,56 +186,120 @@ void Level3OrderBookState::delete_order(const std::string& order_id) {
         return;
     }
 
-    auto order = it->second;
-    bool is_bid = false;
-
-    // Determine if bid or ask
-    auto bid_it = bids_by_price_.find(order->limit_price);
-    if (bid_it != bids_by_price_.end()) {
-        auto& orders = bid_it->second;
-        auto order_it = std::find(orders.begin(), orders.end(), order);
-        if (order_it != orders.end()) {
-            is_bid = true;
-        }
-    }
-
     // Remove from price index
-    remove_from_price_index(order, is_bid);
+    remove_from_price_index(it->second);
 
     // Remove from ID index
     orders_by_id_.erase(it);
 }
 
-void Level3OrderBookState::add_to_price_index(std::shared_ptr<Order> order, bool is_bid) {
-    if (is_bid) {
-        bids_by_price_[order->limit_price].push_back(order);
-    } else {
-        asks_by_price_[order->limit_price].push_back(order);
+void Level3OrderBookState::add_to_price_index(const std::shared_ptr<Order>& order) {
+    Level3PriceLevel& level = order->is_bid ? bids_by_price_[order->limit_price]
+                                            : asks_by_price_[order->limit_price];
+    order->queue_slot = level.queue.append(order->order_qty);
+    level.orders.push_back(order);
+    level.total_qty += order->order_qty;
+    level.fragment_valid = false;
+
+    (order->is_bid ? changed_bids_ : changed_asks_).push_back(order->limit_price);
+}
+
+namespace {
+
+// Smallest number of decimals that prints value exactly (capped at 12)
+int decimals_needed(double value) {
+    double scaled = std::fabs(value);
+    for (int decimals = 0; decimals < 12; decimals++) {
+        if (std::fabs(scaled - std::round(scaled)) <= 1e-6 + scaled * 1e-12) {
+            return decimals;
+        }
+        scaled *= 10.0;
     }
+    return 12;
 }
 
-void Level3OrderBookState::remove_from_price_index(std::shared_ptr<Order> order, bool is_bid) {
-    if (is_bid) {
-        auto it = bids_by_price_.find(order->limit_price);
-        if (it != bids_by_price_.end()) {
-            auto& orders = it->second;
-            orders.erase(std::remove(orders.begin(), orders.end(), order), orders.end());
+// Print value with the given decimals, dropping '.' and leading zeros
+// (Kraken checksum format, e.g. 0.05000000 -> "5000000")
+size_t format_checksum_value(double value, int precision, char* out) {
+    char buf[64];
+    int len = std::snprintf(buf, sizeof(buf), "%.*f", precision, value);
+
+    size_t n = 0;
+    for (int i = 0; i < len; i++) {
+        if (buf[i] == '.' || (buf[i] == '0' && n == 0)) {
+            continue;
+        }
+        out[n++] = buf[i];
+    }
+    return n;
+}
 
+} // anonymous namespace
+
+void Level3OrderBookState::remove_from_price_index(const std::shared_ptr<Order>& order) {
+    double price = order->limit_price;
+    if (order->is_bid) {
+        auto it = bids_by_price_.find(price);
+        if (it != bids_by_price_.end()) {
             // Remove price level if empty
-            if (orders.empty()) {
+            if (remove_from_level(it->second, order)) {
                 bids_by_price_.erase(it);
+                reset_level_probes(true, price);
+            } else if (it->second.queue.holes() > std::max(it->second.queue.live(), MIN_COMPACT_HOLES)) {
+                compact_level(true, price, it->second);
             }
+            changed_bids_.push_back(price);
         }
     } else {
-        auto it = asks_by_price_.find(order->limit_price);
+        auto it = asks_by_price_.find(price);
         if (it != asks_by_price_.end()) {
-            auto& orders = it->second;
-            orders.erase(std::remove(orders.begin(), orders.end(), order), orders.end());
-
             // Remove price level if empty
-            if (orders.empty()) {
+            if (remove_from_level(it->second, order)) {
                 asks_by_price_.erase(it);
+                reset_level_probes(false, price);
+            } else if (it->second.queue.holes() > std::max(it->second.queue.live(), MIN_COMPACT_HOLES)) {
+                compact_level(false, price, it->second);
             }
+            changed_asks_.push_back(price);
+        }
+    }
+}
+
+void Level3OrderBookState::compact_level(bool is_bid, double price, Level3PriceLevel& level) {
+    // A probe keeps the orders ahead of it: its new slot is their count
+    for (auto& probe : probes_) {
+        if (probe.is_bid == is_bid && probe.price == price) {
+            probe.slot = level.queue.count_before(probe.slot);
+        }
+    }
+
+    // Re-summing here also drops the rounding residue of the incremental total
+    std::vector<double> quantities;
+    quantities.reserve(level.queue.live());
+    auto& orders = level.orders;
+    size_t live = 0;
+    level.total_qty = 0;
+    for (size_t i = 0; i < orders.size(); i++) {
+        if (!orders[i]) {
+            continue;
+        }
+        if (live != i) {
+            orders[live] = std::move(orders[i]);
+        }
+        orders[live]->queue_slot = live;
+        quantities.push_back(orders[live]->order_qty);
+        level.total_qty += orders[live]->order_qty;
+        live++;
+    }
+    orders.resize(live);
+    level.queue.rebuild(quantities);
+}
+
+void Level3OrderBookState::reset_level_probes(bool is_bid, double price) {
+    // The level is gone; orders arriving at this price later queue behind
+    for (auto& probe : probes_) {
+        if (probe.is_bid == is_bid && probe.price == price) {
+            probe.slot = 0;
         }
     }
 }
@@ -187,13 +311,7 @@ bool Level3OrderBookState::get_best_bid(double& price, double& total_qty) const
 
     auto it = bids_by_price_.begin();
     price = it->first;
-
-    // Sum all orders at this price level
-    total_qty = 0;
-    for (const auto& order : it->second) {
-        total_qty += order->order_qty;
-    }
-
+    total_qty = it->second.total_qty;
     return true;
 }
 
@@ -204,20 +322,14 @@ bool Level3OrderBookState::get_best_ask(double& price, double& total_qty) const
 
     auto it = asks_by_price_.begin();
     price = it->first;
-
-    // Sum all orders at this price level
-    total_qty = 0;
-    for (const auto& order : it->second) {
-        total_qty += order->order_qty;
-    }
-
+    total_qty = it->second.total_qty;
     return true;
 }
 
 int Level3OrderBookState::get_total_bid_orders() const {
     int count = 0;
     for (const auto& pair : bids_by_price_) {
-        count += pair.second.size();
+        count += pair.second.queue.live();
     }
     return count;
 }
@@ -225,7 +337,7 @@ int Level3OrderBookState::get_total_bid_orders() const {
 int Level3OrderBookState::get_total_ask_orders() const {
     int count = 0;
     for (const auto& pair : asks_by_price_) {
-        count += pair.second.size();
+        count += pair.second.queue.live();
     }
     return count;
 }
@@ -235,7 +347,7 @@ int Level3OrderBookState::get_bid_orders_at_price(double price) const {
     if (it == bids_by_price_.end()) {
         return 0;
     }
-    return it->second.size();
+    return it->second.queue.live();
 }
 
 int Level3OrderBookState::get_ask_orders_at_price(double price) const {
@@ -243,7 +355,7 @@ int Level3OrderBookState::get_ask_orders_at_price(double price) const {
     if (it == asks_by_price_.end()) {
         return 0;
     }
-    return it->second.size();
+    return it->second.queue.live();
 }
 
 double Level3OrderBookState::get_bid_volume_at_price(double price) const {
@@ -251,12 +363,7 @@ double Level3OrderBookState::get_bid_volume_at_price(double price) const {
     if (it == bids_by_price_.end()) {
         return 0.0;
     }
-
-    double total = 0.0;
-    for (const auto& order : it->second) {
-        total += order->order_qty;
-    }
-    return total;
+    return it->second.total_qty;
 }
 
 double Level3OrderBookState::get_ask_volume_at_price(double price) const {
@@ -264,15 +371,11 @@ double Level3OrderBookState::get_ask_volume_at_price(double price) const {
     if (it == asks_by_price_.end()) {
         return 0.0;
     }
-
-    double total = 0.0;
-    for (const auto& order : it->second) {
-        total += order->order_qty;
-    }
-    return total;
+    return it->second.total_qty;
 }
 
 double Level3OrderBookState::get_bid_volume_within_bps(double reference_price, double bps) const {
+    KRAKEN_ALLOC_FREE_SCOPE("level3_state.bid_volume_within_bps");
     if (reference_price <= 0 || bps <= 0) {
         return 0.0;
     }
@@ -282,9 +385,7 @@ double Level3OrderBookState::get_bid_volume_within_bps(double reference_price, d
 
     for (const auto& pair : bids_by_price_) {
         if (pair.first >= min_price) {
-            for (const auto& order : pair.second) {
-                total_volume += order->order_qty;
-            }
+            total_volume += pair.second.total_qty;
         } else {
             break;  // Sorted in descending order
         }
@@ -294,6 +395,7 @@ double Level3OrderBookState::get_bid_volume_within_bps(double reference_price, d
 }
 
 double Level3OrderBookState::get_ask_volume_within_bps(double reference_price, double bps) const {
+    KRAKEN_ALLOC_FREE_SCOPE("level3_state.ask_volume_within_bps");
     if (reference_price <= 0 || bps <= 0) {
         return 0.0;
     }
@@ -303,9 +405,7 @@ double Level3OrderBookState::get_ask_volume_within_bps(double reference_price, d
 
     for (const auto& pair : asks_by_price_) {
         if (pair.first <= max_price) {
-            for (const auto& order : pair.second) {
-                total_volume += order->order_qty;
-            }
+            total_volume += pair.second.total_qty;
         } else {
             break;  // Sorted in ascending order
         }
@@ -322,9 +422,7 @@ double Level3OrderBookState::get_avg_bid_order_size() const {
 
     double total_volume = 0.0;
     for (const auto& pair : bids_by_price_) {
-        for (const auto& order : pair.second) {
-            total_volume += order->order_qty;
-        }
+        total_volume += pair.second.total_qty;
     }
 
     return total_volume / order_count;
@@ -338,14 +436,411 @@ double Level3OrderBookState::get_avg_ask_order_size() const {
 
     double total_volume = 0.0;
     for (const auto& pair : asks_by_price_) {
-        for (const auto& order : pair.second) {
-            total_volume += order->order_qty;
-        }
+        total_volume += pair.second.total_qty;
     }
 
     return total_volume / order_count;
 }
 
+// ============================================================================
+// Aggregated (L2) view
+// ============================================================================
+
+void Level3OrderBookState::get_top_bids(int n, std::vector<PriceLevel>& out) const {
+    out.clear();
+    for (const auto& pair : bids_by_price_) {
+        if (static_cast<int>(out.size()) >= n) break;
+        out.emplace_back(pair.first, pair.second.total_qty);
+    }
+}
+
+void Level3OrderBookState::get_top_asks(int n, std::vector<PriceLevel>& out) const {
+    out.clear();
+    for (const auto& pair : asks_by_price_) {
+        if (static_cast<int>(out.size()) >= n) break;
+        out.emplace_back(pair.first, pair.second.total_qty);
+    }
+}
+
+uint32_t Level3OrderBookState::calculate_l2_checksum() const {
+    std::vector<PriceLevel> bids;
+    std::vector<PriceLevel> asks;
+    get_top_bids(10, bids);
+    get_top_asks(10, asks);
+    return ChecksumValidator::calculate_crc32(bids, asks);
+}
+
+void Level3OrderBookState::get_l2_snapshot(const std::string& timestamp, OrderBookRecord& out) const {
+    out.timestamp = timestamp;
+    out.symbol = symbol_;
+    out.type = "snapshot";
+    get_top_bids(static_cast<int>(bids_by_price_.size()), out.bids);
+    get_top_asks(static_cast<int>(asks_by_price_.size()), out.asks);
+    out.checksum = calculate_l2_checksum();
+}
+
+bool Level3OrderBookState::take_l2_update(const std::string& timestamp, OrderBookRecord& out) {
+    KRAKEN_ALLOC_SCOPE("level3_state.take_l2_update");
+    if (l2_snapshot_pending_) {
+        l2_snapshot_pending_ = false;
+        changed_bids_.clear();
+        changed_asks_.clear();
+        get_l2_snapshot(timestamp, out);
+        return true;
+    }
+
+    if (changed_bids_.empty() && changed_asks_.empty()) {
+        return false;
+    }
+
+    out.timestamp = timestamp;
+    out.symbol = symbol_;
+    out.type = "update";
+    fill_changed_levels(changed_bids_, true, out.bids);
+    fill_changed_levels(changed_asks_, false, out.asks);
+
+    // Checksum over the aggregated top 10, as ChecksumValidator would compute it
+    get_top_bids(10, checksum_bids_);
+    get_top_asks(10, checksum_asks_);
+    out.checksum = ChecksumValidator::calculate_crc32(checksum_bids_, checksum_asks_);
+    return true;
+}
+
+void Level3OrderBookState::fill_changed_levels(std::vector<double>& prices, bool is_bid,
+                                               std::vector<PriceLevel>& out) const {
+    out.clear();
+    if (prices.empty()) {
+        return;
+    }
+
+    // A price can be touched several times per message (e.g. modify in place)
+    if (is_bid) {
+        std::sort(prices.begin(), prices.end(), std::greater<double>());
+    } else {
+        std::sort(prices.begin(), prices.end());
+    }
+    prices.erase(std::unique(prices.begin(), prices.end()), prices.end());
+
+    for (double price : prices) {
+        double qty = is_bid ? get_bid_volume_at_price(price) : get_ask_volume_at_price(price);
+        out.emplace_back(price, qty);  // 0 = level removed
+    }
+    prices.clear();
+}
+
+// ============================================================================
+// Level 3 checksum
+// ============================================================================
+
+void Level3OrderBookState::set_checksum_precision(int price_precision, int qty_precision) {
+    infer_price_precision_ = price_precision < 0;
+    infer_qty_precision_ = qty_precision < 0;
+    if (!infer_price_precision_) {
+        price_precision_ = price_precision;
+    }
+    if (!infer_qty_precision_) {
+        qty_precision_ = qty_precision;
+    }
+    invalidate_checksum_fragments();
+}
+
+void Level3OrderBookState::observe_precision(double price, double qty) {
+    if (!infer_price_precision_ && !infer_qty_precision_) {
+        return;
+    }
+
+    bool changed = false;
+    if (infer_price_precision_) {
+        int decimals = decimals_needed(price);
+        if (decimals > price_precision_) {
+            price_precision_ = decimals;
+            changed = true;
+        }
+    }
+    if (infer_qty_precision_) {
+        int decimals = decimals_needed(qty);
+        if (decimals > qty_precision_) {
+            qty_precision_ = decimals;
+            changed = true;
+        }
+    }
+
+    // Rare: happens while the first snapshot is loaded
+    if (changed) {
+        invalidate_checksum_fragments();
+    }
+}
+
+void Level3OrderBookState::invalidate_checksum_fragments() {
+    for (auto& pair : bids_by_price_) {
+        pair.second.fragment_valid = false;
+    }
+    for (auto& pair : asks_by_price_) {
+        pair.second.fragment_valid = false;
+    }
+}
+
+void Level3OrderBookState::build_checksum_fragment(double price, Level3PriceLevel& level) const {
+    char price_buf[64];
+    char qty_buf[64];
+    size_t price_len = format_checksum_value(price, price_precision_, price_buf);
+
+    level.checksum_fragment.clear();
+    for (const auto& order : level.orders) {
+        if (!order) {
+            continue;  // Removed, awaiting compaction
+        }
+        size_t qty_len = format_checksum_value(order->order_qty, qty_precision_, qty_buf);
+        level.checksum_fragment.append(price_buf, price_len);
+        level.checksum_fragment.append(qty_buf, qty_len);
+    }
+    level.fragment_valid = true;
+}
+
+uint32_t Level3OrderBookState::calculate_checksum() {
+    KRAKEN_ALLOC_SCOPE("level3_state.checksum");
+    uint32_t crc = 0xFFFFFFFF;
+
+    // Asks (lowest first), then bids (highest first), top 10 levels each
+    int level_count = 0;
+    for (auto& pair : asks_by_price_) {
+        if (level_count++ >= 10) break;
+        if (!pair.second.fragment_valid) {
+            build_checksum_fragment(pair.first, pair.second);
+        }
+        const std::string& fragment = pair.second.checksum_fragment;
+        crc = ChecksumValidator::crc32_update(crc, fragment.data(), fragment.size());
+    }
+
+    level_count = 0;
+    for (auto& pair : bids_by_price_) {
+        if (level_count++ >= 10) break;
+        if (!pair.second.fragment_valid) {
+            build_checksum_fragment(pair.first, pair.second);
+        }
+        const std::string& fragment = pair.second.checksum_fragment;
+        crc = ChecksumValidator::crc32_update(crc, fragment.data(), fragment.size());
+    }
+
+    return crc ^ 0xFFFFFFFF;
+}
+
+bool Level3OrderBookState::verify_checksum(uint32_t expected) {
+    checksum_checks_++;
+    if (calculate_checksum() == expected) {
+        return true;
+    }
+    checksum_mismatches_++;
+    return false;
+}
+
+// ============================================================================
+// Checkpoint
+// ============================================================================
+
+namespace {
+
+template <typename Map>
+void save_levels(const Map& levels, CheckpointWriter& out) {
+    out.put_u32(static_cast<uint32_t>(levels.size()));
+    for (const auto& pair : levels) {
+        out.put_f64(pair.first);
+        out.put_u32(static_cast<uint32_t>(pair.second.queue.live()));
+        for (const auto& order : pair.second.orders) {
+            if (!order) {
+                continue;
+            }
+            out.put_string(order->order_id);
+            out.put_f64(order->order_qty);
+            out.put_string(order->timestamp);
+        }
+    }
+}
+
+} // anonymous namespace
+
+void Level3OrderBookState::save_checkpoint(CheckpointWriter& out) const {
+    out.put_i32(price_precision_);
+    out.put_i32(qty_precision_);
+    out.put_u8(infer_price_precision_ ? 1 : 0);
+    out.put_u8(infer_qty_precision_ ? 1 : 0);
+    out.put_i32(add_count_);
+    out.put_i32(modify_count_);
+    out.put_i32(delete_count_);
+
+    save_levels(bids_by_price_, out);
+    save_levels(asks_by_price_, out);
+
+    // Probes by queue position (slots are renumbered on load)
+    out.put_u32(static_cast<uint32_t>(probes_.size()));
+    for (const auto& probe : probes_) {
+        const Level3PriceLevel* level = find_level(probe.is_bid, probe.price);
+        out.put_u8(probe.is_bid ? 1 : 0);
+        out.put_f64(probe.price);
+        out.put_u64(level ? level->queue.count_before(probe.slot) : 0);
+        out.put_f64(probe.placed_ahead);
+    }
+}
+
+bool Level3OrderBookState::load_checkpoint(CheckpointReader& in) {
+    clear_all_orders();
+    probes_.clear();
+
+    int price_precision = in.get_i32();
+    int qty_precision = in.get_i32();
+    bool infer_price = in.get_u8() != 0;
+    bool infer_qty = in.get_u8() != 0;
+    add_count_ = in.get_i32();
+    modify_count_ = in.get_i32();
+    delete_count_ = in.get_i32();
+
+    // Re-adding in queue order restores each level's queue
+    Level3Order order;
+    for (int side = 0; side < 2 && in.ok(); side++) {
+        bool is_bid = side == 0;
+        uint32_t level_count = in.get_u32();
+        for (uint32_t l = 0; l < level_count && in.ok(); l++) {
+            order.limit_price = in.get_f64();
+            uint32_t order_count = in.get_u32();
+            for (uint32_t o = 0; o < order_count && in.ok(); o++) {
+                order.order_id = in.get_string();
+                order.order_qty = in.get_f64();
+                order.timestamp = in.get_string();
+                add_order(order, is_bid);
+            }
+        }
+    }
+
+    uint32_t probe_count = in.get_u32();
+    for (uint32_t i = 0; i < probe_count && in.ok(); i++) {
+        QueueProbe probe;
+        probe.is_bid = in.get_u8() != 0;
+        probe.price = in.get_f64();
+        uint64_t position = in.get_u64();
+        probe.placed_ahead = in.get_f64();
+
+        // Freshly built levels have no empty slots: slot == position
+        const Level3PriceLevel* level = find_level(probe.is_bid, probe.price);
+        size_t slots = level ? level->queue.slots() : 0;
+        probe.slot = position < slots ? static_cast<size_t>(position) : slots;
+        probes_.push_back(probe);
+    }
+
+    if (!in.ok()) {
+        clear_all_orders();
+        probes_.clear();
+        return false;
+    }
+
+    // Precision as saved, not as re-inferred from the restored orders
+    price_precision_ = price_precision;
+    qty_precision_ = qty_precision;
+    infer_price_precision_ = infer_price;
+    infer_qty_precision_ = infer_qty;
+    invalidate_checksum_fragments();
+
+    changed_bids_.clear();
+    changed_asks_.clear();
+    l2_snapshot_pending_ = true;
+    return true;
+}
+
+// ============================================================================
+// Queue position
+// ============================================================================
+
+const Level3PriceLevel* Level3OrderBookState::find_level(bool is_bid, double price) const {
+    if (is_bid) {
+        auto it = bids_by_price_.find(price);
+        return it != bids_by_price_.end() ? &it->second : nullptr;
+    }
+    auto it = asks_by_price_.find(price);
+    return it != asks_by_price_.end() ? &it->second : nullptr;
+}
+
+void Level3OrderBookState::fill_queue_estimate(bool is_bid, double price, size_t slot,
+                                               QueueEstimate& out) const {
+    out = QueueEstimate();
+    out.price = price;
+
+    const Level3PriceLevel* level = find_level(is_bid, price);
+    if (level) {
+        out.position = level->queue.count_before(slot);
+        out.volume_ahead = level->queue.volume_before(slot);
+    }
+
+    // Better levels are walked from the touch (few for prices near the best)
+    if (is_bid) {
+        for (const auto& pair : bids_by_price_) {
+            if (pair.first <= price) break;
+            out.volume_better += pair.second.total_qty;
+        }
+        out.crossed = !asks_by_price_.empty() && asks_by_price_.begin()->first <= price;
+    } else {
+        for (const auto& pair : asks_by_price_) {
+            if (pair.first >= price) break;
+            out.volume_better += pair.second.total_qty;
+        }
+        out.crossed = !bids_by_price_.empty() && bids_by_price_.begin()->first >= price;
+    }
+}
+
+bool Level3OrderBookState::get_queue_position(const std::string& order_id, QueueEstimate& out) const {
+    auto it = orders_by_id_.find(order_id);
+    if (it == orders_by_id_.end()) {
+        return false;
+    }
+    const Order& order = *it->second;
+    fill_queue_estimate(order.is_bid, order.limit_price, order.queue_slot, out);
+    return true;
+}
+
+double Level3OrderBookState::get_volume_ahead(bool is_bid, double price, size_t position) const {
+    const Level3PriceLevel* level = find_level(is_bid, price);
+    return level ? level->queue.volume_ahead(position) : 0.0;
+}
+
+QueueEstimate Level3OrderBookState::estimate_queue(bool is_bid, double price) const {
+    const Level3PriceLevel* level = find_level(is_bid, price);
+    QueueEstimate estimate;
+    fill_queue_estimate(is_bid, price, level ? level->queue.slots() : 0, estimate);
+    return estimate;
+}
+
+int Level3OrderBookState::add_queue_probe(bool is_bid, double price) {
+    QueueProbe probe;
+    probe.is_bid = is_bid;
+    probe.price = price;
+    probe.slot = 0;
+    probe.placed_ahead = 0;
+    probes_.push_back(probe);
+
+    int probe_id = static_cast<int>(probes_.size() - 1);
+    move_queue_probe(probe_id, price);
+    return probe_id;
+}
+
+void Level3OrderBookState::move_queue_probe(int probe_id, double price) {
+    if (probe_id < 0 || probe_id >= static_cast<int>(probes_.size())) {
+        return;
+    }
+    QueueProbe& probe = probes_[probe_id];
+    const Level3PriceLevel* level = find_level(probe.is_bid, price);
+    probe.price = price;
+    probe.slot = level ? level->queue.slots() : 0;
+    probe.placed_ahead = level ? level->queue.volume_before(probe.slot) : 0.0;
+}
+
+bool Level3OrderBookState::get_queue_probe(int probe_id, QueueEstimate& out) const {
+    if (probe_id < 0 || probe_id >= static_cast<int>(probes_.size())) {
+        return false;
+    }
+    const QueueProbe& probe = probes_[probe_id];
+    fill_queue_estimate(probe.is_bid, probe.price, probe.slot, out);
+    out.consumed = std::max(0.0, probe.placed_ahead - out.volume_ahead);
+    return true;
+}
+
 void Level3OrderBookState::reset_event_counters() {
     add_count_ = 0;
     modify_count_ = 0;
@@ -385,18 +880,14 @@ Level3SnapshotMetrics Level3OrderBookState::calculate_metrics(const std::string&
     int bid_level_count = 0;
     for (const auto& pair : bids_by_price_) {
         if (bid_level_count >= 10) break;
-        for (const auto& order : pair.second) {
-            metrics.bid_volume_top10 += order->order_qty;
-        }
+        metrics.bid_volume_top10 += pair.second.total_qty;
         bid_level_count++;
     }
 
     int ask_level_count = 0;
     for (const auto& pair : asks_by_price_) {
         if (ask_level_count >= 10) break;
-        for (const auto& order : pair.second) {
-            metrics.ask_volume_top10 += order->order_qty;
-        }
+        metrics.ask_volume_top10 += pair.second.total_qty;
         ask_level_count++;
     }
 
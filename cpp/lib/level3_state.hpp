@@ -4,6 +4,27 @@
  * Maintains individual order-level state with dual indexing:
  * 1. By order ID - for fast updates/deletes (O(log n) lookup)
  * 2. By price level - for fast metrics calculation (O(1) best price access)
+ *
+ * Each price level keeps its aggregated quantity up to date as orders come
+ * and go, so the L2 view is available without re-summing orders. Levels
+ * touched since the last take_l2_update() are tracked, and the caller can
+ * pull them as an OrderBookRecord ("snapshot" after a snapshot, "update"
+ * with quantity 0 for removed levels otherwise) carrying the checksum
+ * ChecksumValidator computes for the aggregated top 10. Replaying these
+ * records through OrderBookState yields the same aggregated book, so the
+ * L2 tools can run from a single level3 subscription.
+ *
+ * Each level's queue is indexed by arrival slot (QueueIndex), so the volume
+ * ahead of an order, of a queue position, or of a hypothetical order
+ * ("queue probe") placed at some earlier time is an O(log n) query rather
+ * than a scan of the level. Probes do not enter the book: they record the
+ * slot they joined behind and see the orders ahead of them trade or cancel.
+ *
+ * The Kraken level3 checksum (CRC32 over every order in the top 10 price
+ * levels, asks then bids, price and quantity printed at the pair's precision
+ * with '.' and leading zeros removed) is computed from per-level string
+ * fragments cached on the levels. Only levels changed since the last check
+ * are re-formatted, so verifying every message stays cheap.
  */
 
 #ifndef LEVEL3_STATE_HPP
@@ -14,6 +35,9 @@
 #include <vector>
 #include <memory>
 #include "level3_common.hpp"
+#include "orderbook_common.hpp"
+#include "queue_index.hpp"
+#include "checkpoint_io.hpp"
 
 namespace kraken {
 
@@ -25,9 +49,50 @@ struct Order {
     double limit_price;
     double order_qty;
     std::string timestamp;
+    bool is_bid;
+    size_t queue_slot;  // Arrival slot in its price level
+
+    Order(const std::string& id, double price, double qty, const std::string& ts, bool bid)
+        : order_id(id), limit_price(price), order_qty(qty), timestamp(ts), is_bid(bid), queue_slot(0) {}
+};
+
+/**
+ * Orders resting at one price, with their aggregated quantity
+ * orders is indexed by arrival slot; a removed order leaves a null slot
+ * until the level is compacted. total_qty is maintained incrementally by
+ * each add, remove and resize, and re-summed when the level is compacted.
+ */
+struct Level3PriceLevel {
+    std::vector<std::shared_ptr<Order>> orders;
+    QueueIndex queue;
+    double total_qty;
+
+    // Cached checksum input for this level (rebuilt when invalid)
+    std::string checksum_fragment;
+    bool fragment_valid;
 
-    Order(const std::string& id, double price, double qty, const std::string& ts)
-        : order_id(id), limit_price(price), order_qty(qty), timestamp(ts) {}
+    Level3PriceLevel() : total_qty(0), fragment_valid(false) {}
+};
+
+/**
+ * Where an order (real or hypothetical) sits in its price level's queue
+ */
+struct QueueEstimate {
+    double price;
+    size_t position;       // Live orders ahead at the same price
+    double volume_ahead;   // Their total quantity
+    double volume_better;  // Quantity resting at better prices on the same side
+    double consumed;       // Volume ahead traded or cancelled since placement (probes)
+    bool crossed;          // The opposite side trades at or through price
+
+    QueueEstimate()
+        : price(0), position(0), volume_ahead(0), volume_better(0),
+          consumed(0), crossed(false) {}
+
+    /**
+     * Volume that must trade before an order of qty is completely filled
+     */
+    double fill_volume(double qty) const { return volume_better + volume_ahead + qty; }
 };
 
 /**
@@ -73,6 +138,13 @@ struct Level3SnapshotMetrics {
     double order_arrival_rate;
     double order_cancel_rate;
 
+    // Queue probe (optional): a hypothetical order of queue_probe_qty resting
+    // at each side's best price, reported with its current queue standing
+    bool has_queue_probe;
+    double queue_probe_qty;
+    QueueEstimate bid_probe;
+    QueueEstimate ask_probe;
+
     Level3SnapshotMetrics()
         : best_bid(0), best_bid_qty(0), best_ask(0), best_ask_qty(0),
           spread(0), spread_bps(0), mid_price(0),
@@ -82,7 +154,8 @@ struct Level3SnapshotMetrics {
           bid_orders_at_best(0), ask_orders_at_best(0),
           avg_bid_order_size(0), avg_ask_order_size(0),
           add_events(0), modify_events(0), delete_events(0),
-          order_arrival_rate(0), order_cancel_rate(0) {}
+          order_arrival_rate(0), order_cancel_rate(0),
+          has_queue_probe(false), queue_probe_qty(0) {}
 };
 
 /**
@@ -164,11 +237,123 @@ public:
      */
     void reset_event_counters();
 
+    // ========================================================================
+    // Queue position
+    // ========================================================================
+
+    /**
+     * Queue standing of a resting order
+     * @return false if the order is not in the book
+     */
+    bool get_queue_position(const std::string& order_id, QueueEstimate& out) const;
+
+    /**
+     * Volume ahead of 0-based queue position k at a price
+     * (total level quantity when k is past the end, 0 for an empty level)
+     */
+    double get_volume_ahead(bool is_bid, double price, size_t position) const;
+
+    /**
+     * Standing of a hypothetical order joining the back of the queue at price now
+     */
+    QueueEstimate estimate_queue(bool is_bid, double price) const;
+
+    /**
+     * Place a queue probe at the back of the queue at price
+     * Orders arriving later queue behind it; orders ahead of it leaving the
+     * book (trades, cancels, modifies) move it forward. A snapshot puts
+     * every probe back at the end of its level.
+     * @return Probe id
+     */
+    int add_queue_probe(bool is_bid, double price);
+
+    /**
+     * Move an existing probe to the back of the queue at price
+     */
+    void move_queue_probe(int probe_id, double price);
+
+    /**
+     * Current standing of a probe
+     * @return false for an unknown probe id
+     */
+    bool get_queue_probe(int probe_id, QueueEstimate& out) const;
+
+    // ========================================================================
+    // Aggregated (L2) view
+    // ========================================================================
+
+    /**
+     * Get top N aggregated levels (best first)
+     * @param out Cleared and filled (reuses capacity)
+     */
+    void get_top_bids(int n, std::vector<PriceLevel>& out) const;
+    void get_top_asks(int n, std::vector<PriceLevel>& out) const;
+
+    /**
+     * Checksum of the aggregated top 10 (ChecksumValidator format)
+     */
+    uint32_t calculate_l2_checksum() const;
+
+    /**
+     * Fill out with the whole aggregated book as an L2 snapshot
+     */
+    void get_l2_snapshot(const std::string& timestamp, OrderBookRecord& out) const;
+
+    /**
+     * Take aggregated levels changed since the last call
+     * After a snapshot the whole book is returned as type "snapshot";
+     * otherwise changed levels are returned as type "update", with
+     * quantity 0 for levels that no longer exist.
+     * @param timestamp Timestamp for the output record
+     * @param out Output record (filled only when returning true)
+     * @return true if any aggregated level changed
+     */
+    bool take_l2_update(const std::string& timestamp, OrderBookRecord& out);
+
+    // ========================================================================
+    // Level 3 checksum
+    // ========================================================================
+
+    /**
+     * Set decimal places used to print prices and quantities for the checksum
+     * Use the pair's price/qty precision from the instrument channel. A value
+     * of -1 (the default) infers the precision from the values seen so far;
+     * the inferred precision only ever grows.
+     */
+    void set_checksum_precision(int price_precision, int qty_precision);
+    bool precision_known() const { return !infer_price_precision_ && !infer_qty_precision_; }
+    int get_price_precision() const { return price_precision_; }
+    int get_qty_precision() const { return qty_precision_; }
+
+    /**
+     * Kraken level3 checksum of the current book
+     */
+    uint32_t calculate_checksum();
+
+    /**
+     * Compare against the checksum sent with the last applied message
+     * Updates the check / mismatch counters.
+     * @return true if the reconstructed book matches
+     */
+    bool verify_checksum(uint32_t expected);
+
+    uint64_t get_checksum_checks() const { return checksum_checks_; }
+    uint64_t get_checksum_mismatches() const { return checksum_mismatches_; }
+
     /**
      * Get symbol
      */
     std::string get_symbol() const { return symbol_; }
 
+    /**
+     * Save / restore the book: orders in queue order, checksum precision,
+     * event counters and queue probes (probe ids are preserved)
+     * A restored book reports itself as a fresh snapshot to take_l2_update().
+     * @return false if the checkpoint data is malformed (book is cleared)
+     */
+    void save_checkpoint(CheckpointWriter& out) const;
+    bool load_checkpoint(CheckpointReader& in);
+
     /**
      * Calculate comprehensive metrics
      */
@@ -181,24 +366,59 @@ private:
     std::map<std::string, std::shared_ptr<Order>> orders_by_id_;
 
     // Dual indexing: By price (for fast iteration)
-    // Using vectors to hold multiple orders at same price
+    // Each level holds its orders in queue order plus the aggregated quantity
     // Bids: descending order (highest first)
-    std::map<double, std::vector<std::shared_ptr<Order>>, std::greater<double>> bids_by_price_;
+    std::map<double, Level3PriceLevel, std::greater<double>> bids_by_price_;
     // Asks: ascending order (lowest first)
-    std::map<double, std::vector<std::shared_ptr<Order>>> asks_by_price_;
+    std::map<double, Level3PriceLevel> asks_by_price_;
+
+    // Aggregated levels touched since the last take_l2_update()
+    std::vector<double> changed_bids_;
+    std::vector<double> changed_asks_;
+    bool l2_snapshot_pending_;
+
+    // Scratch for checksum calculation (reused)
+    std::vector<PriceLevel> checksum_bids_;
+    std::vector<PriceLevel> checksum_asks_;
+
+    // Level 3 checksum settings and counters
+    int price_precision_;
+    int qty_precision_;
+    bool infer_price_precision_;
+    bool infer_qty_precision_;
+    uint64_t checksum_checks_;
+    uint64_t checksum_mismatches_;
 
     // Event counters
     int add_count_;
     int modify_count_;
     int delete_count_;
 
+    // Hypothetical orders; slot is the first arrival slot queued behind it
+    struct QueueProbe {
+        bool is_bid;
+        double price;
+        size_t slot;
+        double placed_ahead;  // Volume ahead when placed
+    };
+    std::vector<QueueProbe> probes_;
+
     // Helper methods
     void clear_all_orders();
     void add_order(const Level3Order& order, bool is_bid);
     void modify_order(const std::string& order_id, double new_price, double new_qty);
     void delete_order(const std::string& order_id);
-    void remove_from_price_index(std::shared_ptr<Order> order, bool is_bid);
-    void add_to_price_index(std::shared_ptr<Order> order, bool is_bid);
+    void remove_from_price_index(const std::shared_ptr<Order>& order);
+    void add_to_price_index(const std::shared_ptr<Order>& order);
+    void observe_precision(double price, double qty);
+    void invalidate_checksum_fragments();
+    void build_checksum_fragment(double price, Level3PriceLevel& level) const;
+    void fill_changed_levels(std::vector<double>& prices, bool is_bid,
+                             std::vector<PriceLevel>& out) const;
+    const Level3PriceLevel* find_level(bool is_bid, double price) const;
+    void fill_queue_estimate(bool is_bid, double price, size_t slot, QueueEstimate& out) const;
+    void compact_level(bool is_bid, double price, Level3PriceLevel& level);
+    void reset_level_probes(bool is_bid, double price);
 };
 
 } // namespace kraken
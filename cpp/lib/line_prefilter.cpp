@@ -0,0 +1,215 @@
+/**
+ * Line Prefilter - Implementation
+ */
+
+#include "line_prefilter.hpp"
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace kraken {
+
+namespace {
+
+const char TIMESTAMP_PATTERN[] = "\"timestamp\":\"";
+const char SYMBOL_PATTERN[] = "\"symbol\":\"";
+
+// Written first by the JSON Lines writers
+const char LINE_PREFIX[] = "{\"timestamp\":\"";
+
+/**
+ * Compare a field value with a normalized bound (plain byte order)
+ */
+int compare(const char* value, size_t value_len, const std::string& bound) {
+    size_t n = value_len < bound.size() ? value_len : bound.size();
+    int result = std::memcmp(value, bound.data(), n);
+    if (result != 0) {
+        return result;
+    }
+    if (value_len == bound.size()) {
+        return 0;
+    }
+    return value_len < bound.size() ? -1 : 1;
+}
+
+} // namespace
+
+// ============================================================================
+// LinePrefilter
+// ============================================================================
+
+LinePrefilter::LinePrefilter() {}
+
+void LinePrefilter::set_symbols(const std::vector<std::string>& symbols) {
+    symbols_ = symbols;
+}
+
+void LinePrefilter::set_time_range(const std::string& start, const std::string& end) {
+    start_.clear();
+    end_.clear();
+    if (!start.empty()) {
+        normalize_time(start, start_);
+    }
+    if (!end.empty()) {
+        normalize_time(end, end_);
+    }
+}
+
+bool LinePrefilter::active() const {
+    return !symbols_.empty() || !start_.empty() || !end_.empty();
+}
+
+std::string LinePrefilter::describe() const {
+    if (!active()) {
+        return "none";
+    }
+
+    std::vector<std::string> symbols = symbols_;
+    std::sort(symbols.begin(), symbols.end());
+    symbols.erase(std::unique(symbols.begin(), symbols.end()), symbols.end());
+
+    std::string result = "symbols ";
+    for (size_t i = 0; i < symbols.size(); i++) {
+        result += (i > 0 ? "," : "") + symbols[i];
+    }
+    if (symbols.empty()) {
+        result += "any";
+    }
+    result += ", from " + (start_.empty() ? std::string("start") : start_);
+    result += " before " + (end_.empty() ? std::string("end") : end_);
+    return result;
+}
+
+bool LinePrefilter::accept(const char* data, size_t len) const {
+    const char* value;
+    size_t value_len;
+
+    if (!start_.empty() || !end_.empty()) {
+        bool found;
+        const size_t prefix_len = sizeof(LINE_PREFIX) - 1;
+        if (len > prefix_len && std::memcmp(data, LINE_PREFIX, prefix_len) == 0) {
+            value = data + prefix_len;
+            const char* quote = static_cast<const char*>(std::memchr(value, '"', len - prefix_len));
+            found = quote != nullptr;
+            value_len = found ? static_cast<size_t>(quote - value) : 0;
+        } else {
+            found = find_value(data, len, TIMESTAMP_PATTERN, sizeof(TIMESTAMP_PATTERN) - 1,
+                               value, value_len);
+        }
+
+        if (found) {
+            if (!start_.empty() && compare(value, value_len, start_) < 0) {
+                return false;
+            }
+            if (!end_.empty() && compare(value, value_len, end_) >= 0) {
+                return false;
+            }
+        }
+    }
+
+    if (!symbols_.empty() &&
+        find_value(data, len, SYMBOL_PATTERN, sizeof(SYMBOL_PATTERN) - 1, value, value_len)) {
+        for (const auto& symbol : symbols_) {
+            if (symbol.size() == value_len && std::memcmp(symbol.data(), value, value_len) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    return true;
+}
+
+bool LinePrefilter::normalize_time(const std::string& text, std::string& out) {
+    // Digits and separators of "YYYY-MM-DD HH:MM:SS"
+    static const char TEMPLATE[] = "0000-00-00 00:00:00";
+    const size_t template_len = sizeof(TEMPLATE) - 1;
+
+    // Complete fields only: date, then hour, minute, second
+    if (text.size() != 10 && text.size() != 13 && text.size() != 16 && text.size() < 19) {
+        return false;
+    }
+
+    std::string result = text;
+    for (size_t i = 0; i < result.size(); i++) {
+        char c = result[i];
+        if (i < template_len) {
+            if (TEMPLATE[i] == '0') {
+                if (c < '0' || c > '9') return false;
+            } else if (i == 10) {
+                if (c != ' ' && c != 'T') return false;
+                result[i] = ' ';
+            } else if (c != TEMPLATE[i]) {
+                return false;
+            }
+        } else if (i == template_len) {
+            if (c != '.') return false;
+        } else if (c < '0' || c > '9') {
+            return false;
+        }
+    }
+
+    out = result;
+    return true;
+}
+
+const char* LinePrefilter::find(const char* haystack, size_t haystack_len,
+                                const char* needle, size_t needle_len) {
+    if (needle_len == 0) {
+        return haystack;
+    }
+    if (haystack_len < needle_len) {
+        return nullptr;
+    }
+
+    size_t pos = 0;
+
+#if defined(__SSE2__)
+    // Candidates are positions where both the first and the last byte of
+    // the needle match; 16 positions are tested per step and only
+    // candidates are compared in full
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+
+    for (; pos + needle_len - 1 + 16 <= haystack_len; pos += 16) {
+        __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + pos));
+        __m128i block_last = _mm_loadu_si128(
+            reinterpret_cast<const __m128i*>(haystack + pos + needle_len - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last))));
+
+        while (mask != 0) {
+            const char* candidate = haystack + pos + __builtin_ctz(mask);
+            if (std::memcmp(candidate, needle, needle_len) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    // Remaining positions
+    return static_cast<const char*>(memmem(haystack + pos, haystack_len - pos, needle, needle_len));
+}
+
+bool LinePrefilter::find_value(const char* data, size_t len, const char* pattern, size_t pattern_len,
+                               const char*& value, size_t& value_len) {
+    const char* key = find(data, len, pattern, pattern_len);
+    if (key == nullptr) {
+        return false;
+    }
+
+    value = key + pattern_len;
+    size_t remaining = len - static_cast<size_t>(value - data);
+    const char* quote = static_cast<const char*>(std::memchr(value, '"', remaining));
+    if (quote == nullptr) {
+        return false;
+    }
+    value_len = static_cast<size_t>(quote - value);
+    return true;
+}
+
+} // namespace kraken
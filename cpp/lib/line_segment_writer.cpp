@@ -0,0 +1,188 @@
+/**
+ * Line Segment Writer - Implementation
+ */
+
+#include "line_segment_writer.hpp"
+#include "alloc_counter.hpp"
+#include "stage_trace.hpp"
+#include <iostream>
+#include <cstdio>
+
+namespace kraken {
+
+LineSegmentWriter::LineSegmentWriter(const std::string& filename, const std::string& extension,
+                                     const std::string& header)
+    : FlushSegmentMixin<LineSegmentWriter>(),  // Initialize mixin
+      extension_(extension), header_(header),
+      max_file_bytes_(0), file_bytes_(0), bytes_written_(0),
+      part_(0), line_count_(0), file_count_(0), suspended_(false) {
+
+    // Store base filename for segmentation
+    set_base_filename(filename);
+
+    // Note: File opens later:
+    // - When set_segment_mode() is called (wall-clock segmentation)
+    // - On first write (no segmentation, or event-time segmentation)
+    buffer_.reserve(64 * 1024);
+}
+
+LineSegmentWriter::~LineSegmentWriter() {
+    if (!buffer_.empty()) {
+        force_flush();
+    }
+
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+bool LineSegmentWriter::write_line(const char* data, size_t len, const std::string& timestamp) {
+    KRAKEN_ALLOC_SCOPE("line_writer.write_line");
+    KRAKEN_TRACE_SCOPE("line_writer.write");
+    // Event-time segmentation: rotate before buffering (no-op otherwise)
+    advance_event_time(timestamp);
+
+    if (!file_.is_open()) {
+        if (suspended_) {
+            suspended_ = false;
+            open_file(true);
+        } else if (segment_mode_ == SegmentMode::NONE) {
+            current_segment_filename_ = base_filename_;
+            enter_segment(base_filename_);
+        } else {
+            // Event time without a usable timestamp yet: wall-clock key
+            transition_segment();
+        }
+        if (!file_.is_open()) {
+            return false;
+        }
+    }
+
+    // Size rolling: keep each file within the limit (a longer line gets a file of its own)
+    uint64_t pending = file_bytes_ + buffer_.size();
+    if (max_file_bytes_ > 0 && pending > 0 && pending + len + 1 > max_file_bytes_) {
+        perform_flush();
+        roll_part();
+    }
+
+    buffer_.append(data, len);
+    buffer_ += '\n';
+    line_count_++;
+
+    check_and_flush();
+    return true;
+}
+
+void LineSegmentWriter::suspend() {
+    if (!file_.is_open()) {
+        return;
+    }
+    force_flush();
+    file_.close();
+    suspended_ = true;
+}
+
+void LineSegmentWriter::flush() {
+    force_flush();
+}
+
+bool LineSegmentWriter::open_file(bool append) {
+    if (file_.is_open()) {
+        file_.close();
+    }
+
+    std::ios::openmode mode = std::ios::out | std::ios::binary;
+    file_.open(file_name_, append ? (mode | std::ios::app) : (mode | std::ios::trunc));
+    if (!file_.is_open()) {
+        std::cerr << "Error: Cannot open file for writing: " << file_name_ << std::endl;
+        return false;
+    }
+
+    if (!append) {
+        file_bytes_ = 0;
+        file_count_++;
+    }
+    return true;
+}
+
+void LineSegmentWriter::enter_segment(const std::string& segment_name) {
+    // Remember where the current segment stopped
+    if (!segment_name_.empty()) {
+        SegmentFile& previous = segments_[segment_name_];
+        previous.part = part_;
+        previous.bytes = file_bytes_;
+    }
+
+    segment_name_ = segment_name;
+    suspended_ = false;
+
+    auto it = segments_.find(segment_name);
+    if (it == segments_.end()) {
+        part_ = 0;
+        file_name_ = segment_name;
+        open_file(false);
+        return;
+    }
+
+    // Revisited: append to its last part
+    part_ = it->second.part;
+    file_name_ = part_ == 0 ? segment_name : part_filename(part_);
+    if (open_file(true)) {
+        file_bytes_ = it->second.bytes;
+    }
+}
+
+void LineSegmentWriter::roll_part() {
+    part_++;
+    file_name_ = part_filename(part_);
+    open_file(false);
+    std::cout << "[SEGMENT] Starting new file: " << file_name_ << std::endl;
+}
+
+std::string LineSegmentWriter::part_filename(size_t part) const {
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "-%03zu", part);
+
+    const std::string& segment = segment_name_;
+    if (segment.size() >= extension_.size() &&
+        segment.compare(segment.size() - extension_.size(), extension_.size(), extension_) == 0) {
+        return segment.substr(0, segment.size() - extension_.size()) + suffix + extension_;
+    }
+    return segment + suffix;
+}
+
+// ============================================================================
+// CRTP Interface Implementation
+// ============================================================================
+
+void LineSegmentWriter::perform_flush() {
+    KRAKEN_ALLOC_SCOPE("line_writer.flush");
+    if (!file_.is_open() || buffer_.empty()) {
+        return;
+    }
+
+    if (file_bytes_ == 0 && !header_.empty()) {
+        file_ << header_ << '\n';
+        file_bytes_ += header_.size() + 1;
+    }
+
+    file_.write(buffer_.data(), static_cast<std::streamsize>(buffer_.size()));
+    file_bytes_ += buffer_.size();
+    bytes_written_ += buffer_.size();
+
+    file_.flush();
+
+    // Keep capacity: the next batch reuses it
+    buffer_.clear();
+}
+
+void LineSegmentWriter::perform_segment_transition(const std::string& new_filename) {
+    enter_segment(new_filename);
+}
+
+void LineSegmentWriter::on_segment_mode_set() {
+    // Create first segment file when segmentation is enabled
+    perform_segment_transition(current_segment_filename_);
+}
+
+} // namespace kraken
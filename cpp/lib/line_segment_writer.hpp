@@ -0,0 +1,153 @@
+/**
+ * Line Segment Writer
+ *
+ * Writes raw capture lines (JSON Lines or CSV rows) unchanged, with the
+ * FlushSegmentMixin's flushing and hourly / daily segmentation. Used by
+ * reshard_capture to re-partition captures without decoding them.
+ *
+ * On top of the mixin:
+ * - A header line (CSV) is written at the top of every file
+ * - Size rolling: once a file reaches the size limit the segment continues
+ *   in a part file, "book.20251112_10-001.jsonl", "-002", ... (the part
+ *   sorts after its segment, so SegmentBatch chains stay in order)
+ * - suspend() flushes and closes the file; the next write reopens it for
+ *   appending. Callers use it to bound the number of open files.
+ * - A segment revisited later (out-of-order input, e.g. merged captures)
+ *   is appended to, continuing its last part, instead of being truncated.
+ *
+ * The mixin's buffer size is counted in bytes (get_record_size() == 1), so
+ * set_memory_threshold() bounds the buffered bytes per writer.
+ */
+
+#ifndef LINE_SEGMENT_WRITER_HPP
+#define LINE_SEGMENT_WRITER_HPP
+
+#include "flush_segment_mixin.hpp"
+#include <fstream>
+#include <string>
+#include <map>
+#include <cstddef>
+#include <cstdint>
+
+namespace kraken {
+
+/**
+ * Raw line writer with segmentation, size rolling and suspend/resume
+ */
+class LineSegmentWriter : public FlushSegmentMixin<LineSegmentWriter> {
+    friend class FlushSegmentMixin<LineSegmentWriter>;  // Allow mixin to access private interface
+
+public:
+    /**
+     * Constructor
+     * @param filename Output filename (segment keys are inserted before the extension)
+     * @param extension File extension including the dot (".jsonl", ".csv")
+     * @param header Line written at the top of every file ("" for none)
+     */
+    LineSegmentWriter(const std::string& filename, const std::string& extension,
+                      const std::string& header = "");
+
+    /**
+     * Destructor - flushes remaining data and closes the file
+     */
+    ~LineSegmentWriter();
+
+    /**
+     * Write one line (without its newline)
+     * @param timestamp Record timestamp, used with SegmentClock::EVENT_TIME
+     */
+    bool write_line(const char* data, size_t len, const std::string& timestamp);
+
+    /**
+     * Roll to a part file once a file reaches this size (0 = no limit)
+     */
+    void set_max_file_bytes(uint64_t bytes) { max_file_bytes_ = bytes; }
+
+    /**
+     * Flush and close the file; the next write reopens it for appending
+     */
+    void suspend();
+
+    /**
+     * Flush buffered data to disk
+     */
+    void flush();
+
+    bool is_open() const { return file_.is_open(); }
+
+    size_t get_line_count() const { return line_count_; }
+    size_t get_file_count() const { return file_count_; }
+    uint64_t get_bytes_written() const { return bytes_written_; }
+
+private:
+    /**
+     * Where a segment left off
+     */
+    struct SegmentFile {
+        size_t part;
+        uint64_t bytes;
+
+        SegmentFile() : part(0), bytes(0) {}
+    };
+
+    std::ofstream file_;
+    std::string extension_;
+    std::string header_;
+    std::string buffer_;           // Buffered lines, newline-terminated
+    std::string segment_name_;     // Segment file of the current segment
+    std::string file_name_;        // File currently written (segment or part)
+    std::map<std::string, SegmentFile> segments_;  // Segments written so far
+    uint64_t max_file_bytes_;
+    uint64_t file_bytes_;          // Bytes in file_name_ (flushed)
+    uint64_t bytes_written_;
+    size_t part_;                  // Part number within the segment (0 = segment file)
+    size_t line_count_;
+    size_t file_count_;
+    bool suspended_;
+
+    /**
+     * Open file_name_ (truncate for a new file, append when resuming)
+     */
+    bool open_file(bool append);
+
+    /**
+     * Switch to a segment, resuming it if it was written before
+     */
+    void enter_segment(const std::string& segment_name);
+
+    /**
+     * Continue the current segment in the next part file
+     */
+    void roll_part();
+
+    /**
+     * "book.20251112_10.jsonl" -> "book.20251112_10-001.jsonl"
+     */
+    std::string part_filename(size_t part) const;
+
+    // ========================================================================
+    // CRTP Interface Implementation (required by FlushSegmentMixin)
+    // ========================================================================
+
+    size_t get_buffer_size() const {
+        return buffer_.size();
+    }
+
+    size_t get_record_size() const {
+        return 1;  // Buffer size is in bytes
+    }
+
+    std::string get_file_extension() const {
+        return extension_;
+    }
+
+    void perform_flush();
+
+    void perform_segment_transition(const std::string& new_filename);
+
+    void on_segment_mode_set();
+};
+
+} // namespace kraken
+
+#endif // LINE_SEGMENT_WRITER_HPP
@@ -3,6 +3,7 @@
  */
 
 #include "orderbook_common.hpp"
+#include "alloc_counter.hpp"
 #include <algorithm>
 #include <cstring>
 #include <map>
@@ -13,31 +14,40 @@ namespace kraken {
 // ChecksumValidator Implementation
 // ============================================================================
 
-uint32_t ChecksumValidator::crc32_table[256];
-bool ChecksumValidator::table_initialized = false;
+namespace {
 
-void ChecksumValidator::init_crc32_table() {
-    if (table_initialized) return;
+struct Crc32Table {
+    uint32_t entries[256];
 
-    for (uint32_t i = 0; i < 256; i++) {
-        uint32_t crc = i;
-        for (int j = 0; j < 8; j++) {
-            if (crc & 1) {
-                crc = (crc >> 1) ^ 0xEDB88320;
-            } else {
-                crc >>= 1;
+    Crc32Table() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; j++) {
+                if (crc & 1) {
+                    crc = (crc >> 1) ^ 0xEDB88320;
+                } else {
+                    crc >>= 1;
+                }
             }
+            entries[i] = crc;
         }
-        crc32_table[i] = crc;
     }
-    table_initialized = true;
+};
+
+} // namespace
+
+const uint32_t* ChecksumValidator::crc32_table() {
+    // Function-local static: initialized exactly once, even with several
+    // client threads (L2 and Level 3 books) checksumming concurrently
+    static const Crc32Table table;
+    return table.entries;
 }
 
 uint32_t ChecksumValidator::crc32_update(uint32_t crc, const char* data, size_t len) {
-    init_crc32_table();
+    const uint32_t* table = crc32_table();
 
     for (size_t i = 0; i < len; i++) {
-        crc = (crc >> 8) ^ crc32_table[(crc ^ data[i]) & 0xFF];
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
     }
     return crc;
 }
@@ -70,6 +80,7 @@ uint32_t ChecksumValidator::calculate_crc32(
     const std::vector<PriceLevel>& bids,
     const std::vector<PriceLevel>& asks
 ) {
+    KRAKEN_ALLOC_SCOPE("checksum.calculate_crc32");
     std::string data = format_for_checksum(bids, asks);
     uint32_t crc = 0xFFFFFFFF;
     crc = crc32_update(crc, data.c_str(), data.length());
@@ -159,6 +170,14 @@ void OrderBookDisplay::show_top_of_book(const OrderBookRecord& record) {
               << std::endl;
 }
 
+void OrderBookDisplay::show_bbo(const std::string& symbol, const BestBidOffer& bbo) {
+    std::cout << "[" << symbol << "] "
+              << "Bid: " << format_price(bbo.bid_price, 12) << " (" << bbo.bid_qty << ") | "
+              << "Ask: " << format_price(bbo.ask_price, 12) << " (" << bbo.ask_qty << ") | "
+              << "Spread: " << format_price(bbo.spread(), 8)
+              << std::endl;
+}
+
 void OrderBookDisplay::show_full_book(const OrderBookRecord& record, int max_depth) {
     if (record.bids.empty() || record.asks.empty()) {
         std::cout << "[" << record.symbol << "] Order book empty" << std::endl;
@@ -38,8 +38,32 @@ struct OrderBookRecord {
     std::vector<PriceLevel> bids;
     std::vector<PriceLevel> asks;
     uint32_t checksum;
+    int64_t recv_ts_ns;                  // Frame receive time (ns since epoch, 0 = unknown)
 
-    OrderBookRecord() : checksum(0) {}
+    OrderBookRecord() : checksum(0), recv_ts_ns(0) {}
+};
+
+/**
+ * Best bid and offer (top of book)
+ */
+struct BestBidOffer {
+    std::string timestamp;
+    double bid_price;
+    double bid_qty;
+    double ask_price;
+    double ask_qty;
+
+    BestBidOffer() : bid_price(0.0), bid_qty(0.0), ask_price(0.0), ask_qty(0.0) {}
+
+    double spread() const { return ask_price - bid_price; }
+
+    /**
+     * Same prices and quantities on both sides (timestamp ignored)
+     */
+    bool same_top(const BestBidOffer& other) const {
+        return bid_price == other.bid_price && bid_qty == other.bid_qty &&
+               ask_price == other.ask_price && ask_qty == other.ask_qty;
+    }
 };
 
 /**
@@ -93,13 +117,15 @@ public:
     static std::string format_for_checksum(const std::vector<PriceLevel>& bids,
                                             const std::vector<PriceLevel>& asks);
 
-private:
-    // CRC32 lookup table
-    static uint32_t crc32_table[256];
-    static bool table_initialized;
-
-    static void init_crc32_table();
+    /**
+     * Feed bytes into a running CRC32 (start with 0xFFFFFFFF, finish with ^ 0xFFFFFFFF)
+     * For callers that stream cached fragments instead of building one string.
+     */
     static uint32_t crc32_update(uint32_t crc, const char* data, size_t len);
+
+private:
+    // CRC32 lookup table (built once, thread-safe)
+    static const uint32_t* crc32_table();
 };
 
 /**
@@ -124,6 +150,11 @@ public:
      */
     static void show_top_of_book(const OrderBookRecord& record);
 
+    /**
+     * Show best bid/offer maintained from the full book
+     */
+    static void show_bbo(const std::string& symbol, const BestBidOffer& bbo);
+
     /**
      * Show full order book
      * Terminal-based display (single pair only)
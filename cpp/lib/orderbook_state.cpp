@@ -3,6 +3,7 @@
  */
 
 #include "orderbook_state.hpp"
+#include "alloc_counter.hpp"
 #include <algorithm>
 #include <cmath>
 
@@ -17,6 +18,7 @@ OrderBookState::OrderBookState(const std::string& symbol)
 }
 
 void OrderBookState::apply(const OrderBookRecord& record) {
+    KRAKEN_ALLOC_SCOPE("orderbook_state.apply");
     if (record.type == "snapshot") {
         // Reset and initialize from snapshot
         reset();
@@ -97,32 +99,41 @@ bool OrderBookState::get_best_ask(double& price, double& quantity) const {
 std::vector<PriceLevel> OrderBookState::get_top_bids(int n) const {
     std::vector<PriceLevel> result;
     result.reserve(std::min(n, static_cast<int>(bids_.size())));
+    get_top_bids(n, result);
+    return result;
+}
+
+std::vector<PriceLevel> OrderBookState::get_top_asks(int n) const {
+    std::vector<PriceLevel> result;
+    result.reserve(std::min(n, static_cast<int>(asks_.size())));
+    get_top_asks(n, result);
+    return result;
+}
+
+void OrderBookState::get_top_bids(int n, std::vector<PriceLevel>& out) const {
+    out.clear();
 
     int count = 0;
     for (const auto& pair : bids_) {
         if (count >= n) break;
-        result.emplace_back(pair.first, pair.second);
+        out.emplace_back(pair.first, pair.second);
         count++;
     }
-
-    return result;
 }
 
-std::vector<PriceLevel> OrderBookState::get_top_asks(int n) const {
-    std::vector<PriceLevel> result;
-    result.reserve(std::min(n, static_cast<int>(asks_.size())));
+void OrderBookState::get_top_asks(int n, std::vector<PriceLevel>& out) const {
+    out.clear();
 
     int count = 0;
     for (const auto& pair : asks_) {
         if (count >= n) break;
-        result.emplace_back(pair.first, pair.second);
+        out.emplace_back(pair.first, pair.second);
         count++;
     }
-
-    return result;
 }
 
 double OrderBookState::get_bid_volume_within_bps(double reference_price, double bps) const {
+    KRAKEN_ALLOC_FREE_SCOPE("orderbook_state.bid_volume_within_bps");
     // Calculate price threshold
     // For bids, we want prices >= (reference * (1 - bps/10000))
     double threshold = reference_price * (1.0 - bps / 10000.0);
@@ -140,6 +151,7 @@ double OrderBookState::get_bid_volume_within_bps(double reference_price, double
 }
 
 double OrderBookState::get_ask_volume_within_bps(double reference_price, double bps) const {
+    KRAKEN_ALLOC_FREE_SCOPE("orderbook_state.ask_volume_within_bps");
     // Calculate price threshold
     // For asks, we want prices <= (reference * (1 + bps/10000))
     double threshold = reference_price * (1.0 + bps / 10000.0);
@@ -157,6 +169,7 @@ double OrderBookState::get_ask_volume_within_bps(double reference_price, double
 }
 
 double OrderBookState::get_bid_volume_top_n(int n) const {
+    KRAKEN_ALLOC_FREE_SCOPE("orderbook_state.bid_volume_top_n");
     double total_volume = 0.0;
     int count = 0;
 
@@ -170,6 +183,7 @@ double OrderBookState::get_bid_volume_top_n(int n) const {
 }
 
 double OrderBookState::get_ask_volume_top_n(int n) const {
+    KRAKEN_ALLOC_FREE_SCOPE("orderbook_state.ask_volume_top_n");
     double total_volume = 0.0;
     int count = 0;
 
@@ -182,6 +196,122 @@ double OrderBookState::get_ask_volume_top_n(int n) const {
     return total_volume;
 }
 
+void OrderBookState::get_bid_sweep_costs(const std::vector<double>& sizes,
+                                         std::vector<SweepCost>& out) const {
+    get_sweep_costs(bids_, true, sizes, out);
+}
+
+void OrderBookState::get_ask_sweep_costs(const std::vector<double>& sizes,
+                                         std::vector<SweepCost>& out) const {
+    get_sweep_costs(asks_, false, sizes, out);
+}
+
+template <typename Map>
+void OrderBookState::get_sweep_costs(const Map& side, bool is_bid, const std::vector<double>& sizes,
+                                     std::vector<SweepCost>& out) const {
+    KRAKEN_ALLOC_SCOPE("orderbook_state.sweep_costs");
+    out.resize(sizes.size());
+    if (sizes.empty()) {
+        return;
+    }
+
+    // Copy levels until the largest size is covered
+    sweep_price_.clear();
+    sweep_qty_.clear();
+    double max_size = sizes.back();
+    double covered = 0.0;
+    for (const auto& pair : side) {
+        sweep_price_.push_back(pair.first);
+        sweep_qty_.push_back(pair.second);
+        covered += pair.second;
+        if (covered >= max_size) break;
+    }
+
+    // Flat arrays: notional per level, then prefix sums in place
+    size_t n = sweep_price_.size();
+    sweep_notional_.resize(n);
+    const double* price = sweep_price_.data();
+    double* qty = sweep_qty_.data();
+    double* notional = sweep_notional_.data();
+    for (size_t i = 0; i < n; i++) {
+        notional[i] = price[i] * qty[i];
+    }
+    for (size_t i = 1; i < n; i++) {
+        qty[i] += qty[i - 1];
+        notional[i] += notional[i - 1];
+    }
+
+    // Sizes are ascending, so the level index only moves forward
+    double best = n > 0 ? price[0] : 0.0;
+    size_t level = 0;
+    for (size_t k = 0; k < sizes.size(); k++) {
+        SweepCost& cost = out[k];
+        cost = SweepCost();
+        cost.size = sizes[k];
+        if (n == 0 || sizes[k] <= 0.0) {
+            continue;
+        }
+
+        while (level < n && qty[level] < sizes[k]) {
+            level++;
+        }
+
+        double fill_notional;
+        if (level == n) {
+            cost.filled = qty[n - 1];  // Book shallower than size
+            fill_notional = notional[n - 1];
+            cost.levels = static_cast<int>(n);
+        } else {
+            double before_qty = level > 0 ? qty[level - 1] : 0.0;
+            double before_notional = level > 0 ? notional[level - 1] : 0.0;
+            cost.filled = sizes[k];
+            fill_notional = before_notional + (sizes[k] - before_qty) * price[level];
+            cost.levels = static_cast<int>(level + 1);
+        }
+
+        cost.avg_price = fill_notional / cost.filled;
+        double slippage = is_bid ? best - cost.avg_price : cost.avg_price - best;
+        cost.slippage_bps = slippage / best * 10000.0;
+    }
+}
+
+void OrderBookState::save_checkpoint(CheckpointWriter& out) const {
+    out.put_u8(initialized_ ? 1 : 0);
+    out.put_u32(static_cast<uint32_t>(bids_.size()));
+    for (const auto& pair : bids_) {
+        out.put_f64(pair.first);
+        out.put_f64(pair.second);
+    }
+    out.put_u32(static_cast<uint32_t>(asks_.size()));
+    for (const auto& pair : asks_) {
+        out.put_f64(pair.first);
+        out.put_f64(pair.second);
+    }
+}
+
+bool OrderBookState::load_checkpoint(CheckpointReader& in) {
+    reset();
+    bool initialized = in.get_u8() != 0;
+
+    uint32_t count = in.get_u32();
+    for (uint32_t i = 0; i < count && in.ok(); i++) {
+        double price = in.get_f64();
+        bids_[price] = in.get_f64();
+    }
+    count = in.get_u32();
+    for (uint32_t i = 0; i < count && in.ok(); i++) {
+        double price = in.get_f64();
+        asks_[price] = in.get_f64();
+    }
+
+    if (!in.ok()) {
+        reset();
+        return false;
+    }
+    initialized_ = initialized;
+    return true;
+}
+
 bool OrderBookState::validate_checksum(uint32_t expected_checksum) const {
     // Build vectors for checksum calculation
     std::vector<PriceLevel> top_bids = get_top_bids(10);
@@ -242,6 +372,14 @@ SnapshotMetrics MetricsCalculator::calculate(const OrderBookState& state, const
     return metrics;
 }
 
+SnapshotMetrics MetricsCalculator::calculate(const OrderBookState& state, const std::string& timestamp,
+                                             const std::vector<double>& sweep_sizes) {
+    SnapshotMetrics metrics = calculate(state, timestamp);
+    state.get_bid_sweep_costs(sweep_sizes, metrics.bid_sweep);
+    state.get_ask_sweep_costs(sweep_sizes, metrics.ask_sweep);
+    return metrics;
+}
+
 double MetricsCalculator::calculate_basis_points(double value, double reference) {
     if (reference == 0.0) {
         return 0.0;
@@ -3,6 +3,11 @@
  *
  * Maintains order book state by applying snapshots and updates.
  * Used by process_orderbook_snapshots tool to rebuild state from raw .jsonl data.
+ *
+ * Sweep costs: the average fill price of market orders of several sizes is
+ * computed in one walk of a side. The walk copies levels into flat arrays
+ * (stopping once the largest size is covered), turns them into cumulative
+ * quantity / notional, and every size is then read off the curve.
  */
 
 #ifndef ORDERBOOK_STATE_HPP
@@ -13,9 +18,25 @@
 #include <vector>
 #include <cstdint>
 #include "orderbook_common.hpp"
+#include "checkpoint_io.hpp"
 
 namespace kraken {
 
+/**
+ * Cost of sweeping one side with a market order of size
+ */
+struct SweepCost {
+    double size;
+    double filled;        // < size when the book is shallower than size
+    double avg_price;     // Average fill price of the filled part
+    double slippage_bps;  // avg_price vs the side's best price (positive = cost)
+    int levels;           // Price levels touched
+
+    SweepCost() : size(0.0), filled(0.0), avg_price(0.0), slippage_bps(0.0), levels(0) {}
+
+    bool complete() const { return levels > 0 && filled >= size; }
+};
+
 /**
  * Order Book State - maintains current state for one symbol
  */
@@ -53,6 +74,13 @@ public:
      */
     std::vector<PriceLevel> get_top_asks(int n) const;
 
+    /**
+     * Fill out with the top N levels (reuses out's capacity, no allocation
+     * once warmed up)
+     */
+    void get_top_bids(int n, std::vector<PriceLevel>& out) const;
+    void get_top_asks(int n, std::vector<PriceLevel>& out) const;
+
     /**
      * Get all bids within X basis points of reference price
      */
@@ -69,6 +97,15 @@ public:
     double get_bid_volume_top_n(int n) const;
     double get_ask_volume_top_n(int n) const;
 
+    /**
+     * Sweep cost curve: one entry per size, one walk of the side
+     * Bids = selling into the bids, asks = buying from the asks.
+     * @param sizes Order sizes, ascending
+     * @param out Cleared and filled in the order of sizes (reuses capacity)
+     */
+    void get_bid_sweep_costs(const std::vector<double>& sizes, std::vector<SweepCost>& out) const;
+    void get_ask_sweep_costs(const std::vector<double>& sizes, std::vector<SweepCost>& out) const;
+
     /**
      * Validate current state against checksum
      */
@@ -84,6 +121,13 @@ public:
      */
     bool is_initialized() const { return initialized_; }
 
+    /**
+     * Save / restore the book (levels and initialized flag)
+     * @return false if the checkpoint data is malformed (state is reset)
+     */
+    void save_checkpoint(CheckpointWriter& out) const;
+    bool load_checkpoint(CheckpointReader& in);
+
 private:
     std::string symbol_;
     bool initialized_;
@@ -93,6 +137,15 @@ private:
     std::map<double, double, std::greater<double>> bids_;  // Descending (high to low)
     std::map<double, double> asks_;                        // Ascending (low to high)
 
+    // Flat sweep curve scratch (reused across queries)
+    mutable std::vector<double> sweep_price_;
+    mutable std::vector<double> sweep_qty_;
+    mutable std::vector<double> sweep_notional_;
+
+    template <typename Map>
+    void get_sweep_costs(const Map& side, bool is_bid, const std::vector<double>& sizes,
+                         std::vector<SweepCost>& out) const;
+
     /**
      * Apply price levels from record
      */
@@ -133,6 +186,10 @@ struct SnapshotMetrics {
     double depth_25_bps;
     double depth_50_bps;
 
+    // Sweep cost curves (optional, one entry per requested size)
+    std::vector<SweepCost> bid_sweep;
+    std::vector<SweepCost> ask_sweep;
+
     SnapshotMetrics()
         : best_bid(0.0), best_bid_qty(0.0), best_ask(0.0), best_ask_qty(0.0),
           spread(0.0), spread_bps(0.0), mid_price(0.0),
@@ -152,6 +209,12 @@ public:
      */
     static SnapshotMetrics calculate(const OrderBookState& state, const std::string& timestamp);
 
+    /**
+     * Calculate all metrics plus sweep costs for sizes (ascending)
+     */
+    static SnapshotMetrics calculate(const OrderBookState& state, const std::string& timestamp,
+                                     const std::vector<double>& sweep_sizes);
+
 private:
     static double calculate_basis_points(double value, double reference);
 };
@@ -0,0 +1,175 @@
+/**
+ * Top-N Order Book Recorder - Implementation
+ */
+
+#include "orderbook_topn.hpp"
+#include "alloc_counter.hpp"
+
+namespace kraken {
+
+// ============================================================================
+// TopNDeltaTracker Implementation
+// ============================================================================
+
+TopNDeltaTracker::TopNDeltaTracker(const std::string& symbol, int n, TopNMode mode)
+    : n_(n), mode_(mode), state_(symbol), emitted_(false) {
+    prev_bids_.reserve(n);
+    prev_asks_.reserve(n);
+    cur_bids_.reserve(n);
+    cur_asks_.reserve(n);
+}
+
+bool TopNDeltaTracker::apply(const OrderBookRecord& record, OrderBookRecord& out) {
+    KRAKEN_ALLOC_SCOPE("topn_tracker.apply");
+    state_.apply(record);
+
+    if (!state_.is_initialized()) {
+        return false;  // Updates before the first snapshot
+    }
+
+    bool is_snapshot = record.type == "snapshot";
+
+    // Cheap rejection: updates that cannot reach the window change nothing
+    if (!is_snapshot && emitted_ && !touches_window(record)) {
+        return false;
+    }
+
+    state_.get_top_bids(n_, cur_bids_);
+    state_.get_top_asks(n_, cur_asks_);
+
+    out.timestamp = record.timestamp;
+    out.symbol = record.symbol;
+    out.checksum = n_ >= 10 ? record.checksum : 0;
+    out.bids.clear();
+    out.asks.clear();
+
+    if (is_snapshot || !emitted_) {
+        out.type = "snapshot";
+        out.bids = cur_bids_;
+        out.asks = cur_asks_;
+    } else {
+        diff_levels(prev_bids_, cur_bids_, true, out.bids);
+        diff_levels(prev_asks_, cur_asks_, false, out.asks);
+        if (out.bids.empty() && out.asks.empty()) {
+            return false;
+        }
+
+        if (mode_ == TopNMode::FULL) {
+            out.type = "snapshot";
+            out.bids = cur_bids_;
+            out.asks = cur_asks_;
+        } else {
+            out.type = "update";
+        }
+    }
+
+    prev_bids_.swap(cur_bids_);
+    prev_asks_.swap(cur_asks_);
+    emitted_ = true;
+    return true;
+}
+
+bool TopNDeltaTracker::touches_window(const OrderBookRecord& record) const {
+    // A partially filled window accepts any price
+    if (!record.bids.empty()) {
+        if (static_cast<int>(prev_bids_.size()) < n_) {
+            return true;
+        }
+        double worst_bid = prev_bids_.back().price;
+        for (const auto& level : record.bids) {
+            if (level.price >= worst_bid) {
+                return true;
+            }
+        }
+    }
+
+    if (!record.asks.empty()) {
+        if (static_cast<int>(prev_asks_.size()) < n_) {
+            return true;
+        }
+        double worst_ask = prev_asks_.back().price;
+        for (const auto& level : record.asks) {
+            if (level.price <= worst_ask) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void TopNDeltaTracker::diff_levels(const std::vector<PriceLevel>& prev,
+                                   const std::vector<PriceLevel>& cur,
+                                   bool descending,
+                                   std::vector<PriceLevel>& out) {
+    // Both windows are sorted best-first; merge them by price
+    size_t i = 0;
+    size_t j = 0;
+
+    while (i < prev.size() || j < cur.size()) {
+        if (j >= cur.size() ||
+            (i < prev.size() && (descending ? prev[i].price > cur[j].price
+                                            : prev[i].price < cur[j].price))) {
+            // Left the window (removed or pushed out)
+            out.emplace_back(prev[i].price, 0.0);
+            i++;
+        } else if (i >= prev.size() || prev[i].price != cur[j].price) {
+            // Entered the window (new level or moved up from below)
+            out.push_back(cur[j]);
+            j++;
+        } else {
+            // Same level: emit only if resized
+            if (prev[i].quantity != cur[j].quantity) {
+                out.push_back(cur[j]);
+            }
+            i++;
+            j++;
+        }
+    }
+}
+
+// ============================================================================
+// TopNFilter Implementation
+// ============================================================================
+
+TopNFilter::TopNFilter(int n, TopNMode mode)
+    : n_(n), mode_(mode),
+      input_count_(0), output_count_(0),
+      input_levels_(0), output_levels_(0) {
+}
+
+bool TopNFilter::process(const OrderBookRecord& record, OrderBookRecord& out) {
+    auto it = trackers_.find(record.symbol);
+    if (it == trackers_.end()) {
+        it = trackers_.emplace(record.symbol, TopNDeltaTracker(record.symbol, n_, mode_)).first;
+    }
+
+    input_count_++;
+    input_levels_ += record.bids.size() + record.asks.size();
+
+    if (!it->second.apply(record, out)) {
+        return false;
+    }
+
+    output_count_++;
+    output_levels_ += out.bids.size() + out.asks.size();
+    return true;
+}
+
+bool TopNFilter::parse_mode(const std::string& name, TopNMode& mode) {
+    if (name == "delta") {
+        mode = TopNMode::DELTA;
+        return true;
+    }
+    if (name == "full") {
+        mode = TopNMode::FULL;
+        return true;
+    }
+    return false;
+}
+
+const char* TopNFilter::mode_name(TopNMode mode) {
+    return mode == TopNMode::DELTA ? "delta" : "full";
+}
+
+} // namespace kraken
@@ -0,0 +1,144 @@
+/**
+ * Top-N Order Book Recorder
+ *
+ * Maintains the full book per symbol and reduces the raw Kraken stream to
+ * changes inside the top N levels of each side. Deep-level churn that never
+ * reaches the window produces no output at all.
+ *
+ * Output records are ordinary OrderBookRecord objects, so they are written
+ * with JsonLinesWriter / MultiFileJsonLinesWriter and replay with the
+ * existing tools (OrderBookState, process_orderbook_snapshots):
+ *
+ * - DELTA mode: one "snapshot" with the top N levels, then "update" records
+ *   holding only the levels that were inserted into, resized within, or
+ *   removed from (quantity 0) the window. Applying them in order yields
+ *   exactly the top-N book, no truncation needed.
+ * - FULL mode: a complete top-N "snapshot" row whenever anything in the
+ *   window changes.
+ *
+ * The Kraken checksum covers the top 10 levels, so it stays valid for
+ * N >= 10 and is set to 0 otherwise.
+ */
+
+#ifndef ORDERBOOK_TOPN_HPP
+#define ORDERBOOK_TOPN_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+#include "orderbook_common.hpp"
+#include "orderbook_state.hpp"
+
+namespace kraken {
+
+/**
+ * Top-N emission mode
+ */
+enum class TopNMode {
+    DELTA,      // Only changed levels within the window
+    FULL        // Full top-N row on every change
+};
+
+/**
+ * Top-N change tracker for one symbol
+ */
+class TopNDeltaTracker {
+public:
+    TopNDeltaTracker(const std::string& symbol, int n, TopNMode mode);
+
+    /**
+     * Apply a raw record and produce the top-N output record
+     * @param record Raw snapshot or update
+     * @param out Output record (filled only when returning true)
+     * @return true if the top N changed and out should be written
+     */
+    bool apply(const OrderBookRecord& record, OrderBookRecord& out);
+
+    /**
+     * Current top-N levels (as last emitted)
+     */
+    const std::vector<PriceLevel>& top_bids() const { return prev_bids_; }
+    const std::vector<PriceLevel>& top_asks() const { return prev_asks_; }
+
+    const OrderBookState& state() const { return state_; }
+
+private:
+    int n_;
+    TopNMode mode_;
+    OrderBookState state_;
+    bool emitted_;
+
+    // Window as of the last emission, and scratch for the current window
+    std::vector<PriceLevel> prev_bids_;
+    std::vector<PriceLevel> prev_asks_;
+    std::vector<PriceLevel> cur_bids_;
+    std::vector<PriceLevel> cur_asks_;
+
+    /**
+     * Can any level in the update land inside the last emitted window?
+     */
+    bool touches_window(const OrderBookRecord& record) const;
+
+    /**
+     * Append window differences (prev -> cur) to out
+     * @param descending true for bids (sorted high to low)
+     */
+    static void diff_levels(const std::vector<PriceLevel>& prev,
+                            const std::vector<PriceLevel>& cur,
+                            bool descending,
+                            std::vector<PriceLevel>& out);
+};
+
+/**
+ * Top-N filter for multiple symbols
+ *
+ * Usage:
+ *   TopNFilter filter(10, TopNMode::DELTA);
+ *   OrderBookRecord out;
+ *   if (filter.process(record, out)) {
+ *       writer.write_record(out);
+ *   }
+ */
+class TopNFilter {
+public:
+    TopNFilter(int n, TopNMode mode);
+
+    /**
+     * Route record to its symbol's tracker
+     * @return true if out holds a record to write
+     */
+    bool process(const OrderBookRecord& record, OrderBookRecord& out);
+
+    int get_depth() const { return n_; }
+    TopNMode get_mode() const { return mode_; }
+
+    /**
+     * Statistics
+     */
+    size_t get_input_count() const { return input_count_; }
+    size_t get_output_count() const { return output_count_; }
+    size_t get_input_levels() const { return input_levels_; }
+    size_t get_output_levels() const { return output_levels_; }
+
+    /**
+     * Parse mode name ("delta" or "full")
+     * @return false if name is not recognized
+     */
+    static bool parse_mode(const std::string& name, TopNMode& mode);
+    static const char* mode_name(TopNMode mode);
+
+private:
+    int n_;
+    TopNMode mode_;
+    std::map<std::string, TopNDeltaTracker> trackers_;
+
+    size_t input_count_;
+    size_t output_count_;
+    size_t input_levels_;
+    size_t output_levels_;
+};
+
+} // namespace kraken
+
+#endif // ORDERBOOK_TOPN_HPP
@@ -0,0 +1,153 @@
+/**
+ * Parse Pool - Implementation
+ */
+
+#include "parse_pool.hpp"
+#include "stage_trace.hpp"
+#include <iostream>
+#include <exception>
+
+namespace kraken {
+
+ParsePool::ParsePool(size_t num_threads, const ThreadPlacement& placement)
+    : max_queued_(0), submitted_(0), stopping_(false),
+      delivered_(0), out_of_order_(0), stopped_(false) {
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+
+    for (size_t i = 0; i < num_threads; i++) {
+        threads_.emplace_back(&ParsePool::run_parser, this, placement, i);
+    }
+}
+
+ParsePool::~ParsePool() {
+    stop();
+}
+
+bool ParsePool::submit(const std::string& key, Parse parse) {
+    Job job;
+    job.parse = std::move(parse);
+    {
+        std::lock_guard<std::mutex> lock(sequence_mutex_);
+        KeyState& state = keys_[key];
+        job.key = &state;
+        job.sequence = state.next_submit++;
+    }
+
+    bool accepted = false;
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        if (!stopping_) {
+            jobs_.push_back(std::move(job));
+            submitted_++;
+            if (jobs_.size() > max_queued_) {
+                max_queued_ = jobs_.size();
+            }
+            accepted = true;
+        }
+    }
+
+    if (!accepted) {
+        // Keep the key's sequence contiguous for later deliveries
+        complete(job.key, job.sequence, Deliver());
+        return false;
+    }
+    queue_cv_.notify_one();
+    return true;
+}
+
+void ParsePool::stop() {
+    if (stopped_.exchange(true)) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stopping_ = true;
+    }
+    queue_cv_.notify_all();
+
+    for (auto& thread : threads_) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+ParsePool::PoolStats ParsePool::get_stats() const {
+    PoolStats stats = {};
+    stats.threads = threads_.size();
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        stats.queued = jobs_.size();
+        stats.max_queued = max_queued_;
+        stats.submitted = submitted_;
+    }
+    stats.delivered = delivered_;
+    stats.out_of_order = out_of_order_;
+    return stats;
+}
+
+void ParsePool::run_parser(ThreadPlacement placement, size_t index) {
+    KRAKEN_TRACE_THREAD_NAME("parse_pool");
+    placement.apply("parse_pool_" + std::to_string(index), index);
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex_);
+            queue_cv_.wait(lock, [this] { return !jobs_.empty() || stopping_; });
+
+            if (jobs_.empty()) {
+                return;  // Stopping and drained
+            }
+            job = std::move(jobs_.front());
+            jobs_.pop_front();
+        }
+
+        // A failed parse still completes its sequence number, or the key stalls
+        Deliver deliver;
+        try {
+            deliver = job.parse();
+        } catch (const std::exception& e) {
+            std::cerr << "[Error] Parse pool task failed: " << e.what() << std::endl;
+        }
+        complete(job.key, job.sequence, std::move(deliver));
+    }
+}
+
+void ParsePool::complete(KeyState* key, uint64_t sequence, Deliver deliver) {
+    KRAKEN_TRACE_SCOPE("parse_pool.sequence");
+    std::unique_lock<std::mutex> lock(sequence_mutex_);
+    if (sequence != key->next_deliver) {
+        out_of_order_++;
+    }
+    key->ready.emplace(sequence, std::move(deliver));
+
+    // Another thread is delivering this key: it picks the step up in order
+    if (key->delivering) {
+        return;
+    }
+
+    key->delivering = true;
+    while (!key->ready.empty() && key->ready.begin()->first == key->next_deliver) {
+        Deliver step = std::move(key->ready.begin()->second);
+        key->ready.erase(key->ready.begin());
+        key->next_deliver++;
+
+        lock.unlock();
+        if (step) {
+            try {
+                step();
+            } catch (const std::exception& e) {
+                std::cerr << "[Error] Parse pool delivery failed: " << e.what() << std::endl;
+            }
+            delivered_++;
+        }
+        lock.lock();
+    }
+    key->delivering = false;
+}
+
+} // namespace kraken
@@ -0,0 +1,133 @@
+/**
+ * Parse Pool
+ *
+ * Moves message decoding off a WebSocket I/O thread. The I/O thread only
+ * submits raw frames; any of a small number of parser threads decodes them,
+ * so one large frame (e.g. a Level 3 snapshot) no longer delays reading the
+ * next frames and parsing scales across cores.
+ *
+ * Each frame is submitted with a key (the symbol). A parse job returns a
+ * delivery step; a sequencing stage runs the delivery steps of one key in
+ * submission order, one at a time, on whichever parser thread completes the
+ * next step in line. Different keys are delivered concurrently.
+ *
+ * Usage:
+ *   ParsePool pool(3);
+ *   pool.submit(symbol, [frame]() {
+ *       auto records = decode(*frame);           // Any parser thread
+ *       return ParsePool::Deliver([records]() {  // In order per symbol
+ *           apply(records);
+ *       });
+ *   });
+ *   ...
+ *   pool.stop();   // Parses and delivers everything queued, then joins
+ */
+
+#ifndef PARSE_POOL_HPP
+#define PARSE_POOL_HPP
+
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include "thread_placement.hpp"
+
+namespace kraken {
+
+class ParsePool {
+public:
+    using Deliver = std::function<void()>;
+    using Parse = std::function<Deliver()>;
+
+    /**
+     * Aggregate counters
+     */
+    struct PoolStats {
+        size_t threads;
+        size_t queued;              // Frames waiting for a parser right now
+        size_t max_queued;          // High-water mark of the queue
+        uint64_t submitted;
+        uint64_t delivered;
+        uint64_t out_of_order;      // Parsed before an earlier frame of the same key
+    };
+
+    /**
+     * Constructor - starts the parser threads
+     * @param num_threads Number of parser threads (at least 1)
+     * @param placement Parser threads' placement (thread i on the i-th CPU)
+     */
+    explicit ParsePool(size_t num_threads, const ThreadPlacement& placement = ThreadPlacement());
+
+    /**
+     * Destructor - drains and joins (same as stop())
+     */
+    ~ParsePool();
+
+    // Disable copy
+    ParsePool(const ParsePool&) = delete;
+    ParsePool& operator=(const ParsePool&) = delete;
+
+    /**
+     * Queue a frame for parsing (any thread)
+     * Deliveries of one key run in the order of their submit() calls.
+     * @param key Ordering key (e.g. symbol)
+     * @param parse Decodes the frame, returns the delivery step (may be empty)
+     * @return false if the pool is stopped
+     */
+    bool submit(const std::string& key, Parse parse);
+
+    /**
+     * Parse and deliver all queued frames, then join the parser threads
+     */
+    void stop();
+
+    PoolStats get_stats() const;
+    size_t size() const { return threads_.size(); }
+
+private:
+    // Sequencing state of one key (protected by sequence_mutex_)
+    struct KeyState {
+        uint64_t next_submit;
+        uint64_t next_deliver;
+        std::map<uint64_t, Deliver> ready;  // Parsed, waiting for earlier frames
+        bool delivering;                    // A thread is running this key's steps
+
+        KeyState() : next_submit(0), next_deliver(0), delivering(false) {}
+    };
+
+    struct Job {
+        KeyState* key;
+        uint64_t sequence;
+        Parse parse;
+    };
+
+    // Frame queue (protected by queue_mutex_)
+    mutable std::mutex queue_mutex_;
+    std::condition_variable queue_cv_;
+    std::deque<Job> jobs_;
+    size_t max_queued_;
+    uint64_t submitted_;
+    bool stopping_;
+
+    // Sequencing stage (map nodes are stable, jobs keep KeyState pointers)
+    std::mutex sequence_mutex_;
+    std::map<std::string, KeyState> keys_;
+
+    std::atomic<uint64_t> delivered_;
+    std::atomic<uint64_t> out_of_order_;
+    std::atomic<bool> stopped_;
+    std::vector<std::thread> threads_;
+
+    void run_parser(ThreadPlacement placement, size_t index);
+    void complete(KeyState* key, uint64_t sequence, Deliver deliver);
+};
+
+} // namespace kraken
+
+#endif // PARSE_POOL_HPP
@@ -0,0 +1,133 @@
+/**
+ * Queue Index - Implementation
+ */
+
+#include "queue_index.hpp"
+
+namespace kraken {
+
+namespace {
+
+inline size_t lowbit(size_t i) {
+    return i & (~i + 1);
+}
+
+} // anonymous namespace
+
+QueueIndex::QueueIndex() : qty_tree_(1, 0.0), count_tree_(1, 0), live_count_(0) {}
+
+size_t QueueIndex::append(double qty) {
+    size_t slot = qty_.size();
+    qty_.push_back(qty);
+    live_.push_back(true);
+    live_count_++;
+
+    // Node i covers (i - lowbit(i), i]: the new value plus the nodes below it
+    size_t i = slot + 1;
+    double qty_sum = qty;
+    size_t count_sum = 1;
+    size_t stop = i - lowbit(i);
+    for (size_t j = i - 1; j > stop; j -= lowbit(j)) {
+        qty_sum += qty_tree_[j];
+        count_sum += count_tree_[j];
+    }
+    qty_tree_.push_back(qty_sum);
+    count_tree_.push_back(count_sum);
+    return slot;
+}
+
+void QueueIndex::add(size_t slot, double qty_delta, long count_delta) {
+    for (size_t i = slot + 1; i < qty_tree_.size(); i += lowbit(i)) {
+        qty_tree_[i] += qty_delta;
+        count_tree_[i] += static_cast<size_t>(count_delta);  // Wraps back for -1
+    }
+}
+
+void QueueIndex::remove(size_t slot) {
+    if (!is_live(slot)) {
+        return;
+    }
+    add(slot, -qty_[slot], -1);
+    qty_[slot] = 0.0;
+    live_[slot] = false;
+    live_count_--;
+}
+
+void QueueIndex::set_qty(size_t slot, double qty) {
+    if (!is_live(slot)) {
+        return;
+    }
+    add(slot, qty - qty_[slot], 0);
+    qty_[slot] = qty;
+}
+
+double QueueIndex::volume_before(size_t slot) const {
+    double sum = 0.0;
+    for (size_t i = slot < qty_.size() ? slot : qty_.size(); i > 0; i -= lowbit(i)) {
+        sum += qty_tree_[i];
+    }
+    return sum;
+}
+
+size_t QueueIndex::count_before(size_t slot) const {
+    size_t sum = 0;
+    for (size_t i = slot < qty_.size() ? slot : qty_.size(); i > 0; i -= lowbit(i)) {
+        sum += count_tree_[i];
+    }
+    return sum;
+}
+
+size_t QueueIndex::slot_at(size_t position) const {
+    if (position >= live_count_) {
+        return qty_.size();
+    }
+
+    // Descend to the largest index whose prefix count is <= position
+    size_t n = qty_.size();
+    size_t step = 1;
+    while (step * 2 <= n) {
+        step *= 2;
+    }
+
+    size_t index = 0;
+    size_t remaining = position;
+    for (; step > 0; step /= 2) {
+        size_t next = index + step;
+        if (next <= n && count_tree_[next] <= remaining) {
+            index = next;
+            remaining -= count_tree_[next];
+        }
+    }
+    // Prefix [1, index] holds position live orders; the next one is 0-based slot index
+    return index;
+}
+
+void QueueIndex::clear() {
+    qty_tree_.assign(1, 0.0);
+    count_tree_.assign(1, 0);
+    qty_.clear();
+    live_.clear();
+    live_count_ = 0;
+}
+
+void QueueIndex::rebuild(const std::vector<double>& quantities) {
+    size_t n = quantities.size();
+    qty_ = quantities;
+    live_.assign(n, true);
+    live_count_ = n;
+
+    // Linear build: push each node into its parent once
+    qty_tree_.assign(n + 1, 0.0);
+    count_tree_.assign(n + 1, 0);
+    for (size_t i = 1; i <= n; ++i) {
+        qty_tree_[i] += quantities[i - 1];
+        count_tree_[i] += 1;
+        size_t parent = i + lowbit(i);
+        if (parent <= n) {
+            qty_tree_[parent] += qty_tree_[i];
+            count_tree_[parent] += count_tree_[i];
+        }
+    }
+}
+
+} // namespace kraken
@@ -0,0 +1,98 @@
+/**
+ * Queue Index
+ *
+ * Fenwick (binary indexed) tree over the arrival slots of one price level.
+ * Each order gets the next slot when it joins the queue; a slot is emptied
+ * (not shifted) when the order leaves, so slots stay stable and the index
+ * answers, in O(log n):
+ *   - volume / number of live orders ahead of a slot
+ *   - slot of the k-th live order (position -> slot)
+ *
+ * Two trees are kept side by side: one over quantities, one over live
+ * counts. Appending extends both trees in O(log n). Emptied slots are only
+ * reclaimed by rebuild(), which the owner calls when compacting its queue.
+ */
+
+#ifndef QUEUE_INDEX_HPP
+#define QUEUE_INDEX_HPP
+
+#include <vector>
+#include <cstddef>
+
+namespace kraken {
+
+/**
+ * Volume and count prefix sums over one level's queue
+ */
+class QueueIndex {
+public:
+    QueueIndex();
+
+    /**
+     * Add an order at the back of the queue
+     * @return Slot of the new order
+     */
+    size_t append(double qty);
+
+    /**
+     * Empty a slot (order left the queue)
+     */
+    void remove(size_t slot);
+
+    /**
+     * Change the quantity of a live slot in place
+     */
+    void set_qty(size_t slot, double qty);
+
+    /**
+     * Live volume / orders in slots before slot
+     * slot may be slots() (everything in the queue).
+     */
+    double volume_before(size_t slot) const;
+    size_t count_before(size_t slot) const;
+
+    /**
+     * Slot of the live order at 0-based position k
+     * @return slots() if fewer than k + 1 orders are live
+     */
+    size_t slot_at(size_t position) const;
+
+    /**
+     * Volume ahead of queue position k (sum of the first k live orders)
+     */
+    double volume_ahead(size_t position) const {
+        return volume_before(slot_at(position));
+    }
+
+    bool is_live(size_t slot) const { return slot < live_.size() && live_[slot]; }
+
+    size_t slots() const { return qty_.size(); }
+    size_t live() const { return live_count_; }
+    size_t holes() const { return qty_.size() - live_count_; }
+
+    /**
+     * Drop every slot
+     */
+    void clear();
+
+    /**
+     * Replace the queue with the given live quantities (slots 0..n-1), O(n)
+     */
+    void rebuild(const std::vector<double>& quantities);
+
+private:
+    // 1-based Fenwick arrays; element 0 is unused
+    std::vector<double> qty_tree_;
+    std::vector<size_t> count_tree_;
+
+    // Per-slot values (0-based)
+    std::vector<double> qty_;
+    std::vector<bool> live_;
+    size_t live_count_;
+
+    void add(size_t slot, double qty_delta, long count_delta);
+};
+
+} // namespace kraken
+
+#endif // QUEUE_INDEX_HPP
@@ -0,0 +1,468 @@
+/**
+ * Replay Source
+ *
+ * Feeds capture files through the same callback interface as the live
+ * clients (KrakenBookClient, KrakenLevel3Client), so consumer code written
+ * against a live client runs unchanged against history:
+ *
+ *   ReplaySource<OrderBookRecord> source({"book.20251112_10.jsonl", ...});
+ *   source.set_pacing(ReplayPacing::SCALED, 100.0);     // 100x real time
+ *   source.set_update_callback(on_book_update);         // same callback as live
+ *   source.set_connection_callback(on_connection);      // true at start, false at end
+ *   source.start({"BTC/USD"});                          // empty = every symbol
+ *   while (source.is_running()) { ... }
+ *
+ * Lines are decoded with JsonlDecoder, the decoder used by the offline
+ * processing tools. Records are delivered on the source's own thread, like
+ * the live clients' I/O thread.
+ *
+ * Pacing uses the record timestamps (local receive time of the capture):
+ * - AS_FAST: no waiting, limited only by decoding and the consumer
+ * - REAL_TIME: original inter-record gaps
+ * - SCALED: gaps divided by the speed factor
+ * Waits use PrecisionClock: sleep until shortly before the deadline, then
+ * spin, so pacing stays accurate at sub-millisecond gaps.
+ */
+
+#ifndef REPLAY_SOURCE_HPP
+#define REPLAY_SOURCE_HPP
+
+#include <string>
+#include <vector>
+#include <set>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "jsonl_decoder.hpp"
+
+namespace kraken {
+
+/**
+ * Replay pacing mode
+ */
+enum class ReplayPacing {
+    AS_FAST,    // As fast as possible
+    REAL_TIME,  // Original timing
+    SCALED      // Original timing divided by a speed factor
+};
+
+/**
+ * Hybrid sleep/spin wait for precise deadlines
+ */
+class PrecisionClock {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * Block until deadline
+     * Sleeps until spin_window before the deadline (the OS wakes threads
+     * late by tens of microseconds), then spins for the remainder.
+     * @param running Checked while sleeping; returns early when it turns false
+     * @return false if interrupted via running
+     */
+    static bool sleep_until(Clock::time_point deadline, const std::atomic<bool>& running,
+                            std::chrono::microseconds spin_window = std::chrono::microseconds(200)) {
+        constexpr auto max_sleep = std::chrono::milliseconds(50);  // Bounds stop() latency
+
+        while (true) {
+            auto now = Clock::now();
+            if (now >= deadline) {
+                return true;
+            }
+            if (!running.load(std::memory_order_relaxed)) {
+                return false;
+            }
+
+            auto remaining = deadline - now;
+            if (remaining <= spin_window) {
+                break;
+            }
+
+            auto sleep_for = remaining - spin_window;
+            std::this_thread::sleep_for(sleep_for < max_sleep ? sleep_for : max_sleep);
+        }
+
+        while (Clock::now() < deadline) {
+            // Spin
+        }
+        return true;
+    }
+};
+
+/**
+ * Capture file replay with the live client callback interface
+ *
+ * @tparam Record OrderBookRecord or Level3Record (any type JsonlDecoder decodes)
+ */
+template<typename Record>
+class ReplaySource {
+public:
+    // Type definitions (same as the live clients)
+    using UpdateCallback = std::function<void(const Record&)>;
+    using ConnectionCallback = std::function<void(bool connected)>;
+    using ErrorCallback = std::function<void(const std::string& error)>;
+
+    /**
+     * Replay counters
+     */
+    struct ReplayStats {
+        uint64_t records;        // Records delivered
+        uint64_t filtered;       // Records skipped by the symbol filter
+        uint64_t parse_errors;   // Lines that failed to decode
+        double event_seconds;    // Event time covered (last - first record)
+        double wall_seconds;     // Wall time spent replaying
+        double max_lag_us;       // Worst delivery delay behind schedule (paced modes)
+    };
+
+    /**
+     * Constructor
+     * @param files Capture files, replayed in the given order
+     */
+    explicit ReplaySource(const std::vector<std::string>& files);
+    ~ReplaySource();
+
+    // Disable copy
+    ReplaySource(const ReplaySource&) = delete;
+    ReplaySource& operator=(const ReplaySource&) = delete;
+
+    /**
+     * Set pacing (call before start())
+     * @param speed Speed factor for SCALED (e.g. 100.0 = 100x real time)
+     */
+    void set_pacing(ReplayPacing mode, double speed = 1.0);
+
+    // Public API (same as the live clients)
+    bool start(const std::vector<std::string>& symbols);
+    void stop();
+    bool is_connected() const;
+    bool is_running() const;
+    void set_update_callback(UpdateCallback callback);
+    void set_connection_callback(ConnectionCallback callback);
+    void set_error_callback(ErrorCallback callback);
+
+    ReplayStats get_stats() const;
+
+    /**
+     * Parse a pacing specification
+     * "max" -> AS_FAST, "realtime" or "1x" -> REAL_TIME, "<N>x" -> SCALED
+     * @return false if text is not recognized
+     */
+    static bool parse_pacing(const std::string& text, ReplayPacing& mode, double& speed);
+    static const char* pacing_name(ReplayPacing mode);
+
+private:
+    std::vector<std::string> files_;
+    ReplayPacing pacing_;
+    double speed_;
+    std::set<std::string> symbols_;  // Empty = all
+
+    std::thread worker_thread_;
+    std::atomic<bool> running_;
+    std::atomic<bool> connected_;
+
+    // Statistics
+    std::atomic<uint64_t> record_count_;
+    std::atomic<uint64_t> filtered_count_;
+    std::atomic<uint64_t> parse_error_count_;
+    std::atomic<double> event_seconds_;
+    std::atomic<double> wall_seconds_;
+    std::atomic<double> max_lag_us_;
+
+    // Timestamp cache (worker thread only): mktime once per second of capture
+    std::string cached_second_;
+    double cached_epoch_;
+
+    // Callbacks (protected by callback_mutex_)
+    mutable std::mutex callback_mutex_;
+    UpdateCallback update_callback_;
+    ConnectionCallback connection_callback_;
+    ErrorCallback error_callback_;
+
+    // Worker thread main function
+    void run();
+
+    // Helper methods
+    double event_time(const std::string& timestamp);
+    void notify_connection(bool connected);
+    void notify_error(const std::string& error);
+};
+
+// ============================================================================
+// Implementation
+// ============================================================================
+
+template<typename Record>
+ReplaySource<Record>::ReplaySource(const std::vector<std::string>& files)
+    : files_(files), pacing_(ReplayPacing::AS_FAST), speed_(1.0),
+      running_(false), connected_(false),
+      record_count_(0), filtered_count_(0), parse_error_count_(0),
+      event_seconds_(0.0), wall_seconds_(0.0), max_lag_us_(0.0),
+      cached_epoch_(0.0) {
+}
+
+template<typename Record>
+ReplaySource<Record>::~ReplaySource() {
+    stop();
+}
+
+template<typename Record>
+void ReplaySource<Record>::set_pacing(ReplayPacing mode, double speed) {
+    if (running_) {
+        std::cerr << "[Error] set_pacing() must be called before start()" << std::endl;
+        return;
+    }
+    pacing_ = mode;
+    speed_ = (mode == ReplayPacing::SCALED && speed > 0.0) ? speed : 1.0;
+}
+
+template<typename Record>
+bool ReplaySource<Record>::start(const std::vector<std::string>& symbols) {
+    if (running_) {
+        return false;
+    }
+
+    if (files_.empty()) {
+        std::cerr << "[Error] No replay files given" << std::endl;
+        return false;
+    }
+
+    // Join a previous run that ended on its own
+    if (worker_thread_.joinable()) {
+        worker_thread_.join();
+    }
+
+    symbols_ = std::set<std::string>(symbols.begin(), symbols.end());
+    running_ = true;
+
+    worker_thread_ = std::thread([this]() {
+        this->run();
+    });
+
+    return true;
+}
+
+template<typename Record>
+void ReplaySource<Record>::stop() {
+    running_ = false;
+
+    if (worker_thread_.joinable()) {
+        worker_thread_.join();
+    }
+}
+
+template<typename Record>
+bool ReplaySource<Record>::is_connected() const {
+    return connected_.load();
+}
+
+template<typename Record>
+bool ReplaySource<Record>::is_running() const {
+    return running_.load();
+}
+
+template<typename Record>
+void ReplaySource<Record>::set_update_callback(UpdateCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    update_callback_ = callback;
+}
+
+template<typename Record>
+void ReplaySource<Record>::set_connection_callback(ConnectionCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    connection_callback_ = callback;
+}
+
+template<typename Record>
+void ReplaySource<Record>::set_error_callback(ErrorCallback callback) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    error_callback_ = callback;
+}
+
+template<typename Record>
+typename ReplaySource<Record>::ReplayStats ReplaySource<Record>::get_stats() const {
+    ReplayStats stats;
+    stats.records = record_count_.load();
+    stats.filtered = filtered_count_.load();
+    stats.parse_errors = parse_error_count_.load();
+    stats.event_seconds = event_seconds_.load();
+    stats.wall_seconds = wall_seconds_.load();
+    stats.max_lag_us = max_lag_us_.load();
+    return stats;
+}
+
+template<typename Record>
+bool ReplaySource<Record>::parse_pacing(const std::string& text, ReplayPacing& mode, double& speed) {
+    if (text == "max") {
+        mode = ReplayPacing::AS_FAST;
+        speed = 1.0;
+        return true;
+    }
+    if (text == "realtime") {
+        mode = ReplayPacing::REAL_TIME;
+        speed = 1.0;
+        return true;
+    }
+
+    if (text.size() < 2 || text.back() != 'x') {
+        return false;
+    }
+
+    char* end = nullptr;
+    std::string number = text.substr(0, text.size() - 1);
+    double value = std::strtod(number.c_str(), &end);
+    if (end == number.c_str() || *end != '\0' || value <= 0.0) {
+        return false;
+    }
+
+    mode = (value == 1.0) ? ReplayPacing::REAL_TIME : ReplayPacing::SCALED;
+    speed = value;
+    return true;
+}
+
+template<typename Record>
+const char* ReplaySource<Record>::pacing_name(ReplayPacing mode) {
+    switch (mode) {
+        case ReplayPacing::AS_FAST:   return "as fast as possible";
+        case ReplayPacing::REAL_TIME: return "real time";
+        case ReplayPacing::SCALED:    return "scaled";
+    }
+    return "unknown";
+}
+
+template<typename Record>
+void ReplaySource<Record>::run() {
+    using Clock = PrecisionClock::Clock;
+
+    JsonlDecoder decoder;
+    Record record;
+    std::string line;
+
+    bool paced = pacing_ != ReplayPacing::AS_FAST;
+    bool have_origin = false;
+    double first_event = 0.0;
+    double last_event = -1.0;
+    Clock::time_point wall_origin;
+    auto wall_start = Clock::now();
+
+    connected_ = true;
+    notify_connection(true);
+
+    for (const auto& filename : files_) {
+        if (!running_) {
+            break;
+        }
+
+        std::ifstream infile(filename);
+        if (!infile.is_open()) {
+            notify_error("Cannot open replay file: " + filename);
+            continue;
+        }
+
+        size_t line_num = 0;
+        while (running_ && std::getline(infile, line)) {
+            line_num++;
+            if (line.empty()) {
+                continue;
+            }
+
+            if (!decoder.decode(line, record)) {
+                parse_error_count_++;
+                notify_error("Failed to parse " + filename + " line " + std::to_string(line_num));
+                continue;
+            }
+
+            if (!symbols_.empty() && symbols_.count(record.symbol) == 0) {
+                filtered_count_++;
+                continue;
+            }
+
+            double event = event_time(record.timestamp);
+            if (!have_origin) {
+                have_origin = true;
+                first_event = event;
+                wall_origin = Clock::now();
+            }
+            // Out-of-order timestamps (e.g. overlapping captures) are not waited for
+            bool in_order = event >= last_event;
+            if (in_order) {
+                last_event = event;
+            }
+
+            if (paced && in_order) {
+                double offset = (event - first_event) / speed_;
+                auto deadline = wall_origin + std::chrono::duration_cast<Clock::duration>(
+                    std::chrono::duration<double>(offset));
+
+                if (!PrecisionClock::sleep_until(deadline, running_)) {
+                    break;
+                }
+
+                double lag_us = std::chrono::duration<double, std::micro>(Clock::now() - deadline).count();
+                if (lag_us > max_lag_us_.load(std::memory_order_relaxed)) {
+                    max_lag_us_.store(lag_us, std::memory_order_relaxed);
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(callback_mutex_);
+                if (update_callback_) {
+                    update_callback_(record);
+                }
+            }
+            record_count_++;
+        }
+    }
+
+    event_seconds_ = have_origin ? last_event - first_event : 0.0;
+    wall_seconds_ = std::chrono::duration<double>(Clock::now() - wall_start).count();
+
+    connected_ = false;
+    notify_connection(false);
+    running_ = false;
+}
+
+template<typename Record>
+double ReplaySource<Record>::event_time(const std::string& timestamp) {
+    // "YYYY-MM-DD HH:MM:SS.mmm": only the milliseconds change within a second
+    constexpr size_t SECOND_PREFIX = 19;
+
+    if (timestamp.size() <= SECOND_PREFIX) {
+        return JsonlDecoder::parse_timestamp(timestamp);
+    }
+
+    if (timestamp.compare(0, SECOND_PREFIX, cached_second_) != 0) {
+        cached_second_.assign(timestamp, 0, SECOND_PREFIX);
+        cached_epoch_ = JsonlDecoder::parse_timestamp(cached_second_);
+    }
+
+    int millisec = std::atoi(timestamp.c_str() + SECOND_PREFIX + 1);
+    return cached_epoch_ + millisec / 1000.0;
+}
+
+template<typename Record>
+void ReplaySource<Record>::notify_connection(bool connected) {
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (connection_callback_) {
+        connection_callback_(connected);
+    }
+}
+
+template<typename Record>
+void ReplaySource<Record>::notify_error(const std::string& error) {
+    std::cerr << "[Error] " << error << std::endl;
+
+    std::lock_guard<std::mutex> lock(callback_mutex_);
+    if (error_callback_) {
+        error_callback_(error);
+    }
+}
+
+} // namespace kraken
+
+#endif // REPLAY_SOURCE_HPP
@@ -0,0 +1,302 @@
+/**
+ * Segment Batch - Implementation
+ */
+
+#include "segment_batch.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <map>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <glob.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace kraken {
+
+namespace {
+
+bool all_digits(const std::string& text, size_t pos, size_t len) {
+    if (pos + len > text.size()) {
+        return false;
+    }
+    for (size_t i = pos; i < pos + len; i++) {
+        if (!std::isdigit(static_cast<unsigned char>(text[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool is_separator(char c) {
+    return c == '.' || c == '_' || c == '-';
+}
+
+bool has_glob_chars(const std::string& input) {
+    return input.find_first_of("*?[") != std::string::npos;
+}
+
+bool list_directory(const std::string& dir, std::vector<std::string>& files) {
+    DIR* handle = opendir(dir.c_str());
+    if (!handle) {
+        return false;
+    }
+
+    std::string prefix = dir;
+    if (!prefix.empty() && prefix.back() != '/') {
+        prefix += '/';
+    }
+
+    while (struct dirent* entry = readdir(handle)) {
+        std::string name = entry->d_name;
+        if (name.empty() || name[0] == '.') {
+            continue;
+        }
+        if (name.size() > 6 && name.compare(name.size() - 6, 6, ".jsonl") == 0) {
+            files.push_back(prefix + name);
+        }
+    }
+    closedir(handle);
+    return true;
+}
+
+} // anonymous namespace
+
+// ============================================================================
+// SegmentCursor / SegmentLineReader Implementation
+// ============================================================================
+
+bool SegmentCursor::resume_point(const std::string& segment_key, uint64_t& start_offset) const {
+    start_offset = 0;
+    if (!started || segment_key > key) {
+        return true;
+    }
+    if (segment_key < key) {
+        return false;
+    }
+    start_offset = offset;
+    return true;
+}
+
+bool SegmentLineReader::open(const std::string& path, uint64_t offset, bool hold_partial) {
+    file_.open(path, std::ios::in | std::ios::binary);
+    if (!file_.is_open()) {
+        return false;
+    }
+    file_.seekg(static_cast<std::streamoff>(offset));
+    offset_ = offset;
+    hold_partial_ = hold_partial;
+    return file_.good();
+}
+
+bool SegmentLineReader::next(std::string& line) {
+    if (!std::getline(file_, line)) {
+        return false;
+    }
+    if (file_.eof()) {
+        // No newline: possibly still being written
+        if (hold_partial_) {
+            return false;
+        }
+        offset_ += line.size();
+        return true;
+    }
+    offset_ += line.size() + 1;
+    return true;
+}
+
+// ============================================================================
+// SegmentBatch Implementation
+// ============================================================================
+
+bool SegmentBatch::expand_inputs(const std::vector<std::string>& inputs,
+                                 std::vector<std::string>& files,
+                                 std::string& error) {
+    files.clear();
+
+    for (const auto& input : inputs) {
+        size_t before = files.size();
+
+        if (has_glob_chars(input)) {
+            glob_t matches;
+            std::memset(&matches, 0, sizeof(matches));
+            if (glob(input.c_str(), 0, nullptr, &matches) == 0) {
+                for (size_t i = 0; i < matches.gl_pathc; i++) {
+                    files.push_back(matches.gl_pathv[i]);
+                }
+            }
+            globfree(&matches);
+        } else {
+            struct stat info;
+            if (stat(input.c_str(), &info) != 0) {
+                error = "Input does not exist: " + input;
+                return false;
+            }
+            if (S_ISDIR(info.st_mode)) {
+                if (!list_directory(input, files)) {
+                    error = "Cannot read directory: " + input;
+                    return false;
+                }
+            } else {
+                files.push_back(input);
+            }
+        }
+
+        if (files.size() == before) {
+            error = "No input files match: " + input;
+            return false;
+        }
+    }
+
+    std::sort(files.begin(), files.end());
+    files.erase(std::unique(files.begin(), files.end()), files.end());
+    return true;
+}
+
+std::string SegmentBatch::segment_key(const std::string& path, std::string* series) {
+    if (series) {
+        *series = path;
+    }
+
+    size_t name_pos = path.rfind('/');
+    name_pos = (name_pos == std::string::npos) ? 0 : name_pos + 1;
+    size_t ext_pos = path.rfind('.');
+    if (ext_pos == std::string::npos || ext_pos < name_pos) {
+        ext_pos = path.size();
+    }
+
+    // Optional "-NNN" part suffix (LineSegmentWriter size rolling)
+    const size_t part_len = 4;
+    size_t date_end = ext_pos;
+    if (ext_pos >= name_pos + part_len && path[ext_pos - part_len] == '-' &&
+        all_digits(path, ext_pos - 3, 3)) {
+        date_end = ext_pos - part_len;
+    }
+
+    // "<sep>YYYYMMDD_HH" or "<sep>YYYYMMDD" right before the extension (or part)
+    const size_t hourly_len = 11;
+    const size_t daily_len = 8;
+    size_t key_len = 0;
+    if (date_end >= name_pos + hourly_len + 1 &&
+        all_digits(path, date_end - hourly_len, 8) && path[date_end - 3] == '_' &&
+        all_digits(path, date_end - 2, 2)) {
+        key_len = hourly_len;
+    } else if (date_end >= name_pos + daily_len + 1 && all_digits(path, date_end - daily_len, daily_len)) {
+        key_len = daily_len;
+    }
+    if (key_len == 0 || !is_separator(path[date_end - key_len - 1])) {
+        return "";
+    }
+
+    size_t key_pos = date_end - key_len;
+    if (series) {
+        *series = path.substr(0, key_pos - 1) + path.substr(ext_pos);
+    }
+    return path.substr(key_pos, ext_pos - key_pos);
+}
+
+std::vector<SegmentChain> SegmentBatch::build_chains(const std::vector<std::string>& files) {
+    // series -> (key, file)
+    std::map<std::string, std::vector<std::pair<std::string, std::string>>> grouped;
+    for (const auto& file : files) {
+        std::string series;
+        std::string key = segment_key(file, &series);
+        if (key.empty()) {
+            series = file;  // Not a segment: a chain of its own
+        }
+        grouped[series].emplace_back(key, file);
+    }
+
+    std::vector<SegmentChain> chains;
+    chains.reserve(grouped.size());
+    for (auto& pair : grouped) {
+        std::sort(pair.second.begin(), pair.second.end());
+
+        SegmentChain chain;
+        chain.series = pair.first;
+        for (const auto& entry : pair.second) {
+            chain.keys.push_back(entry.first);
+            chain.files.push_back(entry.second);
+        }
+        chains.push_back(std::move(chain));
+    }
+    return chains;
+}
+
+void SegmentBatch::run_parallel(size_t count, size_t jobs, const std::function<void(size_t)>& task) {
+    if (jobs <= 1 || count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            task(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+            task(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    size_t thread_count = std::min(jobs, count);
+    threads.reserve(thread_count);
+    for (size_t t = 0; t < thread_count; t++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+bool SegmentBatch::merge_csv_parts(const std::vector<std::string>& parts,
+                                   const std::string& output,
+                                   std::string& error,
+                                   bool append) {
+    bool header_written = false;
+    if (append) {
+        std::ifstream existing(output);
+        std::string first_line;
+        header_written = existing.is_open() && std::getline(existing, first_line) && !first_line.empty();
+    }
+
+    std::ofstream out(output, append ? (std::ios::out | std::ios::app) : (std::ios::out | std::ios::trunc));
+    if (!out.is_open()) {
+        error = "Cannot open output file: " + output;
+        return false;
+    }
+
+    std::string line;
+    for (const auto& part : parts) {
+        std::ifstream in(part);
+        if (!in.is_open()) {
+            continue;
+        }
+
+        bool first = true;
+        while (std::getline(in, line)) {
+            if (first) {
+                first = false;
+                if (header_written) {
+                    continue;  // Every part starts with the same header
+                }
+                header_written = true;
+            }
+            out << line << '\n';
+        }
+        in.close();
+        std::remove(part.c_str());
+    }
+
+    out.flush();
+    if (!out.good()) {
+        error = "Write failed: " + output;
+        return false;
+    }
+    return true;
+}
+
+} // namespace kraken
@@ -0,0 +1,142 @@
+/**
+ * Segment Batch
+ *
+ * Turns the inputs of the offline processing tools (files, directories,
+ * glob patterns) into ordered segment chains and runs the chains on a
+ * thread pool.
+ *
+ * Segment files carry their segment key in the name, as written by the
+ * recorders' hourly / daily segmentation:
+ *   book.20251112_10.jsonl      (FlushSegmentMixin: "." + key before the extension)
+ *   book_BTC_USD_20251112_10.jsonl
+ *   book.20251112.jsonl         (daily)
+ *   book.20251112_10-001.jsonl  (size-rolled part of a segment, key "20251112_10-001")
+ *
+ * Files whose names are equal once the key is removed form one chain (a
+ * series), ordered by key, so book state can carry forward from one segment
+ * to the next. Different chains are independent and can be processed in
+ * parallel. A file without a key is a chain of its own.
+ *
+ * Incremental runs keep a SegmentCursor per chain (last segment key and
+ * the byte offset after its last complete line). Segments before the
+ * cursor are skipped, the cursor's segment is resumed at the offset (it may
+ * have grown since), later segments are read in full. SegmentLineReader
+ * can hold back a trailing line without a newline, so a line still being
+ * written is left for the next run.
+ */
+
+#ifndef SEGMENT_BATCH_HPP
+#define SEGMENT_BATCH_HPP
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <fstream>
+#include <cstddef>
+#include <cstdint>
+
+namespace kraken {
+
+/**
+ * Consecutive segments of one series
+ */
+struct SegmentChain {
+    std::string series;               // Path with the segment key removed
+    std::vector<std::string> files;   // Ordered by segment key
+    std::vector<std::string> keys;    // Segment key per file ("" if none)
+};
+
+/**
+ * How far a chain has been processed
+ */
+struct SegmentCursor {
+    bool started;
+    std::string key;   // Segment key of the last segment read
+    uint64_t offset;   // Bytes of that segment consumed (complete lines)
+
+    SegmentCursor() : started(false), offset(0) {}
+
+    /**
+     * Where to start reading a segment of the chain
+     * @return false if the segment lies before the cursor (already processed)
+     */
+    bool resume_point(const std::string& segment_key, uint64_t& start_offset) const;
+};
+
+/**
+ * Reads complete lines of a segment from a byte offset
+ */
+class SegmentLineReader {
+public:
+    SegmentLineReader() : offset_(0), hold_partial_(false) {}
+
+    /**
+     * @param hold_partial Do not return a trailing line without a newline
+     */
+    bool open(const std::string& path, uint64_t offset, bool hold_partial);
+
+    /**
+     * Next line (without the newline)
+     * @return false at the end of the file (or at a held partial line)
+     */
+    bool next(std::string& line);
+
+    /**
+     * Offset after the last line returned
+     */
+    uint64_t offset() const { return offset_; }
+
+private:
+    std::ifstream file_;
+    uint64_t offset_;
+    bool hold_partial_;
+};
+
+/**
+ * Input expansion, chain building and parallel chain processing
+ */
+class SegmentBatch {
+public:
+    /**
+     * Expand inputs into a sorted, de-duplicated file list
+     * Each input is a file, a directory (its *.jsonl files) or a glob
+     * pattern (quote it so the shell does not expand it first).
+     * @return false with error set if an input matches nothing
+     */
+    static bool expand_inputs(const std::vector<std::string>& inputs,
+                              std::vector<std::string>& files,
+                              std::string& error);
+
+    /**
+     * Segment key of a file ("YYYYMMDD_HH" or "YYYYMMDD", optionally
+     * followed by a "-NNN" part number; "" if none)
+     * @param series Set to the path with the key (and its separator) removed
+     */
+    static std::string segment_key(const std::string& path, std::string* series = nullptr);
+
+    /**
+     * Group files into chains, ordered by series and then by segment key
+     */
+    static std::vector<SegmentChain> build_chains(const std::vector<std::string>& files);
+
+    /**
+     * Run task(i) for i in [0, count) on up to jobs threads
+     * Tasks are handed out in index order; jobs <= 1 runs them inline.
+     */
+    static void run_parallel(size_t count, size_t jobs, const std::function<void(size_t)>& task);
+
+    /**
+     * Concatenate CSV part files into output, keeping the first header
+     * Parts are removed afterwards; missing parts are skipped. With append,
+     * rows are added to output and no header is repeated if it has one.
+     * @return false with error set if output cannot be written
+     */
+    static bool merge_csv_parts(const std::vector<std::string>& parts,
+                                const std::string& output,
+                                std::string& error,
+                                bool append = false);
+};
+
+} // namespace kraken
+
+#endif // SEGMENT_BATCH_HPP
@@ -2,127 +2,96 @@
  * Snapshot CSV Writer
  *
  * Writes order book snapshot metrics to CSV format with adaptive precision.
+ *
+ * With sweep sizes, each size adds average fill price and slippage columns
+ * per side (e.g. ask_sweep_5_avg_price, ask_sweep_5_slippage_bps). The cells
+ * are left empty when the book is shallower than the size.
+ *
+ * A BufferedWriter with SnapshotCsvCodec (see buffered_writer.hpp): rows
+ * are buffered and written on flush() or the mixin's flush triggers.
  */
 
 #ifndef SNAPSHOT_CSV_WRITER_HPP
 #define SNAPSHOT_CSV_WRITER_HPP
 
 #include <string>
-#include <fstream>
-#include <map>
+#include <vector>
 #include "orderbook_state.hpp"
+#include "buffered_writer.hpp"
 
 namespace kraken {
 
+/**
+ * Snapshot metrics codec (CSV with adaptive precision)
+ */
+struct SnapshotCsvCodec {
+    std::vector<double> sweep_sizes;  // Sweep cost columns to write (ascending)
+
+    SnapshotCsvCodec() {}
+    explicit SnapshotCsvCodec(const std::vector<double>& sizes) : sweep_sizes(sizes) {}
+
+    static const char* extension() { return ".csv"; }
+
+    void header(const SnapshotMetrics& first, std::string& out) const;
+
+    void encode(const SnapshotMetrics& metrics, std::string& out) const;
+
+    /**
+     * Append one side's sweep cost columns
+     */
+    void append_sweep(std::string& out, const std::vector<SweepCost>& sweep) const;
+};
+
 /**
  * CSV writer for snapshot metrics
+ * The file is opened by the constructor.
  */
-class SnapshotCSVWriter {
+class SnapshotCSVWriter : public BufferedWriter<SnapshotMetrics, SnapshotCsvCodec> {
 public:
     /**
      * Constructor
      * @param filename Output CSV filename
      * @param append Append to existing file (default: false)
+     * @param sweep_sizes Sweep cost columns to write (ascending)
      */
-    SnapshotCSVWriter(const std::string& filename, bool append = false);
-
-    /**
-     * Destructor - closes file
-     */
-    ~SnapshotCSVWriter();
+    SnapshotCSVWriter(const std::string& filename, bool append = false,
+                      const std::vector<double>& sweep_sizes = std::vector<double>());
 
     /**
      * Write snapshot metrics to CSV
      */
     bool write_snapshot(const SnapshotMetrics& metrics);
 
-    /**
-     * Flush buffered data to disk
-     */
-    void flush();
-
-    /**
-     * Check if file is open and writable
-     */
-    bool is_open() const;
-
     /**
      * Get number of snapshots written
      */
-    size_t get_snapshot_count() const;
-
-private:
-    std::ofstream file_;
-    std::string filename_;
-    size_t snapshot_count_;
-    bool header_written_;
-
-    /**
-     * Write CSV header
-     */
-    void write_header();
-
-    /**
-     * Format double with adaptive precision (no trailing zeros)
-     */
-    std::string format_double(double value) const;
+    size_t get_snapshot_count() const { return get_record_count(); }
 };
 
 /**
  * Multi-file CSV writer - separate file per symbol
+ * E.g., "snapshots.csv" -> "snapshots_BTC_USD.csv"
  */
-class MultiFileSnapshotCSVWriter {
+class MultiFileSnapshotCSVWriter : public MultiFileWriter<SnapshotMetrics, SnapshotCsvCodec> {
 public:
     /**
      * Constructor
      * @param base_filename Base filename (will be appended with symbol)
+     * @param append Append to existing per-symbol files (default: false)
+     * @param sweep_sizes Sweep cost columns to write (ascending)
      */
-    MultiFileSnapshotCSVWriter(const std::string& base_filename);
-
-    /**
-     * Destructor - closes all files
-     */
-    ~MultiFileSnapshotCSVWriter();
+    MultiFileSnapshotCSVWriter(const std::string& base_filename, bool append = false,
+                               const std::vector<double>& sweep_sizes = std::vector<double>());
 
     /**
      * Write snapshot to appropriate file based on symbol
      */
     bool write_snapshot(const SnapshotMetrics& metrics);
 
-    /**
-     * Flush all files
-     */
-    void flush_all();
-
-    /**
-     * Get number of files open
-     */
-    size_t get_file_count() const;
-
     /**
      * Get total snapshots written across all files
      */
-    size_t get_total_snapshot_count() const;
-
-private:
-    std::string base_filename_;
-    std::map<std::string, SnapshotCSVWriter*> writers_;
-
-    /**
-     * Get or create writer for symbol
-     */
-    SnapshotCSVWriter* get_writer(const std::string& symbol);
-
-    /**
-     * Create filename for symbol
-     * E.g., "snapshots_BTC_USD.csv"
-     */
-    std::string create_filename(const std::string& symbol) const;
-
-    /**
-     * Sanitize symbol for filename (replace / with _)
-     */
-    std::string sanitize_symbol(const std::string& symbol) const;
+    size_t get_total_snapshot_count() const { return get_total_record_count(); }
 };
 
 } // namespace kraken
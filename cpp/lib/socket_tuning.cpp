@@ -0,0 +1,109 @@
+/**
+ * Socket Tuning - Implementation
+ */
+
+#include "socket_tuning.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+namespace kraken {
+
+namespace {
+
+#ifdef __linux__
+const int RCVBUF_READBACK_FACTOR = 2;  // getsockopt(SO_RCVBUF) reports twice the request
+#else
+const int RCVBUF_READBACK_FACTOR = 1;
+#endif
+
+bool set_int_option(int fd, int level, int name, int value, const char* label) {
+    if (setsockopt(fd, level, name, &value, sizeof(value)) != 0) {
+        std::cerr << "[Error] setsockopt(" << label << "=" << value << "): "
+                  << std::strerror(errno) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool SocketTuning::apply(int fd, const SocketOptions& options) {
+    bool ok = true;
+
+    if (options.tcp_nodelay) {
+        ok &= set_int_option(fd, IPPROTO_TCP, TCP_NODELAY, 1, "TCP_NODELAY");
+    }
+
+    if (options.rcvbuf_bytes > 0) {
+        if (set_int_option(fd, SOL_SOCKET, SO_RCVBUF, options.rcvbuf_bytes, "SO_RCVBUF")) {
+            // Silently capped at net.core.rmem_max; make that visible.
+            // Linux doubles the request for bookkeeping overhead and reports
+            // the doubled value, so an uncapped buffer reads back as 2x.
+            int effective = get_rcvbuf(fd);
+            long long expected = static_cast<long long>(options.rcvbuf_bytes) * RCVBUF_READBACK_FACTOR;
+            if (effective >= 0 && effective < expected) {
+                std::cerr << "[Warning] SO_RCVBUF capped at " << effective / RCVBUF_READBACK_FACTOR
+                          << " bytes (raise net.core.rmem_max)" << std::endl;
+            }
+        } else {
+            ok = false;
+        }
+    }
+
+#ifdef SO_BUSY_POLL
+    if (options.busy_poll_us > 0) {
+        ok &= set_int_option(fd, SOL_SOCKET, SO_BUSY_POLL, options.busy_poll_us, "SO_BUSY_POLL");
+    }
+#else
+    if (options.busy_poll_us > 0) {
+        std::cerr << "[Error] SO_BUSY_POLL is not supported on this platform" << std::endl;
+        ok = false;
+    }
+#endif
+
+    return ok;
+}
+
+int SocketTuning::get_rcvbuf(int fd) {
+    int value = 0;
+    socklen_t len = sizeof(value);
+    if (getsockopt(fd, SOL_SOCKET, SO_RCVBUF, &value, &len) != 0) {
+        return -1;
+    }
+    return value;
+}
+
+std::string SocketTuning::describe(const SocketOptions& options) {
+    if (options.empty()) {
+        return "default";
+    }
+
+    std::ostringstream oss;
+    const char* sep = "";
+    if (options.tcp_nodelay) {
+        oss << "nodelay";
+        sep = " ";
+    }
+    if (options.rcvbuf_bytes > 0) {
+        oss << sep << "rcvbuf=" << options.rcvbuf_bytes;
+        sep = " ";
+    }
+    if (options.busy_poll_us > 0) {
+        oss << sep << "busy_poll=" << options.busy_poll_us << "us";
+    }
+    return oss.str();
+}
+
+int64_t SocketTuning::realtime_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+} // namespace kraken
@@ -0,0 +1,74 @@
+/**
+ * Socket Tuning
+ *
+ * Receive-path socket options for the WebSocket clients, applied from the
+ * websocketpp socket-init hook once the TCP connection is established:
+ *   TCP_NODELAY   Send (un)subscribe messages without Nagle delay
+ *   SO_RCVBUF     Fixed kernel receive buffer for snapshot bursts
+ *                 (disables receive autotuning; the kernel doubles the value
+ *                 and caps it at net.core.rmem_max)
+ *   SO_BUSY_POLL  Busy-poll the device queue on reads, in microseconds
+ *                 (epoll-driven I/O also needs net.core.busy_poll)
+ *
+ * Receive timestamps: records carry recv_ts_ns, the wall clock taken on the
+ * I/O thread when websocketpp delivers the frame. Kernel SO_TIMESTAMPING
+ * stamps are not used: for TCP they only arrive as recvmsg() control
+ * messages, and asio's read path passes no control buffer.
+ */
+
+#ifndef SOCKET_TUNING_HPP
+#define SOCKET_TUNING_HPP
+
+#include <string>
+#include <cstdint>
+
+namespace kraken {
+
+/**
+ * Requested socket options (defaults leave the socket unchanged)
+ */
+struct SocketOptions {
+    bool tcp_nodelay;   // Disable Nagle
+    int rcvbuf_bytes;   // 0 = kernel default (autotuning)
+    int busy_poll_us;   // 0 = off
+
+    SocketOptions() : tcp_nodelay(false), rcvbuf_bytes(0), busy_poll_us(0) {}
+
+    bool empty() const {
+        return !tcp_nodelay && rcvbuf_bytes <= 0 && busy_poll_us <= 0;
+    }
+};
+
+/**
+ * Socket option helpers
+ */
+class SocketTuning {
+public:
+    /**
+     * Apply options to a connected socket
+     * Failures are reported to stderr and do not abort the connection.
+     * @param fd Native socket handle
+     * @return true if every requested option was applied
+     */
+    static bool apply(int fd, const SocketOptions& options);
+
+    /**
+     * Effective receive buffer size in bytes (-1 on error)
+     * As reported by the kernel: on Linux twice the usable size requested.
+     */
+    static int get_rcvbuf(int fd);
+
+    /**
+     * Describe options for logs, e.g. "nodelay rcvbuf=4194304 busy_poll=50us"
+     */
+    static std::string describe(const SocketOptions& options);
+
+    /**
+     * Wall clock in nanoseconds since the epoch (receive timestamps)
+     */
+    static int64_t realtime_ns();
+};
+
+} // namespace kraken
+
+#endif // SOCKET_TUNING_HPP
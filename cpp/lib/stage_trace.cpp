@@ -0,0 +1,242 @@
+/**
+ * Stage Tracing with Chrome Trace Export - Implementation
+ */
+
+#include "stage_trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <unistd.h>
+
+namespace kraken {
+namespace trace {
+
+namespace {
+    // Registered rings (intrusive list, never freed so dumps stay valid)
+    std::atomic<TraceRing*> g_rings_head(nullptr);
+    std::atomic<uint32_t> g_next_thread_id(1);
+
+    thread_local TraceRing* tl_ring = nullptr;
+
+    // Timestamps in the exported trace are relative to this point
+    const uint64_t g_epoch_ns = now_ns();
+
+    // Signal-driven dump state
+    volatile std::sig_atomic_t g_dump_requested = 0;
+    std::mutex g_dump_mutex;
+    std::condition_variable g_dump_cv;
+    std::thread g_dump_thread;
+    bool g_dump_stop = false;
+    std::string g_dump_filename;
+
+    void on_dump_signal(int) {
+        g_dump_requested = 1;
+    }
+
+    void append_escaped(std::string& out, const char* s) {
+        for (; *s != '\0'; ++s) {
+            if (*s == '"' || *s == '\\') {
+                out += '\\';
+            }
+            out += *s;
+        }
+    }
+}
+
+// ============================================================================
+// TraceRing Implementation
+// ============================================================================
+
+TraceRing::TraceRing(uint32_t thread_id)
+    : head_(0), thread_id_(thread_id), next_(nullptr) {
+    std::snprintf(thread_name_, sizeof(thread_name_), "thread-%u", thread_id);
+}
+
+void TraceRing::snapshot(std::vector<TraceEvent>& out) const {
+    uint64_t head = head_.load(std::memory_order_acquire);
+    uint64_t begin = head > RING_CAPACITY ? head - RING_CAPACITY : 0;
+
+    size_t first = out.size();
+    for (uint64_t i = begin; i < head; i++) {
+        out.push_back(events_[i & (RING_CAPACITY - 1)]);
+    }
+
+    // Anything the producer lapped while we copied is unreliable; the slot
+    // for index `head_now` may be mid-write, so it is excluded as well.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    uint64_t head_now = head_.load(std::memory_order_relaxed);
+    uint64_t safe_begin = head_now >= RING_CAPACITY ? head_now - RING_CAPACITY + 1 : 0;
+
+    if (safe_begin > begin) {
+        size_t drop = static_cast<size_t>(std::min<uint64_t>(safe_begin - begin, head - begin));
+        out.erase(out.begin() + first, out.begin() + first + drop);
+    }
+}
+
+void TraceRing::set_thread_name(const char* name) {
+    std::snprintf(thread_name_, sizeof(thread_name_), "%s", name);
+}
+
+std::string TraceRing::get_thread_name() const {
+    return std::string(thread_name_);
+}
+
+// ============================================================================
+// Recording
+// ============================================================================
+
+uint64_t now_ns() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+TraceRing& thread_ring() {
+    if (tl_ring == nullptr) {
+        TraceRing* ring = new TraceRing(g_next_thread_id.fetch_add(1));
+
+        TraceRing* head = g_rings_head.load(std::memory_order_relaxed);
+        do {
+            ring->set_next(head);
+        } while (!g_rings_head.compare_exchange_weak(head, ring,
+                                                     std::memory_order_release,
+                                                     std::memory_order_relaxed));
+        tl_ring = ring;
+    }
+    return *tl_ring;
+}
+
+void set_thread_name(const char* name) {
+    thread_ring().set_thread_name(name);
+}
+
+bool tracing_enabled() {
+#ifdef KRAKEN_STAGE_TRACING
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ============================================================================
+// Chrome Trace Export
+// ============================================================================
+
+bool dump_chrome_trace(const std::string& filename) {
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "[Error] Cannot open trace file: " << filename << std::endl;
+        return false;
+    }
+
+    const long pid = static_cast<long>(::getpid());
+    std::vector<TraceEvent> events;
+    events.reserve(RING_CAPACITY);
+
+    std::string line;
+    char buffer[128];
+    bool first = true;
+    size_t total = 0;
+
+    file << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+
+    for (TraceRing* ring = g_rings_head.load(std::memory_order_acquire);
+         ring != nullptr; ring = ring->next()) {
+
+        // Thread name metadata
+        line.clear();
+        line += first ? "" : ",\n";
+        first = false;
+        line += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":";
+        line += std::to_string(pid);
+        line += ",\"tid\":";
+        line += std::to_string(ring->thread_id());
+        line += ",\"args\":{\"name\":\"";
+        append_escaped(line, ring->get_thread_name().c_str());
+        line += "\"}}";
+        file << line;
+
+        events.clear();
+        ring->snapshot(events);
+
+        for (const auto& event : events) {
+            // Chrome trace timestamps are microseconds
+            double ts_us = static_cast<double>(
+                static_cast<int64_t>(event.start_ns - g_epoch_ns)) / 1000.0;
+            double dur_us = static_cast<double>(event.duration_ns) / 1000.0;
+
+            line.clear();
+            line += ",\n{\"name\":\"";
+            append_escaped(line, event.name);
+            std::snprintf(buffer, sizeof(buffer),
+                          "\",\"cat\":\"kraken\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%u}",
+                          ts_us, dur_us, pid, ring->thread_id());
+            line += buffer;
+            file << line;
+        }
+        total += events.size();
+    }
+
+    file << "\n]}\n";
+    file.close();
+
+    if (!file) {
+        std::cerr << "[Error] Failed writing trace file: " << filename << std::endl;
+        return false;
+    }
+
+    std::cout << "[TRACE] Wrote " << total << " events to " << filename << std::endl;
+    return true;
+}
+
+// ============================================================================
+// Signal-triggered dump
+// ============================================================================
+
+bool install_signal_dump(int signum, const std::string& filename) {
+    std::lock_guard<std::mutex> lock(g_dump_mutex);
+    if (g_dump_thread.joinable()) {
+        return false;
+    }
+
+    g_dump_filename = filename;
+    g_dump_stop = false;
+    std::signal(signum, on_dump_signal);
+
+    g_dump_thread = std::thread([]() {
+        std::unique_lock<std::mutex> lock(g_dump_mutex);
+        while (!g_dump_stop) {
+            g_dump_cv.wait_for(lock, std::chrono::milliseconds(100));
+            if (g_dump_requested) {
+                g_dump_requested = 0;
+                std::string filename = g_dump_filename;
+                lock.unlock();
+                dump_chrome_trace(filename);
+                lock.lock();
+            }
+        }
+    });
+
+    return true;
+}
+
+void stop_signal_dump() {
+    {
+        std::lock_guard<std::mutex> lock(g_dump_mutex);
+        if (!g_dump_thread.joinable()) {
+            return;
+        }
+        g_dump_stop = true;
+    }
+    g_dump_cv.notify_all();
+    g_dump_thread.join();
+}
+
+} // namespace trace
+} // namespace kraken
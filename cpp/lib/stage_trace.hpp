@@ -0,0 +1,189 @@
+/**
+ * Stage Tracing with Chrome Trace Export
+ *
+ * Compile-time optional trace points for the per-message stages (parse,
+ * stats locking, callbacks, flush, segment rotation). Build with
+ * -DKRAKEN_STAGE_TRACING=ON to enable; otherwise KRAKEN_TRACE_SCOPE expands
+ * to nothing and no code is generated.
+ *
+ * Each thread writes fixed-size events into its own lock-free ring (the
+ * oldest events are overwritten). Rings are dumped on demand or on a signal
+ * into the Chrome trace event JSON format, which loads directly in
+ * chrome://tracing and https://ui.perfetto.dev.
+ *
+ * Usage:
+ *   void KrakenBookClient::process_book_message(const std::string& payload) {
+ *       KRAKEN_TRACE_SCOPE("book.parse");
+ *       ...
+ *   }
+ *
+ *   trace::install_signal_dump(SIGUSR1, "trace.json");  // kill -USR1 <pid>
+ *   ...
+ *   trace::dump_chrome_trace("trace.json");             // on demand
+ */
+
+#ifndef STAGE_TRACE_HPP
+#define STAGE_TRACE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace kraken {
+namespace trace {
+
+/**
+ * Single completed stage (fixed size, no owned memory)
+ * Names must be string literals or otherwise outlive the process.
+ */
+struct TraceEvent {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+/**
+ * Events kept per thread before the oldest are overwritten
+ */
+constexpr size_t RING_CAPACITY = 1 << 15;  // 32768 events, 768 KB per thread
+
+/**
+ * Single-producer ring owned by one thread
+ *
+ * The owning thread pushes without locks; readers copy a consistent window
+ * by re-checking the head after the copy and discarding overwritten slots.
+ */
+class TraceRing {
+public:
+    explicit TraceRing(uint32_t thread_id);
+
+    // Disable copy
+    TraceRing(const TraceRing&) = delete;
+    TraceRing& operator=(const TraceRing&) = delete;
+
+    /**
+     * Append event (owning thread only)
+     */
+    void push(const char* name, uint64_t start_ns, uint64_t duration_ns) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        TraceEvent& slot = events_[head & (RING_CAPACITY - 1)];
+        slot.name = name;
+        slot.start_ns = start_ns;
+        slot.duration_ns = duration_ns;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * Copy the events currently held in the ring (any thread)
+     */
+    void snapshot(std::vector<TraceEvent>& out) const;
+
+    /**
+     * Set display name for this thread in the exported trace
+     */
+    void set_thread_name(const char* name);
+    std::string get_thread_name() const;
+
+    uint32_t thread_id() const { return thread_id_; }
+    uint64_t total_events() const { return head_.load(std::memory_order_acquire); }
+
+    TraceRing* next() const { return next_; }
+    void set_next(TraceRing* next) { next_ = next; }
+
+private:
+    TraceEvent events_[RING_CAPACITY];
+    std::atomic<uint64_t> head_;
+    uint32_t thread_id_;
+    char thread_name_[32];
+    TraceRing* next_;
+};
+
+/**
+ * Monotonic clock in nanoseconds
+ */
+uint64_t now_ns();
+
+/**
+ * Ring for the calling thread (created and registered on first use)
+ */
+TraceRing& thread_ring();
+
+/**
+ * Record a completed stage on the calling thread
+ */
+inline void record(const char* name, uint64_t start_ns, uint64_t end_ns) {
+    thread_ring().push(name, start_ns, end_ns - start_ns);
+}
+
+/**
+ * Name the calling thread in exported traces (e.g. "io", "writer")
+ */
+void set_thread_name(const char* name);
+
+/**
+ * RAII trace point: records one complete event for the enclosing block
+ */
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name_(name), start_ns_(now_ns()) {}
+    ~TraceScope() { record(name_, start_ns_, now_ns()); }
+
+    // Disable copy
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t start_ns_;
+};
+
+/**
+ * True when built with KRAKEN_STAGE_TRACING
+ */
+bool tracing_enabled();
+
+/**
+ * Write all rings to a Chrome/Perfetto trace JSON file
+ * @return true on success
+ */
+bool dump_chrome_trace(const std::string& filename);
+
+/**
+ * Dump to filename whenever signum is delivered (e.g. SIGUSR1)
+ *
+ * The signal handler only sets a flag; a background thread performs the
+ * dump so no I/O happens in signal context.
+ * @return false if a signal dump is already installed
+ */
+bool install_signal_dump(int signum, const std::string& filename);
+
+/**
+ * Stop the background dump thread started by install_signal_dump()
+ */
+void stop_signal_dump();
+
+} // namespace trace
+} // namespace kraken
+
+#ifdef KRAKEN_STAGE_TRACING
+
+#define KRAKEN_TRACE_CONCAT_INNER(a, b) a##b
+#define KRAKEN_TRACE_CONCAT(a, b) KRAKEN_TRACE_CONCAT_INNER(a, b)
+
+// Record the enclosing block as one stage
+#define KRAKEN_TRACE_SCOPE(name) \
+    ::kraken::trace::TraceScope KRAKEN_TRACE_CONCAT(kraken_trace_scope_, __LINE__)(name)
+
+// Label the calling thread in exported traces
+#define KRAKEN_TRACE_THREAD_NAME(name) ::kraken::trace::set_thread_name(name)
+
+#else
+
+#define KRAKEN_TRACE_SCOPE(name) ((void)0)
+#define KRAKEN_TRACE_THREAD_NAME(name) ((void)0)
+
+#endif // KRAKEN_STAGE_TRACING
+
+#endif // STAGE_TRACE_HPP
@@ -0,0 +1,385 @@
+/**
+ * Dynamic Symbol Universe - Implementation
+ */
+
+#include "symbol_universe.hpp"
+#include "cli_utils.hpp"
+#include "kraken_common.hpp"
+#include <iostream>
+
+namespace kraken {
+
+SymbolUniverse::SymbolUniverse(size_t max_symbols_per_message,
+                               std::chrono::milliseconds min_message_interval)
+    : max_symbols_per_message_(max_symbols_per_message > 0 ? max_symbols_per_message : 1),
+      min_message_interval_(min_message_interval),
+      ack_timeout_(std::chrono::seconds(10)),
+      max_attempts_(3),
+      last_message_time_(),
+      messages_sent_(0), acks_(0), nacks_(0), timeouts_(0), reloads_(0) {
+}
+
+// ============================================================================
+// Desired set
+// ============================================================================
+
+bool SymbolUniverse::load(const std::string& spec) {
+    auto result = cli::InputParser::parse(spec);
+    if (!result.success) {
+        std::cerr << "[Error] Cannot load symbol universe: " << result.error_message << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    spec_ = spec;
+    desired_ = std::set<std::string>(result.values.begin(), result.values.end());
+    return true;
+}
+
+bool SymbolUniverse::reload() {
+    std::string spec;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        spec = spec_;
+    }
+
+    if (spec.empty()) {
+        std::cerr << "[Error] Cannot reload symbol universe: no specification loaded" << std::endl;
+        return false;
+    }
+
+    // Parse outside the lock (may read a large file)
+    auto result = cli::InputParser::parse(spec);
+    if (!result.success) {
+        std::cerr << "[Error] Cannot reload symbol universe: " << result.error_message << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    desired_ = std::set<std::string>(result.values.begin(), result.values.end());
+    reloads_++;
+
+    // Give rejected symbols another chance
+    for (auto it = symbols_.begin(); it != symbols_.end(); ) {
+        if (it->second.state == SymbolState::FAILED) {
+            it = symbols_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return true;
+}
+
+void SymbolUniverse::set_desired(const std::vector<std::string>& symbols) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    desired_ = std::set<std::string>(symbols.begin(), symbols.end());
+}
+
+void SymbolUniverse::add_desired(const std::vector<std::string>& symbols) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    desired_.insert(symbols.begin(), symbols.end());
+}
+
+void SymbolUniverse::remove_desired(const std::vector<std::string>& symbols) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& symbol : symbols) {
+        desired_.erase(symbol);
+    }
+}
+
+std::vector<std::string> SymbolUniverse::get_desired() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::vector<std::string>(desired_.begin(), desired_.end());
+}
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+void SymbolUniverse::set_max_symbols_per_message(size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    max_symbols_per_message_ = count > 0 ? count : 1;
+}
+
+void SymbolUniverse::set_min_message_interval(std::chrono::milliseconds interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    min_message_interval_ = interval;
+}
+
+void SymbolUniverse::set_ack_timeout(std::chrono::milliseconds timeout, int max_attempts) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ack_timeout_ = timeout;
+    max_attempts_ = max_attempts > 0 ? max_attempts : 1;
+}
+
+std::chrono::milliseconds SymbolUniverse::get_min_message_interval() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return min_message_interval_;
+}
+
+// ============================================================================
+// Client side
+// ============================================================================
+
+bool SymbolUniverse::next_batch(Clock::time_point now, Batch& batch) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    reconcile_locked();
+    expire_in_flight_locked(now);
+
+    // Rate limit: at most one message per interval
+    if (now - last_message_time_ < min_message_interval_) {
+        return false;
+    }
+
+    if (fill_batch_locked(SymbolState::PENDING_UNSUBSCRIBE, Action::UNSUBSCRIBE, now, batch) ||
+        fill_batch_locked(SymbolState::PENDING_SUBSCRIBE, Action::SUBSCRIBE, now, batch)) {
+        last_message_time_ = now;
+        messages_sent_++;
+        return true;
+    }
+
+    return false;
+}
+
+bool SymbolUniverse::handle_ack(Action action, const std::string& symbol,
+                                bool success, const std::string& error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = symbols_.find(symbol);
+    if (it == symbols_.end()) {
+        return false;
+    }
+
+    SymbolStatus& status = it->second;
+
+    if (action == Action::SUBSCRIBE) {
+        if (status.state != SymbolState::PENDING_SUBSCRIBE) {
+            return true;  // Late ack for a request we already gave up on
+        }
+
+        // "Already subscribed" means the server has it, which is what we want
+        if (success || error.find("lready subscribed") != std::string::npos) {
+            acks_++;
+            status.state = SymbolState::SUBSCRIBED;
+            status.last_error.clear();
+        } else {
+            nacks_++;
+            status.state = SymbolState::FAILED;
+            status.last_error = error;
+            std::cerr << "[UNIVERSE] Subscribe rejected for " << symbol
+                      << ": " << error << std::endl;
+        }
+        status.in_flight = false;
+        status.attempts = 0;
+        return true;
+    }
+
+    if (status.state != SymbolState::PENDING_UNSUBSCRIBE) {
+        return true;
+    }
+
+    // A failed unsubscribe almost always means the server no longer has the
+    // subscription ("Subscription Not Found"), so the symbol is gone either way
+    if (success) {
+        acks_++;
+    } else {
+        nacks_++;
+        std::cerr << "[UNIVERSE] Unsubscribe rejected for " << symbol
+                  << ": " << error << std::endl;
+    }
+    symbols_.erase(it);
+    return true;
+}
+
+bool SymbolUniverse::handle_message(const std::string& payload) {
+    // Data messages carry "channel", acks carry "method"
+    if (!SimpleJsonParser::contains(payload, "method")) {
+        return false;
+    }
+
+    std::string method = SimpleJsonParser::extract_string(payload, "method");
+    Action action;
+    if (method == "subscribe") {
+        action = Action::SUBSCRIBE;
+    } else if (method == "unsubscribe") {
+        action = Action::UNSUBSCRIBE;
+    } else {
+        return false;
+    }
+
+    // Success acks nest the symbol under "result", failures carry it at top
+    // level; both are the first "symbol" key in the payload
+    std::string symbol = SimpleJsonParser::extract_string(payload, "symbol");
+    bool success = payload.find("\"success\":true") != std::string::npos;
+    std::string error = SimpleJsonParser::extract_string(payload, "error");
+
+    if (!symbol.empty()) {
+        handle_ack(action, symbol, success, error);
+    }
+    return true;
+}
+
+void SymbolUniverse::on_disconnected() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    for (auto it = symbols_.begin(); it != symbols_.end(); ) {
+        SymbolStatus& status = it->second;
+
+        if (status.state == SymbolState::PENDING_UNSUBSCRIBE) {
+            it = symbols_.erase(it);  // Nothing left to unsubscribe from
+            continue;
+        }
+
+        if (status.state != SymbolState::FAILED) {
+            status.state = SymbolState::PENDING_SUBSCRIBE;
+            status.in_flight = false;
+            status.attempts = 0;
+        }
+        ++it;
+    }
+
+    last_message_time_ = Clock::time_point();  // First message on the new connection goes out immediately
+}
+
+// ============================================================================
+// Queries
+// ============================================================================
+
+std::vector<std::string> SymbolUniverse::get_active_symbols() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    std::vector<std::string> active;
+    for (const auto& entry : symbols_) {
+        if (entry.second.state == SymbolState::SUBSCRIBED ||
+            entry.second.state == SymbolState::PENDING_SUBSCRIBE) {
+            active.push_back(entry.first);
+        }
+    }
+    return active;
+}
+
+std::map<std::string, SymbolUniverse::SymbolStatus> SymbolUniverse::get_symbol_status() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return symbols_;
+}
+
+SymbolUniverse::UniverseStats SymbolUniverse::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    UniverseStats stats = {};
+    stats.desired = desired_.size();
+    for (const auto& entry : symbols_) {
+        switch (entry.second.state) {
+            case SymbolState::PENDING_SUBSCRIBE:   stats.pending_subscribe++; break;
+            case SymbolState::SUBSCRIBED:          stats.subscribed++; break;
+            case SymbolState::PENDING_UNSUBSCRIBE: stats.pending_unsubscribe++; break;
+            case SymbolState::FAILED:              stats.failed++; break;
+        }
+    }
+    stats.messages_sent = messages_sent_;
+    stats.acks = acks_;
+    stats.nacks = nacks_;
+    stats.timeouts = timeouts_;
+    stats.reloads = reloads_;
+    return stats;
+}
+
+const char* SymbolUniverse::state_name(SymbolState state) {
+    switch (state) {
+        case SymbolState::PENDING_SUBSCRIBE:   return "pending_subscribe";
+        case SymbolState::SUBSCRIBED:          return "subscribed";
+        case SymbolState::PENDING_UNSUBSCRIBE: return "pending_unsubscribe";
+        case SymbolState::FAILED:              return "failed";
+    }
+    return "unknown";
+}
+
+// ============================================================================
+// Private helpers
+// ============================================================================
+
+void SymbolUniverse::reconcile_locked() {
+    // Wanted but unknown -> subscribe; wanted but leaving -> keep if not yet sent
+    for (const auto& symbol : desired_) {
+        auto it = symbols_.find(symbol);
+        if (it == symbols_.end()) {
+            symbols_.emplace(symbol, SymbolStatus());
+        } else if (it->second.state == SymbolState::PENDING_UNSUBSCRIBE && !it->second.in_flight) {
+            it->second.state = SymbolState::SUBSCRIBED;
+            it->second.attempts = 0;
+        }
+    }
+
+    // Known but unwanted -> unsubscribe (in-flight subscribes finish first)
+    for (auto it = symbols_.begin(); it != symbols_.end(); ) {
+        if (desired_.count(it->first) > 0) {
+            ++it;
+            continue;
+        }
+
+        SymbolStatus& status = it->second;
+        if (status.state == SymbolState::FAILED ||
+            (status.state == SymbolState::PENDING_SUBSCRIBE && !status.in_flight)) {
+            it = symbols_.erase(it);
+            continue;
+        }
+        if (status.state == SymbolState::SUBSCRIBED) {
+            status.state = SymbolState::PENDING_UNSUBSCRIBE;
+            status.in_flight = false;
+            status.attempts = 0;
+        }
+        ++it;
+    }
+}
+
+void SymbolUniverse::expire_in_flight_locked(Clock::time_point now) {
+    for (auto it = symbols_.begin(); it != symbols_.end(); ) {
+        SymbolStatus& status = it->second;
+        if (!status.in_flight || now - status.last_sent < ack_timeout_) {
+            ++it;
+            continue;
+        }
+
+        timeouts_++;
+        status.in_flight = false;
+
+        if (status.attempts >= max_attempts_) {
+            if (status.state == SymbolState::PENDING_UNSUBSCRIBE) {
+                it = symbols_.erase(it);
+                continue;
+            }
+            status.state = SymbolState::FAILED;
+            status.last_error = "No acknowledgement";
+            std::cerr << "[UNIVERSE] No acknowledgement for " << it->first
+                      << " after " << status.attempts << " attempt(s)" << std::endl;
+        }
+        ++it;
+    }
+}
+
+bool SymbolUniverse::fill_batch_locked(SymbolState state, Action action,
+                                       Clock::time_point now, Batch& batch) {
+    batch.action = action;
+    batch.symbols.clear();
+
+    for (auto& entry : symbols_) {
+        SymbolStatus& status = entry.second;
+        if (status.state != state || status.in_flight) {
+            continue;
+        }
+
+        status.in_flight = true;
+        status.attempts++;
+        status.last_sent = now;
+        batch.symbols.push_back(entry.first);
+
+        if (batch.symbols.size() >= max_symbols_per_message_) {
+            break;
+        }
+    }
+
+    return !batch.symbols.empty();
+}
+
+} // namespace kraken
@@ -0,0 +1,234 @@
+/**
+ * Dynamic Symbol Universe
+ *
+ * Tracks the set of symbols a WebSocket client should be subscribed to and
+ * reconciles it against what the server has acknowledged. The desired set can
+ * come from any cli::InputParser specification (direct list, CSV or text file)
+ * and can be reloaded at runtime without reconnecting.
+ *
+ * Threading model:
+ * - Desired set changes (load/reload/set/add/remove) may come from any thread
+ * - next_batch(), handle_ack() and on_disconnected() are called by the
+ *   client's I/O thread only, so all sends happen on the I/O thread
+ * - All state is protected by an internal mutex (cold path, a few calls/sec)
+ *
+ * Per-symbol lifecycle:
+ *   (absent) -> PENDING_SUBSCRIBE -> SUBSCRIBED -> PENDING_UNSUBSCRIBE -> (absent)
+ *                      |
+ *                      +-> FAILED (rejected, retried on next reload)
+ *
+ * Usage:
+ *   auto universe = std::make_shared<SymbolUniverse>();
+ *   universe->load("pairs.txt:100");
+ *   client.set_symbol_universe(universe);
+ *   client.start({});
+ *   ...
+ *   universe->reload();   // e.g. on SIGHUP; diff is applied in batches
+ */
+
+#ifndef SYMBOL_UNIVERSE_HPP
+#define SYMBOL_UNIVERSE_HPP
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <cstdint>
+
+namespace kraken {
+
+/**
+ * Desired-vs-subscribed symbol tracker with batched, rate-limited diffs
+ */
+class SymbolUniverse {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class SymbolState {
+        PENDING_SUBSCRIBE,      // Wanted, subscribe queued or awaiting ack
+        SUBSCRIBED,             // Server acknowledged subscription
+        PENDING_UNSUBSCRIBE,    // No longer wanted, unsubscribe queued or awaiting ack
+        FAILED                  // Server rejected subscription (or no ack after retries)
+    };
+
+    enum class Action {
+        SUBSCRIBE,
+        UNSUBSCRIBE
+    };
+
+    /**
+     * Per-symbol tracking state
+     */
+    struct SymbolStatus {
+        SymbolState state;
+        bool in_flight;             // Request sent, ack not yet received
+        int attempts;               // Sends since last ack
+        std::string last_error;
+        Clock::time_point last_sent;
+
+        SymbolStatus()
+            : state(SymbolState::PENDING_SUBSCRIBE), in_flight(false), attempts(0) {}
+    };
+
+    /**
+     * One subscribe or unsubscribe message worth of symbols
+     */
+    struct Batch {
+        Action action;
+        std::vector<std::string> symbols;
+    };
+
+    /**
+     * Aggregate counters
+     */
+    struct UniverseStats {
+        size_t desired;
+        size_t subscribed;
+        size_t pending_subscribe;
+        size_t pending_unsubscribe;
+        size_t failed;
+        uint64_t messages_sent;
+        uint64_t acks;
+        uint64_t nacks;
+        uint64_t timeouts;
+        uint64_t reloads;
+    };
+
+    /**
+     * Constructor
+     * @param max_symbols_per_message Maximum symbols in one (un)subscribe message
+     * @param min_message_interval Minimum spacing between consecutive messages
+     */
+    explicit SymbolUniverse(size_t max_symbols_per_message = 50,
+                            std::chrono::milliseconds min_message_interval = std::chrono::milliseconds(500));
+
+    // Disable copy
+    SymbolUniverse(const SymbolUniverse&) = delete;
+    SymbolUniverse& operator=(const SymbolUniverse&) = delete;
+
+    // ========================================================================
+    // Desired set (any thread)
+    // ========================================================================
+
+    /**
+     * Load desired set from an InputParser specification
+     * The specification is remembered for reload()
+     * @param spec Direct list, CSV file (path:column[:limit]) or text file (path[:limit])
+     * @return false if the specification cannot be parsed (desired set unchanged)
+     */
+    bool load(const std::string& spec);
+
+    /**
+     * Re-read the specification given to load()
+     * FAILED symbols that are still desired get another attempt.
+     * @return false if nothing was loaded before or parsing failed
+     */
+    bool reload();
+
+    /**
+     * Replace / extend / shrink the desired set directly
+     */
+    void set_desired(const std::vector<std::string>& symbols);
+    void add_desired(const std::vector<std::string>& symbols);
+    void remove_desired(const std::vector<std::string>& symbols);
+
+    std::vector<std::string> get_desired() const;
+
+    // ========================================================================
+    // Configuration
+    // ========================================================================
+
+    void set_max_symbols_per_message(size_t count);
+    void set_min_message_interval(std::chrono::milliseconds interval);
+
+    /**
+     * Resend a request when no ack arrives within timeout
+     * After max_attempts unanswered sends the symbol is marked FAILED.
+     */
+    void set_ack_timeout(std::chrono::milliseconds timeout, int max_attempts = 3);
+
+    std::chrono::milliseconds get_min_message_interval() const;
+
+    // ========================================================================
+    // Client side (I/O thread)
+    // ========================================================================
+
+    /**
+     * Next message to send, honoring batch size and rate limit
+     * Unsubscribes are sent before subscribes to free server-side capacity.
+     * @param now Current time
+     * @param batch Filled when a message should be sent
+     * @return true if batch was filled
+     */
+    bool next_batch(Clock::time_point now, Batch& batch);
+
+    /**
+     * Apply a per-symbol acknowledgement
+     * @param action Acknowledged method
+     * @param symbol Symbol named in the ack
+     * @param success Value of the "success" field
+     * @param error Error text for failed requests
+     * @return true if the symbol was tracked
+     */
+    bool handle_ack(Action action, const std::string& symbol,
+                    bool success, const std::string& error);
+
+    /**
+     * Inspect a raw message and apply it if it is an (un)subscribe ack
+     * For clients without their own response parsing.
+     * @return true if the payload was an ack
+     */
+    bool handle_message(const std::string& payload);
+
+    /**
+     * Connection lost: server-side subscriptions are gone
+     * Everything still desired is re-subscribed on the next connection.
+     */
+    void on_disconnected();
+
+    // ========================================================================
+    // Queries (any thread)
+    // ========================================================================
+
+    /**
+     * Symbols subscribed or being subscribed
+     */
+    std::vector<std::string> get_active_symbols() const;
+
+    std::map<std::string, SymbolStatus> get_symbol_status() const;
+    UniverseStats get_stats() const;
+
+    static const char* state_name(SymbolState state);
+
+private:
+    mutable std::mutex mutex_;
+
+    std::string spec_;
+    std::set<std::string> desired_;
+    std::map<std::string, SymbolStatus> symbols_;
+
+    size_t max_symbols_per_message_;
+    std::chrono::milliseconds min_message_interval_;
+    std::chrono::milliseconds ack_timeout_;
+    int max_attempts_;
+    Clock::time_point last_message_time_;
+
+    // Counters
+    uint64_t messages_sent_;
+    uint64_t acks_;
+    uint64_t nacks_;
+    uint64_t timeouts_;
+    uint64_t reloads_;
+
+    // Must be called with mutex_ held
+    void reconcile_locked();
+    void expire_in_flight_locked(Clock::time_point now);
+    bool fill_batch_locked(SymbolState state, Action action,
+                           Clock::time_point now, Batch& batch);
+};
+
+} // namespace kraken
+
+#endif // SYMBOL_UNIVERSE_HPP
@@ -0,0 +1,204 @@
+/**
+ * Thread Placement - Implementation
+ */
+
+#include "thread_placement.hpp"
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+
+namespace kraken {
+
+namespace {
+
+bool parse_int(const std::string& text, int& value) {
+    if (text.empty()) {
+        return false;
+    }
+    try {
+        size_t pos = 0;
+        value = std::stoi(text, &pos);
+        return pos == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// "3", "2-3", "0,2,4" or "any"
+bool parse_cpus(const std::string& text, std::vector<int>& cpus) {
+    cpus.clear();
+    if (text.empty() || text == "any") {
+        return true;
+    }
+
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t dash = item.find('-');
+        int first = 0;
+        int last = 0;
+        if (dash == std::string::npos) {
+            if (!parse_int(item, first)) return false;
+            last = first;
+        } else if (!parse_int(item.substr(0, dash), first) ||
+                   !parse_int(item.substr(dash + 1), last)) {
+            return false;
+        }
+        if (first < 0 || last < first) {
+            return false;
+        }
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return !cpus.empty();
+}
+
+const char* policy_name(int policy) {
+    switch (policy) {
+        case SCHED_FIFO: return "fifo";
+        case SCHED_RR: return "rr";
+#ifdef SCHED_BATCH
+        case SCHED_BATCH: return "batch";
+#endif
+#ifdef SCHED_IDLE
+        case SCHED_IDLE: return "idle";
+#endif
+        default: return "other";
+    }
+}
+
+bool parse_policy(const std::string& name, int& policy) {
+    if (name == "other") {
+        policy = SCHED_OTHER;
+    } else if (name == "fifo") {
+        policy = SCHED_FIFO;
+    } else if (name == "rr") {
+        policy = SCHED_RR;
+#ifdef SCHED_BATCH
+    } else if (name == "batch") {
+        policy = SCHED_BATCH;
+#endif
+#ifdef SCHED_IDLE
+    } else if (name == "idle") {
+        policy = SCHED_IDLE;
+#endif
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool is_realtime(int policy) {
+    return policy == SCHED_FIFO || policy == SCHED_RR;
+}
+
+} // namespace
+
+ThreadPlacement::ThreadPlacement() : policy(SCHED_OTHER), priority(0) {}
+
+bool ThreadPlacement::empty() const {
+    return cpus.empty() && policy == SCHED_OTHER;
+}
+
+bool ThreadPlacement::apply(const std::string& label, size_t index) const {
+    bool ok = true;
+
+    if (!cpus.empty()) {
+#ifdef __linux__
+        int cpu = cpus[index % cpus.size()];
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc != 0) {
+            std::cerr << "[Error] " << label << ": cannot pin to CPU " << cpu << ": "
+                      << std::strerror(rc) << std::endl;
+            ok = false;
+        }
+#else
+        std::cerr << "[Error] " << label << ": CPU affinity is not supported on this platform" << std::endl;
+        ok = false;
+#endif
+    }
+
+    if (policy != SCHED_OTHER) {
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = is_realtime(policy) ? priority : 0;
+        int rc = pthread_setschedparam(pthread_self(), policy, &param);
+        if (rc != 0) {
+            std::cerr << "[Error] " << label << ": cannot set scheduling policy "
+                      << policy_name(policy) << ": " << std::strerror(rc) << std::endl;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+std::string ThreadPlacement::describe() const {
+    if (empty()) {
+        return "default";
+    }
+
+    std::ostringstream oss;
+    if (cpus.empty()) {
+        oss << "cpu any";
+    } else {
+        oss << "cpu ";
+        for (size_t i = 0; i < cpus.size(); ++i) {
+            oss << (i > 0 ? "," : "") << cpus[i];
+        }
+    }
+    if (policy != SCHED_OTHER) {
+        oss << " " << policy_name(policy);
+        if (is_realtime(policy)) {
+            oss << ":" << priority;
+        }
+    }
+    return oss.str();
+}
+
+bool ThreadPlacement::parse(const std::string& spec, ThreadPlacement& placement, std::string& error_message) {
+    placement = ThreadPlacement();
+
+    std::vector<std::string> parts;
+    std::istringstream stream(spec);
+    std::string part;
+    while (std::getline(stream, part, ':')) {
+        parts.push_back(part);
+    }
+    if (parts.empty() || parts.size() > 3) {
+        error_message = "invalid thread placement '" + spec + "' (expected CPUS[:POLICY[:PRIORITY]])";
+        return false;
+    }
+
+    if (!parse_cpus(parts[0], placement.cpus)) {
+        error_message = "invalid CPU list '" + parts[0] + "' (e.g. 3, 2-3, 0,2,4 or any)";
+        return false;
+    }
+
+    if (parts.size() > 1 && !parse_policy(parts[1], placement.policy)) {
+        error_message = "unknown scheduling policy '" + parts[1] + "' (other, batch, idle, fifo, rr)";
+        return false;
+    }
+
+    if (is_realtime(placement.policy)) {
+        placement.priority = 1;
+        if (parts.size() > 2 &&
+            (!parse_int(parts[2], placement.priority) || placement.priority < 1 || placement.priority > 99)) {
+            error_message = "invalid priority '" + parts[2] + "' (1-99)";
+            return false;
+        }
+    } else if (parts.size() > 2) {
+        error_message = "priority is only valid with fifo or rr";
+        return false;
+    }
+
+    return true;
+}
+
+} // namespace kraken
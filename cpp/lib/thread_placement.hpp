@@ -0,0 +1,89 @@
+/**
+ * Thread Placement
+ *
+ * CPU affinity and scheduling policy for the I/O, writer and consumer
+ * threads, plus the busy-poll I/O loop.
+ *
+ * Spec format: CPUS[:POLICY[:PRIORITY]]
+ *   CPUS      "any", "3", "2-3" or "0,2,4" (thread i of a role is pinned to
+ *             the i-th listed CPU, wrapping around)
+ *   POLICY    other | batch | idle | fifo | rr
+ *   PRIORITY  1-99, fifo / rr only (default 1; needs CAP_SYS_NICE)
+ *
+ * Examples: "3", "2-3:fifo:50", "any:batch"
+ *
+ * Pinning keeps a thread on one core (no migrations, warm caches). Busy-poll
+ * makes an I/O thread spin on poll() instead of sleeping in run(), which
+ * removes the wakeup latency but burns its core - use it on dedicated,
+ * pinned cores only.
+ */
+
+#ifndef THREAD_PLACEMENT_HPP
+#define THREAD_PLACEMENT_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace kraken {
+
+/**
+ * Affinity and scheduling for one thread role
+ */
+struct ThreadPlacement {
+    std::vector<int> cpus;  // Empty = any CPU
+    int policy;             // SCHED_* (default SCHED_OTHER)
+    int priority;           // Static priority for SCHED_FIFO / SCHED_RR
+
+    ThreadPlacement();
+
+    bool empty() const;
+
+    /**
+     * Apply to the calling thread
+     * Failures are reported to stderr; the thread keeps running unpinned.
+     * @param label Thread role for messages (e.g. "book_io")
+     * @param index Thread index within the role (selects the CPU)
+     * @return true if everything requested was applied
+     */
+    bool apply(const std::string& label, size_t index = 0) const;
+
+    /**
+     * Describe for logs, e.g. "cpu 2,3 fifo:50" or "default"
+     */
+    std::string describe() const;
+
+    /**
+     * Parse a placement spec (see file header)
+     * @return false with error_message set on invalid input
+     */
+    static bool parse(const std::string& spec, ThreadPlacement& placement, std::string& error_message);
+
+    /**
+     * Run an io_service or websocketpp endpoint until it runs out of work
+     * or is stopped; busy_poll spins on poll() instead of blocking in run()
+     */
+    template <typename Service>
+    static void run_io(Service& service, bool busy_poll) {
+        if (!busy_poll) {
+            service.run();
+            return;
+        }
+        while (!service.stopped()) {
+            if (service.poll() == 0) {
+                cpu_relax();
+            }
+        }
+    }
+
+private:
+    static void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+};
+
+} // namespace kraken
+
+#endif // THREAD_PLACEMENT_HPP
@@ -0,0 +1,125 @@
+/**
+ * Ticker Bars - Implementation
+ */
+
+#include "ticker_bars.hpp"
+#include <cmath>
+#include <algorithm>
+
+namespace kraken {
+
+TickerBarBuilder::TickerBarBuilder(const std::vector<int>& intervals, BarCallback on_bar)
+    : intervals_(intervals), on_bar_(on_bar), out_of_order_(0), bar_count_(0) {}
+
+TickerBarBuilder::SymbolBars& TickerBarBuilder::get_symbol(const std::string& symbol) {
+    auto it = symbols_.find(symbol);
+    if (it != symbols_.end()) {
+        return it->second;
+    }
+
+    SymbolBars& state = symbols_[symbol];
+    state.bars.resize(intervals_.size());
+    for (size_t i = 0; i < intervals_.size(); i++) {
+        state.bars[i].bar.symbol = symbol;
+        state.bars[i].bar.interval_seconds = intervals_[i];
+    }
+    return state;
+}
+
+void TickerBarBuilder::add(const std::string& symbol, double time, double bid, double ask,
+                           double last, double volume_24h) {
+    SymbolBars& state = get_symbol(symbol);
+    if (time < state.last_time) {
+        out_of_order_++;
+        return;
+    }
+    state.last_time = time;
+
+    // Volume traded since the previous tick, from the rolling 24h volume
+    double volume_delta = 0.0;
+    if (volume_24h >= 0) {
+        if (state.last_volume >= 0 && volume_24h > state.last_volume) {
+            volume_delta = volume_24h - state.last_volume;
+        }
+        state.last_volume = volume_24h;
+    }
+
+    bool has_mid = bid > 0 && ask > 0;
+    double mid = has_mid ? (bid + ask) / 2.0 : 0.0;
+    double spread = has_mid ? ask - bid : 0.0;
+
+    for (size_t i = 0; i < intervals_.size(); i++) {
+        OpenBar& open_bar = state.bars[i];
+        TickerBar& bar = open_bar.bar;
+        double interval = static_cast<double>(intervals_[i]);
+        double start = std::floor(time / interval) * interval;
+
+        if (bar.ticks > 0 && start != bar.start) {
+            emit(open_bar);
+        }
+        if (bar.ticks == 0) {
+            bar.start = start;
+        }
+        bar.ticks++;
+        bar.volume += volume_delta;
+
+        if (last > 0) {
+            if (!bar.has_price) {
+                bar.open = bar.high = bar.low = last;
+                bar.has_price = true;
+            }
+            bar.high = std::max(bar.high, last);
+            bar.low = std::min(bar.low, last);
+            bar.close = last;
+        }
+
+        if (has_mid) {
+            if (!bar.has_mid) {
+                bar.mid_open = bar.mid_high = bar.mid_low = mid;
+                bar.spread_min = bar.spread_max = spread;
+                bar.has_mid = true;
+            }
+            bar.mid_high = std::max(bar.mid_high, mid);
+            bar.mid_low = std::min(bar.mid_low, mid);
+            bar.mid_close = mid;
+            bar.spread_min = std::min(bar.spread_min, spread);
+            bar.spread_max = std::max(bar.spread_max, spread);
+            open_bar.spread_sum += spread;
+            open_bar.spread_bps_sum += spread / mid * 10000.0;
+            open_bar.spread_ticks++;
+        }
+    }
+}
+
+void TickerBarBuilder::finish() {
+    for (auto& pair : symbols_) {
+        for (auto& open_bar : pair.second.bars) {
+            if (open_bar.bar.ticks > 0) {
+                emit(open_bar);
+            }
+        }
+    }
+}
+
+void TickerBarBuilder::emit(OpenBar& open_bar) {
+    TickerBar& bar = open_bar.bar;
+    if (open_bar.spread_ticks > 0) {
+        bar.spread_mean = open_bar.spread_sum / open_bar.spread_ticks;
+        bar.spread_bps_mean = open_bar.spread_bps_sum / open_bar.spread_ticks;
+    }
+    on_bar_(bar);
+    bar_count_++;
+
+    // Reset for the next bar (symbol and interval stay)
+    bar.ticks = 0;
+    bar.open = bar.high = bar.low = bar.close = bar.volume = 0;
+    bar.mid_open = bar.mid_high = bar.mid_low = bar.mid_close = 0;
+    bar.spread_mean = bar.spread_min = bar.spread_max = bar.spread_bps_mean = 0;
+    open_bar.spread_sum = 0;
+    open_bar.spread_bps_sum = 0;
+    open_bar.spread_ticks = 0;
+    bar.has_price = false;
+    bar.has_mid = false;
+}
+
+} // namespace kraken
@@ -0,0 +1,142 @@
+/**
+ * Ticker Bars
+ *
+ * Aggregates Level 1 ticker records (best bid/ask, last price, rolling 24h
+ * volume) into time bars per symbol, at several intervals in one pass.
+ *
+ * Each bar carries:
+ * - OHLC of the last traded price
+ * - Volume: sum of the increases of the rolling 24h volume between ticks
+ *   (an estimate of the volume traded in the bar; trades leaving the 24h
+ *   window can hide part of it)
+ * - OHLC of the mid price
+ * - Spread mean / min / max (absolute) and mean spread in bps
+ *
+ * Bars are aligned to multiples of the interval since the epoch (UTC) and
+ * closed by the first tick of a later bar; intervals without ticks produce
+ * no bar.
+ */
+
+#ifndef TICKER_BARS_HPP
+#define TICKER_BARS_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <cstddef>
+
+namespace kraken {
+
+/**
+ * One completed bar
+ */
+struct TickerBar {
+    std::string symbol;
+    int interval_seconds;
+    double start;          // Bar start, seconds since the epoch (UTC)
+    size_t ticks;
+    bool has_price;        // Some tick had a last price
+    bool has_mid;          // Some tick had both sides
+
+    // Last price
+    double open;
+    double high;
+    double low;
+    double close;
+    double volume;
+
+    // Mid price
+    double mid_open;
+    double mid_high;
+    double mid_low;
+    double mid_close;
+
+    // Spread (over ticks with both sides)
+    double spread_mean;
+    double spread_min;
+    double spread_max;
+    double spread_bps_mean;
+
+    TickerBar()
+        : interval_seconds(0), start(0), ticks(0), has_price(false), has_mid(false),
+          open(0), high(0), low(0), close(0), volume(0),
+          mid_open(0), mid_high(0), mid_low(0), mid_close(0),
+          spread_mean(0), spread_min(0), spread_max(0), spread_bps_mean(0) {}
+};
+
+/**
+ * Builds bars for every symbol at a fixed set of intervals
+ */
+class TickerBarBuilder {
+public:
+    typedef std::function<void(const TickerBar&)> BarCallback;
+
+    /**
+     * @param intervals Bar intervals in seconds
+     * @param on_bar Called for every completed bar
+     */
+    TickerBarBuilder(const std::vector<int>& intervals, BarCallback on_bar);
+
+    /**
+     * Add one ticker record
+     * Non-positive prices (missing side) are ignored for the affected values.
+     * @param time Seconds since the epoch (UTC)
+     * @param volume_24h Rolling 24h volume (negative if unknown)
+     */
+    void add(const std::string& symbol, double time, double bid, double ask,
+             double last, double volume_24h);
+
+    /**
+     * Emit all open bars (end of input)
+     */
+    void finish();
+
+    /**
+     * Records out of time order (ignored)
+     */
+    size_t get_out_of_order_count() const { return out_of_order_; }
+
+    size_t get_bar_count() const { return bar_count_; }
+
+private:
+    /**
+     * Bar being built
+     */
+    struct OpenBar {
+        TickerBar bar;
+        double spread_sum;
+        double spread_bps_sum;
+        size_t spread_ticks;
+
+        OpenBar() : spread_sum(0), spread_bps_sum(0), spread_ticks(0) {}
+    };
+
+    /**
+     * Per-symbol state: one open bar per interval
+     */
+    struct SymbolBars {
+        std::vector<OpenBar> bars;
+        double last_time;
+        double last_volume;
+
+        SymbolBars() : last_time(0), last_volume(-1) {}
+    };
+
+    std::vector<int> intervals_;
+    BarCallback on_bar_;
+    std::map<std::string, SymbolBars> symbols_;
+    size_t out_of_order_;
+    size_t bar_count_;
+
+    SymbolBars& get_symbol(const std::string& symbol);
+
+    /**
+     * Finish a bar's averages and hand it to the callback
+     */
+    void emit(OpenBar& open_bar);
+};
+
+} // namespace kraken
+
+#endif // TICKER_BARS_HPP
@@ -0,0 +1,137 @@
+/**
+ * TLS Context and Session Cache - Implementation
+ */
+
+#include "tls_session_cache.hpp"
+#include <iostream>
+
+namespace kraken {
+
+TlsSessionCache& TlsSessionCache::instance() {
+    static TlsSessionCache cache;
+    return cache;
+}
+
+TlsSessionCache::TlsSessionCache()
+    : resumption_enabled_(true) {
+}
+
+TlsSessionCache::~TlsSessionCache() {
+    clear_sessions();
+}
+
+TlsSessionCache::context_ptr TlsSessionCache::get_context() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (context_) {
+        return context_;
+    }
+
+    context_ = std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::sslv23);
+
+    try {
+        context_->set_options(boost::asio::ssl::context::default_workarounds |
+                              boost::asio::ssl::context::no_sslv2 |
+                              boost::asio::ssl::context::no_sslv3 |
+                              boost::asio::ssl::context::single_dh_use);
+    } catch (const std::exception& e) {
+        std::cerr << "[Error] TLS context options: " << e.what() << std::endl;
+    }
+
+    // Client-side caching: OpenSSL hands every new session (including TLS 1.3
+    // post-handshake tickets) to on_new_session; we keep them per host
+    SSL_CTX* native = context_->native_handle();
+    SSL_CTX_set_session_cache_mode(native, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_sess_set_new_cb(native, &TlsSessionCache::on_new_session);
+
+    return context_;
+}
+
+void TlsSessionCache::prepare(SSL* ssl, const std::string& host) {
+    if (ssl == nullptr) {
+        return;
+    }
+
+    // Sessions are keyed by SNI, so make sure it is set
+    if (!host.empty() && SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name) == nullptr) {
+        SSL_set_tlsext_host_name(ssl, host.c_str());
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!resumption_enabled_) {
+        return;
+    }
+
+    auto it = sessions_.find(host);
+    if (it != sessions_.end()) {
+        SSL_set_session(ssl, it->second);  // Takes its own reference
+    }
+}
+
+void TlsSessionCache::record_handshake(double ms, bool resumed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.record(ms, resumed);
+}
+
+void TlsSessionCache::set_resumption_enabled(bool enabled) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        resumption_enabled_ = enabled;
+    }
+    if (!enabled) {
+        clear_sessions();
+    }
+}
+
+bool TlsSessionCache::is_resumption_enabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return resumption_enabled_;
+}
+
+TlsHandshakeStats TlsSessionCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+size_t TlsSessionCache::get_cached_session_count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sessions_.size();
+}
+
+void TlsSessionCache::clear_sessions() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& entry : sessions_) {
+        SSL_SESSION_free(entry.second);
+    }
+    sessions_.clear();
+}
+
+int TlsSessionCache::on_new_session(SSL* ssl, SSL_SESSION* session) {
+    const char* host = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+    if (host == nullptr) {
+        return 0;  // Cannot key it; OpenSSL frees the session
+    }
+
+    instance().store_session(host, session);
+    return 1;
+}
+
+void TlsSessionCache::store_session(const std::string& host, SSL_SESSION* session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (!resumption_enabled_) {
+        SSL_SESSION_free(session);
+        return;
+    }
+
+    // Newest session wins (TLS 1.3 servers often send several tickets)
+    auto it = sessions_.find(host);
+    if (it != sessions_.end()) {
+        SSL_SESSION_free(it->second);
+        it->second = session;
+    } else {
+        sessions_.emplace(host, session);
+    }
+}
+
+} // namespace kraken
@@ -0,0 +1,144 @@
+/**
+ * TLS Context and Session Cache
+ *
+ * One long-lived boost::asio::ssl::context per process, shared by every
+ * WebSocket client, with client-side TLS session caching so reconnects and
+ * additional sharded connections resume the previous session (abbreviated
+ * handshake) instead of paying for a full one.
+ *
+ * Sessions are cached per server name (SNI). They are captured through
+ * OpenSSL's new-session callback, which also covers TLS 1.3 where tickets
+ * arrive after the handshake has completed.
+ *
+ * Client integration (I/O thread):
+ *   on_tls_init          -> return TlsSessionCache::instance().get_context()
+ *   tcp pre-init handler -> timer.start(); cache.prepare(ssl, host)
+ *   tcp post-init handler-> stats.record(timer.elapsed_ms(), SSL_session_reused(ssl))
+ */
+
+#ifndef TLS_SESSION_CACHE_HPP
+#define TLS_SESSION_CACHE_HPP
+
+#include <string>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <boost/asio/ssl.hpp>
+
+namespace kraken {
+
+/**
+ * TLS handshake timing (per client or process-wide)
+ */
+struct TlsHandshakeStats {
+    uint64_t handshakes;    // Completed handshakes
+    uint64_t resumed;       // Handshakes that resumed a cached session
+    double last_ms;         // Most recent handshake duration
+    double total_ms;        // Sum of all handshake durations
+    double max_ms;          // Slowest handshake
+
+    TlsHandshakeStats()
+        : handshakes(0), resumed(0), last_ms(0.0), total_ms(0.0), max_ms(0.0) {}
+
+    void record(double ms, bool was_resumed) {
+        handshakes++;
+        if (was_resumed) {
+            resumed++;
+        }
+        last_ms = ms;
+        total_ms += ms;
+        if (ms > max_ms) {
+            max_ms = ms;
+        }
+    }
+
+    double avg_ms() const {
+        return handshakes > 0 ? total_ms / handshakes : 0.0;
+    }
+};
+
+/**
+ * Handshake stopwatch for one connection attempt (I/O thread only)
+ */
+class TlsHandshakeTimer {
+public:
+    void start() { start_ = std::chrono::steady_clock::now(); }
+
+    double elapsed_ms() const {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Process-wide shared SSL context with client session cache
+ *
+ * Thread-safe; used concurrently by the I/O threads of all clients.
+ */
+class TlsSessionCache {
+public:
+    using context_ptr = std::shared_ptr<boost::asio::ssl::context>;
+
+    static TlsSessionCache& instance();
+
+    // Disable copy
+    TlsSessionCache(const TlsSessionCache&) = delete;
+    TlsSessionCache& operator=(const TlsSessionCache&) = delete;
+
+    /**
+     * Shared client context (created on first use)
+     */
+    context_ptr get_context();
+
+    /**
+     * Prepare a connection before its handshake
+     * Sets SNI if the transport has not, and offers the cached session for
+     * that server name when resumption is enabled.
+     * @param ssl Connection's SSL handle
+     * @param host Server name (e.g. "ws.kraken.com")
+     */
+    void prepare(SSL* ssl, const std::string& host);
+
+    /**
+     * Add a completed handshake to the process-wide statistics
+     */
+    void record_handshake(double ms, bool resumed);
+
+    /**
+     * Enable or disable session resumption (default: enabled)
+     * Disabling also drops the cached sessions.
+     */
+    void set_resumption_enabled(bool enabled);
+    bool is_resumption_enabled() const;
+
+    TlsHandshakeStats get_stats() const;
+    size_t get_cached_session_count() const;
+    void clear_sessions();
+
+private:
+    TlsSessionCache();
+    ~TlsSessionCache();
+
+    mutable std::mutex mutex_;
+    context_ptr context_;
+    std::map<std::string, SSL_SESSION*> sessions_;  // Owned references
+    bool resumption_enabled_;
+    TlsHandshakeStats stats_;
+
+    /**
+     * OpenSSL new-session callback (any I/O thread)
+     * @return 1 (cache keeps the reference)
+     */
+    static int on_new_session(SSL* ssl, SSL_SESSION* session);
+
+    void store_session(const std::string& host, SSL_SESSION* session);
+};
+
+} // namespace kraken
+
+#endif // TLS_SESSION_CACHE_HPP
@@ -0,0 +1,159 @@
+/**
+ * CSV Writer for Trade Data - Implementation
+ */
+
+#include "trade_csv_writer.hpp"
+#include "alloc_counter.hpp"
+#include "stage_trace.hpp"
+#include <iostream>
+#include <iomanip>
+
+namespace kraken {
+
+TradeCsvWriter::TradeCsvWriter(const std::string& filename)
+    : FlushSegmentMixin<TradeCsvWriter>(),  // Initialize mixin
+      record_count_(0), header_written_(false) {
+
+    // Store base filename for segmentation
+    set_base_filename(filename);
+
+    // Note: File opens later:
+    // - When set_segment_mode() is called (if segmentation enabled)
+    // - On first write (if segmentation disabled)
+    record_buffer_.reserve(4096);  // Bursts arrive dozens of trades per frame
+}
+
+TradeCsvWriter::~TradeCsvWriter() {
+    if (!record_buffer_.empty()) {
+        force_flush();
+    }
+
+    if (file_.is_open()) {
+        file_.close();
+    }
+}
+
+bool TradeCsvWriter::is_open() const {
+    return file_.is_open();
+}
+
+size_t TradeCsvWriter::get_record_count() const {
+    return record_count_;
+}
+
+bool TradeCsvWriter::ensure_open() {
+    if (!file_.is_open() && segment_mode_ == SegmentMode::NONE) {
+        file_.open(base_filename_, std::ios::out);
+        if (!file_.is_open()) {
+            std::cerr << "Error: Cannot open file for writing: " << base_filename_ << std::endl;
+            return false;
+        }
+        header_written_ = false;
+        current_segment_filename_ = base_filename_;
+    }
+    return file_.is_open();
+}
+
+bool TradeCsvWriter::write_record(const TradeRecord& record) {
+    advance_event_time(record.trade_timestamp);
+    if (!ensure_open()) {
+        return false;
+    }
+
+    record_buffer_.push_back(record);
+    check_and_flush();
+    return true;
+}
+
+bool TradeCsvWriter::write_records(const std::vector<TradeRecord>& records) {
+    KRAKEN_ALLOC_SCOPE("trade_writer.write_records");
+    KRAKEN_TRACE_SCOPE("trade_writer.write");
+    if (segment_clock_ == SegmentClock::EVENT_TIME) {
+        // A frame can straddle an hour: route each trade to its own segment
+        for (const auto& record : records) {
+            advance_event_time(record.trade_timestamp);
+            if (!ensure_open()) {
+                return false;
+            }
+            record_buffer_.push_back(record);
+        }
+        check_and_flush();
+        return true;
+    }
+
+    if (!ensure_open()) {
+        return false;
+    }
+
+    record_buffer_.insert(record_buffer_.end(), records.begin(), records.end());
+
+    // One check per frame instead of per trade
+    check_and_flush();
+    return true;
+}
+
+void TradeCsvWriter::flush() {
+    force_flush();
+}
+
+// ============================================================================
+// CRTP Interface Implementation
+// ============================================================================
+
+void TradeCsvWriter::perform_flush() {
+    KRAKEN_ALLOC_SCOPE("trade_writer.flush");
+    if (!file_.is_open() || record_buffer_.empty()) {
+        return;
+    }
+
+    if (!header_written_) {
+        file_ << "timestamp,symbol,type,side,ord_type,price,qty,trade_id,trade_timestamp\n";
+        header_written_ = true;
+    }
+
+    // Same precision as the order book writers
+    for (const auto& record : record_buffer_) {
+        file_ << record.timestamp << ","
+              << record.symbol << ","
+              << record.type << ","
+              << record.side << ","
+              << record.ord_type << ","
+              << std::fixed << std::setprecision(10) << record.price << ","
+              << std::fixed << std::setprecision(8) << record.qty << ","
+              << record.trade_id << ","
+              << record.trade_timestamp << "\n";
+    }
+    record_count_ += record_buffer_.size();
+
+    file_.flush();
+
+    // Keep capacity: the next burst reuses it
+    record_buffer_.clear();
+}
+
+void TradeCsvWriter::perform_segment_transition(const std::string& new_filename) {
+    if (file_.is_open()) {
+        file_.close();
+    }
+
+    // Open new segment file (overwrite, but append when a late record
+    // leads back to a segment written earlier in this run)
+    bool revisit = segment_entered(new_filename);
+    file_.open(new_filename, revisit ? (std::ios::out | std::ios::app) : std::ios::out);
+    header_written_ = false;
+    if (revisit) {
+        std::ifstream check(new_filename, std::ios::binary | std::ios::ate);
+        header_written_ = check.is_open() && check.tellg() > 0;
+    }
+
+    if (!file_.is_open()) {
+        std::cerr << "Error: Cannot open segment file: " << new_filename << std::endl;
+    }
+}
+
+void TradeCsvWriter::on_segment_mode_set() {
+    // Create first segment file when segmentation is enabled
+    perform_segment_transition(current_segment_filename_);
+}
+
+} // namespace kraken
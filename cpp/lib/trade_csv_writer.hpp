@@ -0,0 +1,112 @@
+/**
+ * CSV Writer for Trade Data
+ *
+ * Writes TradeRecord data to .csv, one row per trade.
+ * Batches are appended with one call per WebSocket frame, so a burst of
+ * trades costs a single buffer insert and flush check.
+ *
+ * Uses FlushSegmentMixin for periodic flushing and segmentation; with
+ * SegmentClock::EVENT_TIME trades are segmented by their exchange time
+ * (trade_timestamp), not the local receive time
+ */
+
+#ifndef TRADE_CSV_WRITER_HPP
+#define TRADE_CSV_WRITER_HPP
+
+#include "kraken_common.hpp"
+#include "flush_segment_mixin.hpp"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace kraken {
+
+/**
+ * Trade CSV Writer
+ * Writes trade records to .csv format with periodic flushing and segmentation
+ */
+class TradeCsvWriter : public FlushSegmentMixin<TradeCsvWriter> {
+    friend class FlushSegmentMixin<TradeCsvWriter>;  // Allow mixin to access private interface
+
+public:
+    /**
+     * Constructor
+     * @param filename Output filename
+     */
+    explicit TradeCsvWriter(const std::string& filename);
+
+    /**
+     * Destructor - closes file and flushes remaining data
+     */
+    ~TradeCsvWriter();
+
+    /**
+     * Write one trade (buffered with periodic flush)
+     */
+    bool write_record(const TradeRecord& record);
+
+    /**
+     * Write all trades of one frame (buffered with periodic flush)
+     */
+    bool write_records(const std::vector<TradeRecord>& records);
+
+    /**
+     * Flush buffered data to disk
+     */
+    void flush();
+
+    /**
+     * Check if file is open and writable
+     */
+    bool is_open() const;
+
+    /**
+     * Get number of records written (total across all flushes)
+     */
+    size_t get_record_count() const;
+
+    // Note: Flush/segment configuration methods inherited from FlushSegmentMixin
+    // - void set_flush_interval(std::chrono::seconds interval)
+    // - void set_memory_threshold(size_t bytes)
+    // - void set_segment_clock(SegmentClock clock)
+    // - void set_segment_mode(SegmentMode mode)
+    // - size_t get_flush_count() const
+    // - size_t get_current_memory_usage() const
+    // - size_t get_segment_count() const
+    // - std::string get_current_segment_filename() const
+
+private:
+    std::ofstream file_;
+    size_t record_count_;
+    bool header_written_;
+    std::vector<TradeRecord> record_buffer_;
+
+    /**
+     * Open the base file on first write (non-segmented mode)
+     */
+    bool ensure_open();
+
+    // ========================================================================
+    // CRTP Interface Implementation (required by FlushSegmentMixin)
+    // ========================================================================
+
+    size_t get_buffer_size() const {
+        return record_buffer_.size();
+    }
+
+    size_t get_record_size() const {
+        return sizeof(TradeRecord);
+    }
+
+    std::string get_file_extension() const {
+        return ".csv";
+    }
+
+    void perform_flush();
+    void perform_segment_transition(const std::string& new_filename);
+    void on_segment_mode_set();
+};
+
+} // namespace kraken
+
+#endif // TRADE_CSV_WRITER_HPP
@@ -0,0 +1,153 @@
+/**
+ * WebSocket permessage-deflate (RFC 7692)
+ *
+ * websocketpp picks its compression extension at compile time through the
+ * endpoint config. asio_tls_client_deflate plugs in DeflateExtension, which
+ * only offers permessage-deflate in the client handshake while
+ * WebSocketDeflate is enabled, so the choice stays a runtime setting.
+ *
+ * Inflate runs on the connection's I/O thread inside websocketpp's frame
+ * processing, through the extension's reusable inflate buffer. The
+ * compressed/inflated byte counts and the time spent inflating are recorded
+ * so the bandwidth saved can be weighed against the CPU spent.
+ *
+ * The setting is process-wide and read when a connection is opened; the
+ * server may still decline, in which case no bytes are counted.
+ */
+
+#ifndef WEBSOCKET_DEFLATE_HPP
+#define WEBSOCKET_DEFLATE_HPP
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
+
+namespace kraken {
+
+/**
+ * Inflate counters (process-wide)
+ */
+struct DeflateStats {
+    uint64_t inflate_calls;       // Frame payload chunks inflated
+    uint64_t compressed_bytes;    // Bytes received compressed (wire payload)
+    uint64_t inflated_bytes;      // Bytes after inflate
+    uint64_t inflate_ns;          // Time spent inflating
+
+    DeflateStats()
+        : inflate_calls(0), compressed_bytes(0), inflated_bytes(0), inflate_ns(0) {}
+
+    double ratio() const {
+        return compressed_bytes > 0 ? static_cast<double>(inflated_bytes) / compressed_bytes : 0.0;
+    }
+
+    // Inflate cost per byte of received (uncompressed) data
+    double ns_per_inflated_byte() const {
+        return inflated_bytes > 0 ? static_cast<double>(inflate_ns) / inflated_bytes : 0.0;
+    }
+};
+
+/**
+ * Runtime switch and counters for permessage-deflate
+ */
+class WebSocketDeflate {
+public:
+    /**
+     * Offer permessage-deflate on connections opened from now on
+     * (default: disabled)
+     */
+    static void set_enabled(bool enabled) {
+        state().enabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    static bool is_enabled() {
+        return state().enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Count one inflate call (I/O threads)
+     */
+    static void record_inflate(size_t compressed, size_t inflated, uint64_t ns) {
+        State& s = state();
+        s.inflate_calls.fetch_add(1, std::memory_order_relaxed);
+        s.compressed_bytes.fetch_add(compressed, std::memory_order_relaxed);
+        s.inflated_bytes.fetch_add(inflated, std::memory_order_relaxed);
+        s.inflate_ns.fetch_add(ns, std::memory_order_relaxed);
+    }
+
+    static DeflateStats get_stats() {
+        State& s = state();
+        DeflateStats stats;
+        stats.inflate_calls = s.inflate_calls.load(std::memory_order_relaxed);
+        stats.compressed_bytes = s.compressed_bytes.load(std::memory_order_relaxed);
+        stats.inflated_bytes = s.inflated_bytes.load(std::memory_order_relaxed);
+        stats.inflate_ns = s.inflate_ns.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    struct State {
+        std::atomic<bool> enabled{false};
+        std::atomic<uint64_t> inflate_calls{0};
+        std::atomic<uint64_t> compressed_bytes{0};
+        std::atomic<uint64_t> inflated_bytes{0};
+        std::atomic<uint64_t> inflate_ns{0};
+    };
+
+    static State& state() {
+        static State s;
+        return s;
+    }
+};
+
+/**
+ * permessage-deflate extension with runtime offer and inflate accounting
+ *
+ * websocketpp calls these through the config's static type, so they take
+ * the place of the base versions.
+ */
+template <typename config>
+class DeflateExtension : public websocketpp::extensions::permessage_deflate::enabled<config> {
+    typedef websocketpp::extensions::permessage_deflate::enabled<config> base;
+
+public:
+    /**
+     * Extension offer for the client handshake (empty = not offered)
+     */
+    std::string generate_offer() const {
+        return WebSocketDeflate::is_enabled() ? std::string("permessage-deflate") : std::string();
+    }
+
+    /**
+     * Inflate a compressed payload chunk, appending to out (I/O thread)
+     */
+    websocketpp::lib::error_code decompress(uint8_t const* buf, size_t len, std::string& out) {
+        size_t before = out.size();
+        auto start = std::chrono::steady_clock::now();
+
+        websocketpp::lib::error_code ec = base::decompress(buf, len, out);
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        WebSocketDeflate::record_inflate(len, out.size() - before, static_cast<uint64_t>(ns));
+        return ec;
+    }
+};
+
+/**
+ * TLS client config with permessage-deflate available
+ */
+struct asio_tls_client_deflate : public websocketpp::config::asio_tls_client {
+    typedef asio_tls_client_deflate type;
+    typedef websocketpp::config::asio_tls_client base;
+
+    struct permessage_deflate_config {};
+
+    typedef DeflateExtension<permessage_deflate_config> permessage_deflate_type;
+};
+
+} // namespace kraken
+
+#endif // WEBSOCKET_DEFLATE_HPP
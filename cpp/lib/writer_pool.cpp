@@ -0,0 +1,118 @@
+/**
+ * Writer Pool - Implementation
+ */
+
+#include "writer_pool.hpp"
+#include "stage_trace.hpp"
+#include <iostream>
+#include <string>
+
+namespace kraken {
+
+WriterPool::WriterPool(size_t num_lanes, const ThreadPlacement& placement)
+    : next_lane_(0), stopped_(false) {
+    if (num_lanes == 0) {
+        num_lanes = 1;
+    }
+
+    for (size_t i = 0; i < num_lanes; i++) {
+        lanes_.emplace_back(new Lane());
+    }
+    for (size_t i = 0; i < lanes_.size(); i++) {
+        lanes_[i]->thread = std::thread(&WriterPool::run_lane, lanes_[i].get(), placement, i);
+    }
+}
+
+WriterPool::~WriterPool() {
+    stop();
+}
+
+size_t WriterPool::assign_lane() {
+    return next_lane_++ % lanes_.size();
+}
+
+bool WriterPool::submit(size_t lane_index, Task task) {
+    Lane& lane = *lanes_[lane_index % lanes_.size()];
+    {
+        std::lock_guard<std::mutex> lock(lane.mutex);
+        if (lane.stopping) {
+            return false;
+        }
+        lane.tasks.push_back(std::move(task));
+        lane.submitted++;
+        if (lane.tasks.size() > lane.max_queued) {
+            lane.max_queued = lane.tasks.size();
+        }
+    }
+    lane.cv.notify_one();
+    return true;
+}
+
+void WriterPool::stop() {
+    if (stopped_.exchange(true)) {
+        return;
+    }
+
+    for (auto& lane : lanes_) {
+        {
+            std::lock_guard<std::mutex> lock(lane->mutex);
+            lane->stopping = true;
+        }
+        lane->cv.notify_one();
+    }
+    for (auto& lane : lanes_) {
+        if (lane->thread.joinable()) {
+            lane->thread.join();
+        }
+    }
+}
+
+WriterPool::PoolStats WriterPool::get_stats() const {
+    PoolStats stats = {};
+    stats.lanes = lanes_.size();
+
+    for (const auto& lane : lanes_) {
+        std::lock_guard<std::mutex> lock(lane->mutex);
+        stats.queued += lane->tasks.size();
+        if (lane->max_queued > stats.max_queued) {
+            stats.max_queued = lane->max_queued;
+        }
+        stats.submitted += lane->submitted;
+        stats.executed += lane->executed;
+    }
+    return stats;
+}
+
+void WriterPool::run_lane(Lane* lane, ThreadPlacement placement, size_t index) {
+    KRAKEN_TRACE_THREAD_NAME("writer_pool");
+    placement.apply("writer_pool_" + std::to_string(index), index);
+
+    std::deque<Task> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(lane->mutex);
+            lane->cv.wait(lock, [lane] { return !lane->tasks.empty() || lane->stopping; });
+
+            if (lane->tasks.empty()) {
+                return;  // Stopping and drained
+            }
+            batch.swap(lane->tasks);  // Take everything queued in one lock
+        }
+
+        for (auto& task : batch) {
+            try {
+                task();
+            } catch (const std::exception& e) {
+                std::cerr << "[Error] Writer pool task failed: " << e.what() << std::endl;
+            }
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(lane->mutex);
+            lane->executed += batch.size();
+        }
+        batch.clear();
+    }
+}
+
+} // namespace kraken
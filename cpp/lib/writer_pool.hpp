@@ -0,0 +1,109 @@
+/**
+ * Writer Pool
+ *
+ * Moves file output off the WebSocket I/O threads. A small number of lanes,
+ * each a FIFO queue drained by one thread, is shared by all outputs of a
+ * process. Every output is pinned to one lane, so its records are written
+ * in arrival order by a single thread and the writers themselves need no
+ * locking.
+ *
+ * Usage:
+ *   WriterPool pool(2);
+ *   size_t lane = pool.assign_lane();
+ *   client.set_update_callback([&](const OrderBookRecord& record) {
+ *       pool.submit(lane, [&writer, record]() { writer.write_record(record); });
+ *   });
+ *   ...
+ *   pool.stop();   // Drains all queues, then joins
+ */
+
+#ifndef WRITER_POOL_HPP
+#define WRITER_POOL_HPP
+
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include "thread_placement.hpp"
+
+namespace kraken {
+
+class WriterPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * Aggregate counters across lanes
+     */
+    struct PoolStats {
+        size_t lanes;
+        size_t queued;              // Tasks waiting right now
+        size_t max_queued;          // High-water mark of a single lane
+        uint64_t submitted;
+        uint64_t executed;
+    };
+
+    /**
+     * Constructor - starts one thread per lane
+     * @param num_lanes Number of lanes / threads (at least 1)
+     * @param placement Lane threads' placement (lane i on the i-th CPU)
+     */
+    explicit WriterPool(size_t num_lanes, const ThreadPlacement& placement = ThreadPlacement());
+
+    /**
+     * Destructor - drains and joins (same as stop())
+     */
+    ~WriterPool();
+
+    // Disable copy
+    WriterPool(const WriterPool&) = delete;
+    WriterPool& operator=(const WriterPool&) = delete;
+
+    /**
+     * Lane for a new output (round-robin)
+     */
+    size_t assign_lane();
+
+    /**
+     * Queue a task on a lane (any thread)
+     * @return false if the pool is stopped
+     */
+    bool submit(size_t lane, Task task);
+
+    /**
+     * Run all queued tasks, then join the lane threads
+     */
+    void stop();
+
+    PoolStats get_stats() const;
+    size_t size() const { return lanes_.size(); }
+
+private:
+    struct Lane {
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Task> tasks;
+        size_t max_queued;
+        uint64_t submitted;
+        uint64_t executed;
+        bool stopping;
+        std::thread thread;
+
+        Lane() : max_queued(0), submitted(0), executed(0), stopping(false) {}
+    };
+
+    std::vector<std::unique_ptr<Lane>> lanes_;
+    std::atomic<size_t> next_lane_;
+    std::atomic<bool> stopped_;
+
+    static void run_lane(Lane* lane, ThreadPlacement placement, size_t index);
+};
+
+} // namespace kraken
+
+#endif // WRITER_POOL_HPP
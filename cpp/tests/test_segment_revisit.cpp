@@ -0,0 +1,128 @@
+/**
+ * Event-Time Segment Revisit Test
+ *
+ * A late record whose timestamp falls in an earlier hour is written back to
+ * that hour's segment file. The file must be appended to, not truncated:
+ * every record has to survive, each in the segment of its own timestamp.
+ *
+ * Run from any writable directory; returns non-zero on failure.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "jsonl_writer.hpp"
+#include "trade_csv_writer.hpp"
+
+using kraken::JsonLinesWriter;
+using kraken::TradeCsvWriter;
+using kraken::OrderBookRecord;
+using kraken::TradeRecord;
+using kraken::SegmentMode;
+using kraken::SegmentClock;
+
+namespace {
+
+// Arrival order: the fourth record belongs to the previous hour
+const char* const TIMESTAMPS[] = {
+    "2025-11-12 10:59:59.000",
+    "2025-11-12 10:59:59.500",
+    "2025-11-12 11:00:00.001",
+    "2025-11-12 10:59:59.900",
+    "2025-11-12 11:00:00.500"
+};
+
+std::vector<std::string> read_lines(const std::string& filename) {
+    std::vector<std::string> lines;
+    std::ifstream file(filename);
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+/**
+ * Check that a segment holds exactly the expected timestamps, in order
+ */
+bool expect_segment(const std::string& filename, size_t header_lines,
+                    const std::vector<std::string>& timestamps) {
+    std::vector<std::string> lines = read_lines(filename);
+    bool ok = lines.size() == header_lines + timestamps.size();
+    for (size_t i = 0; ok && i < timestamps.size(); i++) {
+        ok = lines[header_lines + i].find(timestamps[i]) != std::string::npos;
+    }
+
+    if (!ok) {
+        std::cerr << "FAIL " << filename << ": expected " << header_lines + timestamps.size()
+                  << " lines, found " << lines.size() << std::endl;
+        for (const auto& line : lines) {
+            std::cerr << "  " << line << std::endl;
+        }
+    }
+    std::remove(filename.c_str());
+    return ok;
+}
+
+bool test_jsonl_writer() {
+    {
+        JsonLinesWriter writer("segment_revisit_book.jsonl");
+        writer.set_flush_interval(std::chrono::seconds(0));
+        writer.set_memory_threshold(0);
+        writer.set_segment_clock(SegmentClock::EVENT_TIME);
+        writer.set_segment_mode(SegmentMode::HOURLY);
+
+        for (const char* timestamp : TIMESTAMPS) {
+            OrderBookRecord record;
+            record.timestamp = timestamp;
+            record.symbol = "BTC/USD";
+            record.type = "update";
+            writer.write_record(record);
+        }
+        writer.flush();
+    }
+
+    bool ok = expect_segment("segment_revisit_book.20251112_10.jsonl", 0,
+                             {TIMESTAMPS[0], TIMESTAMPS[1], TIMESTAMPS[3]});
+    ok = expect_segment("segment_revisit_book.20251112_11.jsonl", 0,
+                        {TIMESTAMPS[2], TIMESTAMPS[4]}) && ok;
+    return ok;
+}
+
+bool test_trade_csv_writer() {
+    {
+        TradeCsvWriter writer("segment_revisit_trades.csv");
+        writer.set_flush_interval(std::chrono::seconds(0));
+        writer.set_memory_threshold(0);
+        writer.set_segment_clock(SegmentClock::EVENT_TIME);
+        writer.set_segment_mode(SegmentMode::HOURLY);
+
+        for (const char* timestamp : TIMESTAMPS) {
+            TradeRecord record;
+            record.timestamp = timestamp;
+            record.symbol = "BTC/USD";
+            record.type = "update";
+            writer.write_record(record);
+        }
+        writer.flush();
+    }
+
+    // One header per file, not repeated when the segment is revisited
+    bool ok = expect_segment("segment_revisit_trades.20251112_10.csv", 1,
+                             {TIMESTAMPS[0], TIMESTAMPS[1], TIMESTAMPS[3]});
+    ok = expect_segment("segment_revisit_trades.20251112_11.csv", 1,
+                        {TIMESTAMPS[2], TIMESTAMPS[4]}) && ok;
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    bool ok = test_jsonl_writer();
+    ok = test_trade_csv_writer() && ok;
+
+    std::cout << (ok ? "PASS" : "FAIL") << ": event-time segment revisit" << std::endl;
+    return ok ? 0 : 1;
+}